@@ -1,5 +1,7 @@
 #include "sticker_algebra.h"
 
+static int _cuboid_count_centers_off(const Cuboid * cuboid, int axisOnly);
+
 int cuboid_is_center_solid(const Cuboid * cuboid, int face) {
     int centerCount = cuboid_count_centers_for_face(cuboid, face);
     int i, expected = 0;
@@ -24,6 +26,45 @@ int cuboid_is_dedge_paired(const Cuboid * cuboid, int dedge) {
     return 1;
 }
 
+int cuboid_count_moved_dedges(const Cuboid * operation) {
+    int i, j, count = 0;
+    for (i = 0; i < 12; i++) {
+        int edgeCount = cuboid_count_edges_for_dedge(operation, i);
+        for (j = 0; j < edgeCount; j++) {
+            CuboidEdge e = operation->edges[cuboid_edge_index(operation, i, j)];
+            if (e.dedgeIndex != i || e.edgeIndex != j || e.symmetry != 0) break;
+        }
+        if (j < edgeCount) count++;
+    }
+    return count;
+}
+
+int cuboid_count_moved_centers(const Cuboid * operation) {
+    int face, i, count = 0;
+    for (face = 1; face <= 6; face++) {
+        int centerCount = cuboid_count_centers_for_face(operation, face);
+        for (i = 0; i < centerCount; i++) {
+            CuboidCenter c = operation->centers[cuboid_center_index(operation, face, i)];
+            if (c.side != face || c.index != i) count++;
+        }
+    }
+    return count;
+}
+
+int cuboid_count_misplaced_centers(const Cuboid * cuboid) {
+    return _cuboid_count_centers_off(cuboid, 0);
+}
+
+int cuboid_count_off_axis_centers(const Cuboid * cuboid) {
+    return _cuboid_count_centers_off(cuboid, 1);
+}
+
+int cuboid_moves_needed(int count, int perMove) {
+    if (count == 0) return 0;
+    if (perMove == 0) return 0xffff;
+    return (count + perMove - 1) / perMove;
+}
+
 int stickermap_face_is_solid_color(const StickerMap * map, int face) {
     int w, h, i;
     stickermap_dimensions_of_face(map, face, &w, &h);
@@ -36,3 +77,21 @@ int stickermap_face_is_solid_color(const StickerMap * map, int face) {
     }
     return 1;
 }
+
+/***********
+ * Private *
+ ***********/
+
+static int _cuboid_count_centers_off(const Cuboid * cuboid, int axisOnly) {
+    int face, i, count = 0;
+    for (face = 1; face <= 6; face++) {
+        int centerCount = cuboid_count_centers_for_face(cuboid, face);
+        for (i = 0; i < centerCount; i++) {
+            CuboidCenter c = cuboid->centers[cuboid_center_index(cuboid, face, i)];
+            if (axisOnly) {
+                if ((c.side - 1) / 2 != (face - 1) / 2) count++;
+            } else if (c.side != face) count++;
+        }
+    }
+    return count;
+}
@@ -3,4 +3,19 @@
 
 int cuboid_is_center_solid(const Cuboid * cuboid, int face);
 int cuboid_is_dedge_paired(const Cuboid * cuboid, int dedge);
+
+// the number of dedges, or centers, which `operation` moves or turns a
+// piece of; applying it to a cuboid changes nothing anywhere else
+int cuboid_count_moved_dedges(const Cuboid * operation);
+int cuboid_count_moved_centers(const Cuboid * operation);
+
+// the number of centers which are not on their own face, or not even on
+// a face of their own axis
+int cuboid_count_misplaced_centers(const Cuboid * cuboid);
+int cuboid_count_off_axis_centers(const Cuboid * cuboid);
+
+// a lower bound on the moves which fix `count` pieces when no move fixes
+// more than `perMove` of them, or 0xffff if no move fixes any
+int cuboid_moves_needed(int count, int perMove);
+
 int stickermap_face_is_solid_color(const StickerMap * map, int face);
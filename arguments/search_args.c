@@ -4,8 +4,10 @@ static int _cl_sa_process_dims(CLArgumentList * args, CuboidDimensions * dims);
 static void _cl_sa_process_flags(CLArgumentList * args, CLSearchParameters * params);
 static int _cl_sa_process_min_max(CLArgumentList * args, CLSearchParameters * params);
 static int _cl_sa_process_threads(CLArgumentList * args, CLSearchParameters * params);
+static int _cl_sa_process_cache(CLArgumentList * args, CLSearchParameters * params);
 static int _cl_sa_process_operations(CLArgumentList * args, CLSearchParameters * params);
 static int _cl_sa_process_heuristics(CLArgumentList * args, CLSearchParameters * params);
+static int _cl_sa_check_groups(HeuristicList * list, AlgList * operations);
 
 CLArgumentList * cl_sa_default_arguments() {
     CLArgumentList * list = cl_argument_list_new();
@@ -13,11 +15,19 @@ CLArgumentList * cl_sa_default_arguments() {
     cl_argument_list_add(list, cl_argument_new_string("dimensions", "3x3x3"));
     cl_argument_list_add(list, cl_argument_new_string("operations", ""));
     cl_argument_list_add(list, cl_argument_new_string("heuristic", ""));
+    cl_argument_list_add(list, cl_argument_new_string("additive", ""));
     cl_argument_list_add(list, cl_argument_new_flag("multiple", 0));
     cl_argument_list_add(list, cl_argument_new_flag("verbose", 0));
+    cl_argument_list_add(list, cl_argument_new_flag("batch", 0));
+    cl_argument_list_add(list, cl_argument_new_flag("dual", 0));
+    cl_argument_list_add(list, cl_argument_new_flag("filter", 0));
+    cl_argument_list_add(list, cl_argument_new_flag("compress", 0));
+    cl_argument_list_add(list, cl_argument_new_flag("stats", 0));
     cl_argument_list_add(list, cl_argument_new_integer("mindepth", 0));
     cl_argument_list_add(list, cl_argument_new_integer("maxdepth", 20));
     cl_argument_list_add(list, cl_argument_new_integer("threads", 8));
+    cl_argument_list_add(list, cl_argument_new_integer("cachelines",
+                                                       kHeuristicCacheDefaultLines));
     
     return list;
 }
@@ -28,6 +38,7 @@ int cl_sa_process(CLArgumentList * args, CLSearchParameters * params) {
     _cl_sa_process_flags(args, params);
     if (!_cl_sa_process_min_max(args, params)) return 0;
     if (!_cl_sa_process_threads(args, params)) return 0;
+    if (!_cl_sa_process_cache(args, params)) return 0;
     if (!_cl_sa_process_operations(args, params)) return 0;
     if (!_cl_sa_process_heuristics(args, params)) {
         alg_list_release(params->operations);
@@ -128,6 +139,31 @@ static void _cl_sa_process_flags(CLArgumentList * args, CLSearchParameters * par
     assert(index >= 0);
     argument = cl_argument_list_get(args, index);
     params->verboseFlag = argument->contents.flag.boolValue;
+    
+    index = cl_argument_list_find(args, "batch");
+    assert(index >= 0);
+    argument = cl_argument_list_get(args, index);
+    params->batchFlag = argument->contents.flag.boolValue;
+    
+    index = cl_argument_list_find(args, "dual");
+    assert(index >= 0);
+    argument = cl_argument_list_get(args, index);
+    params->dualFlag = argument->contents.flag.boolValue;
+    
+    index = cl_argument_list_find(args, "filter");
+    assert(index >= 0);
+    argument = cl_argument_list_get(args, index);
+    params->filterFlag = argument->contents.flag.boolValue;
+    
+    index = cl_argument_list_find(args, "compress");
+    assert(index >= 0);
+    argument = cl_argument_list_get(args, index);
+    params->compressFlag = argument->contents.flag.boolValue;
+    
+    index = cl_argument_list_find(args, "stats");
+    assert(index >= 0);
+    argument = cl_argument_list_get(args, index);
+    params->statsFlag = argument->contents.flag.boolValue;
 }
 
 static int _cl_sa_process_min_max(CLArgumentList * args, CLSearchParameters * params) {
@@ -159,6 +195,18 @@ static int _cl_sa_process_threads(CLArgumentList * args, CLSearchParameters * pa
     return (params->threadCount > 0);
 }
 
+static int _cl_sa_process_cache(CLArgumentList * args, CLSearchParameters * params) {
+    int index;
+    CLArgument * argument;
+    
+    index = cl_argument_list_find(args, "cachelines");
+    assert(index >= 0);
+    argument = cl_argument_list_get(args, index);
+    params->cacheLines = argument->contents.integer.value;
+    
+    return (params->cacheLines >= 0);
+}
+
 static int _cl_sa_process_operations(CLArgumentList * args, CLSearchParameters * params) {
     int index;
     CLArgument * argument;
@@ -179,19 +227,50 @@ static int _cl_sa_process_operations(CLArgumentList * args, CLSearchParameters *
 static int _cl_sa_process_heuristics(CLArgumentList * args, CLSearchParameters * params) {
     HeuristicList * list = heuristic_list_new();
     
-    int i;
-    for (i = 0; i < cl_argument_list_count(args); i++) {
+    // the files are loaded together, and then added in order
+    int i, count = 0, argCount = cl_argument_list_count(args);
+    const char ** fileNames = (const char **)malloc(sizeof(char *) * (argCount + 1));
+    int * additives = (int *)malloc(sizeof(int) * (argCount + 1));
+    for (i = 0; i < argCount; i++) {
         CLArgument * argument = cl_argument_list_get(args, i);
-        if (strcmp(argument->name, "heuristic")) continue;
-        const char * fileName = argument->contents.string.value;
-        Heuristic * heuristic = heuristic_from_file(fileName, params->dimensions);
-        if (!heuristic) {
-            heuristic_list_free(list);
-            return 0;
+        int additive = (strcmp(argument->name, "additive") == 0);
+        if (strcmp(argument->name, "heuristic") && !additive) continue;
+        additives[count] = additive;
+        fileNames[count++] = argument->contents.string.value;
+    }
+    
+    int success = (count == 0 || !additives[0]);
+    Heuristic ** heuristics = (Heuristic **)malloc(sizeof(void *) * (count + 1));
+    if (success) {
+        heuristics_from_files(fileNames, count, params->dimensions, heuristics);
+        for (i = 0; i < count; i++) {
+            if (!heuristics[i]) success = 0;
+        }
+        for (i = 0; i < count && !success; i++) {
+            if (heuristics[i]) heuristic_free(heuristics[i]);
         }
-        heuristic_list_add(list, heuristic, fileName);
+    }
+    for (i = 0; i < count && success; i++) {
+        if (additives[i]) {
+            heuristic_list_add_additive(list, heuristics[i], fileNames[i]);
+        } else {
+            heuristic_list_add(list, heuristics[i], fileNames[i]);
+        }
+    }
+    free(fileNames);
+    free(additives);
+    free(heuristics);
+    if (!success) {
+        heuristic_list_free(list);
+        return 0;
+    }
+    if (!_cl_sa_check_groups(list, params->operations)) {
+        heuristic_list_free(list);
+        return 0;
     }
     
+    list->filterLarge = params->filterFlag;
+    list->compressLarge = params->compressFlag;
     Cuboid * temp = cuboid_create(params->dimensions);
     heuristic_list_prepare(list, temp);
     cuboid_free(temp);
@@ -199,3 +278,33 @@ static int _cl_sa_process_heuristics(CLArgumentList * args, CLSearchParameters *
     params->heuristics = list;
     return 1;
 }
+
+static int _cl_sa_check_groups(HeuristicList * list, AlgList * operations) {
+    // a sum is only admissible if no operation counts in two of its terms
+    int first, i, op;
+    for (first = 0; first < list->count; first = i) {
+        int end = heuristic_list_group_end(list, first);
+        if (end == first + 1) {
+            i = end;
+            continue;
+        }
+        for (op = 0; op < operations->entryCount; op++) {
+            Cuboid * operation = operations->entries[op].cuboid;
+            int cost = 0;
+            for (i = first; i < end; i++) {
+                cost += heuristic_operation_cost(list->heuristics[i], operation);
+            }
+            if (cost > 1) {
+                fprintf(stderr, "Error: an operation counts in two additive heuristics.\n");
+                return 0;
+            }
+        }
+        for (i = first; i < end; i++) {
+            if (heuristic_is_dense(list->heuristics[i])) {
+                fprintf(stderr, "Error: dense heuristics cannot be additive.\n");
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
@@ -4,11 +4,18 @@
 #include "arguments.h"
 #include "algebra/basis.h"
 #include "heuristic/heuristic_io.h"
+#include "heuristic/heuristic_cache.h"
 
 typedef struct {
     int minDepth, maxDepth;
     int threadCount;
     int verboseFlag, multipleFlag;
+    int batchFlag;
+    int dualFlag;
+    int filterFlag;
+    int compressFlag;
+    int statsFlag;
+    int cacheLines;
     CuboidDimensions dimensions;
     AlgList * operations;
     HeuristicList * heuristics;
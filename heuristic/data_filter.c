@@ -0,0 +1,76 @@
+#include "data_filter.h"
+
+static uint64_t _data_filter_hash(DataFilter * filter, const uint8_t * key);
+static uint64_t * _data_filter_block(DataFilter * filter, uint64_t hash);
+
+DataFilter * data_filter_create(int keyLen, unsigned long long keyCount) {
+    unsigned long long blockBits = kDataFilterBlockWords * 64;
+    unsigned long long wanted = (keyCount * kDataFilterBitsPerKey) / blockBits + 1;
+    unsigned long long blockCount = 1;
+    while (blockCount < wanted) blockCount <<= 1;
+    
+    void * blocks = NULL;
+    unsigned long long size = blockCount * kDataFilterBlockWords * sizeof(uint64_t);
+    if (posix_memalign(&blocks, 64, size)) return NULL;
+    bzero(blocks, size);
+    
+    DataFilter * filter = (DataFilter *)malloc(sizeof(DataFilter));
+    filter->keyLen = keyLen;
+    filter->blockCount = blockCount;
+    filter->blocks = (uint64_t *)blocks;
+    return filter;
+}
+
+void data_filter_free(DataFilter * filter) {
+    free(filter->blocks);
+    free(filter);
+}
+
+void data_filter_add(DataFilter * filter, const uint8_t * key) {
+    uint64_t hash = _data_filter_hash(filter, key);
+    uint64_t * block = _data_filter_block(filter, hash);
+    int i;
+    for (i = 0; i < kDataFilterBlockWords; i++) {
+        block[i] |= 1ULL << ((hash >> (i * 6)) & 63);
+    }
+}
+
+int data_filter_may_contain(DataFilter * filter, const uint8_t * key) {
+    uint64_t hash = _data_filter_hash(filter, key);
+    uint64_t * block = _data_filter_block(filter, hash);
+    int i;
+    for (i = 0; i < kDataFilterBlockWords; i++) {
+        if (!(block[i] & (1ULL << ((hash >> (i * 6)) & 63)))) return 0;
+    }
+    return 1;
+}
+
+unsigned long long data_filter_memory_size(DataFilter * filter) {
+    return filter->blockCount * kDataFilterBlockWords * sizeof(uint64_t);
+}
+
+/***********
+ * Private *
+ ***********/
+
+static uint64_t _data_filter_hash(DataFilter * filter, const uint8_t * key) {
+    // the same FNV-1a and finalizer as the hash data list
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    int i;
+    for (i = 0; i < filter->keyLen; i++) {
+        hash ^= key[i];
+        hash *= 0x100000001b3ULL;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+static uint64_t * _data_filter_block(DataFilter * filter, uint64_t hash) {
+    // the bits of a block come from the low 48 bits of the hash, so the
+    // block is chosen by a second mix of the whole hash
+    uint64_t index = (hash * 0xc4ceb9fe1a85ec53ULL) >> 16;
+    index &= filter->blockCount - 1;
+    return &filter->blocks[index * kDataFilterBlockWords];
+}
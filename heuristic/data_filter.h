@@ -0,0 +1,47 @@
+#ifndef __DATA_FILTER_H__
+#define __DATA_FILTER_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+// a block is one cache line of 64-bit words
+#define kDataFilterBlockWords 8
+
+// the filter is sized for roughly this many bits per key, which gives
+// about one false positive in a hundred
+#define kDataFilterBitsPerKey 12
+
+/***
+ *
+ * A data filter is a blocked Bloom filter over the keys of a DataList. It
+ * answers "definitely not in the list" from a single cache line, so a
+ * lookup for a missing key does not have to search the list itself.
+ *
+ * Each key sets one bit in every word of one block; both the block and
+ * the bits come from a hash of the key.
+ *
+ */
+
+typedef struct {
+    int keyLen;
+    unsigned long long blockCount; // always a power of two
+    uint64_t * blocks;
+} DataFilter;
+
+DataFilter * data_filter_create(int keyLen, unsigned long long keyCount);
+void data_filter_free(DataFilter * filter);
+
+void data_filter_add(DataFilter * filter, const uint8_t * key);
+
+/**
+ * @return 0 if `key` was never added, 1 if it may have been.
+ */
+int data_filter_may_contain(DataFilter * filter, const uint8_t * key);
+
+/**
+ * Returns the number of bytes the filter uses.
+ */
+unsigned long long data_filter_memory_size(DataFilter * filter);
+
+#endif
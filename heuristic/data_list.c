@@ -3,10 +3,34 @@
 static int data_list_node_subnode_index(DataListNode * node, uint8_t subnodeByte, int * found);
 static void data_list_node_add_subnode(DataListNode * node, DataListNode * subnode, int index);
 
-static int data_list_base_entry_size(DataList * list);
+static int data_list_base_entry_size(DataListNode * base);
 static long long data_list_base_entry_index(DataListNode * base, const uint8_t * entry, int * found);
 static int _compare_data(const uint8_t * left, const uint8_t * right, int len);
 
+static void _data_list_probe_prefetch(DataListProbe * probe);
+
+static DataListNode * _data_list_node_create(DataList * list, uint8_t nodeByte, int depth);
+static void _data_list_node_balance(DataListNode * node);
+static void _data_list_node_split(DataListNode * node);
+static void _data_list_node_reshard(DataListNode * node, unsigned long long targetSize);
+static void _data_list_node_collapse(DataListNode * node);
+static void _data_list_node_gather(DataListNode * target, DataListNode * node, uint8_t * key,
+                                   uint8_t * output, unsigned long long * offset);
+
+static unsigned long long _data_list_node_entry_count(DataListNode * node);
+static int _data_list_freeze(DataList * list, int options);
+static void _data_list_node_strip_header(DataListNode * node, int headerLen);
+static void _data_list_node_set_header_byte(DataListNode * node, int index, uint8_t value);
+static unsigned long long _data_list_node_remove_from(DataListNode * node, uint8_t * key,
+                                                      uint8_t minValue, DataListRemoved removed,
+                                                      void * context);
+static unsigned long long _data_list_node_memory_size(DataListNode * node);
+static unsigned long long _data_list_node_resident_size(DataListNode * node);
+static void _data_list_node_shard_histogram(DataListNode * node, unsigned long long * buckets,
+                                           int bucketCount);
+static void _data_list_node_freeze(DataListNode * node, uint8_t * key, FrozenDataList * frozen,
+                                   DataFilter * filter);
+
 DataList * data_list_create(int dataSize, int headerLen, int shardDepth) {
     assert(dataSize >= shardDepth);
     DataList * list = (DataList *)malloc(sizeof(DataList));
@@ -14,17 +38,35 @@ DataList * data_list_create(int dataSize, int headerLen, int shardDepth) {
     list->dataSize = dataSize;
     list->headerLen = headerLen;
     list->depth = shardDepth;
-    
-    DataListNode * node = (DataListNode *)malloc(sizeof(DataListNode));
-    bzero(node, sizeof(DataListNode));
-    node->list = list;
-    list->rootNode = node;
-    
+    list->rootNode = _data_list_node_create(list, 0, 0);
+    return list;
+}
+
+DataList * data_list_create_adaptive(int dataSize, int headerLen, int maxDepth,
+                                     unsigned long long splitSize) {
+    DataList * list = data_list_create(dataSize, headerLen, maxDepth);
+    list->splitSize = splitSize;
+    return list;
+}
+
+DataList * data_list_create_hashed(int dataSize, int headerLen) {
+    DataList * list = (DataList *)malloc(sizeof(DataList));
+    bzero(list, sizeof(DataList));
+    list->dataSize = dataSize;
+    list->headerLen = headerLen;
+    list->hash = hash_data_list_create(dataSize, headerLen);
     return list;
 }
 
 void data_list_free(DataList * list) {
-    data_list_node_free((DataListNode *)list->rootNode);
+    if (list->filter) data_filter_free(list->filter);
+    if (list->frozen) {
+        frozen_data_list_free(list->frozen);
+    } else if (list->hash) {
+        hash_data_list_free(list->hash);
+    } else {
+        data_list_node_free((DataListNode *)list->rootNode);
+    }
     free(list);
 }
 
@@ -44,19 +86,21 @@ void data_list_node_free(DataListNode * node) {
 }
 
 DataListNode * data_list_find_base(DataList * list, const uint8_t * body, int create) {
+    assert(!list->frozen && !list->hash);
     DataListNode * current = (DataListNode *)list->rootNode;
     int depth;
     for (depth = 0; depth < list->depth; depth++) {
+        // a node without subnodes is a base node if it has entries, if
+        // the list is adaptive, or if nothing will be added below it
+        if (current->subnodeCount == 0) {
+            if (current->dataSize > 0 || list->splitSize || !create) break;
+        }
         int found;
         int index = data_list_node_subnode_index(current, body[depth], &found);
         if (found) {
             current = (DataListNode *)current->subnodes[index];
         } else if (create) {
-            DataListNode * insertMe = (DataListNode *)malloc(sizeof(DataListNode));
-            bzero(insertMe, sizeof(DataListNode));
-            insertMe->list = list;
-            insertMe->nodeByte = body[depth];
-            insertMe->depth = depth + 1;
+            DataListNode * insertMe = _data_list_node_create(list, body[depth], depth + 1);
             data_list_node_add_subnode(current, insertMe, index);
             current = insertMe;
         } else return NULL;
@@ -69,7 +113,7 @@ int data_list_base_add(DataListNode * node, const uint8_t * body, const uint8_t
     long long index = data_list_base_entry_index(node, body, &found);
     if (found) return 0;
 
-    long long entrySize = data_list_base_entry_size(node->list);
+    long long entrySize = data_list_base_entry_size(node);
     assert(entrySize > 0);
 
     if (node->dataSize + entrySize > node->dataAlloc) {
@@ -91,26 +135,257 @@ int data_list_base_add(DataListNode * node, const uint8_t * body, const uint8_t
         memmove(dest, source, moveSize);
     }
     
-    const uint8_t * bodyBuffer = &body[node->list->depth];
-    long long bodyLen = node->list->dataSize - node->list->depth;
+    const uint8_t * bodyBuffer = &body[node->depth];
+    long long bodyLen = node->list->dataSize - node->depth;
     memcpy(&node->nodeData[offset], header, node->list->headerLen);
     memcpy(&node->nodeData[offset + node->list->headerLen], bodyBuffer, bodyLen);
     
     node->dataSize += entrySize;
+    _data_list_node_balance(node);
     
     return 1;
 }
 
+long long data_list_base_merge(DataListNode * node, const uint8_t * records, long long count) {
+    if (count == 0) return 0;
+    DataList * list = node->list;
+    long long entrySize = data_list_base_entry_size(node);
+    long long recordSize = list->headerLen + list->dataSize;
+    long long bodyLen = list->dataSize - node->depth;
+    long long oldCount = node->dataSize / entrySize;
+    uint8_t * merged = (uint8_t *)malloc((oldCount + count) * entrySize);
+    
+    long long i = 0, j = 0, outCount = 0, added = 0;
+    while (i < oldCount || j < count) {
+        uint8_t * oldEntry = &node->nodeData[i * entrySize];
+        const uint8_t * record = &records[j * recordSize];
+        const uint8_t * recordBody = &record[list->headerLen + node->depth];
+        int comparison;
+        if (i == oldCount) {
+            comparison = 1;
+        } else if (j == count) {
+            comparison = -1;
+        } else {
+            comparison = _compare_data(&oldEntry[list->headerLen], recordBody, bodyLen);
+        }
+        
+        uint8_t * dest = &merged[outCount * entrySize];
+        if (comparison < 0) {
+            memcpy(dest, oldEntry, entrySize);
+            i++;
+        } else if (comparison > 0) {
+            memcpy(dest, record, list->headerLen);
+            memcpy(&dest[list->headerLen], recordBody, bodyLen);
+            j++;
+            added++;
+        } else {
+            memcpy(dest, oldEntry, entrySize);
+            if (record[0] < oldEntry[0]) {
+                memcpy(dest, record, list->headerLen);
+            }
+            i++;
+            j++;
+        }
+        outCount++;
+    }
+    
+    if (node->nodeData) free(node->nodeData);
+    node->nodeData = merged;
+    node->dataSize = outCount * entrySize;
+    node->dataAlloc = (oldCount + count) * entrySize;
+    _data_list_node_balance(node);
+    return added;
+}
+
 int data_list_base_find(DataListNode * node, const uint8_t * body, uint8_t ** headerOut) {
     int found;
     long long index = data_list_base_entry_index(node, body, &found);
     if (!found) return 0;
-    long long dataSize = data_list_base_entry_size(node->list);
+    long long dataSize = data_list_base_entry_size(node);
     uint8_t * ptr = &node->nodeData[dataSize * index];
     *headerOut = ptr;
     return 1;
 }
 
+int data_list_find(DataList * list, const uint8_t * body, uint8_t ** headerOut) {
+    if (list->filter && !data_filter_may_contain(list->filter, body)) return 0;
+    if (list->frozen) {
+        return frozen_data_list_find(list->frozen, body, headerOut);
+    } else if (list->hash) {
+        return hash_data_list_find(list->hash, body, headerOut);
+    }
+    DataListNode * base = data_list_find_base(list, body, 0);
+    if (!base) return 0;
+    return data_list_base_find(base, body, headerOut);
+}
+
+int data_list_add(DataList * list, const uint8_t * body, const uint8_t * header) {
+    if (list->hash) {
+        return hash_data_list_add(list->hash, body, header);
+    }
+    DataListNode * base = data_list_find_base(list, body, 1);
+    return data_list_base_add(base, body, header);
+}
+
+int data_list_freeze(DataList * list) {
+    return _data_list_freeze(list, 0);
+}
+
+int data_list_freeze_filtered(DataList * list) {
+    return _data_list_freeze(list, kDataListFreezeFilter);
+}
+
+int data_list_freeze_options(DataList * list, int options) {
+    return _data_list_freeze(list, options);
+}
+
+void data_list_strip_header(DataList * list, int headerLen) {
+    assert(!list->frozen);
+    assert(headerLen <= list->headerLen);
+    if (headerLen == list->headerLen) return;
+    if (list->hash) {
+        hash_data_list_strip_header(list->hash, headerLen);
+    } else {
+        _data_list_node_strip_header((DataListNode *)list->rootNode, headerLen);
+    }
+    list->headerLen = headerLen;
+}
+
+void data_list_set_header_byte(DataList * list, int index, uint8_t value) {
+    assert(!list->frozen);
+    assert(index < list->headerLen);
+    if (!list->hash) {
+        _data_list_node_set_header_byte((DataListNode *)list->rootNode, index, value);
+        return;
+    }
+    unsigned long long slot, slotCount = list->hash->groupCount * kHashDataListGroupSlots;
+    for (slot = 0; slot < slotCount; slot++) {
+        uint8_t * record = hash_data_list_slot(list->hash, slot);
+        if (record) record[index] = value;
+    }
+}
+
+unsigned long long data_list_remove_from(DataList * list, uint8_t minValue,
+                                         DataListRemoved removed, void * context) {
+    assert(!list->frozen && !list->hash);
+    uint8_t * key = (uint8_t *)malloc(list->dataSize + 1);
+    unsigned long long count = _data_list_node_remove_from((DataListNode *)list->rootNode, key,
+                                                           minValue, removed, context);
+    free(key);
+    return count;
+}
+
+void data_list_reshard(DataList * list, unsigned long long targetSize) {
+    assert(!list->frozen && !list->hash);
+    list->splitSize = targetSize * 2;
+    _data_list_node_reshard((DataListNode *)list->rootNode, targetSize);
+}
+
+unsigned long long data_list_memory_size(DataList * list) {
+    unsigned long long size = 0;
+    if (list->frozen) {
+        size = frozen_data_list_memory_size(list->frozen);
+    } else if (list->hash) {
+        size = list->hash->groupCount * list->hash->groupSize;
+    } else {
+        size = _data_list_node_memory_size((DataListNode *)list->rootNode);
+    }
+    if (list->filter) size += data_filter_memory_size(list->filter);
+    return size;
+}
+
+unsigned long long data_list_resident_size(DataList * list) {
+    unsigned long long size = sizeof(DataList);
+    if (list->frozen) {
+        size += data_list_memory_size(list) + sizeof(FrozenDataList);
+    } else if (list->hash) {
+        size += data_list_memory_size(list) + sizeof(HashDataList);
+    } else {
+        size += _data_list_node_resident_size((DataListNode *)list->rootNode);
+        if (list->filter) size += data_filter_memory_size(list->filter);
+    }
+    return size;
+}
+
+void data_list_shard_histogram(DataList * list, unsigned long long * buckets, int bucketCount) {
+    if (list->frozen || list->hash) return;
+    _data_list_node_shard_histogram((DataListNode *)list->rootNode, buckets, bucketCount);
+}
+
+void data_list_probe_start(DataListProbe * probe, DataList * list, const uint8_t * body) {
+    if (list->frozen || list->hash) {
+        // flat tables need few enough steps that they are searched at once
+        probe->body = body;
+        probe->node = NULL;
+        if (data_list_find(list, body, &probe->header)) {
+            probe->state = kDataListProbeFound;
+        } else {
+            probe->header = NULL;
+            probe->state = kDataListProbeMissing;
+        }
+        return;
+    }
+    
+    // the shard nodes are few and usually cached, so they are walked at once
+    DataListNode * base = data_list_find_base(list, body, 0);
+    probe->body = body;
+    probe->header = NULL;
+    probe->node = base;
+    if (!base) {
+        probe->state = kDataListProbeMissing;
+        return;
+    }
+    probe->state = kDataListProbeBase;
+    probe->entrySize = data_list_base_entry_size(base);
+    probe->lowIndex = -1;
+    probe->highIndex = base->dataSize / probe->entrySize;
+    _data_list_probe_prefetch(probe);
+}
+
+int data_list_probe_step(DataListProbe * probe) {
+    if (probe->state != kDataListProbeBase) return 0;
+    if (probe->highIndex - probe->lowIndex <= 1) {
+        probe->state = kDataListProbeMissing;
+        return 0;
+    }
+    
+    DataListNode * node = probe->node;
+    DataList * list = node->list;
+    long long testIndex = (probe->lowIndex + probe->highIndex) / 2;
+    uint8_t * buffer = &node->nodeData[testIndex * probe->entrySize];
+    int comparison = _compare_data(&buffer[list->headerLen], &probe->body[node->depth],
+                                   list->dataSize - node->depth);
+    if (comparison > 0) {
+        probe->highIndex = testIndex;
+    } else if (comparison < 0) {
+        probe->lowIndex = testIndex;
+    } else {
+        probe->header = buffer;
+        probe->state = kDataListProbeFound;
+        return 0;
+    }
+    _data_list_probe_prefetch(probe);
+    return 1;
+}
+
+void data_list_probe_batch(DataListProbe * probes, int count) {
+    // finished probes in the window are replaced by the next ones
+    int window[kDataListProbeWindow];
+    int i, active = 0, next = 0;
+    while (next < count && active < kDataListProbeWindow) {
+        window[active++] = next++;
+    }
+    while (active > 0) {
+        for (i = 0; i < active; i++) {
+            if (data_list_probe_step(&probes[window[i]])) continue;
+            if (next < count) {
+                window[i] = next++;
+            } else {
+                window[i--] = window[--active];
+            }
+        }
+    }
+}
 
 /***********
  * Private *
@@ -162,16 +437,14 @@ static void data_list_node_add_subnode(DataListNode * node, DataListNode * subno
  * Base nodes *
  **************/
 
-static int data_list_base_entry_size(DataList * list) {
-    return list->dataSize + list->headerLen - list->depth;
+static int data_list_base_entry_size(DataListNode * base) {
+    return base->list->dataSize + base->list->headerLen - base->depth;
 }
 
 static long long data_list_base_entry_index(DataListNode * base, const uint8_t * entry, int * found) {
-    assert(base->depth == base->list->depth);
-    
     const uint8_t * baseBuffer = &entry[base->depth];
     long long bodySize = base->list->dataSize - base->depth;
-    long long entrySize = data_list_base_entry_size(base->list);
+    long long entrySize = data_list_base_entry_size(base);
     assert(entrySize > 0);
     
     if (found) *found = 0;
@@ -204,3 +477,324 @@ static int _compare_data(const uint8_t * left, const uint8_t * right, int len) {
     }
     return 0;
 }
+
+/************
+ * Sharding *
+ ************/
+
+static DataListNode * _data_list_node_create(DataList * list, uint8_t nodeByte, int depth) {
+    DataListNode * node = (DataListNode *)malloc(sizeof(DataListNode));
+    bzero(node, sizeof(DataListNode));
+    node->list = list;
+    node->nodeByte = nodeByte;
+    node->depth = depth;
+    return node;
+}
+
+static void _data_list_node_balance(DataListNode * node) {
+    DataList * list = node->list;
+    if (!list->splitSize || node->dataSize <= list->splitSize) return;
+    if (node->depth >= list->depth) return;
+    _data_list_node_split(node);
+}
+
+static void _data_list_node_split(DataListNode * node) {
+    // the entries are sorted, so those with the same first byte are
+    // next to each other and stay sorted in their subnode
+    DataList * list = node->list;
+    long long entrySize = data_list_base_entry_size(node);
+    long long count = node->dataSize / entrySize;
+    long long start = 0;
+    while (start < count) {
+        uint8_t nodeByte = node->nodeData[start * entrySize + list->headerLen];
+        long long i, end = start + 1;
+        while (end < count && node->nodeData[end * entrySize + list->headerLen] == nodeByte) {
+            end++;
+        }
+        
+        DataListNode * subnode = _data_list_node_create(list, nodeByte, node->depth + 1);
+        long long subnodeEntrySize = entrySize - 1;
+        subnode->dataSize = (end - start) * subnodeEntrySize;
+        subnode->dataAlloc = subnode->dataSize;
+        subnode->nodeData = (uint8_t *)malloc(subnode->dataSize);
+        for (i = start; i < end; i++) {
+            const uint8_t * entry = &node->nodeData[i * entrySize];
+            uint8_t * dest = &subnode->nodeData[(i - start) * subnodeEntrySize];
+            memcpy(dest, entry, list->headerLen);
+            memcpy(&dest[list->headerLen], &entry[list->headerLen + 1],
+                   subnodeEntrySize - list->headerLen);
+        }
+        data_list_node_add_subnode(node, subnode, node->subnodeCount);
+        _data_list_node_balance(subnode);
+        start = end;
+    }
+    
+    free(node->nodeData);
+    node->nodeData = NULL;
+    node->dataSize = 0;
+    node->dataAlloc = 0;
+}
+
+static void _data_list_node_reshard(DataListNode * node, unsigned long long targetSize) {
+    if (node->subnodeCount == 0) {
+        _data_list_node_balance(node);
+        return;
+    }
+    // the entries get longer when they are gathered
+    unsigned long long size = _data_list_node_entry_count(node) * data_list_base_entry_size(node);
+    if (size <= targetSize) {
+        _data_list_node_collapse(node);
+        return;
+    }
+    int i;
+    for (i = 0; i < node->subnodeCount; i++) {
+        _data_list_node_reshard((DataListNode *)node->subnodes[i], targetSize);
+    }
+}
+
+static void _data_list_node_collapse(DataListNode * node) {
+    DataList * list = node->list;
+    unsigned long long count = _data_list_node_entry_count(node);
+    unsigned long long offset = 0;
+    uint8_t * data = NULL;
+    if (count > 0) data = (uint8_t *)malloc(count * data_list_base_entry_size(node));
+    uint8_t * key = (uint8_t *)malloc(list->dataSize + 1);
+    _data_list_node_gather(node, node, key, data, &offset);
+    free(key);
+    
+    int i;
+    for (i = 0; i < node->subnodeCount; i++) {
+        data_list_node_free((DataListNode *)node->subnodes[i]);
+    }
+    free(node->subnodes);
+    node->subnodes = NULL;
+    node->subnodeCount = 0;
+    node->subnodeAlloc = 0;
+    if (node->nodeData) free(node->nodeData);
+    node->nodeData = data;
+    node->dataSize = offset;
+    node->dataAlloc = offset;
+}
+
+static void _data_list_node_gather(DataListNode * target, DataListNode * node, uint8_t * key,
+                                   uint8_t * output, unsigned long long * offset) {
+    // the bytes between the two depths come from the path to `node`
+    DataList * list = node->list;
+    int i;
+    for (i = 0; i < node->subnodeCount; i++) {
+        DataListNode * subnode = (DataListNode *)node->subnodes[i];
+        key[node->depth] = subnode->nodeByte;
+        _data_list_node_gather(target, subnode, key, output, offset);
+    }
+    if (node->dataSize == 0) return;
+    
+    long long entrySize = data_list_base_entry_size(node);
+    long long j, count = node->dataSize / entrySize;
+    int prefixLen = node->depth - target->depth;
+    for (j = 0; j < count; j++) {
+        const uint8_t * entry = &node->nodeData[j * entrySize];
+        uint8_t * dest = &output[*offset];
+        memcpy(dest, entry, list->headerLen);
+        memcpy(&dest[list->headerLen], &key[target->depth], prefixLen);
+        memcpy(&dest[list->headerLen + prefixLen], &entry[list->headerLen],
+               entrySize - list->headerLen);
+        *offset += entrySize + prefixLen;
+    }
+}
+
+/**********
+ * Probes *
+ **********/
+
+static void _data_list_probe_prefetch(DataListProbe * probe) {
+    if (probe->highIndex - probe->lowIndex <= 1) return;
+    long long testIndex = (probe->lowIndex + probe->highIndex) / 2;
+    __builtin_prefetch(&probe->node->nodeData[testIndex * probe->entrySize]);
+}
+
+/************
+ * Freezing *
+ ************/
+
+static unsigned long long _data_list_node_entry_count(DataListNode * node) {
+    unsigned long long count = 0;
+    if (node->dataSize > 0) {
+        count += node->dataSize / data_list_base_entry_size(node);
+    }
+    int i;
+    for (i = 0; i < node->subnodeCount; i++) {
+        count += _data_list_node_entry_count((DataListNode *)node->subnodes[i]);
+    }
+    return count;
+}
+
+static int _data_list_freeze(DataList * list, int options) {
+    if (list->frozen) return 1;
+    if (list->hash) return 0;
+    DataListNode * root = (DataListNode *)list->rootNode;
+    unsigned long long count = _data_list_node_entry_count(root);
+    FrozenDataList * frozen;
+    if (options & kDataListFreezeCompress) {
+        frozen = frozen_data_list_create_compressed(list->dataSize, list->headerLen, count);
+    } else {
+        frozen = frozen_data_list_create(list->dataSize, list->headerLen, count);
+    }
+    if (!frozen) return 0;
+    
+    DataFilter * dataFilter = NULL;
+    if (options & kDataListFreezeFilter) {
+        dataFilter = data_filter_create(list->dataSize, count);
+        if (!dataFilter) {
+            frozen_data_list_free(frozen);
+            return 0;
+        }
+    }
+    
+    uint8_t * key = (uint8_t *)malloc(list->dataSize + 1);
+    _data_list_node_freeze(root, key, frozen, dataFilter);
+    frozen_data_list_finish(frozen);
+    free(key);
+    
+    data_list_node_free(root);
+    list->rootNode = NULL;
+    list->frozen = frozen;
+    list->filter = dataFilter;
+    return 1;
+}
+
+static unsigned long long _data_list_node_memory_size(DataListNode * node) {
+    unsigned long long size = node->dataSize;
+    int i;
+    for (i = 0; i < node->subnodeCount; i++) {
+        size += _data_list_node_memory_size((DataListNode *)node->subnodes[i]);
+    }
+    return size;
+}
+
+static unsigned long long _data_list_node_resident_size(DataListNode * node) {
+    unsigned long long size = sizeof(DataListNode) + node->dataAlloc;
+    size += sizeof(void *) * node->subnodeAlloc;
+    int i;
+    for (i = 0; i < node->subnodeCount; i++) {
+        size += _data_list_node_resident_size((DataListNode *)node->subnodes[i]);
+    }
+    return size;
+}
+
+static void _data_list_node_shard_histogram(DataListNode * node, unsigned long long * buckets,
+                                           int bucketCount) {
+    if (node->dataSize > 0) {
+        int bucket = 0;
+        while (bucket + 1 < bucketCount && (node->dataSize >> (bucket + 1))) {
+            bucket++;
+        }
+        buckets[bucket]++;
+    }
+    int i;
+    for (i = 0; i < node->subnodeCount; i++) {
+        DataListNode * subnode = (DataListNode *)node->subnodes[i];
+        _data_list_node_shard_histogram(subnode, buckets, bucketCount);
+    }
+}
+
+static void _data_list_node_freeze(DataListNode * node, uint8_t * key, FrozenDataList * frozen,
+                                   DataFilter * filter) {
+    // subnodes and entries are both sorted, so records come out in order
+    DataList * list = node->list;
+    int i;
+    for (i = 0; i < node->subnodeCount; i++) {
+        DataListNode * subnode = (DataListNode *)node->subnodes[i];
+        key[node->depth] = subnode->nodeByte;
+        _data_list_node_freeze(subnode, key, frozen, filter);
+    }
+    if (node->dataSize == 0) return;
+    
+    long long entrySize = data_list_base_entry_size(node);
+    long long j, count = node->dataSize / entrySize;
+    for (j = 0; j < count; j++) {
+        uint8_t * entry = &node->nodeData[j * entrySize];
+        memcpy(&key[node->depth], &entry[list->headerLen], list->dataSize - node->depth);
+        frozen_data_list_append(frozen, key, entry);
+        if (filter) data_filter_add(filter, key);
+    }
+    
+    // the data is no longer needed, so it is freed right away
+    free(node->nodeData);
+    node->nodeData = NULL;
+    node->dataSize = 0;
+    node->dataAlloc = 0;
+}
+
+static void _data_list_node_strip_header(DataListNode * node, int headerLen) {
+    DataList * list = node->list;
+    int i;
+    for (i = 0; i < node->subnodeCount; i++) {
+        _data_list_node_strip_header((DataListNode *)node->subnodes[i], headerLen);
+    }
+    if (node->dataSize == 0) return;
+    
+    // entries only shrink, so each one can be moved down in place
+    long long entrySize = data_list_base_entry_size(node);
+    long long bodyLen = entrySize - list->headerLen;
+    long long j, count = node->dataSize / entrySize;
+    long long newSize = bodyLen + headerLen;
+    for (j = 0; j < count; j++) {
+        uint8_t * entry = &node->nodeData[j * entrySize];
+        uint8_t * output = &node->nodeData[j * newSize];
+        memmove(output, entry, headerLen);
+        memmove(&output[headerLen], &entry[list->headerLen], bodyLen);
+    }
+    node->dataSize = count * newSize;
+    node->nodeData = (uint8_t *)realloc(node->nodeData, node->dataSize);
+    node->dataAlloc = node->dataSize;
+}
+
+static void _data_list_node_set_header_byte(DataListNode * node, int index, uint8_t value) {
+    int i;
+    for (i = 0; i < node->subnodeCount; i++) {
+        _data_list_node_set_header_byte((DataListNode *)node->subnodes[i], index, value);
+    }
+    long long j, entrySize = data_list_base_entry_size(node);
+    for (j = 0; j < node->dataSize; j += entrySize) {
+        node->nodeData[j + index] = value;
+    }
+}
+
+static unsigned long long _data_list_node_remove_from(DataListNode * node, uint8_t * key,
+                                                      uint8_t minValue, DataListRemoved removed,
+                                                      void * context) {
+    DataList * list = node->list;
+    unsigned long long removedCount = 0;
+    int i;
+    for (i = 0; i < node->subnodeCount; i++) {
+        DataListNode * subnode = (DataListNode *)node->subnodes[i];
+        key[node->depth] = subnode->nodeByte;
+        removedCount += _data_list_node_remove_from(subnode, key, minValue, removed, context);
+    }
+    if (node->dataSize == 0) return removedCount;
+    
+    // the entries which stay are moved down in place
+    long long entrySize = data_list_base_entry_size(node);
+    long long j, count = node->dataSize / entrySize, kept = 0;
+    for (j = 0; j < count; j++) {
+        uint8_t * entry = &node->nodeData[j * entrySize];
+        if (entry[0] < minValue) {
+            if (kept != j) memmove(&node->nodeData[kept * entrySize], entry, entrySize);
+            kept++;
+            continue;
+        }
+        memcpy(&key[node->depth], &entry[list->headerLen], list->dataSize - node->depth);
+        removed(context, key, entry);
+        removedCount++;
+    }
+    node->dataSize = kept * entrySize;
+    if (kept == 0) {
+        free(node->nodeData);
+        node->nodeData = NULL;
+        node->dataAlloc = 0;
+    } else if (kept < count) {
+        node->nodeData = (uint8_t *)realloc(node->nodeData, node->dataSize);
+        node->dataAlloc = node->dataSize;
+    }
+    return removedCount;
+}
@@ -5,10 +5,21 @@
 #include <stdint.h>
 #include <string.h>
 #include <assert.h>
+#include "frozen_data_list.h"
+#include "hash_data_list.h"
+#include "data_filter.h"
 
 #define kSubnodeAllocBuffer 4
 #define kBasenodeAllocBuffer 512
 
+// options for data_list_freeze_options()
+#define kDataListFreezeFilter 1
+#define kDataListFreezeCompress 2
+
+// the base node size which data_list_reshard() is usually asked for; an
+// adaptive list splits its base nodes at twice this size
+#define kDataListTargetSize (1 << 14)
+
 /***
  * 
  * The data list allows for fast, dynamic searching and insertion of
@@ -18,6 +29,24 @@
  * and, instead of storing them in a giant buffer, storing them one byte
  * at a time in deeper and deeper nodes which are easy to traverse.
  *
+ * An adaptive list picks the depth of each shard by itself: a base node
+ * which grows past `splitSize` bytes is split into subnodes by the next
+ * byte of its entries, as long as it is shallower than `depth`. Dense
+ * parts of the key space thus end up deep and sparse parts shallow. Any
+ * node without subnodes which holds entries is a base node, and its
+ * entries leave out the first `node->depth` bytes of their bodies.
+ *
+ * A list which will only be searched may be frozen, replacing all of its
+ * nodes with a FrozenDataList. Only data_list_find(), the probes and
+ * data_list_free() may be used on a frozen list.
+ *
+ * A list may instead be backed by a HashDataList from the start. Such a
+ * list has no nodes either; entries are added with data_list_add() or a
+ * DataListBatch and found with data_list_find().
+ *
+ * A frozen list may also keep a DataFilter, which turns away most lookups
+ * for missing keys before they reach the frozen records.
+ *
  */
 
 typedef struct {
@@ -25,6 +54,18 @@ typedef struct {
     int dataSize;
     int headerLen;
     int depth;
+    
+    // 0 unless the list is adaptive
+    unsigned long long splitSize;
+    
+    // set instead of rootNode once the list is frozen
+    FrozenDataList * frozen;
+    
+    // set instead of rootNode for hashed lists
+    HashDataList * hash;
+    
+    // NULL unless the list was frozen with a filter
+    DataFilter * filter;
 } DataList;
 
 typedef struct {
@@ -43,6 +84,35 @@ typedef struct {
     unsigned long long dataAlloc;
 } DataListNode;
 
+/***
+ *
+ * A probe is a lookup which advances a little at a time, so that many
+ * lookups may be interleaved and their cache misses overlap. The probe
+ * finds its base node right away; every step then halves the range of
+ * the binary search in the base node and prefetches the entry which the
+ * next step will compare against.
+ *
+ */
+
+#define kDataListProbeBase 0
+#define kDataListProbeFound 1
+#define kDataListProbeMissing 2
+
+// the number of probes which data_list_probe_batch() keeps in flight
+#define kDataListProbeWindow 16
+
+typedef struct {
+    const uint8_t * body;
+    DataListNode * node;
+    long long entrySize;
+    long long lowIndex;
+    long long highIndex;
+    int state;
+    
+    // set once the state is kDataListProbeFound
+    uint8_t * header;
+} DataListProbe;
+
 /**
  * Creates a new data list.
  * @argument shardDepth  The maximum depth for a node. If this is equal to
@@ -50,6 +120,18 @@ typedef struct {
  */
 DataList * data_list_create(int dataSize, int headerLen, int shardDepth);
 
+/**
+ * Creates an adaptive data list, whose base nodes are split once they
+ * hold more than `splitSize` bytes, down to a depth of at most `maxDepth`.
+ */
+DataList * data_list_create_adaptive(int dataSize, int headerLen, int maxDepth,
+                                     unsigned long long splitSize);
+
+/**
+ * Creates a new data list backed by a hash table. Its depth is always 0.
+ */
+DataList * data_list_create_hashed(int dataSize, int headerLen);
+
 /**
  * Frees a DataList and all of its subnodes.
  */
@@ -61,23 +143,134 @@ void data_list_free(DataList * list);
 void data_list_node_free(DataListNode * node);
 
 /**
- * Finds the "base node" (that is, node of depth `list->depth`) which
- * would correspond to the body `body`.
+ * Finds the "base node" (the node which holds the entries, usually of
+ * depth `list->depth`) which would correspond to the body `body`.
  * @argument create If this is 1, the base node and all parents will be
  * created as necessary.
  */
 DataListNode * data_list_find_base(DataList * list, const uint8_t * body, int create);
 
 /**
- * Adds the body excluding the length indicated by `list->depth` to the node.
+ * Adds the body excluding the first `node->depth` bytes to the node. An
+ * adaptive list may split the node afterwards, so it should be found again
+ * for the next body.
  * @return 1 if added, 0 if it was already in the list.
  */
 int data_list_base_add(DataListNode * node, const uint8_t * body, const uint8_t * header);
 
 /**
- * Finds the body excluding the length indicated by `list->depth` in the node.
+ * Merges sorted records into the node in one pass. Each record is a header
+ * followed by the full body; no two records may have the same body.
+ * When a body is already in the node, the header whose first byte is
+ * lower is kept. Like data_list_base_add(), this may split the node.
+ * @return The number of records which were not already in the node.
+ */
+long long data_list_base_merge(DataListNode * node, const uint8_t * records, long long count);
+
+/**
+ * Finds the body excluding the first `node->depth` bytes in the node.
  * @return 1 if found, 0 if not.
  */
 int data_list_base_find(DataListNode * node, const uint8_t * body, uint8_t ** headerOut);
 
+/**
+ * Finds `body` in the list, whether it is frozen, hashed or neither.
+ * @return 1 if found, 0 if not.
+ */
+int data_list_find(DataList * list, const uint8_t * body, uint8_t ** headerOut);
+
+/**
+ * Adds `body` to a list which is not frozen.
+ * @return 1 if added, 0 if it was already in the list.
+ */
+int data_list_add(DataList * list, const uint8_t * body, const uint8_t * header);
+
+/**
+ * Rebuilds the shards of a list which is neither frozen nor hashed so that
+ * each base node holds about `targetSize` bytes: base nodes over twice
+ * that are split (down to `list->depth`), and subtrees which hold no more
+ * than that are gathered into one base node. The list becomes adaptive.
+ */
+void data_list_reshard(DataList * list, unsigned long long targetSize);
+
+/**
+ * Replaces the nodes of the list with a FrozenDataList.
+ * @return 0 if the list could not be frozen and was left untouched. Hashed
+ * lists are never frozen.
+ */
+int data_list_freeze(DataList * list);
+
+/**
+ * Like data_list_freeze(), but also builds a DataFilter of the keys.
+ */
+int data_list_freeze_filtered(DataList * list);
+
+/**
+ * Like data_list_freeze(), with kDataListFreezeFilter to build a filter
+ * and kDataListFreezeCompress to front-code the records (see
+ * frozen_data_list.h).
+ */
+int data_list_freeze_options(DataList * list, int options);
+
+/**
+ * Drops every byte of each header after the first `headerLen`. Lists
+ * which are done being built only need what lookups read.
+ */
+void data_list_strip_header(DataList * list, int headerLen);
+
+/**
+ * Sets byte `index` of every entry's header to `value`.
+ */
+void data_list_set_header_byte(DataList * list, int index, uint8_t value);
+
+// receives an entry which data_list_remove_from() took out of a list
+typedef void (*DataListRemoved)(void * context, const uint8_t * body, const uint8_t * header);
+
+/**
+ * Removes every entry whose first header byte is at least `minValue` from
+ * a list which is not hashed, handing each one to `removed` in sorted
+ * order with its full body. Returns the number of entries removed.
+ */
+unsigned long long data_list_remove_from(DataList * list, uint8_t minValue,
+                                         DataListRemoved removed, void * context);
+
+/**
+ * Returns the number of bytes the entries of the list take up, including
+ * the filter but not the shard nodes.
+ */
+unsigned long long data_list_memory_size(DataList * list);
+
+/**
+ * Estimates the bytes the list really occupies: unlike
+ * data_list_memory_size(), this counts the node structures, subnode arrays
+ * and unused capacity of the base nodes, or the directory of a frozen list.
+ */
+unsigned long long data_list_resident_size(DataList * list);
+
+/**
+ * Adds the base nodes of a list which is neither frozen nor hashed to a
+ * histogram of their sizes: buckets[i] counts the base nodes which hold
+ * at least 2^i and less than 2^(i+1) bytes, and the last bucket counts
+ * every bigger one as well. Empty nodes are left out.
+ */
+void data_list_shard_histogram(DataList * list, unsigned long long * buckets, int bucketCount);
+
+/**
+ * Begins looking up `body`, which must remain valid until the probe is done.
+ */
+void data_list_probe_start(DataListProbe * probe, DataList * list, const uint8_t * body);
+
+/**
+ * Performs the next step of a probe.
+ * @return 1 if the probe needs more steps, 0 if it is found or missing.
+ */
+int data_list_probe_step(DataListProbe * probe);
+
+/**
+ * Resolves every probe, stepping up to kDataListProbeWindow of them in
+ * round-robin order. A larger window would hide more latency, but the
+ * lines that neighboring lookups share would fall out of the cache.
+ */
+void data_list_probe_batch(DataListProbe * probes, int count);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include "data_list_batch.h"
+
+static void _data_list_batch_sort(DataListBatch * batch);
+static unsigned long long _data_list_batch_unique(DataListBatch * batch);
+static long long _data_list_batch_merge_hashed(DataListBatch * batch);
+
+DataListBatch * data_list_batch_create(DataList * list) {
+    DataListBatch * batch = (DataListBatch *)malloc(sizeof(DataListBatch));
+    bzero(batch, sizeof(DataListBatch));
+    batch->list = list;
+    return batch;
+}
+
+void data_list_batch_free(DataListBatch * batch) {
+    if (batch->records) free(batch->records);
+    free(batch);
+}
+
+void data_list_batch_add(DataListBatch * batch, const uint8_t * body, const uint8_t * header) {
+    DataList * list = batch->list;
+    int recordSize = list->headerLen + list->dataSize;
+    if (batch->count == batch->alloc) {
+        // grow geometrically so that filling a batch stays linear
+        unsigned long long newAlloc = batch->alloc * 2 + kDataListBatchAllocBuffer;
+        if (!batch->records) {
+            batch->records = (uint8_t *)malloc(newAlloc * recordSize);
+        } else {
+            batch->records = (uint8_t *)realloc(batch->records, newAlloc * recordSize);
+        }
+        batch->alloc = newAlloc;
+    }
+    uint8_t * record = &batch->records[batch->count * recordSize];
+    memcpy(record, header, list->headerLen);
+    memcpy(&record[list->headerLen], body, list->dataSize);
+    batch->count++;
+}
+
+long long data_list_batch_merge(DataListBatch * batch) {
+    if (batch->count == 0) return 0;
+    DataList * list = batch->list;
+    int recordSize = list->headerLen + list->dataSize;
+    if (list->hash) return _data_list_batch_merge_hashed(batch);
+    
+    _data_list_batch_sort(batch);
+    unsigned long long count = _data_list_batch_unique(batch);
+    
+    // records with the same first `base->depth` bytes share a base node
+    long long added = 0;
+    unsigned long long start = 0;
+    while (start < count) {
+        const uint8_t * body = &batch->records[start * recordSize + list->headerLen];
+        DataListNode * base = data_list_find_base(list, body, 1);
+        unsigned long long end = start + 1;
+        while (end < count) {
+            const uint8_t * next = &batch->records[end * recordSize + list->headerLen];
+            if (memcmp(body, next, base->depth)) break;
+            end++;
+        }
+        added += data_list_base_merge(base, &batch->records[start * recordSize], end - start);
+        start = end;
+    }
+    
+    free(batch->records);
+    batch->records = NULL;
+    batch->count = 0;
+    batch->alloc = 0;
+    return added;
+}
+
+/***********
+ * Private *
+ ***********/
+
+static void _data_list_batch_sort(DataListBatch * batch) {
+    // LSD radix sort on the body, one byte per pass
+    DataList * list = batch->list;
+    int recordSize = list->headerLen + list->dataSize;
+    unsigned long long i, count = batch->count;
+    uint8_t * source = batch->records;
+    uint8_t * dest = (uint8_t *)malloc(count * recordSize);
+    unsigned long long offsets[256];
+    
+    int byte;
+    for (byte = list->dataSize - 1; byte >= 0; byte--) {
+        int column = list->headerLen + byte;
+        bzero(offsets, sizeof(offsets));
+        for (i = 0; i < count; i++) {
+            offsets[source[i * recordSize + column]]++;
+        }
+        
+        // a pass where every record has the same byte changes nothing
+        if (offsets[source[column]] == count) continue;
+        
+        unsigned long long total = 0;
+        int value;
+        for (value = 0; value < 256; value++) {
+            unsigned long long valueCount = offsets[value];
+            offsets[value] = total;
+            total += valueCount;
+        }
+        for (i = 0; i < count; i++) {
+            const uint8_t * record = &source[i * recordSize];
+            memcpy(&dest[offsets[record[column]]++ * recordSize], record, recordSize);
+        }
+        uint8_t * temp = source;
+        source = dest;
+        dest = temp;
+    }
+    
+    free(dest);
+    batch->records = source;
+    batch->alloc = count;
+}
+
+static unsigned long long _data_list_batch_unique(DataListBatch * batch) {
+    DataList * list = batch->list;
+    int recordSize = list->headerLen + list->dataSize;
+    unsigned long long i, count = 0;
+    for (i = 0; i < batch->count; i++) {
+        uint8_t * record = &batch->records[i * recordSize];
+        if (count > 0) {
+            uint8_t * last = &batch->records[(count - 1) * recordSize];
+            if (!memcmp(&last[list->headerLen], &record[list->headerLen], list->dataSize)) {
+                if (record[0] < last[0]) memcpy(last, record, list->headerLen);
+                continue;
+            }
+        }
+        if (count != i) {
+            memcpy(&batch->records[count * recordSize], record, recordSize);
+        }
+        count++;
+    }
+    batch->count = count;
+    return count;
+}
+
+static long long _data_list_batch_merge_hashed(DataListBatch * batch) {
+    // hashed lists take inserts in any order, so nothing is sorted
+    DataList * list = batch->list;
+    int recordSize = list->headerLen + list->dataSize;
+    long long added = 0;
+    unsigned long long i;
+    for (i = 0; i < batch->count; i++) {
+        uint8_t * record = &batch->records[i * recordSize];
+        uint8_t * body = &record[list->headerLen];
+        uint8_t * header;
+        if (hash_data_list_find(list->hash, body, &header)) {
+            if (record[0] < header[0]) memcpy(header, record, list->headerLen);
+        } else {
+            hash_data_list_add(list->hash, body, record);
+            added++;
+        }
+    }
+    
+    free(batch->records);
+    batch->records = NULL;
+    batch->count = 0;
+    batch->alloc = 0;
+    return added;
+}
@@ -0,0 +1,41 @@
+#ifndef __DATA_LIST_BATCH_H__
+#define __DATA_LIST_BATCH_H__
+
+#include "data_list.h"
+
+#define kDataListBatchAllocBuffer 4096
+
+/***
+ *
+ * A batch collects entries for a DataList without touching the list, so
+ * that building a large list does not pay for a memmove on every insert.
+ * When the batch is merged, its entries are radix sorted and merged into
+ * each base node in a single pass. Entries for a hashed list are simply
+ * inserted one at a time.
+ *
+ * Entries with the same body are resolved by keeping the header whose
+ * first byte (usually the depth) is lowest.
+ *
+ */
+
+typedef struct {
+    DataList * list;
+    
+    // each record is a header followed by the full body
+    uint8_t * records;
+    unsigned long long count;
+    unsigned long long alloc;
+} DataListBatch;
+
+DataListBatch * data_list_batch_create(DataList * list);
+void data_list_batch_free(DataListBatch * batch);
+
+void data_list_batch_add(DataListBatch * batch, const uint8_t * body, const uint8_t * header);
+
+/**
+ * Merges every entry into the list and empties the batch.
+ * @return The number of entries which were not already in the list.
+ */
+long long data_list_batch_merge(DataListBatch * batch);
+
+#endif
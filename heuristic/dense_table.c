@@ -0,0 +1,203 @@
+#include "dense_table.h"
+
+static void _dense_table_generate_packing(DenseTable * table);
+static long long _dense_table_index(DenseTable * table, const uint8_t * key);
+static void _data_list_node_masks(DataListNode * node, uint8_t * key, uint8_t * masks);
+static void _data_list_node_fill(DataListNode * node, uint8_t * key, DenseTable * table);
+static void _hash_data_list_masks(HashDataList * list, uint8_t * masks);
+static void _hash_data_list_fill(HashDataList * list, DenseTable * table);
+
+DenseTable * dense_table_create_from_list(DataList * list) {
+    assert(!list->frozen);
+    uint8_t * key = (uint8_t *)malloc(list->dataSize);
+    uint8_t * masks = (uint8_t *)malloc(list->dataSize);
+    bzero(key, list->dataSize);
+    bzero(masks, list->dataSize);
+    
+    if (list->hash) {
+        _hash_data_list_masks(list->hash, masks);
+    } else {
+        _data_list_node_masks((DataListNode *)list->rootNode, key, masks);
+    }
+    
+    int i, j, bits = 0;
+    for (i = 0; i < list->dataSize; i++) {
+        for (j = 0; j < 8; j++) {
+            if (masks[i] & (1 << j)) bits++;
+        }
+    }
+    if (bits > kDenseTableMaxKeyBits) {
+        free(key);
+        free(masks);
+        return NULL;
+    }
+    
+    DenseTable * table = dense_table_create(list->dataSize, masks);
+    if (list->hash) {
+        _hash_data_list_fill(list->hash, table);
+    } else {
+        _data_list_node_fill((DataListNode *)list->rootNode, key, table);
+    }
+    
+    free(key);
+    free(masks);
+    return table;
+}
+
+DenseTable * dense_table_create(int dataSize, const uint8_t * masks) {
+    DenseTable * table = (DenseTable *)malloc(sizeof(DenseTable));
+    bzero(table, sizeof(DenseTable));
+    table->dataSize = dataSize;
+    table->masks = (uint8_t *)malloc(dataSize);
+    memcpy(table->masks, masks, dataSize);
+    _dense_table_generate_packing(table);
+    
+    assert(table->keyBits <= kDenseTableMaxKeyBits);
+    table->entryCount = 1ULL << table->keyBits;
+    
+    // four entries per byte, all of them kDenseTableNotFound
+    unsigned long long byteCount = (table->entryCount + 3) / 4;
+    table->entries = (uint8_t *)malloc(byteCount);
+    memset(table->entries, 0xff, byteCount);
+    
+    return table;
+}
+
+void dense_table_free(DenseTable * table) {
+    free(table->masks);
+    free(table->packed);
+    free(table->entries);
+    free(table);
+}
+
+void dense_table_set(DenseTable * table, const uint8_t * key, int depth) {
+    long long index = _dense_table_index(table, key);
+    assert(index >= 0);
+    int shift = (index & 3) * 2;
+    uint8_t value = (uint8_t)(depth % 3);
+    uint8_t * byte = &table->entries[index >> 2];
+    *byte = (*byte & ~(3 << shift)) | (value << shift);
+}
+
+int dense_table_get(DenseTable * table, const uint8_t * key) {
+    long long index = _dense_table_index(table, key);
+    if (index < 0) return kDenseTableNotFound;
+    int shift = (index & 3) * 2;
+    return (table->entries[index >> 2] >> shift) & 3;
+}
+
+int dense_table_exact_depth(int modValue, int neighborDepth) {
+    if (modValue == kDenseTableNotFound) return -1;
+    int offset = (modValue - neighborDepth % 3 + 3) % 3;
+    // offset 0 means equal, 1 means one deeper, 2 means one shallower
+    if (offset == 0) return neighborDepth;
+    if (offset == 1) return neighborDepth + 1;
+    return neighborDepth - 1;
+}
+
+/***********
+ * Private *
+ ***********/
+
+static void _dense_table_generate_packing(DenseTable * table) {
+    int i, value, bit, shift = 0;
+    table->packed = (uint32_t *)malloc(sizeof(uint32_t) * 256 * table->dataSize);
+    for (i = 0; i < table->dataSize; i++) {
+        uint8_t mask = table->masks[i];
+        int bitCount = 0;
+        for (bit = 0; bit < 8; bit++) {
+            if (mask & (1 << bit)) bitCount++;
+        }
+        for (value = 0; value < 256; value++) {
+            uint32_t * packed = &table->packed[i * 256 + value];
+            if (value & ~mask) {
+                *packed = kDenseTableBadByte;
+                continue;
+            }
+            uint32_t compressed = 0;
+            int compressedBit = 0;
+            for (bit = 0; bit < 8; bit++) {
+                if (!(mask & (1 << bit))) continue;
+                if (value & (1 << bit)) {
+                    compressed |= (1 << compressedBit);
+                }
+                compressedBit++;
+            }
+            *packed = compressed << shift;
+        }
+        shift += bitCount;
+    }
+    table->keyBits = shift;
+}
+
+static long long _dense_table_index(DenseTable * table, const uint8_t * key) {
+    long long index = 0;
+    int i;
+    for (i = 0; i < table->dataSize; i++) {
+        uint32_t packed = table->packed[i * 256 + key[i]];
+        if (packed == kDenseTableBadByte) return -1;
+        index |= packed;
+    }
+    return index;
+}
+
+static void _data_list_node_masks(DataListNode * node, uint8_t * key, uint8_t * masks) {
+    DataList * list = node->list;
+    int i;
+    for (i = 0; i < node->subnodeCount; i++) {
+        DataListNode * subnode = (DataListNode *)node->subnodes[i];
+        masks[subnode->depth - 1] |= subnode->nodeByte;
+        _data_list_node_masks(subnode, key, masks);
+    }
+    if (node->dataSize == 0) return;
+    
+    long long j, entrySize = list->dataSize + list->headerLen - node->depth;
+    long long count = node->dataSize / entrySize;
+    for (j = 0; j < count; j++) {
+        uint8_t * body = &node->nodeData[j * entrySize + list->headerLen];
+        for (i = node->depth; i < list->dataSize; i++) {
+            masks[i] |= body[i - node->depth];
+        }
+    }
+}
+
+static void _data_list_node_fill(DataListNode * node, uint8_t * key, DenseTable * table) {
+    DataList * list = node->list;
+    int i;
+    for (i = 0; i < node->subnodeCount; i++) {
+        DataListNode * subnode = (DataListNode *)node->subnodes[i];
+        key[subnode->depth - 1] = subnode->nodeByte;
+        _data_list_node_fill(subnode, key, table);
+    }
+    if (node->dataSize == 0) return;
+    
+    long long j, entrySize = list->dataSize + list->headerLen - node->depth;
+    long long count = node->dataSize / entrySize;
+    for (j = 0; j < count; j++) {
+        uint8_t * entry = &node->nodeData[j * entrySize];
+        memcpy(&key[node->depth], &entry[list->headerLen],
+               list->dataSize - node->depth);
+        dense_table_set(table, key, entry[0]);
+    }
+}
+
+static void _hash_data_list_masks(HashDataList * list, uint8_t * masks) {
+    unsigned long long slot, slotCount = list->groupCount * kHashDataListGroupSlots;
+    for (slot = 0; slot < slotCount; slot++) {
+        uint8_t * record = hash_data_list_slot(list, slot);
+        if (!record) continue;
+        int i;
+        for (i = 0; i < list->dataSize; i++) {
+            masks[i] |= record[list->headerLen + i];
+        }
+    }
+}
+
+static void _hash_data_list_fill(HashDataList * list, DenseTable * table) {
+    unsigned long long slot, slotCount = list->groupCount * kHashDataListGroupSlots;
+    for (slot = 0; slot < slotCount; slot++) {
+        uint8_t * record = hash_data_list_slot(list, slot);
+        if (!record) continue;
+        dense_table_set(table, &record[list->headerLen], record[0]);
+    }
+}
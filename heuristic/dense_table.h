@@ -0,0 +1,67 @@
+#ifndef __DENSE_TABLE_H__
+#define __DENSE_TABLE_H__
+
+#include "data_list.h"
+
+#define kDenseTableMaxKeyBits 32
+#define kDenseTableNotFound 3
+
+/***
+ *
+ * A dense table stores the depth of every possible key modulo 3 in
+ * two bits. The key is packed into an index using only the bits which
+ * were ever set in the DataList it was built from, so small keys like
+ * edge orientations produce very small tables.
+ *
+ * Since only `depth % 3` is stored, the exact depth of a node must be
+ * recovered from the exact depth of its parent; see heuristic_path.h.
+ * The value kDenseTableNotFound means that the key was not indexed.
+ *
+ */
+
+typedef struct {
+    int dataSize;
+    int keyBits;
+    
+    // masks[i] contains every bit which may be set in byte i of a key
+    uint8_t * masks;
+    
+    // packed[i * 256 + b] is the index contribution of byte i having the
+    // value b, or kDenseTableBadByte if b has bits outside of masks[i].
+    uint32_t * packed;
+    
+    uint8_t * entries;
+    unsigned long long entryCount;
+} DenseTable;
+
+#define kDenseTableBadByte 0xffffffff
+
+/**
+ * Creates a dense table from a DataList whose headers start with the
+ * depth of each entry.
+ * @return NULL if the keys in the list do not fit in kDenseTableMaxKeyBits.
+ */
+DenseTable * dense_table_create_from_list(DataList * list);
+
+/**
+ * Creates an empty dense table with the given key masks. Every entry will
+ * be kDenseTableNotFound.
+ */
+DenseTable * dense_table_create(int dataSize, const uint8_t * masks);
+void dense_table_free(DenseTable * table);
+
+void dense_table_set(DenseTable * table, const uint8_t * key, int depth);
+
+/**
+ * Returns the depth of `key` modulo 3, or kDenseTableNotFound.
+ */
+int dense_table_get(DenseTable * table, const uint8_t * key);
+
+/**
+ * Recovers a depth from a value returned by dense_table_get() given the
+ * depth of a node which is within one move of this one.
+ * @return -1 if `modValue` is kDenseTableNotFound.
+ */
+int dense_table_exact_depth(int modValue, int neighborDepth);
+
+#endif
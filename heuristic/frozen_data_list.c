@@ -0,0 +1,307 @@
+#include "frozen_data_list.h"
+
+static FrozenDataList * _frozen_data_list_alloc(int dataSize, int headerLen,
+                                                unsigned long long entryCount);
+static void _frozen_data_list_append_compressed(FrozenDataList * list, const uint8_t * key,
+                                                const uint8_t * header, int newBlock);
+static int _frozen_data_list_find_compressed(FrozenDataList * list, unsigned long long block,
+                                             const uint8_t * key, uint8_t ** headerOut);
+static unsigned long long _frozen_data_list_block(FrozenDataList * list, const uint8_t * key);
+static void _frozen_data_list_words(FrozenDataList * list, const uint8_t * record, uint64_t * words);
+static int _frozen_data_list_compare(FrozenDataList * list, const uint8_t * record,
+                                     const uint64_t * words);
+static uint64_t _load_big_endian(const uint8_t * ptr);
+static void _eytzinger_fill(uint8_t * block, const uint8_t * sorted, int recordSize,
+                            unsigned long long * next, unsigned long long index,
+                            unsigned long long count);
+
+FrozenDataList * frozen_data_list_create(int dataSize, int headerLen,
+                                         unsigned long long entryCount) {
+    FrozenDataList * list = _frozen_data_list_alloc(dataSize, headerLen, entryCount);
+    if (list->keyWords > kFrozenDataListMaxKeyWords) {
+        free(list);
+        return NULL;
+    }
+    
+    // words are read straight out of the records, so the last one is padded
+    unsigned long long directorySize = sizeof(uint64_t) * ((1ULL << (8 * list->directoryDepth)) + 1);
+    unsigned long long recordsSize = entryCount * list->recordSize + sizeof(uint64_t);
+    list->buffer = (uint64_t *)malloc(directorySize + recordsSize);
+    bzero(list->buffer, directorySize);
+    list->directory = list->buffer;
+    list->records = (uint8_t *)list->buffer + directorySize;
+    bzero(&list->records[recordsSize - sizeof(uint64_t)], sizeof(uint64_t));
+    
+    return list;
+}
+
+FrozenDataList * frozen_data_list_create_compressed(int dataSize, int headerLen,
+                                                    unsigned long long entryCount) {
+    FrozenDataList * list = _frozen_data_list_alloc(dataSize, headerLen, entryCount);
+    if (list->keyLen > 0xff) {
+        free(list);
+        return NULL;
+    }
+    list->restartInterval = kFrozenDataListRestartInterval;
+    
+    // the records are allocated for the worst case, in which no key shares
+    // anything with the one before it, and trimmed once they are finished
+    unsigned long long directorySize = sizeof(uint64_t) * ((1ULL << (8 * list->directoryDepth)) + 1);
+    list->buffer = (uint64_t *)malloc(directorySize);
+    bzero(list->buffer, directorySize);
+    list->directory = list->buffer;
+    list->records = (uint8_t *)malloc(entryCount * (list->recordSize + 1) + 1);
+    list->restarts = (uint64_t *)malloc(sizeof(uint64_t) * (entryCount + 1));
+    list->lastKey = (uint8_t *)malloc(list->keyLen + 1);
+    
+    return list;
+}
+
+void frozen_data_list_free(FrozenDataList * list) {
+    if (list->restartInterval) {
+        free(list->records);
+        free(list->restarts);
+        if (list->lastKey) free(list->lastKey);
+    }
+    free(list->buffer);
+    free(list);
+}
+
+void frozen_data_list_append(FrozenDataList * list, const uint8_t * key,
+                             const uint8_t * header) {
+    assert(list->appended < list->entryCount);
+    unsigned long long block = _frozen_data_list_block(list, key);
+    assert(block + 1 >= list->nextBlock);
+    int newBlock = (list->nextBlock <= block);
+    if (list->restartInterval) {
+        while (list->nextBlock <= block) {
+            list->directory[list->nextBlock++] = list->restartCount;
+        }
+        _frozen_data_list_append_compressed(list, key, header, newBlock);
+        return;
+    }
+    while (list->nextBlock <= block) {
+        list->directory[list->nextBlock++] = list->appended;
+    }
+    
+    uint8_t * record = &list->records[list->appended * list->recordSize];
+    memcpy(record, &key[list->directoryDepth], list->keyLen);
+    memcpy(&record[list->keyLen], header, list->headerLen);
+    list->appended++;
+}
+
+void frozen_data_list_finish(FrozenDataList * list) {
+    assert(list->appended == list->entryCount);
+    unsigned long long blockCount = 1ULL << (8 * list->directoryDepth);
+    if (list->restartInterval) {
+        while (list->nextBlock <= blockCount) {
+            list->directory[list->nextBlock++] = list->restartCount;
+        }
+        list->restarts[list->restartCount] = list->recordsSize;
+        list->records = (uint8_t *)realloc(list->records, list->recordsSize + 1);
+        list->restarts = (uint64_t *)realloc(list->restarts,
+                                             sizeof(uint64_t) * (list->restartCount + 1));
+        free(list->lastKey);
+        list->lastKey = NULL;
+        return;
+    }
+    while (list->nextBlock <= blockCount) {
+        list->directory[list->nextBlock++] = list->appended;
+    }
+    
+    unsigned long long i, maxCount = 0;
+    for (i = 0; i < blockCount; i++) {
+        unsigned long long count = list->directory[i + 1] - list->directory[i];
+        if (count > maxCount) maxCount = count;
+    }
+    
+    // each block is sorted; copy it out and refill it in Eytzinger order
+    uint8_t * sorted = (uint8_t *)malloc(list->recordSize * maxCount + 1);
+    for (i = 0; i < blockCount; i++) {
+        unsigned long long count = list->directory[i + 1] - list->directory[i];
+        if (count < 2) continue;
+        uint8_t * block = &list->records[list->directory[i] * list->recordSize];
+        memcpy(sorted, block, list->recordSize * count);
+        unsigned long long next = 0;
+        _eytzinger_fill(block, sorted, list->recordSize, &next, 1, count);
+    }
+    free(sorted);
+}
+
+int frozen_data_list_find(FrozenDataList * list, const uint8_t * key,
+                          uint8_t ** headerOut) {
+    uint64_t words[kFrozenDataListMaxKeyWords];
+    unsigned long long block = _frozen_data_list_block(list, key);
+    if (list->restartInterval) {
+        return _frozen_data_list_find_compressed(list, block, &key[list->directoryDepth],
+                                                 headerOut);
+    }
+    _frozen_data_list_words(list, &key[list->directoryDepth], words);
+    
+    int recordSize = list->recordSize;
+    unsigned long long start = list->directory[block];
+    unsigned long long count = list->directory[block + 1] - start;
+    uint8_t * records = &list->records[start * recordSize];
+    
+    // the node at index i has children at 2i and 2i + 1
+    unsigned long long index = 1;
+    while (index <= count) {
+        // the records four levels down are contiguous
+        if (index * 16 <= count) {
+            __builtin_prefetch(&records[(index * 16 - 1) * recordSize]);
+        }
+        uint8_t * record = &records[(index - 1) * recordSize];
+        int comparison = _frozen_data_list_compare(list, record, words);
+        if (comparison == 0) {
+            *headerOut = &record[list->keyLen];
+            return 1;
+        }
+        index = index * 2 + (comparison < 0);
+    }
+    return 0;
+}
+
+unsigned long long frozen_data_list_memory_size(FrozenDataList * list) {
+    unsigned long long size = sizeof(uint64_t) << (8 * list->directoryDepth);
+    if (list->restartInterval) {
+        return size + list->recordsSize + sizeof(uint64_t) * (list->restartCount + 1);
+    }
+    return size + list->entryCount * list->recordSize;
+}
+
+/***********
+ * Private *
+ ***********/
+
+static FrozenDataList * _frozen_data_list_alloc(int dataSize, int headerLen,
+                                                unsigned long long entryCount) {
+    int directoryDepth = dataSize;
+    if (directoryDepth > kFrozenDataListDirectoryDepth) {
+        directoryDepth = kFrozenDataListDirectoryDepth;
+    }
+    int keyLen = dataSize - directoryDepth;
+    
+    FrozenDataList * list = (FrozenDataList *)malloc(sizeof(FrozenDataList));
+    bzero(list, sizeof(FrozenDataList));
+    list->dataSize = dataSize;
+    list->headerLen = headerLen;
+    list->directoryDepth = directoryDepth;
+    list->keyLen = keyLen;
+    list->keyWords = (keyLen + 7) / 8;
+    list->recordSize = keyLen + headerLen;
+    list->entryCount = entryCount;
+    list->lastWordMask = ~0ULL;
+    if (keyLen % 8) {
+        list->lastWordMask <<= 8 * (8 - keyLen % 8);
+    }
+    return list;
+}
+
+static void _frozen_data_list_append_compressed(FrozenDataList * list, const uint8_t * key,
+                                                const uint8_t * header, int newBlock) {
+    const uint8_t * rest = &key[list->directoryDepth];
+    int shared = 0;
+    if (newBlock || list->restartFill == list->restartInterval) {
+        list->restarts[list->restartCount++] = list->recordsSize;
+        list->restartFill = 0;
+    } else {
+        while (shared < list->keyLen && rest[shared] == list->lastKey[shared]) shared++;
+    }
+    list->restartFill++;
+    
+    uint8_t * record = &list->records[list->recordsSize];
+    record[0] = shared;
+    memcpy(&record[1], &rest[shared], list->keyLen - shared);
+    memcpy(&record[1 + list->keyLen - shared], header, list->headerLen);
+    list->recordsSize += 1 + list->keyLen - shared + list->headerLen;
+    memcpy(list->lastKey, rest, list->keyLen);
+    list->appended++;
+}
+
+static int _frozen_data_list_find_compressed(FrozenDataList * list, unsigned long long block,
+                                             const uint8_t * key, uint8_t ** headerOut) {
+    unsigned long long low = list->directory[block];
+    unsigned long long high = list->directory[block + 1];
+    if (low == high) return 0;
+    
+    // find the last restart block whose first key is not above the key; its
+    // first key is stored whole, right after the shared byte of 0
+    high--;
+    while (low < high) {
+        unsigned long long mid = (low + high + 1) / 2;
+        int comparison = memcmp(&list->records[list->restarts[mid] + 1], key, list->keyLen);
+        if (comparison == 0) {
+            *headerOut = &list->records[list->restarts[mid] + 1 + list->keyLen];
+            return 1;
+        }
+        if (comparison < 0) low = mid;
+        else high = mid - 1;
+    }
+    
+    uint8_t current[0x100];
+    uint8_t * ptr = &list->records[list->restarts[low]];
+    uint8_t * end = &list->records[list->restarts[low + 1]];
+    while (ptr < end) {
+        int shared = ptr[0];
+        memcpy(&current[shared], &ptr[1], list->keyLen - shared);
+        ptr += 1 + list->keyLen - shared;
+        int comparison = memcmp(current, key, list->keyLen);
+        if (comparison == 0) {
+            *headerOut = ptr;
+            return 1;
+        }
+        if (comparison > 0) return 0;
+        ptr += list->headerLen;
+    }
+    return 0;
+}
+
+static unsigned long long _frozen_data_list_block(FrozenDataList * list, const uint8_t * key) {
+    unsigned long long block = 0;
+    int i;
+    for (i = 0; i < list->directoryDepth; i++) {
+        block = (block << 8) | key[i];
+    }
+    return block;
+}
+
+static void _frozen_data_list_words(FrozenDataList * list, const uint8_t * record, uint64_t * words) {
+    uint8_t padded[kFrozenDataListMaxKeyWords * 8];
+    bzero(padded, sizeof(padded));
+    memcpy(padded, record, list->keyLen);
+    int i;
+    for (i = 0; i < list->keyWords; i++) {
+        words[i] = _load_big_endian(&padded[i * 8]);
+    }
+}
+
+static int _frozen_data_list_compare(FrozenDataList * list, const uint8_t * record,
+                                     const uint64_t * words) {
+    int i;
+    for (i = 0; i < list->keyWords; i++) {
+        uint64_t word = _load_big_endian(&record[i * 8]);
+        if (i == list->keyWords - 1) word &= list->lastWordMask;
+        if (word < words[i]) return -1;
+        if (word > words[i]) return 1;
+    }
+    return 0;
+}
+
+static uint64_t _load_big_endian(const uint8_t * ptr) {
+    uint64_t word;
+    memcpy(&word, ptr, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
+static void _eytzinger_fill(uint8_t * block, const uint8_t * sorted, int recordSize,
+                            unsigned long long * next, unsigned long long index,
+                            unsigned long long count) {
+    if (index > count) return;
+    _eytzinger_fill(block, sorted, recordSize, next, index * 2, count);
+    memcpy(&block[(index - 1) * recordSize], &sorted[*next * recordSize], recordSize);
+    (*next)++;
+    _eytzinger_fill(block, sorted, recordSize, next, index * 2 + 1, count);
+}
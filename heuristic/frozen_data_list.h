@@ -0,0 +1,115 @@
+#ifndef __FROZEN_DATA_LIST_H__
+#define __FROZEN_DATA_LIST_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+// the number of leading key bytes which index the directory directly
+#define kFrozenDataListDirectoryDepth 2
+
+// keys longer than this many 64-bit words cannot be frozen
+#define kFrozenDataListMaxKeyWords 4
+
+// the number of front-coded records between two full keys
+#define kFrozenDataListRestartInterval 16
+
+/***
+ *
+ * A frozen data list is a read-only copy of a DataList laid out for
+ * lookups. Everything lives in one buffer:
+ *
+ * - a directory with an offset for every possible value of the first
+ *   `directoryDepth` bytes of a key, replacing the top of the trie;
+ * - fixed-width records holding the rest of each key followed by the
+ *   header. Keys are read as big-endian 64-bit words, so they compare
+ *   as integers rather than byte by byte.
+ *
+ * The records of each directory block are stored in Eytzinger (BFS)
+ * order, so the first few levels of every search share cache lines and
+ * the lines further down can be prefetched well ahead of time.
+ *
+ * A compressed list instead front-codes its records, which stay sorted.
+ * They are cut into restart blocks of up to `restartInterval` records,
+ * none of which spans two directory blocks. Each record is one byte
+ * giving how many leading key bytes it shares with the record before it,
+ * the rest of its key, and the header; the first record of a restart
+ * block shares nothing. A lookup binary searches the first keys of the
+ * restart blocks and then decodes a single block. Neighboring keys of a
+ * wide index usually share most of their bytes, so this takes far less
+ * memory, at the cost of slower lookups.
+ *
+ */
+
+typedef struct {
+    int dataSize;
+    int headerLen;
+    int directoryDepth;
+    int keyLen;
+    int keyWords;
+    int recordSize;
+    unsigned long long entryCount;
+    
+    // masks out the bytes after the key in its last word
+    uint64_t lastWordMask;
+    
+    uint64_t * buffer;
+    uint64_t * directory;
+    uint8_t * records;
+    
+    // compressed lists only; restartInterval is 0 otherwise. The directory
+    // holds restart indices, and restarts[r] is the offset of restart
+    // block r in `records`, with one more offset for the end.
+    int restartInterval;
+    unsigned long long restartCount;
+    unsigned long long recordsSize;
+    uint64_t * restarts;
+    
+    // used while records are appended
+    unsigned long long appended;
+    unsigned long long nextBlock;
+    int restartFill;
+    uint8_t * lastKey;
+} FrozenDataList;
+
+/**
+ * Creates a frozen list with room for `entryCount` records.
+ * @return NULL if the keys are longer than kFrozenDataListMaxKeyWords.
+ */
+FrozenDataList * frozen_data_list_create(int dataSize, int headerLen,
+                                         unsigned long long entryCount);
+
+/**
+ * Creates a compressed frozen list for `entryCount` records.
+ * @return NULL if the keys are longer than 255 bytes.
+ */
+FrozenDataList * frozen_data_list_create_compressed(int dataSize, int headerLen,
+                                                    unsigned long long entryCount);
+void frozen_data_list_free(FrozenDataList * list);
+
+/**
+ * Adds a record. Records must be appended in ascending order of `key`.
+ */
+void frozen_data_list_append(FrozenDataList * list, const uint8_t * key,
+                             const uint8_t * header);
+
+/**
+ * Called once every record has been appended; reorders each block for
+ * searching, or trims a compressed list to its final size.
+ */
+void frozen_data_list_finish(FrozenDataList * list);
+
+/**
+ * Finds the header of `key`.
+ * @return 1 if found, 0 if not.
+ */
+int frozen_data_list_find(FrozenDataList * list, const uint8_t * key,
+                          uint8_t ** headerOut);
+
+/**
+ * Returns the number of bytes the directory and records take up.
+ */
+unsigned long long frozen_data_list_memory_size(FrozenDataList * list);
+
+#endif
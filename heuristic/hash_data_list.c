@@ -0,0 +1,207 @@
+#include "hash_data_list.h"
+
+#define kHashDataListLowBits 0x0101010101010101ULL
+#define kHashDataListHighBits 0x8080808080808080ULL
+
+static uint64_t _hash_data_list_hash(HashDataList * list, const uint8_t * key);
+static uint64_t _hash_data_list_control(const uint8_t * group);
+static uint64_t _match_byte(uint64_t control, uint8_t byte);
+static int _lowest_byte(uint64_t mask);
+
+static uint8_t * _hash_data_list_lookup(HashDataList * list, const uint8_t * key,
+                                        uint64_t hash, uint8_t ** emptyOut);
+static void _hash_data_list_insert(HashDataList * list, uint8_t * slot, uint64_t hash,
+                                   const uint8_t * key, const uint8_t * header);
+static void _hash_data_list_grow(HashDataList * list);
+
+HashDataList * hash_data_list_create(int dataSize, int headerLen) {
+    return hash_data_list_create_groups(dataSize, headerLen, 1);
+}
+
+HashDataList * hash_data_list_create_groups(int dataSize, int headerLen,
+                                            unsigned long long groupCount) {
+    assert(groupCount > 0 && (groupCount & (groupCount - 1)) == 0);
+    HashDataList * list = (HashDataList *)malloc(sizeof(HashDataList));
+    bzero(list, sizeof(HashDataList));
+    list->dataSize = dataSize;
+    list->headerLen = headerLen;
+    list->recordSize = dataSize + headerLen;
+    list->groupSize = kHashDataListGroupSlots * (1 + list->recordSize);
+    list->groupCount = groupCount;
+    
+    list->groups = (uint8_t *)malloc(groupCount * list->groupSize);
+    bzero(list->groups, groupCount * list->groupSize);
+    unsigned long long i;
+    for (i = 0; i < groupCount; i++) {
+        memset(&list->groups[i * list->groupSize], kHashDataListEmpty,
+               kHashDataListGroupSlots);
+    }
+    return list;
+}
+
+void hash_data_list_free(HashDataList * list) {
+    free(list->groups);
+    free(list);
+}
+
+int hash_data_list_add(HashDataList * list, const uint8_t * key, const uint8_t * header) {
+    uint64_t hash = _hash_data_list_hash(list, key);
+    uint8_t * empty;
+    if (_hash_data_list_lookup(list, key, hash, &empty)) return 0;
+    
+    unsigned long long slotCount = list->groupCount * kHashDataListGroupSlots;
+    if ((list->count + 1) * 8 > slotCount * kHashDataListMaxLoad) {
+        _hash_data_list_grow(list);
+        _hash_data_list_lookup(list, key, hash, &empty);
+    }
+    _hash_data_list_insert(list, empty, hash, key, header);
+    list->count++;
+    return 1;
+}
+
+int hash_data_list_find(HashDataList * list, const uint8_t * key, uint8_t ** headerOut) {
+    uint64_t hash = _hash_data_list_hash(list, key);
+    uint8_t * record = _hash_data_list_lookup(list, key, hash, NULL);
+    if (!record) return 0;
+    *headerOut = record;
+    return 1;
+}
+
+void hash_data_list_strip_header(HashDataList * list, int headerLen) {
+    // the hash only covers the key, so every record keeps its slot; groups
+    // only shrink, so each byte is moved down in place
+    int recordSize = list->dataSize + headerLen;
+    int groupSize = kHashDataListGroupSlots * (1 + recordSize);
+    unsigned long long i;
+    int j;
+    for (i = 0; i < list->groupCount; i++) {
+        uint8_t * group = &list->groups[i * list->groupSize];
+        uint8_t * output = &list->groups[i * groupSize];
+        memmove(output, group, kHashDataListGroupSlots);
+        for (j = 0; j < kHashDataListGroupSlots; j++) {
+            uint8_t * record = &group[kHashDataListGroupSlots + j * list->recordSize];
+            uint8_t * newRecord = &output[kHashDataListGroupSlots + j * recordSize];
+            memmove(newRecord, record, headerLen);
+            memmove(&newRecord[headerLen], &record[list->headerLen], list->dataSize);
+        }
+    }
+    list->headerLen = headerLen;
+    list->recordSize = recordSize;
+    list->groupSize = groupSize;
+    list->groups = (uint8_t *)realloc(list->groups, list->groupCount * groupSize);
+}
+
+uint8_t * hash_data_list_slot(HashDataList * list, unsigned long long slot) {
+    uint8_t * group = &list->groups[(slot / kHashDataListGroupSlots) * list->groupSize];
+    int index = slot % kHashDataListGroupSlots;
+    if (group[index] == kHashDataListEmpty) return NULL;
+    return &group[kHashDataListGroupSlots + index * list->recordSize];
+}
+
+/***********
+ * Private *
+ ***********/
+
+static uint64_t _hash_data_list_hash(HashDataList * list, const uint8_t * key) {
+    // FNV-1a followed by a finalizer so that the low and high bits both mix
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    int i;
+    for (i = 0; i < list->dataSize; i++) {
+        hash ^= key[i];
+        hash *= 0x100000001b3ULL;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+static uint64_t _hash_data_list_control(const uint8_t * group) {
+    // byte i of the group is always byte i of the word, counting from the bottom
+    uint64_t control;
+    memcpy(&control, group, sizeof(control));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    control = __builtin_bswap64(control);
+#endif
+    return control;
+}
+
+static uint64_t _match_byte(uint64_t control, uint8_t byte) {
+    // sets the high bit of every byte equal to `byte`; a byte just above a
+    // match may be flagged too, so every candidate is checked anyway
+    uint64_t diff = control ^ (kHashDataListLowBits * byte);
+    return (diff - kHashDataListLowBits) & ~diff & kHashDataListHighBits;
+}
+
+static int _lowest_byte(uint64_t mask) {
+    int index = 0;
+    while (!(mask & 0x80)) {
+        mask >>= 8;
+        index++;
+    }
+    return index;
+}
+
+static uint8_t * _hash_data_list_lookup(HashDataList * list, const uint8_t * key,
+                                        uint64_t hash, uint8_t ** emptyOut) {
+    uint8_t fingerprint = hash & 0x7f;
+    unsigned long long mask = list->groupCount - 1;
+    unsigned long long groupIndex = (hash >> 7) & mask;
+    unsigned long long probe;
+    for (probe = 0; probe < list->groupCount; probe++) {
+        uint8_t * group = &list->groups[groupIndex * list->groupSize];
+        uint8_t * records = &group[kHashDataListGroupSlots];
+        uint64_t control = _hash_data_list_control(group);
+        
+        uint64_t matches = _match_byte(control, fingerprint);
+        while (matches) {
+            int index = _lowest_byte(matches);
+            uint8_t * record = &records[index * list->recordSize];
+            if (group[index] == fingerprint &&
+                !memcmp(&record[list->headerLen], key, list->dataSize)) {
+                return record;
+            }
+            matches &= matches - 1;
+        }
+        
+        // keys are never removed, so an empty slot ends the probe sequence
+        uint64_t empty = control & kHashDataListHighBits;
+        if (empty) {
+            if (emptyOut) *emptyOut = &records[_lowest_byte(empty) * list->recordSize];
+            return NULL;
+        }
+        groupIndex = (groupIndex + probe + 1) & mask;
+    }
+    if (emptyOut) *emptyOut = NULL;
+    return NULL;
+}
+
+static void _hash_data_list_insert(HashDataList * list, uint8_t * slot, uint64_t hash,
+                                   const uint8_t * key, const uint8_t * header) {
+    assert(slot != NULL);
+    unsigned long long offset = slot - list->groups;
+    uint8_t * group = &list->groups[offset - offset % list->groupSize];
+    int index = (slot - group - kHashDataListGroupSlots) / list->recordSize;
+    group[index] = hash & 0x7f;
+    memcpy(slot, header, list->headerLen);
+    memcpy(&slot[list->headerLen], key, list->dataSize);
+}
+
+static void _hash_data_list_grow(HashDataList * list) {
+    HashDataList * larger = hash_data_list_create_groups(list->dataSize, list->headerLen,
+                                                         list->groupCount * 2);
+    unsigned long long i, slotCount = list->groupCount * kHashDataListGroupSlots;
+    for (i = 0; i < slotCount; i++) {
+        uint8_t * record = hash_data_list_slot(list, i);
+        if (!record) continue;
+        const uint8_t * key = &record[list->headerLen];
+        uint64_t hash = _hash_data_list_hash(larger, key);
+        uint8_t * empty;
+        _hash_data_list_lookup(larger, key, hash, &empty);
+        _hash_data_list_insert(larger, empty, hash, key, record);
+    }
+    free(list->groups);
+    list->groups = larger->groups;
+    list->groupCount = larger->groupCount;
+    free(larger);
+}
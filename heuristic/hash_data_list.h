@@ -0,0 +1,76 @@
+#ifndef __HASH_DATA_LIST_H__
+#define __HASH_DATA_LIST_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+// slots are probed eight at a time, one control byte each
+#define kHashDataListGroupSlots 8
+#define kHashDataListEmpty 0x80
+
+// the table grows once it is this many eighths full
+#define kHashDataListMaxLoad 7
+
+/***
+ *
+ * A hash data list is an open addressing table for the same records a
+ * DataList stores. It takes O(1) expected time to insert or find a key,
+ * where the sorted trie needs a memmove or a binary search.
+ *
+ * Slots are arranged in groups of kHashDataListGroupSlots. Each group
+ * starts with one control byte per slot followed by the records of its
+ * slots, so a lookup usually touches a single group. A control byte is
+ * either kHashDataListEmpty or a 7-bit fingerprint of the key stored in
+ * the slot; all eight are compared at once as a 64-bit word.
+ *
+ * Each record is a header followed by the key.
+ *
+ */
+
+typedef struct {
+    int dataSize;
+    int headerLen;
+    int recordSize;
+    int groupSize;
+    
+    unsigned long long groupCount; // always a power of two
+    unsigned long long count;
+    uint8_t * groups;
+} HashDataList;
+
+HashDataList * hash_data_list_create(int dataSize, int headerLen);
+void hash_data_list_free(HashDataList * list);
+
+/**
+ * Adds a key unless it is already in the list.
+ * @return 1 if added, 0 if it was already in the list.
+ */
+int hash_data_list_add(HashDataList * list, const uint8_t * key, const uint8_t * header);
+
+/**
+ * Finds the header of `key`.
+ * @return 1 if found, 0 if not.
+ */
+int hash_data_list_find(HashDataList * list, const uint8_t * key, uint8_t ** headerOut);
+
+/**
+ * Drops every byte of each header after the first `headerLen`.
+ */
+void hash_data_list_strip_header(HashDataList * list, int headerLen);
+
+/**
+ * Returns the record in a slot, or NULL if the slot is empty. Slots range
+ * from 0 to groupCount * kHashDataListGroupSlots - 1.
+ */
+uint8_t * hash_data_list_slot(HashDataList * list, unsigned long long slot);
+
+/**
+ * Creates a list with room for `groupCount` groups, all of them empty.
+ * Used when loading a saved list.
+ */
+HashDataList * hash_data_list_create_groups(int dataSize, int headerLen,
+                                            unsigned long long groupCount);
+
+#endif
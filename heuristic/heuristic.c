@@ -6,6 +6,8 @@ typedef struct {
 } HDataAddress;
 
 static int _heuristic_find_subproblem(const char * name, HSubproblem * sp);
+static int _heuristic_moves_tracked(Heuristic * heuristic, int type, int count, int size,
+                                    const void * identity, const void * operation);
 
 Heuristic * heuristic_create(HSParameters params, CLArgumentList * args, const char * spName) {
     HSubproblem subproblem;
@@ -36,6 +38,13 @@ void heuristic_free(Heuristic * heuristic) {
         }
         free(heuristic->cosets);
     }
+    if (heuristic->denseCosets) {
+        int i;
+        for (i = 0; i < heuristic->cosetCount; i++) {
+            dense_table_free(heuristic->denseCosets[i]);
+        }
+        free(heuristic->denseCosets);
+    }
     
     heuristic->subproblem.completed(heuristic->spUserData);
     heuristic_angles_free(heuristic->angles);
@@ -107,6 +116,55 @@ void heuristic_get_raw_data(Heuristic * heuristic, const Cuboid * cuboid,
     }
 }
 
+void heuristic_get_all_data(Heuristic * heuristic, const Cuboid * cuboid,
+                            Cuboid * cache, uint8_t * dataOut) {
+    assert(rotation_group_count(heuristic->dataSymmetries) == 1 || cache);
+    int symmetryCount = rotation_group_count(heuristic->dataSymmetries);
+    if (symmetryCount == 1) {
+        heuristic_get_all_raw_data(heuristic, cuboid, dataOut);
+        return;
+    }
+    
+    int i, angle, dataSize = heuristic_data_size(heuristic);
+    int angleCount = heuristic->angles->numAngles;
+    uint8_t * tempData = (uint8_t *)malloc(dataSize * angleCount);
+    bzero(dataOut, dataSize * angleCount);
+    
+    for (i = 0; i < symmetryCount; i++) {
+        Cuboid * symmetry = rotation_group_get(heuristic->dataSymmetries, i);
+        cuboid_multiply(cache, symmetry, cuboid);
+        heuristic_get_all_raw_data(heuristic, cache, tempData);
+        for (angle = 0; angle < angleCount; angle++) {
+            uint8_t * data = &tempData[angle * dataSize];
+            uint8_t * best = &dataOut[angle * dataSize];
+            if (heuristic_data_is_gt(data, best, dataSize)) {
+                memcpy(best, data, dataSize);
+            }
+        }
+    }
+    free(tempData);
+}
+
+void heuristic_get_all_raw_data(Heuristic * heuristic, const Cuboid * cuboid,
+                                uint8_t * dataOut) {
+    int angle, dataSize = heuristic_data_size(heuristic);
+    int angleCount = heuristic->angles->numAngles;
+    if (!heuristic->subproblem.get_all_angles) {
+        for (angle = 0; angle < angleCount; angle++) {
+            heuristic_get_raw_data(heuristic, cuboid, angle, &dataOut[angle * dataSize]);
+        }
+        return;
+    }
+    
+    heuristic->subproblem.get_all_angles(heuristic->spUserData, cuboid, dataOut, dataSize);
+    if (heuristic->angles->numDistinct > 1) {
+        for (angle = 0; angle < angleCount; angle++) {
+            int saveAngle = heuristic->angles->saveAngles[angle];
+            dataOut[angle * dataSize + dataSize - 1] = saveAngle;
+        }
+    }
+}
+
 void heuristic_initialize_symmetries(Heuristic * heuristic) {
     assert(!heuristic->dataCosets);
     assert(!heuristic->dataSymmetries);
@@ -147,46 +205,182 @@ int heuristic_data_is_gt(const uint8_t * d1, const uint8_t * d2, int len) {
     return 0;
 }
 
+int heuristic_make_dense(Heuristic * heuristic) {
+    assert(heuristic->cosets != NULL);
+    int i, j;
+    DenseTable ** tables = (DenseTable **)malloc(sizeof(void *) * heuristic->cosetCount);
+    for (i = 0; i < heuristic->cosetCount; i++) {
+        tables[i] = dense_table_create_from_list(heuristic->cosets[i]);
+        if (!tables[i]) {
+            for (j = 0; j < i; j++) {
+                dense_table_free(tables[j]);
+            }
+            free(tables);
+            return 0;
+        }
+    }
+    for (i = 0; i < heuristic->cosetCount; i++) {
+        data_list_free(heuristic->cosets[i]);
+    }
+    free(heuristic->cosets);
+    heuristic->cosets = NULL;
+    heuristic->denseCosets = tables;
+    return 1;
+}
+
+int heuristic_is_dense(Heuristic * heuristic) {
+    return (heuristic->denseCosets != NULL);
+}
+
+void heuristic_freeze(Heuristic * heuristic, int options) {
+    int i;
+    for (i = 0; i < heuristic->cosetCount; i++) {
+        heuristic_freeze_coset(heuristic, i, options);
+    }
+}
+
+void heuristic_freeze_coset(Heuristic * heuristic, int coset, int options) {
+    if (!heuristic->cosets) return;
+    data_list_freeze_options(heuristic->cosets[coset], options);
+}
+
+unsigned long long heuristic_memory_size(Heuristic * heuristic) {
+    unsigned long long size = 0;
+    int i;
+    for (i = 0; i < heuristic->cosetCount; i++) {
+        if (heuristic->cosets) {
+            size += data_list_memory_size(heuristic->cosets[i]);
+        } else {
+            size += (heuristic->denseCosets[i]->entryCount + 3) / 4;
+        }
+    }
+    return size;
+}
+
+unsigned long long heuristic_resident_size(Heuristic * heuristic) {
+    unsigned long long size = 0;
+    int i;
+    for (i = 0; i < heuristic->cosetCount; i++) {
+        if (heuristic->cosets) {
+            size += data_list_resident_size(heuristic->cosets[i]);
+        } else {
+            size += sizeof(DenseTable) + (heuristic->denseCosets[i]->entryCount + 3) / 4;
+        }
+    }
+    return size;
+}
+
+int heuristic_operation_affects(Heuristic * heuristic, const Cuboid * operation) {
+    int pieces = kHSPieceCorners | kHSPieceEdges | kHSPieceCenters;
+    if (heuristic->subproblem.piece_types) {
+        pieces = heuristic->subproblem.piece_types(heuristic->spUserData);
+    }
+    
+    // cuboid_multiply() treats each kind of piece separately, so an operation
+    // which is the identity on every kind we read leaves every rotation of
+    // the cuboid with the same data.
+    Cuboid * identity = cuboid_create(operation->dimensions);
+    int affects = 0;
+    if (pieces & kHSPieceCorners) {
+        if (memcmp(identity->corners, operation->corners, sizeof(CuboidCorner) * 8)) {
+            affects = 1;
+        }
+    }
+    if (pieces & kHSPieceEdges) {
+        int size = sizeof(CuboidEdge) * cuboid_count_edges(operation);
+        if (size && memcmp(identity->edges, operation->edges, size)) affects = 1;
+    }
+    if (pieces & kHSPieceCenters) {
+        int size = sizeof(CuboidCenter) * cuboid_count_centers(operation);
+        if (size && memcmp(identity->centers, operation->centers, size)) affects = 1;
+    }
+    cuboid_free(identity);
+    return affects;
+}
+
+int heuristic_operation_affects_inverse(Heuristic * heuristic, const Cuboid * operation) {
+    if (!heuristic->subproblem.tracks_piece) {
+        return heuristic_operation_affects(heuristic, operation);
+    }
+    Cuboid * identity = cuboid_create(operation->dimensions);
+    int affects = _heuristic_moves_tracked(heuristic, kHSPieceCorners, 8,
+                                           sizeof(CuboidCorner), identity->corners,
+                                           operation->corners);
+    affects |= _heuristic_moves_tracked(heuristic, kHSPieceEdges,
+                                        cuboid_count_edges(operation), sizeof(CuboidEdge),
+                                        identity->edges, operation->edges);
+    affects |= _heuristic_moves_tracked(heuristic, kHSPieceCenters,
+                                        cuboid_count_centers(operation), sizeof(CuboidCenter),
+                                        identity->centers, operation->centers);
+    cuboid_free(identity);
+    return affects;
+}
+
+int heuristic_operation_cost(Heuristic * heuristic, const Cuboid * operation) {
+    if (!heuristic->subproblem.operation_cost) return 1;
+    return heuristic->subproblem.operation_cost(heuristic->spUserData, operation);
+}
+
 /***********
  * Lookups *
  ***********/
 
 int heuristic_pruning_value(Heuristic * heuristic, const Cuboid * cuboid, Cuboid * scratchpad) {
+    // a dense heuristic can only be used with knowledge of the path
+    if (heuristic_is_dense(heuristic)) return 0;
+    
     int angleCount = heuristic->subproblem.angle_count(heuristic->spUserData);
     int dataSize = heuristic_data_size(heuristic);
-    int * angleValues = (int *)malloc(sizeof(int) * angleCount);
-    uint8_t * heuristicData = (uint8_t *)malloc(dataSize);
-    
-    bzero(heuristicData, dataSize);
-    
-    int i, angle, cosetIdx;
-    
-    for (i = 0; i < angleCount; i++) {
-        angleValues[i] = heuristic->params.maxDepth + 1;
-    }
+    int triggerCount = rotation_cosets_count(heuristic->dataCosets);
+    uint8_t * heuristicData = (uint8_t *)malloc(dataSize * angleCount * triggerCount);
     
     Cuboid * extraTemp = NULL;
     if (rotation_group_count(heuristic->dataSymmetries) > 1) {
         extraTemp = cuboid_create(cuboid->dimensions);
     }
     
-    for (i = 0; i < rotation_cosets_count(heuristic->dataCosets); i++) {
+    int i;
+    for (i = 0; i < triggerCount; i++) {
         Cuboid * symmetry = rotation_cosets_get_trigger(heuristic->dataCosets, i);
         cuboid_multiply(scratchpad, symmetry, cuboid);
+        heuristic_get_all_data(heuristic, scratchpad, extraTemp,
+                               &heuristicData[i * angleCount * dataSize]);
+    }
+    if (extraTemp) cuboid_free(extraTemp);
+    
+    int value = heuristic_data_pruning_value(heuristic, heuristicData);
+    free(heuristicData);
+    return value;
+}
+
+int heuristic_data_pruning_value(Heuristic * heuristic, const uint8_t * data) {
+    int angleCount = heuristic->subproblem.angle_count(heuristic->spUserData);
+    int dataSize = heuristic_data_size(heuristic);
+    int triggerCount = rotation_cosets_count(heuristic->dataCosets);
+    int * angleValues = (int *)malloc(sizeof(int) * angleCount);
+    
+    int i, angle, cosetIdx;
+    
+    for (i = 0; i < angleCount; i++) {
+        angleValues[i] = heuristic->params.maxDepth + 1;
+    }
+    
+    for (i = 0; i < triggerCount; i++) {
+        // the data does not depend on the coset it is looked up in
+        const uint8_t * triggerData = &data[i * angleCount * dataSize];
         for (cosetIdx = 0; cosetIdx < heuristic->cosetCount; cosetIdx++) {
             DataList * coset = heuristic->cosets[cosetIdx];
             assert(coset->dataSize == dataSize);
             assert(coset->headerLen > 0);
             for (angle = 0; angle < angleCount; angle++) {
-                heuristic_get_data(heuristic, scratchpad, extraTemp, angle, heuristicData);
-                int thisValue = heuristic_coset_pruning_value(coset, heuristicData);
+                const uint8_t * angleData = &triggerData[angle * dataSize];
+                int thisValue = heuristic_coset_pruning_value(coset, angleData);
                 if (thisValue < angleValues[angle] && thisValue >= 0) {
                     angleValues[angle] = thisValue;
                 }
             }
         }
     }
-    if (extraTemp) cuboid_free(extraTemp);
     
     int maxValue = 0;
     for (i = 0; i < angleCount; i++) {
@@ -195,21 +389,75 @@ int heuristic_pruning_value(Heuristic * heuristic, const Cuboid * cuboid, Cuboid
         }
     }
     
-    free(heuristicData);
     free(angleValues);
     return maxValue;
 }
 
 int heuristic_coset_pruning_value(DataList * list, const uint8_t * data) {
-    DataListNode * base = data_list_find_base(list, data, 0);
-    if (!base) return -1;
     uint8_t * header;
-    if (!data_list_base_find(base, data, &header)) {
+    if (!data_list_find(list, data, &header)) {
         return -1;
     }
     return header[0];
 }
 
+/********************
+ * Dense heuristics *
+ ********************/
+
+int heuristic_dense_slot_count(Heuristic * heuristic) {
+    int angleCount = heuristic->subproblem.angle_count(heuristic->spUserData);
+    int dataCosets = rotation_cosets_count(heuristic->dataCosets);
+    return angleCount * dataCosets * heuristic->cosetCount;
+}
+
+void heuristic_dense_values(Heuristic * heuristic, const Cuboid * cuboid,
+                            Cuboid * scratchpad, uint8_t * modOut) {
+    assert(heuristic_is_dense(heuristic));
+    int angleCount = heuristic->subproblem.angle_count(heuristic->spUserData);
+    int dataSize = heuristic_data_size(heuristic);
+    uint8_t * heuristicData = (uint8_t *)malloc(dataSize * angleCount);
+    
+    Cuboid * extraTemp = NULL;
+    if (rotation_group_count(heuristic->dataSymmetries) > 1) {
+        extraTemp = cuboid_create(cuboid->dimensions);
+    }
+    
+    int i, angle, cosetIdx, slot = 0;
+    for (i = 0; i < rotation_cosets_count(heuristic->dataCosets); i++) {
+        Cuboid * symmetry = rotation_cosets_get_trigger(heuristic->dataCosets, i);
+        cuboid_multiply(scratchpad, symmetry, cuboid);
+        heuristic_get_all_data(heuristic, scratchpad, extraTemp, heuristicData);
+        for (cosetIdx = 0; cosetIdx < heuristic->cosetCount; cosetIdx++) {
+            DenseTable * table = heuristic->denseCosets[cosetIdx];
+            for (angle = 0; angle < angleCount; angle++) {
+                modOut[slot++] = dense_table_get(table, &heuristicData[angle * dataSize]);
+            }
+        }
+    }
+    
+    if (extraTemp) cuboid_free(extraTemp);
+    free(heuristicData);
+}
+
+int heuristic_dense_pruning_value(Heuristic * heuristic, const int * slotValues) {
+    int angleCount = heuristic->subproblem.angle_count(heuristic->spUserData);
+    int slotCount = heuristic_dense_slot_count(heuristic);
+    int angle, slot, maxValue = 0;
+    for (angle = 0; angle < angleCount; angle++) {
+        int value = heuristic->params.maxDepth + 1;
+        for (slot = angle; slot < slotCount; slot += angleCount) {
+            if (slotValues[slot] < value) {
+                value = slotValues[slot];
+            }
+        }
+        if (value > maxValue) {
+            maxValue = value;
+        }
+    }
+    return maxValue;
+}
+
 /***********
  * Private *
  ***********/
@@ -227,3 +475,16 @@ static int _heuristic_find_subproblem(const char * name, HSubproblem * sp) {
     return 0;
 }
 
+static int _heuristic_moves_tracked(Heuristic * heuristic, int type, int count, int size,
+                                    const void * identity, const void * operation) {
+    // a piece stays where it is if the operation holds it as a solved cuboid does
+    int i;
+    for (i = 0; i < count; i++) {
+        if (!heuristic->subproblem.tracks_piece(heuristic->spUserData, type, i)) continue;
+        if (memcmp((const uint8_t *)identity + i * size,
+                   (const uint8_t *)operation + i * size, size)) {
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -3,6 +3,7 @@
 
 #include "subproblem_table.h"
 #include "data_list.h"
+#include "dense_table.h"
 #include "heuristic_angles.h"
 #include "algebra/rotation_cosets.h"
 
@@ -14,6 +15,9 @@ typedef struct {
     int cosetCount;
     DataList ** cosets;
     
+    // non-NULL instead of cosets if the heuristic was made dense
+    DenseTable ** denseCosets;
+    
     RotationGroup * dataSymmetries;
     RotationCosets * dataCosets;
     HeuristicAngles * angles;
@@ -31,14 +35,67 @@ void heuristic_get_data(Heuristic * heuristic, const Cuboid * cuboid,
                         Cuboid * cache, int angle, uint8_t * dataOut);
 void heuristic_get_raw_data(Heuristic * heuristic, const Cuboid * cuboid,
                             int angle, uint8_t * dataOut);
+
+// like the functions above, but for every angle at once. The data of angle
+// i starts at dataOut[i * heuristic_data_size()].
+void heuristic_get_all_data(Heuristic * heuristic, const Cuboid * cuboid,
+                            Cuboid * cache, uint8_t * dataOut);
+void heuristic_get_all_raw_data(Heuristic * heuristic, const Cuboid * cuboid,
+                                uint8_t * dataOut);
 void heuristic_initialize_symmetries(Heuristic * heuristic);
 int heuristic_data_is_gt(const uint8_t * d1, const uint8_t * d2, int len);
 
+// replaces every coset with a DenseTable; returns 0 if a coset is too large.
+int heuristic_make_dense(Heuristic * heuristic);
+int heuristic_is_dense(Heuristic * heuristic);
+
+// freezes every coset for faster lookups; `options` are passed on to
+// data_list_freeze_options().
+void heuristic_freeze(Heuristic * heuristic, int options);
+void heuristic_freeze_coset(Heuristic * heuristic, int coset, int options);
+
+// the number of bytes the cosets of the heuristic take up
+unsigned long long heuristic_memory_size(Heuristic * heuristic);
+
+// an estimate of everything the cosets occupy; see data_list_resident_size()
+unsigned long long heuristic_resident_size(Heuristic * heuristic);
+
+// returns 0 if applying `operation` can never change the heuristic's data
+// (and thus its value), for every data coset and symmetry at once.
+int heuristic_operation_affects(Heuristic * heuristic, const Cuboid * operation);
+
+/**
+ * Returns 0 if applying `operation` to a cuboid can never change the data
+ * of the cuboid's inverse. The inverse of op * x is x^-1 * op^-1, whose
+ * pieces are those of x^-1 renamed by op^-1, so this holds whenever the
+ * subproblem tracks pieces (see tracks_piece in subproblem_type.h) which
+ * `operation` leaves in place, whatever the data coset and symmetry. A U
+ * turn, say, never changes the inverse data of a table of D-layer dedges.
+ * Otherwise, this is heuristic_operation_affects().
+ */
+int heuristic_operation_affects_inverse(Heuristic * heuristic, const Cuboid * operation);
+
+// returns the number of moves (0 or 1) which the heuristic counts `operation` as.
+int heuristic_operation_cost(Heuristic * heuristic, const Cuboid * operation);
+
 /* user-friendly functions */
                                 
 // applies each symmetry and checks each coset for every angle.
 // picks the highest angle value and the lowest symmetry value for each angle.
 int heuristic_pruning_value(Heuristic * heuristic, const Cuboid * cuboid, Cuboid * scratchpad);
+
+// the pruning value for data which is already known: the output of
+// heuristic_get_all_data() for each trigger of dataCosets in turn.
+int heuristic_data_pruning_value(Heuristic * heuristic, const uint8_t * data);
 int heuristic_coset_pruning_value(DataList * list, const uint8_t * data);
 
+/* dense heuristics */
+
+// dense heuristics only store values modulo 3, so each lookup ("slot") has
+// to be tracked separately along the search path; see heuristic_path.h.
+int heuristic_dense_slot_count(Heuristic * heuristic);
+void heuristic_dense_values(Heuristic * heuristic, const Cuboid * cuboid,
+                            Cuboid * scratchpad, uint8_t * modOut);
+int heuristic_dense_pruning_value(Heuristic * heuristic, const int * slotValues);
+
 #endif
\ No newline at end of file
@@ -36,13 +36,14 @@ void heuristic_buffer_free(HeuristicBuffer * buffer) {
 
 void heuristic_buffer_add(HeuristicBuffer * buffer, const Cuboid * cb, int coset) {
     int angle = 0;
-    uint8_t * temp = (uint8_t *)malloc(buffer->dataSize);
+    uint8_t * temp = (uint8_t *)malloc(buffer->dataSize * buffer->angleCount);
+    heuristic_get_all_raw_data(buffer->heuristic, cb, temp);
     for (angle = 0; angle < buffer->angleCount; angle++) {
-        heuristic_get_raw_data(buffer->heuristic, cb, angle, temp);
         // check if it's better than our current data
+        uint8_t * data = &temp[angle * buffer->dataSize];
         uint8_t * dataDest = buffer->data[angle][coset];
-        if (heuristic_data_is_gt(temp, dataDest, buffer->dataSize)) {
-            memcpy(dataDest, temp, buffer->dataSize);
+        if (heuristic_data_is_gt(data, dataDest, buffer->dataSize)) {
+            memcpy(dataDest, data, buffer->dataSize);
         }
     }
     free(temp);
@@ -50,6 +51,7 @@ void heuristic_buffer_add(HeuristicBuffer * buffer, const Cuboid * cb, int coset
 
 int heuristic_buffer_pruning_value(HeuristicBuffer * buffer) {
     int angle, currentValue = 0;
+    if (heuristic_is_dense(buffer->heuristic)) return 0;
     for (angle = 0; angle < buffer->angleCount; angle++) {
         int i, j, value = buffer->heuristic->params.maxDepth + 1;
         for (i = 0; i < buffer->cosetCount; i++) {
@@ -67,4 +69,43 @@ int heuristic_buffer_pruning_value(HeuristicBuffer * buffer) {
         }
     }
     return currentValue;
-}
\ No newline at end of file
+}
+int heuristic_buffer_probe_count(HeuristicBuffer * buffer) {
+    if (heuristic_is_dense(buffer->heuristic)) return 0;
+    return buffer->angleCount * buffer->cosetCount * buffer->heuristic->cosetCount;
+}
+
+void heuristic_buffer_start_probes(HeuristicBuffer * buffer, DataListProbe * probes) {
+    if (heuristic_is_dense(buffer->heuristic)) return;
+    int angle, i, j, probe = 0;
+    for (angle = 0; angle < buffer->angleCount; angle++) {
+        for (i = 0; i < buffer->cosetCount; i++) {
+            uint8_t * data = buffer->data[angle][i];
+            for (j = 0; j < buffer->heuristic->cosetCount; j++) {
+                DataList * coset = buffer->heuristic->cosets[j];
+                data_list_probe_start(&probes[probe++], coset, data);
+            }
+        }
+    }
+}
+
+int heuristic_buffer_probed_value(HeuristicBuffer * buffer, DataListProbe * probes) {
+    if (heuristic_is_dense(buffer->heuristic)) return 0;
+    int angle, i, j, probe = 0, currentValue = 0;
+    for (angle = 0; angle < buffer->angleCount; angle++) {
+        int value = buffer->heuristic->params.maxDepth + 1;
+        for (i = 0; i < buffer->cosetCount; i++) {
+            for (j = 0; j < buffer->heuristic->cosetCount; j++) {
+                DataListProbe * result = &probes[probe++];
+                if (result->state != kDataListProbeFound) continue;
+                if (result->header[0] < value) {
+                    value = result->header[0];
+                }
+            }
+        }
+        if (value > currentValue) {
+            currentValue = value;
+        }
+    }
+    return currentValue;
+}
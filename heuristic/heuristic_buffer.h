@@ -1,3 +1,6 @@
+#ifndef __HEURISTIC_BUFFER_H__
+#define __HEURISTIC_BUFFER_H__
+
 /***
  * A heuristic buffer consumes a set of rotated cuboids
  * and ultimately sifts out the heuristic value to use.
@@ -29,3 +32,11 @@ HeuristicBuffer * heuristic_buffer_create(Heuristic * heuristic);
 void heuristic_buffer_free(HeuristicBuffer * buffer);
 void heuristic_buffer_add(HeuristicBuffer * buffer, const Cuboid * cb, int coset);
 int heuristic_buffer_pruning_value(HeuristicBuffer * buffer);
+
+// The same lookups as heuristic_buffer_pruning_value(), split up so that the
+// probes of many buffers may be resolved together with data_list_probe_batch().
+int heuristic_buffer_probe_count(HeuristicBuffer * buffer);
+void heuristic_buffer_start_probes(HeuristicBuffer * buffer, DataListProbe * probes);
+int heuristic_buffer_probed_value(HeuristicBuffer * buffer, DataListProbe * probes);
+
+#endif
@@ -0,0 +1,91 @@
+#include "heuristic_cache.h"
+
+#define kHeuristicCacheTagMask 0xffffffffffffff00ULL
+
+static uint64_t _heuristic_cache_mix(uint64_t hash, const uint8_t * data, int len);
+
+HeuristicCache * heuristic_cache_create(int lineCount) {
+    if (lineCount < 1) return NULL;
+    unsigned long long entryCount = kHeuristicCacheLineEntries;
+    while (entryCount * 2 <= (unsigned long long)lineCount * kHeuristicCacheLineEntries) {
+        entryCount *= 2;
+    }
+    
+    HeuristicCache * cache = (HeuristicCache *)malloc(sizeof(HeuristicCache));
+    bzero(cache, sizeof(HeuristicCache));
+    cache->entries = (uint64_t *)malloc(sizeof(uint64_t) * entryCount);
+    bzero(cache->entries, sizeof(uint64_t) * entryCount);
+    cache->mask = entryCount - 1;
+    return cache;
+}
+
+void heuristic_cache_free(HeuristicCache * cache) {
+    free(cache->entries);
+    free(cache);
+}
+
+uint64_t heuristic_cache_hash(const Cuboid * cuboid) {
+    uint64_t hash = 0;
+    int cornerCount = 8;
+    int edgeCount = cuboid_count_edges(cuboid);
+    int centerCount = cuboid_count_centers(cuboid);
+    hash = _heuristic_cache_mix(hash, (const uint8_t *)cuboid->corners,
+                                cornerCount * sizeof(CuboidCorner));
+    if (edgeCount) {
+        hash = _heuristic_cache_mix(hash, (const uint8_t *)cuboid->edges,
+                                    edgeCount * sizeof(CuboidEdge));
+    }
+    if (centerCount) {
+        hash = _heuristic_cache_mix(hash, (const uint8_t *)cuboid->centers,
+                                    centerCount * sizeof(CuboidCenter));
+    }
+    return hash;
+}
+
+int heuristic_cache_lookup(HeuristicCache * cache, uint64_t hash,
+                           int maxValue, int * exceeds) {
+    cache->lookups++;
+    uint64_t entry = cache->entries[hash & cache->mask];
+    if ((entry & kHeuristicCacheTagMask) != (hash & kHeuristicCacheTagMask)) return 0;
+    
+    int value = entry & kHeuristicCacheValueMask;
+    if (value > maxValue) {
+        *exceeds = 1;
+    } else if (entry & kHeuristicCacheExactFlag) {
+        *exceeds = 0;
+    } else {
+        // a lower bound which is too low to prune says nothing
+        return 0;
+    }
+    cache->hits++;
+    return 1;
+}
+
+void heuristic_cache_store(HeuristicCache * cache, uint64_t hash, int value, int exact) {
+    if (value > kHeuristicCacheValueMask) {
+        value = kHeuristicCacheValueMask;
+        exact = 0;
+    }
+    uint64_t entry = (hash & kHeuristicCacheTagMask) | value;
+    if (exact) entry |= kHeuristicCacheExactFlag;
+    cache->entries[hash & cache->mask] = entry;
+}
+
+/***********
+ * Private *
+ ***********/
+
+static uint64_t _heuristic_cache_mix(uint64_t hash, const uint8_t * data, int len) {
+    // eight bytes at a time, each word folded in with a multiply-xorshift
+    int i;
+    for (i = 0; i < len; i += 8) {
+        uint64_t word = 0;
+        memcpy(&word, &data[i], (len - i < 8 ? len - i : 8));
+        hash ^= word;
+        hash *= 0x9e3779b97f4a7c15ULL;
+        hash ^= hash >> 29;
+    }
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 32;
+    return hash;
+}
@@ -0,0 +1,59 @@
+#ifndef __HEURISTIC_CACHE_H__
+#define __HEURISTIC_CACHE_H__
+
+#include "representation/cuboid_base.h"
+
+// every entry is one 64-bit word, so a cache line holds eight of them
+#define kHeuristicCacheLineEntries 8
+#define kHeuristicCacheDefaultLines 4096
+
+#define kHeuristicCacheExactFlag 0x80
+#define kHeuristicCacheValueMask 0x7f
+
+/***
+ *
+ * A heuristic cache remembers the pruning values of recently visited
+ * states. IDA* visits the same states on every iteration, and different
+ * sequences often reach the same state within one iteration, so many
+ * lookups can skip the heuristic tables entirely.
+ *
+ * The cache is direct mapped and is not thread safe; each search thread
+ * should have its own. An entry holds the upper 56 bits of a state's
+ * hash and a lower bound on its pruning value. The bound is exact if
+ * every heuristic was evaluated, or a lower bound if the evaluation
+ * stopped at the first heuristic which exceeded the remaining depth.
+ *
+ */
+
+typedef struct {
+    uint64_t * entries;
+    unsigned long long mask;
+    
+    unsigned long long lookups;
+    unsigned long long hits;
+} HeuristicCache;
+
+/**
+ * Creates a cache of `lineCount` cache lines, rounded down to a power
+ * of two. Returns NULL if lineCount is less than 1.
+ */
+HeuristicCache * heuristic_cache_create(int lineCount);
+void heuristic_cache_free(HeuristicCache * cache);
+
+uint64_t heuristic_cache_hash(const Cuboid * cuboid);
+
+/**
+ * Checks if the cache knows whether the state with `hash` has a
+ * pruning value above `maxValue`.
+ * @return 1 if it does, in which case `exceeds` is set; 0 otherwise.
+ */
+int heuristic_cache_lookup(HeuristicCache * cache, uint64_t hash,
+                           int maxValue, int * exceeds);
+
+/**
+ * Stores the pruning value of a state. Pass exact = 0 if `value` is only
+ * a lower bound. Any entry which the state maps to is replaced.
+ */
+void heuristic_cache_store(HeuristicCache * cache, uint64_t hash, int value, int exact);
+
+#endif
@@ -0,0 +1,241 @@
+#include "heuristic_coords.h"
+#include "algebra/inverse.h"
+
+static HeuristicCoordsEntry * _heuristic_coords_entry(Heuristic * heuristic,
+                                                      AlgList * operations);
+static void _heuristic_coords_entry_free(HeuristicCoordsEntry * entry);
+static Cuboid * _heuristic_coords_block_symmetry(HeuristicCoordsEntry * entry, int trigger,
+                                                 int symmetry);
+static void _heuristic_coords_root(HeuristicCoords * coords, const Cuboid * root,
+                                   uint8_t * row);
+static void _heuristic_coords_apply(const HSField * fields, int count, int spDataSize,
+                                    const uint8_t * in, uint8_t * out);
+static uint8_t * _heuristic_coords_row(HeuristicCoords * coords, int len);
+
+HeuristicCoords * heuristic_coords_create(HeuristicList * list, AlgList * operations) {
+    HeuristicCoordsEntry ** entries = (HeuristicCoordsEntry **)malloc(sizeof(void *) * (list->count + 1));
+    int i, rowSize = 0;
+    for (i = 0; i < list->count; i++) {
+        entries[i] = _heuristic_coords_entry(list->heuristics[i], operations);
+        if (!entries[i]) continue;
+        int dataSize = heuristic_data_size(list->heuristics[i]);
+        entries[i]->offset = rowSize;
+        rowSize += entries[i]->blockCount * dataSize;
+    }
+    if (rowSize == 0) {
+        free(entries);
+        return NULL;
+    }
+    
+    HeuristicCoords * coords = (HeuristicCoords *)malloc(sizeof(HeuristicCoords));
+    bzero(coords, sizeof(HeuristicCoords));
+    coords->list = list;
+    coords->operations = operations;
+    coords->entries = entries;
+    coords->rowSize = rowSize;
+    coords->lookupData = (uint8_t *)malloc(rowSize);
+    alg_list_retain(operations);
+    
+    CuboidDimensions dims = operations->entries[0].cuboid->dimensions;
+    coords->scratch = cuboid_create(dims);
+    coords->symmetric = cuboid_create(dims);
+    return coords;
+}
+
+void heuristic_coords_free(HeuristicCoords * coords) {
+    int i;
+    for (i = 0; i < coords->list->count; i++) {
+        if (coords->entries[i]) _heuristic_coords_entry_free(coords->entries[i]);
+    }
+    for (i = 0; i < coords->rowsAlloc; i++) {
+        free(coords->rows[i]);
+    }
+    if (coords->rows) free(coords->rows);
+    free(coords->entries);
+    free(coords->lookupData);
+    cuboid_free(coords->scratch);
+    cuboid_free(coords->symmetric);
+    alg_list_release(coords->operations);
+    free(coords);
+}
+
+void heuristic_coords_update(HeuristicCoords * coords, const Cuboid * root,
+                             const int * sequence, int len) {
+    coords->current = len;
+    uint8_t * row = _heuristic_coords_row(coords, len);
+    if (len == 0) {
+        _heuristic_coords_root(coords, root, row);
+        return;
+    }
+    
+    // the root never passes through here by itself, so its children start it
+    uint8_t * parent = _heuristic_coords_row(coords, len - 1);
+    if (len == 1) _heuristic_coords_root(coords, root, parent);
+    
+    int i, block, op = sequence[len - 1];
+    for (i = 0; i < coords->list->count; i++) {
+        HeuristicCoordsEntry * entry = coords->entries[i];
+        if (!entry) continue;
+        int dataSize = heuristic_data_size(entry->heuristic);
+        int spDataSize = entry->heuristic->subproblem.data_size(entry->heuristic->spUserData);
+        
+        // the angle byte, if any, never changes
+        memcpy(&row[entry->offset], &parent[entry->offset], entry->blockCount * dataSize);
+        for (block = 0; block < entry->blockCount; block++) {
+            int step = op * entry->blockCount + block;
+            int offset = entry->offset + block * dataSize;
+            _heuristic_coords_apply(&entry->fields[step * entry->maxFields],
+                                    entry->fieldCounts[step], spDataSize,
+                                    &parent[offset], &row[offset]);
+        }
+    }
+}
+
+int heuristic_coords_value(HeuristicCoords * coords, int index) {
+    HeuristicCoordsEntry * entry = coords->entries[index];
+    if (!entry) return -1;
+    
+    // each angle takes its highest data over the symmetries, as
+    // heuristic_get_all_data() does
+    int dataSize = heuristic_data_size(entry->heuristic);
+    const uint8_t * row = &_heuristic_coords_row(coords, coords->current)[entry->offset];
+    int trigger, symmetry, angle;
+    for (trigger = 0; trigger < entry->triggerCount; trigger++) {
+        for (angle = 0; angle < entry->angleCount; angle++) {
+            const uint8_t * best = NULL;
+            for (symmetry = 0; symmetry < entry->symmetryCount; symmetry++) {
+                int block = (trigger * entry->symmetryCount + symmetry) * entry->angleCount + angle;
+                const uint8_t * data = &row[block * dataSize];
+                if (!best || heuristic_data_is_gt(data, best, dataSize)) best = data;
+            }
+            int slot = trigger * entry->angleCount + angle;
+            memcpy(&coords->lookupData[slot * dataSize], best, dataSize);
+        }
+    }
+    return heuristic_data_pruning_value(entry->heuristic, coords->lookupData);
+}
+
+/***********
+ * Private *
+ ***********/
+
+static HeuristicCoordsEntry * _heuristic_coords_entry(Heuristic * heuristic,
+                                                      AlgList * operations) {
+    if (heuristic_is_dense(heuristic) || !heuristic->subproblem.transition) return NULL;
+    
+    HeuristicCoordsEntry * entry = (HeuristicCoordsEntry *)malloc(sizeof(HeuristicCoordsEntry));
+    bzero(entry, sizeof(HeuristicCoordsEntry));
+    entry->heuristic = heuristic;
+    entry->triggerCount = rotation_cosets_count(heuristic->dataCosets);
+    entry->symmetryCount = rotation_group_count(heuristic->dataSymmetries);
+    entry->angleCount = heuristic->subproblem.angle_count(heuristic->spUserData);
+    entry->blockCount = entry->triggerCount * entry->symmetryCount * entry->angleCount;
+    entry->maxFields = heuristic->subproblem.data_size(heuristic->spUserData) * 8;
+    
+    int stepCount = operations->entryCount * entry->blockCount;
+    entry->fieldCounts = (int *)malloc(sizeof(int) * stepCount);
+    entry->fields = (HSField *)malloc(sizeof(HSField) * stepCount * entry->maxFields);
+    
+    // a node's data in block (t, s) is read from s * t * node, and
+    // s * t * (op * node) = (s * t * op * (s * t)^-1) * (s * t * node)
+    CuboidDimensions dims = operations->entries[0].cuboid->dimensions;
+    Cuboid * temp = cuboid_create(dims);
+    Cuboid * conjugate = cuboid_create(dims);
+    int op, trigger, symmetry, angle, success = 1;
+    for (trigger = 0; trigger < entry->triggerCount && success; trigger++) {
+        for (symmetry = 0; symmetry < entry->symmetryCount && success; symmetry++) {
+            Cuboid * blockSymmetry = _heuristic_coords_block_symmetry(entry, trigger, symmetry);
+            Cuboid * inverse = cuboid_inverse(blockSymmetry);
+            for (op = 0; op < operations->entryCount && success; op++) {
+                cuboid_multiply(temp, blockSymmetry, operations->entries[op].cuboid);
+                cuboid_multiply(conjugate, temp, inverse);
+                for (angle = 0; angle < entry->angleCount && success; angle++) {
+                    int block = (trigger * entry->symmetryCount + symmetry) * entry->angleCount + angle;
+                    int step = op * entry->blockCount + block;
+                    HSField * fields = &entry->fields[step * entry->maxFields];
+                    int count = heuristic->subproblem.transition(heuristic->spUserData, conjugate,
+                                                                 angle, fields);
+                    entry->fieldCounts[step] = count;
+                    if (count < 0) success = 0;
+                }
+            }
+            cuboid_free(blockSymmetry);
+            cuboid_free(inverse);
+        }
+    }
+    cuboid_free(temp);
+    cuboid_free(conjugate);
+    
+    if (!success) {
+        _heuristic_coords_entry_free(entry);
+        return NULL;
+    }
+    return entry;
+}
+
+static void _heuristic_coords_entry_free(HeuristicCoordsEntry * entry) {
+    free(entry->fieldCounts);
+    free(entry->fields);
+    free(entry);
+}
+
+static Cuboid * _heuristic_coords_block_symmetry(HeuristicCoordsEntry * entry, int trigger,
+                                                 int symmetry) {
+    Heuristic * heuristic = entry->heuristic;
+    Cuboid * triggerCuboid = rotation_cosets_get_trigger(heuristic->dataCosets, trigger);
+    Cuboid * symmetryCuboid = rotation_group_get(heuristic->dataSymmetries, symmetry);
+    Cuboid * result = cuboid_create(triggerCuboid->dimensions);
+    cuboid_multiply(result, symmetryCuboid, triggerCuboid);
+    return result;
+}
+
+static void _heuristic_coords_root(HeuristicCoords * coords, const Cuboid * root,
+                                   uint8_t * row) {
+    int i, trigger, symmetry;
+    for (i = 0; i < coords->list->count; i++) {
+        HeuristicCoordsEntry * entry = coords->entries[i];
+        if (!entry) continue;
+        Heuristic * heuristic = entry->heuristic;
+        int dataSize = heuristic_data_size(heuristic);
+        for (trigger = 0; trigger < entry->triggerCount; trigger++) {
+            Cuboid * triggerCuboid = rotation_cosets_get_trigger(heuristic->dataCosets, trigger);
+            cuboid_multiply(coords->scratch, triggerCuboid, root);
+            for (symmetry = 0; symmetry < entry->symmetryCount; symmetry++) {
+                Cuboid * symmetryCuboid = rotation_group_get(heuristic->dataSymmetries, symmetry);
+                cuboid_multiply(coords->symmetric, symmetryCuboid, coords->scratch);
+                int block = (trigger * entry->symmetryCount + symmetry) * entry->angleCount;
+                heuristic_get_all_raw_data(heuristic, coords->symmetric,
+                                           &row[entry->offset + block * dataSize]);
+            }
+        }
+    }
+}
+
+static void _heuristic_coords_apply(const HSField * fields, int count, int spDataSize,
+                                    const uint8_t * in, uint8_t * out) {
+    int i;
+    bzero(out, spDataSize);
+    for (i = 0; i < count; i++) {
+        const HSField * field = &fields[i];
+        int mask = (1 << field->width) - 1;
+        int value = (in[field->source >> 3] >> (field->source & 7)) & mask;
+        out[field->position >> 3] |= field->values[value] << (field->position & 7);
+    }
+}
+
+static uint8_t * _heuristic_coords_row(HeuristicCoords * coords, int len) {
+    if (len >= coords->rowsAlloc) {
+        int i, newAlloc = len + 1;
+        int newSize = sizeof(uint8_t *) * newAlloc;
+        if (coords->rows) {
+            coords->rows = (uint8_t **)realloc(coords->rows, newSize);
+        } else {
+            coords->rows = (uint8_t **)malloc(newSize);
+        }
+        for (i = coords->rowsAlloc; i < newAlloc; i++) {
+            coords->rows[i] = (uint8_t *)malloc(coords->rowSize);
+        }
+        coords->rowsAlloc = newAlloc;
+    }
+    return coords->rows[len];
+}
@@ -0,0 +1,76 @@
+#ifndef __HEURISTIC_COORDS_H__
+#define __HEURISTIC_COORDS_H__
+
+#include "heuristic_list.h"
+#include "notation/alg_list.h"
+
+/***
+ * Heuristic coordinates carry the data of the sparse heuristics along the
+ * path which a search thread is currently exploring. The data of a node
+ * follows from the data of its parent and the last operation (see the
+ * transition method of HSubproblem), so a lookup never has to apply the
+ * data cosets and symmetries to the cuboid and read the data out of it.
+ *
+ * A heuristic is only tracked if its subproblem has a transition for
+ * every operation, conjugated by every data coset and symmetry. Like a
+ * HeuristicReuse, this relies on a node's parent being the last node of
+ * its length which was updated.
+ */
+
+typedef struct {
+    Heuristic * heuristic;
+    
+    // one block of data for each trigger, data symmetry and angle, in
+    // that order; a row holds all of them.
+    int triggerCount;
+    int symmetryCount;
+    int angleCount;
+    int blockCount;
+    int offset;
+    
+    // the fields of block b after operation op start at
+    // fields[(op * blockCount + b) * maxFields]
+    int maxFields;
+    int * fieldCounts;
+    HSField * fields;
+} HeuristicCoordsEntry;
+
+typedef struct {
+    HeuristicList * list;
+    AlgList * operations;
+    
+    // entries[i] is NULL if heuristic i is not tracked
+    HeuristicCoordsEntry ** entries;
+    int rowSize;
+    
+    // rows[len] holds the data of the node of length len
+    uint8_t ** rows;
+    int rowsAlloc;
+    int current;
+    
+    uint8_t * lookupData;
+    Cuboid * scratch;
+    Cuboid * symmetric;
+} HeuristicCoords;
+
+/**
+ * Returns NULL if no heuristic of the list can be tracked.
+ */
+HeuristicCoords * heuristic_coords_create(HeuristicList * list, AlgList * operations);
+void heuristic_coords_free(HeuristicCoords * coords);
+
+/**
+ * Finds the data for the node `sequence` of length `len`, from its parent's
+ * data or, for the first operation, from `root`. The node becomes the one
+ * which heuristic_coords_value() looks up.
+ */
+void heuristic_coords_update(HeuristicCoords * coords, const Cuboid * root,
+                             const int * sequence, int len);
+
+/**
+ * Returns the pruning value of heuristic `index` for the node which was last
+ * updated, or -1 if the heuristic is not tracked.
+ */
+int heuristic_coords_value(HeuristicCoords * coords, int index);
+
+#endif
@@ -1,84 +1,100 @@
 #include "heuristic_io.h"
+#include "heuristic_jobs.h"
 
 #define CHECK_HEURISTIC_ANGLES 1
 
+// set in the saved coset count if the cosets are DenseTables
+#define kCosetsDenseFlag 0x80000000
+
+// set in the saved coset count if the size of each coset follows it
+#define kCosetsSizedFlag 0x40000000
+
+// set in the saved heuristic count if the group of each heuristic follows
+#define kHeuristicListGroupsFlag 0x80000000
+
 static void _save_heuristic_parameters(HSParameters params, FILE * fp);
-static void _save_cosets(Heuristic * heuristic, FILE * fp);
+static int _save_heuristic(Heuristic * heuristic, HeuristicCosetWriter * writer, FILE * fp);
+static int _save_cosets(Heuristic * heuristic, HeuristicCosetWriter * writer, FILE * fp);
 static void _save_heuristic_angles(HeuristicAngles * angles, FILE * fp);
 
+typedef struct {
+    const char ** fileNames;
+    CuboidDimensions dims;
+    Heuristic ** heuristics;
+} HeuristicFileJobs;
+
+typedef struct {
+    Heuristic * heuristic;
+    const char * fileName;
+    uint64_t * offsets;
+} HeuristicCosetJobs;
+
+static Heuristic * _load_heuristic(FILE * fp, const char * fileName,
+                                   CuboidDimensions newDims);
+static void _load_file_job(void * context, int index);
 static int _load_subproblem(FILE * fp, HSubproblem * spOut);
 static int _load_heuristic_parameters(FILE * fp, HSParameters * params);
-static int _load_cosets(Heuristic * heuristic, FILE * fp);
+static int _load_cosets(Heuristic * heuristic, FILE * fp, const char * fileName);
+static int _load_coset(Heuristic * heuristic, int index, FILE * fp);
+static void _load_coset_job(void * context, int index);
+static void _free_cosets(Heuristic * heuristic);
 static HeuristicAngles * _load_heuristic_angles(FILE * fp);
 static int _initialize_subproblem(Heuristic * heuristic, FILE * fp);
 
 void save_heuristic(Heuristic * heuristic, FILE * fp) {
-    save_string(heuristic->subproblem.name, fp);
-    _save_heuristic_parameters(heuristic->params, fp);
-    _save_heuristic_angles(heuristic->angles, fp);
-    _save_cosets(heuristic, fp);
-    heuristic->subproblem.save(heuristic->spUserData, fp);
+    _save_heuristic(heuristic, NULL, fp);
 }
 
 Heuristic * load_heuristic(FILE * fp, CuboidDimensions newDims) {
-    HSubproblem subproblem;
-    HSParameters params;
-    params.symmetries.dims = newDims;
-    if (!_load_subproblem(fp, &subproblem)) return NULL;
-    if (!_load_heuristic_parameters(fp, &params)) return NULL;
-    
-    RotationBasis general = rotation_basis_standard(newDims);
-    if (!rotation_basis_is_subset(general, params.symmetries)) {
-        return NULL;
-    }
-    
-    HeuristicAngles * angles = _load_heuristic_angles(fp);
-    if (!angles) {
-        return NULL;
-    }
-    
-    Heuristic * heuristic = (Heuristic *)malloc(sizeof(Heuristic));
-    bzero(heuristic, sizeof(Heuristic));
-    heuristic->subproblem = subproblem;
-    heuristic->params = params;
-    heuristic->angles = angles;
-    if (!_load_cosets(heuristic, fp)) {
-        free(heuristic);
-        heuristic_angles_free(angles);
-        return NULL;
-    }
-    
-    if (!_initialize_subproblem(heuristic, fp)) {
-        int i;
-        for (i = 0; i < heuristic->cosetCount; i++) {
-            data_list_free(heuristic->cosets[i]);
-        }
-        if (heuristic->cosets) free(heuristic->cosets);
-        heuristic_angles_free(angles);
-        free(heuristic);
-        return NULL;
-    }
-    
-    heuristic_initialize_symmetries(heuristic);
-    return heuristic;
+    return _load_heuristic(fp, NULL, newDims);
+}
+
+int heuristic_to_file(Heuristic * heuristic, const char * fileName) {
+    FILE * fp = fopen(fileName, "w");
+    if (!fp) return 0;
+    setvbuf(fp, NULL, _IOFBF, kHeuristicIOBufferSize);
+    save_heuristic(heuristic, fp);
+    return (fclose(fp) == 0);
+}
+
+int heuristic_to_file_with(Heuristic * heuristic, const char * fileName,
+                           HeuristicCosetWriter * writer) {
+    FILE * fp = fopen(fileName, "w");
+    if (!fp) return 0;
+    setvbuf(fp, NULL, _IOFBF, kHeuristicIOBufferSize);
+    int result = _save_heuristic(heuristic, writer, fp);
+    if (fclose(fp)) result = 0;
+    return result;
 }
 
 Heuristic * heuristic_from_file(const char * fileName, CuboidDimensions dims) {
     FILE * fp = fopen(fileName, "r");
     if (!fp) return NULL;
-    Heuristic * h = load_heuristic(fp, dims);
+    setvbuf(fp, NULL, _IOFBF, kHeuristicIOBufferSize);
+    Heuristic * h = _load_heuristic(fp, fileName, dims);
     fclose(fp);
     return h;
 }
 
+void heuristics_from_files(const char ** fileNames, int count, CuboidDimensions dims,
+                           Heuristic ** heuristicsOut) {
+    HeuristicFileJobs jobs = {fileNames, dims, heuristicsOut};
+    heuristic_jobs_run(count, _load_file_job, &jobs);
+}
+
 void save_heuristic_list(HeuristicList * list, FILE * fp) {
     uint32_t heuristicCount = list->count;
-    save_uint32(heuristicCount, fp);
+    int hasGroups = heuristic_list_has_groups(list);
+    save_uint32(heuristicCount | (hasGroups ? kHeuristicListGroupsFlag : 0), fp);
     int i;
     for (i = 0; i < heuristicCount; i++) {
         const char * file = list->fileNames[i];
         fwrite(file, 1, strlen(file) + 1, fp);
     }
+    if (!hasGroups) return;
+    for (i = 0; i < heuristicCount; i++) {
+        save_uint32(list->groups[i], fp);
+    }
 }
 
 HeuristicList * load_heuristic_list(FILE * fp, CuboidDimensions dims) {
@@ -86,24 +102,53 @@ HeuristicList * load_heuristic_list(FILE * fp, CuboidDimensions dims) {
     int i;
     
     if (!load_uint32(&count, fp)) return 0;
+    int hasGroups = (count & kHeuristicListGroupsFlag) != 0;
+    count &= ~kHeuristicListGroupsFlag;
     
-    HeuristicList * list = heuristic_list_new();
+    // the names come first, so that the files can be loaded together
+    char ** names = (char **)malloc(sizeof(char *) * (count + 1));
+    Heuristic ** heuristics = (Heuristic **)malloc(sizeof(void *) * (count + 1));
     for (i = 0; i < count; i++) {
-        char * name = load_string(fp);
-        if (!name) {
-            heuristic_list_free(list);
-            return NULL;
+        names[i] = load_string(fp);
+        if (!names[i]) break;
+    }
+    int success = (i == count);
+    if (success) {
+        heuristics_from_files((const char **)names, count, dims, heuristics);
+        for (i = 0; i < count; i++) {
+            if (!heuristics[i]) success = 0;
         }
-        Heuristic * heuristic = heuristic_from_file(name, dims);
-        if (!heuristic) {
+        if (!success) {
+            for (i = 0; i < count; i++) {
+                if (heuristics[i]) heuristic_free(heuristics[i]);
+            }
+        }
+    }
+    
+    HeuristicList * list = heuristic_list_new();
+    for (i = 0; i < count && names[i]; i++) {
+        if (success) heuristic_list_add(list, heuristics[i], names[i]);
+        free(names[i]);
+    }
+    free(names);
+    free(heuristics);
+    if (!success) {
+        heuristic_list_free(list);
+        return NULL;
+    }
+    
+    if (!hasGroups) return list;
+    for (i = 0; i < count; i++) {
+        uint32_t group;
+        if (!load_uint32(&group, fp)) group = count;
+        
+        // groups are made of adjacent heuristics
+        if (group != i && (i == 0 || group != list->groups[i - 1])) {
             heuristic_list_free(list);
-            free(name);
             return NULL;
         }
-        heuristic_list_add(list, heuristic, name);
-        free(name);
+        list->groups[i] = group;
     }
-    
     return list;
 }
 
@@ -123,13 +168,42 @@ static void _save_heuristic_parameters(HSParameters params, FILE * fp) {
     save_uint32(maxDepth, fp);
 }
 
-static void _save_cosets(Heuristic * heuristic, FILE * fp) {
+static int _save_heuristic(Heuristic * heuristic, HeuristicCosetWriter * writer, FILE * fp) {
+    save_string(heuristic->subproblem.name, fp);
+    _save_heuristic_parameters(heuristic->params, fp);
+    _save_heuristic_angles(heuristic->angles, fp);
+    if (!_save_cosets(heuristic, writer, fp)) return 0;
+    heuristic->subproblem.save(heuristic->spUserData, fp);
+    return 1;
+}
+
+static int _save_cosets(Heuristic * heuristic, HeuristicCosetWriter * writer, FILE * fp) {
     uint32_t count = heuristic->cosetCount;
-    save_uint32(count, fp);
-    int i;
+    int i, dense = heuristic_is_dense(heuristic);
+    assert(!writer || !dense);
+    save_uint32(count | kCosetsSizedFlag | (dense ? kCosetsDenseFlag : 0), fp);
+    
+    // the sizes let a loader find every coset without reading the ones
+    // before it
+    for (i = 0; i < count; i++) {
+        if (writer) {
+            save_uint64(writer->coset_size(writer->context, i), fp);
+        } else if (dense) {
+            save_uint64(save_dense_table_size(heuristic->denseCosets[i]), fp);
+        } else {
+            save_uint64(save_data_list_size(heuristic->cosets[i]), fp);
+        }
+    }
     for (i = 0; i < count; i++) {
-        save_data_list(heuristic->cosets[i], fp);
+        if (writer) {
+            if (!writer->save_coset(writer->context, i, fp)) return 0;
+        } else if (dense) {
+            save_dense_table(heuristic->denseCosets[i], fp);
+        } else {
+            save_data_list(heuristic->cosets[i], fp);
+        }
     }
+    return 1;
 }
 
 static void _save_heuristic_angles(HeuristicAngles * angles, FILE * fp) {
@@ -152,6 +226,53 @@ static void _save_heuristic_angles(HeuristicAngles * angles, FILE * fp) {
  * Private: loading *
  ********************/
 
+static Heuristic * _load_heuristic(FILE * fp, const char * fileName,
+                                   CuboidDimensions newDims) {
+    HSubproblem subproblem;
+
+    HSParameters params;
+    params.symmetries.dims = newDims;
+    if (!_load_subproblem(fp, &subproblem)) return NULL;
+    if (!_load_heuristic_parameters(fp, &params)) return NULL;
+    
+    RotationBasis general = rotation_basis_standard(newDims);
+    if (!rotation_basis_is_subset(general, params.symmetries)) {
+        return NULL;
+    }
+    
+    HeuristicAngles * angles = _load_heuristic_angles(fp);
+    if (!angles) {
+        return NULL;
+    }
+    
+    Heuristic * heuristic = (Heuristic *)malloc(sizeof(Heuristic));
+    bzero(heuristic, sizeof(Heuristic));
+    heuristic->subproblem = subproblem;
+    heuristic->params = params;
+    heuristic->angles = angles;
+    if (!_load_cosets(heuristic, fp, fileName)) {
+        free(heuristic);
+        heuristic_angles_free(angles);
+        return NULL;
+    }
+    
+    if (!_initialize_subproblem(heuristic, fp)) {
+        _free_cosets(heuristic);
+        heuristic_angles_free(angles);
+        free(heuristic);
+        return NULL;
+    }
+    
+    heuristic_initialize_symmetries(heuristic);
+    return heuristic;
+}
+
+
+static void _load_file_job(void * context, int index) {
+    HeuristicFileJobs * jobs = (HeuristicFileJobs *)context;
+    jobs->heuristics[index] = heuristic_from_file(jobs->fileNames[index], jobs->dims);
+}
+
 static int _load_subproblem(FILE * fp, HSubproblem * spOut) {
     char * nameBuffer = load_string(fp);
     if (!nameBuffer) return 0;
@@ -182,30 +303,95 @@ static int _load_heuristic_parameters(FILE * fp, HSParameters * params) {
     return 1;
 }
 
-static int _load_cosets(Heuristic * heuristic, FILE * fp) {
+static int _load_cosets(Heuristic * heuristic, FILE * fp, const char * fileName) {
     uint32_t count;
     if (!load_uint32(&count, fp)) return 0;
+    int dense = (count & kCosetsDenseFlag) != 0;
+    int sized = (count & kCosetsSizedFlag) != 0;
+    count &= ~(kCosetsDenseFlag | kCosetsSizedFlag);
     heuristic->cosetCount = count;
-    if (count > 0) {
+    if (dense) {
+        heuristic->denseCosets = (DenseTable **)malloc(sizeof(void *) * (count + 1));
+        bzero(heuristic->denseCosets, sizeof(void *) * (count + 1));
+    } else if (count > 0) {
         heuristic->cosets = (DataList **)malloc(sizeof(void *) * count);
-        int i, j;
-        for (i = 0; i < count; i++) {
-            DataList * dl = load_data_list(fp);
-            if (!dl) {
-                for (j = 0; j < i; j++) {
-                    data_list_free(heuristic->cosets[j]);
-                }
-                free(heuristic->cosets);
-                return 0;
-            }
-            heuristic->cosets[i] = dl;
+        bzero(heuristic->cosets, sizeof(void *) * count);
+    }
+    
+    int i, success = 1;
+    uint64_t * offsets = (uint64_t *)malloc(sizeof(uint64_t) * (count + 1));
+    offsets[0] = 0;
+    for (i = 0; i < count && sized; i++) {
+        if (!load_uint64(&offsets[i + 1], fp)) {
+            free(offsets);
+            _free_cosets(heuristic);
+            return 0;
+        }
+        offsets[i + 1] += offsets[i];
+    }
+    
+    if (!sized || !fileName || count < 2) {
+        for (i = 0; i < count && success; i++) {
+            success = _load_coset(heuristic, i, fp);
         }
     } else {
-        heuristic->cosets = NULL;
+        // each coset is read through its own stream, starting at its offset
+        long long start = ftello(fp);
+        for (i = 0; i <= count; i++) {
+            offsets[i] += start;
+        }
+        HeuristicCosetJobs jobs = {heuristic, fileName, offsets};
+        heuristic_jobs_run(count, _load_coset_job, &jobs);
+        for (i = 0; i < count; i++) {
+            if (dense && !heuristic->denseCosets[i]) success = 0;
+            if (!dense && !heuristic->cosets[i]) success = 0;
+        }
+        if (success && fseeko(fp, offsets[count], SEEK_SET)) success = 0;
+    }
+    free(offsets);
+    
+    if (!success) {
+        _free_cosets(heuristic);
+        return 0;
     }
     return 1;
 }
 
+static int _load_coset(Heuristic * heuristic, int index, FILE * fp) {
+    if (heuristic->denseCosets) {
+        heuristic->denseCosets[index] = load_dense_table(fp);
+        return (heuristic->denseCosets[index] != NULL);
+    }
+    heuristic->cosets[index] = load_data_list(fp);
+    return (heuristic->cosets[index] != NULL);
+}
+
+static void _load_coset_job(void * context, int index) {
+    HeuristicCosetJobs * jobs = (HeuristicCosetJobs *)context;
+    FILE * fp = fopen(jobs->fileName, "r");
+    if (!fp) return;
+    setvbuf(fp, NULL, _IOFBF, kHeuristicIOBufferSize);
+    if (fseeko(fp, jobs->offsets[index], SEEK_SET) == 0) {
+        _load_coset(jobs->heuristic, index, fp);
+    }
+    fclose(fp);
+}
+
+static void _free_cosets(Heuristic * heuristic) {
+    int i;
+    for (i = 0; i < heuristic->cosetCount; i++) {
+        if (heuristic->cosets && heuristic->cosets[i]) {
+            data_list_free(heuristic->cosets[i]);
+        } else if (heuristic->denseCosets && heuristic->denseCosets[i]) {
+            dense_table_free(heuristic->denseCosets[i]);
+        }
+    }
+    if (heuristic->cosets) free(heuristic->cosets);
+    if (heuristic->denseCosets) free(heuristic->denseCosets);
+    heuristic->cosets = NULL;
+    heuristic->denseCosets = NULL;
+}
+
 static HeuristicAngles * _load_heuristic_angles(FILE * fp) {
     uint8_t angleCount, distinctCount;
     if (!load_uint8(&angleCount, fp)) return NULL;
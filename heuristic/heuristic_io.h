@@ -4,11 +4,36 @@
 #include "heuristic_list.h"
 #include "heuristic.h"
 #include "saving/save_data_list.h"
+#include "saving/save_dense_table.h"
+
+// files are read and written through buffers of this many bytes
+#define kHeuristicIOBufferSize (1 << 22)
 
 void save_heuristic(Heuristic * heuristic, FILE * fp);
 Heuristic * load_heuristic(FILE * fp, CuboidDimensions newDims);
+
+// returns 0 if the file cannot be written
+int heuristic_to_file(Heuristic * heuristic, const char * fileName);
+
+// supplies the cosets of a heuristic which are not kept in its data lists
+typedef struct {
+    void * context;
+    unsigned long long (*coset_size)(void * context, int coset);
+    int (*save_coset)(void * context, int coset, FILE * fp); // returns 0 on failure
+} HeuristicCosetWriter;
+
+// like heuristic_to_file(), but the cosets come from `writer` one at a time
+int heuristic_to_file_with(Heuristic * heuristic, const char * fileName,
+                           HeuristicCosetWriter * writer);
+
+// loads the cosets of the file on several threads when it was saved with
+// their sizes, which every file saved by save_heuristic() is.
 Heuristic * heuristic_from_file(const char * fileName, CuboidDimensions dims);
 
+// loads several files at once; heuristicsOut[i] is NULL if file i failed
+void heuristics_from_files(const char ** fileNames, int count, CuboidDimensions dims,
+                           Heuristic ** heuristicsOut);
+
 // saves the file name of each heuristic
 void save_heuristic_list(HeuristicList * list, FILE * fp);
 HeuristicList * load_heuristic_list(FILE * fp, CuboidDimensions dims);
@@ -0,0 +1,45 @@
+#include "heuristic_jobs.h"
+#include <stdlib.h>
+
+typedef struct {
+    HeuristicJob job;
+    void * context;
+    int count;
+    int next;
+} HeuristicJobs;
+
+static void * _heuristic_jobs_thread(void * argument);
+
+void heuristic_jobs_run(int count, HeuristicJob job, void * context) {
+    HeuristicJobs jobs = {job, context, count, 0};
+    int i, threadCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threadCount > count) threadCount = count;
+    if (threadCount <= 1) {
+        _heuristic_jobs_thread(&jobs);
+        return;
+    }
+    
+    // the calling thread takes jobs as well
+    pthread_t * threads = (pthread_t *)malloc(sizeof(pthread_t) * threadCount);
+    for (i = 1; i < threadCount; i++) {
+        pthread_create(&threads[i], NULL, _heuristic_jobs_thread, &jobs);
+    }
+    _heuristic_jobs_thread(&jobs);
+    for (i = 1; i < threadCount; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+}
+
+/***********
+ * Private *
+ ***********/
+
+static void * _heuristic_jobs_thread(void * argument) {
+    HeuristicJobs * jobs = (HeuristicJobs *)argument;
+    int index;
+    while ((index = __sync_fetch_and_add(&jobs->next, 1)) < jobs->count) {
+        jobs->job(jobs->context, index);
+    }
+    return NULL;
+}
@@ -0,0 +1,17 @@
+#ifndef __HEURISTIC_JOBS_H__
+#define __HEURISTIC_JOBS_H__
+
+#include <pthread.h>
+#include <unistd.h>
+
+/***
+ * Runs independent jobs, such as loading or freezing the cosets of the
+ * heuristics, on as many threads as there are processors. Jobs are handed
+ * out one at a time, so large and small jobs may be mixed.
+ */
+
+typedef void (*HeuristicJob)(void * context, int index);
+
+void heuristic_jobs_run(int count, HeuristicJob job, void * context);
+
+#endif
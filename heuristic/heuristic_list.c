@@ -1,8 +1,18 @@
 #include "heuristic_list.h"
+#include "heuristic_jobs.h"
+
+typedef struct {
+    HeuristicList * list;
+    int * heuristics;
+    int * cosets;
+    int * options;
+} HeuristicListFreezeJobs;
 
 static void _generate_coset_map(Heuristic * heuristic, HeuristicCosetMap * map, 
                                 RotationGroup * allSymmetries, Cuboid * cache);
 static RotationBasis _rotation_basis_container(RotationBasis b1, RotationBasis b2);
+static void _freeze_all(HeuristicList * list);
+static void _freeze_job(void * context, int index);
 
 HeuristicList * heuristic_list_new() {
     HeuristicList * list = (HeuristicList *)malloc(sizeof(HeuristicList));
@@ -21,6 +31,7 @@ void heuristic_list_free(HeuristicList * list) {
         }
         free(list->cosetMaps);
     }
+    if (list->groups) free(list->groups);
     free(list);
 }
 
@@ -37,6 +48,9 @@ void heuristic_list_add(HeuristicList * list, Heuristic * h, const char * file)
         int newSize = (list->count + 1) * sizeof(void *);
         list->fileNames = (char **)realloc(list->fileNames, newSize);
     }
+    int newSize = (list->count + 1) * sizeof(int);
+    list->groups = (int *)realloc(list->groups, newSize);
+    list->groups[list->count] = list->count;
     list->heuristics[list->count] = h;
     list->fileNames[list->count] = (char *)malloc(strlen(file) + 1);
     strcpy(list->fileNames[list->count], file);
@@ -47,6 +61,43 @@ void heuristic_list_add(HeuristicList * list, Heuristic * h, const char * file)
     list->dataBasis = _rotation_basis_container(dataBasis, list->dataBasis);
 }
 
+void heuristic_list_add_additive(HeuristicList * list, Heuristic * h, const char * file) {
+    assert(list->count > 0);
+    heuristic_list_add(list, h, file);
+    list->groups[list->count - 1] = list->groups[list->count - 2];
+}
+
+int heuristic_list_has_groups(HeuristicList * list) {
+    int i;
+    for (i = 0; i < list->count; i++) {
+        if (list->groups[i] != i) return 1;
+    }
+    return 0;
+}
+
+int heuristic_list_group_depth(HeuristicList * list, int first) {
+    int i, depth = -1, end = heuristic_list_group_end(list, first);
+    for (i = first; i < end; i++) {
+        depth += list->heuristics[i]->params.maxDepth + 1;
+    }
+    return depth;
+}
+
+int heuristic_list_group_end(HeuristicList * list, int first) {
+    int end = first + 1;
+    while (end < list->count && list->groups[end] == first) end++;
+    return end;
+}
+
+unsigned long long heuristic_list_group_size(HeuristicList * list, int first) {
+    unsigned long long size = 0;
+    int i, end = heuristic_list_group_end(list, first);
+    for (i = first; i < end; i++) {
+        size += heuristic_memory_size(list->heuristics[i]);
+    }
+    return size;
+}
+
 /***********
  * Lookups *
  ***********/
@@ -60,6 +111,7 @@ void heuristic_list_prepare(HeuristicList * list, Cuboid * cache) {
     int mapsSize = sizeof(HeuristicCosetMap) * list->count;
     list->cosetMaps = (HeuristicCosetMap *)malloc(mapsSize);
     int i;
+    _freeze_all(list);
     for (i = 0; i < list->count; i++) {
         _generate_coset_map(list->heuristics[i], &list->cosetMaps[i],
                             list->dataSymmetries, cache);
@@ -90,12 +142,13 @@ int heuristic_list_pruning_value(HeuristicList * list, const Cuboid * cuboid,
         }
     }
     
-    int pruningValue = 0;
+    int pruningValue = 0, sum = 0;
     for (i = 0; i < list->count; i++) {
         HeuristicBuffer * buffer = buffers[i];
-        int value = heuristic_buffer_pruning_value(buffer);
-        if (value > pruningValue) {
-            pruningValue = value;
+        if (list->groups[i] == i) sum = 0;
+        sum += heuristic_buffer_pruning_value(buffer);
+        if (sum > pruningValue) {
+            pruningValue = sum;
         }
     }
     
@@ -128,19 +181,24 @@ int heuristic_list_exceeds(HeuristicList * list, const Cuboid * cuboid,
         rotations[i] = cuboid_copy(cache);
     }
     
-    int exceeds = 0;
-    // test all heuristics
-    for (i = 0; i < list->count; i++) {
+    int exceeds = 0, sum = 0;
+    // test all heuristics; dense heuristics add nothing to their group
+    for (i = 0; i < list->count && !exceeds; i++) {
+        if (list->groups[i] == i) {
+            sum = 0;
+            if (maxValue > heuristic_list_group_depth(list, i)) {
+                i = heuristic_list_group_end(list, i) - 1;
+                continue;
+            }
+        }
+        if (heuristic_is_dense(list->heuristics[i])) continue;
         HeuristicBuffer * buffer = buffers[i];
         for (j = 0; j < rotation_group_count(list->dataSymmetries); j++) {
             int coset = list->cosetMaps[i].cosets[j];
             heuristic_buffer_add(buffer, rotations[j], coset);
         }
-        int value = heuristic_buffer_pruning_value(buffer);
-        if (value > maxValue) {
-            exceeds = 1;
-            break;
-        }
+        sum += heuristic_buffer_pruning_value(buffer);
+        if (sum > maxValue) exceeds = 1;
     }
     
     // free resources
@@ -156,6 +214,76 @@ int heuristic_list_exceeds(HeuristicList * list, const Cuboid * cuboid,
     return exceeds;
 }
 
+void heuristic_list_exceeds_batch(HeuristicList * list, const Cuboid ** cuboids,
+                                  int count, Cuboid * cache, int maxValue,
+                                  int * exceeds) {
+    int i, j, k;
+    for (k = 0; k < count; k++) {
+        if (cuboids[k]) exceeds[k] = 0;
+    }
+    if (list->count == 0) return;
+    
+    HeuristicBuffer ** buffers = (HeuristicBuffer **)malloc(sizeof(void *) * count);
+    int * sums = (int *)malloc(sizeof(int) * count);
+    for (i = 0; i < list->count; i++) {
+        Heuristic * heuristic = list->heuristics[i];
+        if (list->groups[i] == i) {
+            bzero(sums, sizeof(int) * count);
+            if (maxValue > heuristic_list_group_depth(list, i)) {
+                i = heuristic_list_group_end(list, i) - 1;
+                continue;
+            }
+        }
+        if (heuristic_is_dense(heuristic)) continue;
+        
+        // fill a buffer for every cuboid which has not been pruned yet
+        int probeCount = 0;
+        for (k = 0; k < count; k++) {
+            buffers[k] = NULL;
+            if (!cuboids[k] || exceeds[k]) continue;
+            buffers[k] = heuristic_buffer_create(heuristic);
+            for (j = 0; j < rotation_group_count(list->dataSymmetries); j++) {
+                int coset = list->cosetMaps[i].cosets[j];
+                if (coset < 0) continue;
+                const Cuboid * rotation = rotation_group_get(list->dataSymmetries, j);
+                cuboid_multiply(cache, rotation, cuboids[k]);
+                heuristic_buffer_add(buffers[k], cache, coset);
+            }
+            probeCount += heuristic_buffer_probe_count(buffers[k]);
+        }
+        
+        DataListProbe * probes = (DataListProbe *)malloc(sizeof(DataListProbe) * (probeCount + 1));
+        int offset = 0;
+        for (k = 0; k < count; k++) {
+            if (!buffers[k]) continue;
+            heuristic_buffer_start_probes(buffers[k], &probes[offset]);
+            offset += heuristic_buffer_probe_count(buffers[k]);
+        }
+        
+        data_list_probe_batch(probes, probeCount);
+        
+        offset = 0;
+        for (k = 0; k < count; k++) {
+            if (!buffers[k]) continue;
+            sums[k] += heuristic_buffer_probed_value(buffers[k], &probes[offset]);
+            if (sums[k] > maxValue) exceeds[k] = 1;
+            offset += heuristic_buffer_probe_count(buffers[k]);
+            heuristic_buffer_free(buffers[k]);
+        }
+        free(probes);
+    }
+    free(buffers);
+    free(sums);
+}
+
+int heuristic_list_has_dense(HeuristicList * list) {
+    int i;
+    for (i = 0; i < list->count; i++) {
+        if (heuristic_is_dense(list->heuristics[i])) return 1;
+    }
+    return 0;
+}
+
 /***********
  * Private *
  ***********/
@@ -203,3 +331,42 @@ static RotationBasis _rotation_basis_container(RotationBasis b1, RotationBasis b
     
     return newBasis;
 }
+
+static void _freeze_all(HeuristicList * list) {
+    // every coset of every heuristic is frozen on its own; the sizes are
+    // found first, since freezing changes them
+    int i, j, count = 0;
+    for (i = 0; i < list->count; i++) {
+        count += list->heuristics[i]->cosetCount;
+    }
+    HeuristicListFreezeJobs jobs;
+    jobs.list = list;
+    jobs.heuristics = (int *)malloc(sizeof(int) * (count + 1));
+    jobs.cosets = (int *)malloc(sizeof(int) * (count + 1));
+    jobs.options = (int *)malloc(sizeof(int) * (count + 1));
+    count = 0;
+    for (i = 0; i < list->count; i++) {
+        Heuristic * heuristic = list->heuristics[i];
+        int options = 0;
+        if (heuristic_memory_size(heuristic) > kHeuristicListSmallSize) {
+            if (list->filterLarge) options |= kDataListFreezeFilter;
+            if (list->compressLarge) options |= kDataListFreezeCompress;
+        }
+        for (j = 0; j < heuristic->cosetCount; j++) {
+            jobs.heuristics[count] = i;
+            jobs.cosets[count] = j;
+            jobs.options[count] = options;
+            count++;
+        }
+    }
+    heuristic_jobs_run(count, _freeze_job, &jobs);
+    free(jobs.heuristics);
+    free(jobs.cosets);
+    free(jobs.options);
+}
+
+static void _freeze_job(void * context, int index) {
+    HeuristicListFreezeJobs * jobs = (HeuristicListFreezeJobs *)context;
+    Heuristic * heuristic = jobs->list->heuristics[jobs->heuristics[index]];
+    heuristic_freeze_coset(heuristic, jobs->cosets[index], jobs->options[index]);
+}
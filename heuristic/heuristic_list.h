@@ -1,3 +1,6 @@
+#ifndef __HEURISTIC_LIST_H__
+#define __HEURISTIC_LIST_H__
+
 #include "heuristic.h"
 #include "heuristic_buffer.h"
 
@@ -11,11 +14,27 @@ typedef struct {
     int8_t * cosets;
 } HeuristicCosetMap;
 
+// heuristics of up to this many bytes are likely to stay in the cache
+#define kHeuristicListSmallSize (1 << 21)
+
 typedef struct {
     Heuristic ** heuristics;
     char ** fileNames;
     int count;
     
+    // groups[i] is the first heuristic of the additive group which
+    // heuristic i belongs to. The values within a group are summed, and
+    // the list takes the highest sum. Members of a group are adjacent.
+    int * groups;
+    
+    // if set before heuristic_list_prepare(), heuristics larger than
+    // kHeuristicListSmallSize get a filter of their keys (see data_filter.h)
+    int filterLarge;
+    
+    // likewise, heuristics larger than kHeuristicListSmallSize are frozen
+    // with front-coded records, which take less memory but search slower
+    int compressLarge;
+    
     // made to enclose the data symmetries of all heuristics
     RotationBasis dataBasis;
     RotationGroup * dataSymmetries;
@@ -26,10 +45,42 @@ HeuristicList * heuristic_list_new();
 void heuristic_list_free(HeuristicList * list);
 void heuristic_list_add(HeuristicList * list, Heuristic * h, const char * file);
 
-// called when all heuristics have been added
+// adds a heuristic to the group of the last heuristic. The caller must make
+// sure that no operation is counted by more than one heuristic of a group;
+// see heuristic_operation_cost().
+void heuristic_list_add_additive(HeuristicList * list, Heuristic * h, const char * file);
+
+// returns 1 if some group has more than one heuristic
+int heuristic_list_has_groups(HeuristicList * list);
+
+// the highest value a group can return while all of its heuristics are
+// within their maxDepth; a group cannot prune past this value.
+int heuristic_list_group_depth(HeuristicList * list, int first);
+
+// returns the index after the last heuristic of the group starting at `first`
+int heuristic_list_group_end(HeuristicList * list, int first);
+
+// the number of bytes the heuristics of a group take up
+unsigned long long heuristic_list_group_size(HeuristicList * list, int first);
+
+// called when all heuristics have been added; freezes every heuristic
 void heuristic_list_prepare(HeuristicList * list, Cuboid * cache);
 int heuristic_list_pruning_value(HeuristicList * list, const Cuboid * cuboid,
                                  Cuboid * cache);
+
+// groups whose depth is below maxValue are skipped, since they cannot
+// prune; see heuristic_order.h for adaptive ordering.
 int heuristic_list_exceeds(HeuristicList * list, const Cuboid * cuboid,
                            Cuboid * cache, int maxValue);
 
+// like heuristic_list_exceeds(), but for several cuboids (usually the children
+// of one node) whose lookups are interleaved. exceeds[i] is set for every
+// non-NULL entry of cuboids.
+void heuristic_list_exceeds_batch(HeuristicList * list, const Cuboid ** cuboids,
+                                  int count, Cuboid * cache, int maxValue,
+                                  int * exceeds);
+
+// dense heuristics are skipped by the lookups above; see heuristic_path.h
+int heuristic_list_has_dense(HeuristicList * list);
+
+#endif
@@ -0,0 +1,220 @@
+#include "heuristic_order.h"
+
+static int _heuristic_order_known_value(HeuristicOrder * order, int first, const int * values,
+                                        int inverses);
+static int _heuristic_order_lookup(HeuristicOrder * order, int first, const Cuboid * cuboid,
+                                   const Cuboid * inverse, Cuboid * cache, int maxValue,
+                                   int * values, int * exact);
+static int _heuristic_order_is_before(HeuristicOrder * order, int index, int other);
+static double _heuristic_order_cost(HeuristicOrderStats * stats);
+static double _heuristic_order_seconds();
+
+HeuristicOrder * heuristic_order_create(HeuristicList * list) {
+    HeuristicOrder * order = (HeuristicOrder *)malloc(sizeof(HeuristicOrder));
+    bzero(order, sizeof(HeuristicOrder));
+    order->list = list;
+    order->order = (int *)malloc(sizeof(int) * (list->count + 1));
+    order->stats = (HeuristicOrderStats *)malloc(sizeof(HeuristicOrderStats) * (list->count + 1));
+    bzero(order->stats, sizeof(HeuristicOrderStats) * (list->count + 1));
+    order->tiers = (int *)malloc(sizeof(int) * (list->count + 1));
+    
+    // start out in command line order within each tier, with one entry
+    // per group
+    int i, tier;
+    for (i = 0; i < list->count; i++) {
+        if (list->groups[i] != i) continue;
+        order->tiers[i] = (heuristic_list_group_size(list, i) > kHeuristicListSmallSize);
+    }
+    for (tier = 0; tier < 2; tier++) {
+        for (i = 0; i < list->count; i++) {
+            if (heuristic_is_dense(list->heuristics[i])) continue;
+            if (list->groups[i] != i || order->tiers[i] != tier) continue;
+            order->order[order->count++] = i;
+        }
+    }
+    return order;
+}
+
+void heuristic_order_free(HeuristicOrder * order) {
+    free(order->order);
+    free(order->stats);
+    free(order->tiers);
+    free(order);
+}
+
+int heuristic_order_exceeds(HeuristicOrder * order, const Cuboid * cuboid,
+                            const Cuboid * inverse, Cuboid * cache, int maxValue,
+                            int * values, int * valueOut, int * exactOut) {
+    int i, exceeds = 0, highest = 0, exact = 1;
+    int sample = (order->checks % kHeuristicOrderSampleRate == 0);
+    int inverses = (inverse != NULL);
+    
+    // values which are already known cost nothing, so they go first
+    if (values) {
+        for (i = 0; i < order->count; i++) {
+            int value = _heuristic_order_known_value(order, order->order[i], values, inverses);
+            if (value > highest) highest = value;
+            if (value > maxValue) exceeds = 1;
+        }
+    }
+    
+    for (i = 0; i < order->count && !exceeds; i++) {
+        int index = order->order[i];
+        HeuristicOrderStats * stats = &order->stats[index];
+        if (values && _heuristic_order_known_value(order, index, values, inverses) >= 0) continue;
+        if (maxValue > heuristic_list_group_depth(order->list, index)) {
+            exact = 0;
+            continue;
+        }
+        
+        double start = (sample ? _heuristic_order_seconds() : 0);
+        int value = _heuristic_order_lookup(order, index, cuboid, inverse, cache,
+                                            maxValue, values, &exact);
+        if (sample) {
+            stats->sampledSeconds += _heuristic_order_seconds() - start;
+            stats->sampledLookups++;
+        }
+        stats->lookups++;
+        
+        if (value > highest) highest = value;
+        if (value > maxValue) {
+            stats->prunes++;
+            exceeds = 1;
+            if (order->counters) {
+                int j, end = heuristic_list_group_end(order->list, index);
+                for (j = index; j < end; j++) heuristic_stats_add_prune(order->counters, j);
+            }
+        }
+    }
+    
+    // anything after the heuristic which pruned was never looked at
+    for (; i < order->count; i++) {
+        if (!values || _heuristic_order_known_value(order, order->order[i], values, inverses) < 0) {
+            exact = 0;
+        }
+    }
+    
+    order->checks++;
+    if (order->checks % kHeuristicOrderInterval == 0) {
+        heuristic_order_update(order);
+    }
+    
+    if (valueOut) {
+        *valueOut = highest;
+        *exactOut = exact;
+    }
+    return exceeds;
+}
+
+void heuristic_order_update(HeuristicOrder * order) {
+    // insertion sort; there are rarely more than a handful of heuristics
+    int i, j;
+    for (i = 1; i < order->count; i++) {
+        int index = order->order[i];
+        for (j = i; j > 0; j--) {
+            int previous = order->order[j - 1];
+            if (!_heuristic_order_is_before(order, index, previous)) break;
+            order->order[j] = previous;
+        }
+        order->order[j] = index;
+    }
+    
+    for (i = 0; i < order->list->count; i++) {
+        HeuristicOrderStats * stats = &order->stats[i];
+        stats->lookups /= 2;
+        stats->prunes /= 2;
+        stats->sampledLookups /= 2;
+        stats->sampledSeconds /= 2;
+    }
+}
+
+/***********
+ * Private *
+ ***********/
+
+static int _heuristic_order_known_value(HeuristicOrder * order, int first, const int * values,
+                                        int inverses) {
+    // the sum of a group is only known once every member is
+    HeuristicList * list = order->list;
+    int i, sum = 0, end = heuristic_list_group_end(list, first);
+    for (i = first; i < end; i++) {
+        if (heuristic_is_dense(list->heuristics[i])) continue;
+        if (values[i] < 0) return -1;
+        sum += values[i];
+    }
+    
+    // so is the value of a heuristic which is also looked up on the inverse
+    if (inverses && end == first + 1 && !heuristic_is_dense(list->heuristics[first])) {
+        int dual = values[list->count + first];
+        if (dual < 0) return -1;
+        if (dual > sum) sum = dual;
+    }
+    return sum;
+}
+
+static int _heuristic_order_lookup(HeuristicOrder * order, int first, const Cuboid * cuboid,
+                                   const Cuboid * inverse, Cuboid * cache, int maxValue,
+                                   int * values, int * exact) {
+    HeuristicList * list = order->list;
+    int i, sum = 0, end = heuristic_list_group_end(list, first);
+    for (i = first; i < end; i++) {
+        Heuristic * heuristic = list->heuristics[i];
+        if (heuristic_is_dense(heuristic)) continue;
+        int known = (values && values[i] >= 0);
+        int sample = (!known && order->counters &&
+                      heuristic_stats_should_sample(order->counters, i));
+        double start = (sample ? heuristic_stats_seconds() : 0);
+        int value;
+        if (known) {
+            value = values[i];
+        } else if (order->coords && order->coords->entries[i]) {
+            value = heuristic_coords_value(order->coords, i);
+        } else {
+            value = heuristic_pruning_value(heuristic, cuboid, cache);
+        }
+        if (values) values[i] = value;
+        
+        // the inverse is not summed, since groups split up moves unevenly
+        if (inverse && end == first + 1) {
+            if (value <= maxValue) {
+                int * dualValue = (values ? &values[list->count + i] : NULL);
+                int dual = (dualValue ? *dualValue : -1);
+                if (dual < 0) dual = heuristic_pruning_value(heuristic, inverse, cache);
+                if (dualValue) *dualValue = dual;
+                if (dual > value) value = dual;
+            } else {
+                // the dual value might have been higher still
+                *exact = 0;
+            }
+        }
+        if (!known && order->counters) {
+            double seconds = (sample ? heuristic_stats_seconds() - start : 0);
+            heuristic_stats_add_lookup(order->counters, i, value, sample, seconds);
+        }
+        sum += value;
+    }
+    return sum;
+}
+
+static int _heuristic_order_is_before(HeuristicOrder * order, int index, int other) {
+    if (order->tiers[index] != order->tiers[other]) {
+        return order->tiers[index] < order->tiers[other];
+    }
+    double cost = _heuristic_order_cost(&order->stats[index]);
+    return cost < _heuristic_order_cost(&order->stats[other]);
+}
+
+static double _heuristic_order_cost(HeuristicOrderStats * stats) {
+    // time per lookup divided by cutoffs per lookup. A heuristic which
+    // has not been timed yet looks free, so it moves up and gets measured.
+    if (stats->sampledLookups == 0) return 0;
+    double lookupCost = stats->sampledSeconds / (double)stats->sampledLookups;
+    double pruneRate = (double)(stats->prunes + 1) / (double)(stats->lookups + 1);
+    return lookupCost / pruneRate;
+}
+
+static double _heuristic_order_seconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
@@ -0,0 +1,91 @@
+#ifndef __HEURISTIC_ORDER_H__
+#define __HEURISTIC_ORDER_H__
+
+#include <time.h>
+#include "heuristic_list.h"
+#include "heuristic_coords.h"
+#include "heuristic_stats.h"
+
+// checks between two reorders
+#define kHeuristicOrderInterval 0x4000
+
+// one lookup in this many is timed
+#define kHeuristicOrderSampleRate 16
+
+/***
+ *
+ * A heuristic order decides which heuristics of a list are checked first.
+ * It records how often each heuristic prunes and how long its lookups
+ * take, and every kHeuristicOrderInterval checks it sorts the heuristics
+ * by their expected cost per cutoff, cheapest first. Older statistics are
+ * halved on each reorder so that the order follows the search as it moves
+ * between depths.
+ *
+ * Groups of at most kHeuristicListSmallSize bytes form the first tier and
+ * are always checked before the larger ones, whatever their statistics;
+ * the large tables are only probed once the small ones failed to prune.
+ *
+ * A heuristic is skipped when the remaining depth exceeds its maxDepth,
+ * since it never returns more than maxDepth + 1 and cannot prune there.
+ * An additive group of heuristics (see heuristic_list.h) is ordered and
+ * skipped as a whole, by the sum of its values.
+ *
+ * An order keeps running statistics, so each search thread should have
+ * its own.
+ *
+ */
+
+typedef struct {
+    unsigned long long lookups;
+    unsigned long long prunes;
+    unsigned long long sampledLookups;
+    double sampledSeconds;
+} HeuristicOrderStats;
+
+typedef struct {
+    HeuristicList * list;
+    
+    // the first heuristic of each group in list->heuristics, dense
+    // heuristics excluded
+    int * order;
+    int count;
+    
+    // tiers[i] is 0 if the group starting at i is small, 1 otherwise
+    int * tiers;
+    
+    HeuristicOrderStats * stats;
+    unsigned long long checks;
+    
+    // optional; the heuristics which it tracks are looked up on its last
+    // updated node instead of the cuboid
+    HeuristicCoords * coords;
+    
+    // optional; every lookup and prune of a heuristic is counted here
+    HeuristicStats * counters;
+} HeuristicOrder;
+
+HeuristicOrder * heuristic_order_create(HeuristicList * list);
+void heuristic_order_free(HeuristicOrder * order);
+
+/**
+ * Checks if any heuristic puts `cuboid` more than `maxValue` moves away.
+ * If `valueOut` is non-NULL, it is set to the highest value found, and
+ * `exactOut` is set to 0 if some heuristic was not checked, either because
+ * an earlier one pruned or because it was skipped.
+ * @argument values NULL, or one value per heuristic of the list, followed
+ * by one per heuristic for the inverse if `inverse` is given. Values of 0
+ * or more are used as they are, without a lookup; the value of every
+ * heuristic which is looked up is written back. See heuristic_reuse.h.
+ * @argument inverse NULL, or the inverse of `cuboid`. Each heuristic outside
+ * of a group which does not prune the cuboid itself is also looked up on the
+ * inverse, and the higher value counts. This is only admissible when the moveset is
+ * closed under inverses and the goal is symmetric.
+ */
+int heuristic_order_exceeds(HeuristicOrder * order, const Cuboid * cuboid,
+                            const Cuboid * inverse, Cuboid * cache, int maxValue,
+                            int * values, int * valueOut, int * exactOut);
+
+// sorts the heuristics by their statistics; called automatically
+void heuristic_order_update(HeuristicOrder * order);
+
+#endif
@@ -0,0 +1,148 @@
+#include "heuristic_path.h"
+
+static void _heuristic_path_set_root(HeuristicPath * path, const Cuboid * root);
+static int _heuristic_path_walk(HeuristicPath * path, Heuristic * h, int slot);
+static int * _heuristic_path_row(HeuristicPath * path, int len);
+
+HeuristicPath * heuristic_path_create(HeuristicList * list, AlgList * operations) {
+    HeuristicPath * path = (HeuristicPath *)malloc(sizeof(HeuristicPath));
+    bzero(path, sizeof(HeuristicPath));
+    path->list = list;
+    path->operations = operations;
+    alg_list_retain(operations);
+    
+    int i, maxSlots = 0;
+    path->offsets = (int *)malloc(sizeof(int) * (list->count + 1));
+    for (i = 0; i < list->count; i++) {
+        Heuristic * h = list->heuristics[i];
+        path->offsets[i] = path->slotCount;
+        if (!heuristic_is_dense(h)) continue;
+        int slots = heuristic_dense_slot_count(h);
+        path->slotCount += slots;
+        if (slots > maxSlots) maxSlots = slots;
+    }
+    path->modBuffer = (uint8_t *)malloc(maxSlots + 1);
+    return path;
+}
+
+void heuristic_path_free(HeuristicPath * path) {
+    int i;
+    for (i = 0; i < path->valuesAlloc; i++) {
+        free(path->values[i]);
+    }
+    if (path->values) free(path->values);
+    if (path->scratch) cuboid_free(path->scratch);
+    alg_list_release(path->operations);
+    free(path->modBuffer);
+    free(path->offsets);
+    free(path);
+}
+
+int heuristic_path_exceeds(HeuristicPath * path, const Cuboid * root,
+                           const Cuboid * cuboid, int len, int maxValue) {
+    if (path->root != root) {
+        _heuristic_path_set_root(path, root);
+    }
+    if (len == 0) return 0;
+    
+    int * parent = _heuristic_path_row(path, len - 1);
+    int * row = _heuristic_path_row(path, len);
+    
+    int i, slot;
+    for (i = 0; i < path->list->count; i++) {
+        Heuristic * h = path->list->heuristics[i];
+        if (!heuristic_is_dense(h)) continue;
+        
+        int offset = path->offsets[i];
+        int maxDepth = h->params.maxDepth;
+        heuristic_dense_values(h, cuboid, path->scratch, path->modBuffer);
+        for (slot = 0; slot < heuristic_dense_slot_count(h); slot++) {
+            int value = dense_table_exact_depth(path->modBuffer[slot],
+                                                parent[offset + slot]);
+            if (value < 0) value = maxDepth + 1;
+            else if (value > maxDepth) value = maxDepth;
+            row[offset + slot] = value;
+        }
+        if (heuristic_dense_pruning_value(h, &row[offset]) > maxValue) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/***********
+ * Private *
+ ***********/
+
+static void _heuristic_path_set_root(HeuristicPath * path, const Cuboid * root) {
+    path->root = root;
+    if (!path->scratch) {
+        path->scratch = cuboid_create(root->dimensions);
+    }
+    
+    int * row = _heuristic_path_row(path, 0);
+    int i, slot;
+    for (i = 0; i < path->list->count; i++) {
+        Heuristic * h = path->list->heuristics[i];
+        if (!heuristic_is_dense(h)) continue;
+        for (slot = 0; slot < heuristic_dense_slot_count(h); slot++) {
+            row[path->offsets[i] + slot] = _heuristic_path_walk(path, h, slot);
+        }
+    }
+}
+
+static int _heuristic_path_walk(HeuristicPath * path, Heuristic * h, int slot) {
+    // follow neighbors which are one move closer to the goal until
+    // there are none; the number of moves made is the exact value.
+    Cuboid * current = cuboid_copy(path->root);
+    Cuboid * next = cuboid_create(path->root->dimensions);
+    
+    heuristic_dense_values(h, current, path->scratch, path->modBuffer);
+    int mod = path->modBuffer[slot], steps = 0, i;
+    if (mod == kDenseTableNotFound) {
+        cuboid_free(current);
+        cuboid_free(next);
+        return h->params.maxDepth + 1;
+    }
+    
+    while (steps < h->params.maxDepth) {
+        int closer = (mod + 2) % 3, found = 0;
+        for (i = 0; i < path->operations->entryCount; i++) {
+            Cuboid * op = path->operations->entries[i].cuboid;
+            cuboid_multiply(next, op, current);
+            heuristic_dense_values(h, next, path->scratch, path->modBuffer);
+            if (path->modBuffer[slot] == closer) {
+                found = 1;
+                break;
+            }
+        }
+        if (!found) break;
+        
+        Cuboid * temp = current;
+        current = next;
+        next = temp;
+        mod = closer;
+        steps++;
+    }
+    
+    cuboid_free(current);
+    cuboid_free(next);
+    return steps;
+}
+
+static int * _heuristic_path_row(HeuristicPath * path, int len) {
+    if (len >= path->valuesAlloc) {
+        int i, newAlloc = len + 1;
+        int newSize = sizeof(int *) * newAlloc;
+        if (path->values) {
+            path->values = (int **)realloc(path->values, newSize);
+        } else {
+            path->values = (int **)malloc(newSize);
+        }
+        for (i = path->valuesAlloc; i < newAlloc; i++) {
+            path->values[i] = (int *)malloc(sizeof(int) * (path->slotCount + 1));
+        }
+        path->valuesAlloc = newAlloc;
+    }
+    return path->values[len];
+}
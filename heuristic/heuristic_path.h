@@ -0,0 +1,46 @@
+#ifndef __HEURISTIC_PATH_H__
+#define __HEURISTIC_PATH_H__
+
+#include "heuristic_list.h"
+#include "notation/alg_list.h"
+
+/***
+ * A heuristic path tracks the exact values of dense heuristics along
+ * the path which a search thread is currently exploring.
+ *
+ * Dense heuristics store their values modulo 3. Since a single operation
+ * changes the distance of a node by at most one, the exact value of a
+ * node follows from the exact value of its parent. The value of the root
+ * is found by walking towards the goal with the search operations, so the
+ * operations must be the ones which the dense tables were indexed with.
+ */
+
+typedef struct {
+    HeuristicList * list;
+    AlgList * operations;
+    const Cuboid * root;
+    
+    // offsets[i] is the first slot of heuristic i in every row
+    int * offsets;
+    int slotCount;
+    
+    // values[len] holds the exact slot values for the node of length len
+    int ** values;
+    int valuesAlloc;
+    
+    uint8_t * modBuffer;
+    Cuboid * scratch;
+} HeuristicPath;
+
+HeuristicPath * heuristic_path_create(HeuristicList * list, AlgList * operations);
+void heuristic_path_free(HeuristicPath * path);
+
+/**
+ * Returns 1 if a dense heuristic exceeds `maxValue` for `cuboid`. The
+ * node's parent (of length len - 1) must have been checked by the last
+ * call to this function which used the same depth.
+ */
+int heuristic_path_exceeds(HeuristicPath * path, const Cuboid * root,
+                           const Cuboid * cuboid, int len, int maxValue);
+
+#endif
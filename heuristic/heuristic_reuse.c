@@ -0,0 +1,110 @@
+#include "heuristic_reuse.h"
+
+static int * _heuristic_reuse_row(HeuristicReuse * reuse, int len);
+static void _heuristic_reuse_inherit(HeuristicReuse * reuse, const uint8_t * affects,
+                                     const int * parent, int * row);
+
+HeuristicReuse * heuristic_reuse_create(HeuristicList * list, AlgList * operations,
+                                        int inverses) {
+    int i, op, count = list->count, reusable = 0;
+    int size = operations->entryCount * count + 1;
+    uint8_t * affects = (uint8_t *)malloc(size);
+    uint8_t * inverseAffects = (inverses ? (uint8_t *)malloc(size) : NULL);
+    for (op = 0; op < operations->entryCount; op++) {
+        Cuboid * cuboid = operations->entries[op].cuboid;
+        for (i = 0; i < count; i++) {
+            Heuristic * h = list->heuristics[i];
+            if (heuristic_is_dense(h)) {
+                affects[op * count + i] = 1;
+                if (inverseAffects) inverseAffects[op * count + i] = 1;
+                continue;
+            }
+            affects[op * count + i] = heuristic_operation_affects(h, cuboid);
+            if (!affects[op * count + i]) reusable = 1;
+            if (!inverseAffects) continue;
+            inverseAffects[op * count + i] = heuristic_operation_affects_inverse(h, cuboid);
+            if (!inverseAffects[op * count + i]) reusable = 1;
+        }
+    }
+    if (!reusable) {
+        free(affects);
+        if (inverseAffects) free(inverseAffects);
+        return NULL;
+    }
+    
+    HeuristicReuse * reuse = (HeuristicReuse *)malloc(sizeof(HeuristicReuse));
+    bzero(reuse, sizeof(HeuristicReuse));
+    reuse->list = list;
+    reuse->operations = operations;
+    reuse->affects = affects;
+    reuse->inverseAffects = inverseAffects;
+    alg_list_retain(operations);
+    
+    // nothing is known about the root
+    int * root = _heuristic_reuse_row(reuse, 0);
+    for (i = 0; i < count * 2; i++) root[i] = -1;
+    return reuse;
+}
+
+void heuristic_reuse_free(HeuristicReuse * reuse) {
+    int i;
+    for (i = 0; i < reuse->valuesAlloc; i++) {
+        free(reuse->values[i]);
+    }
+    if (reuse->values) free(reuse->values);
+    alg_list_release(reuse->operations);
+    free(reuse->affects);
+    if (reuse->inverseAffects) free(reuse->inverseAffects);
+    free(reuse);
+}
+
+int * heuristic_reuse_row(HeuristicReuse * reuse, const int * sequence, int len) {
+    int i, count = reuse->list->count;
+    int * row = _heuristic_reuse_row(reuse, len);
+    if (len == 0) return row;
+    
+    int * parent = _heuristic_reuse_row(reuse, len - 1);
+    int op = sequence[len - 1];
+    _heuristic_reuse_inherit(reuse, &reuse->affects[op * count], parent, row);
+    if (reuse->inverseAffects) {
+        _heuristic_reuse_inherit(reuse, &reuse->inverseAffects[op * count],
+                                 &parent[count], &row[count]);
+    } else {
+        for (i = 0; i < count; i++) row[count + i] = -1;
+    }
+    return row;
+}
+
+/***********
+ * Private *
+ ***********/
+
+static int * _heuristic_reuse_row(HeuristicReuse * reuse, int len) {
+    if (len >= reuse->valuesAlloc) {
+        int i, newAlloc = len + 1;
+        int newSize = sizeof(int *) * newAlloc;
+        if (reuse->values) {
+            reuse->values = (int **)realloc(reuse->values, newSize);
+        } else {
+            reuse->values = (int **)malloc(newSize);
+        }
+        for (i = reuse->valuesAlloc; i < newAlloc; i++) {
+            reuse->values[i] = (int *)malloc(sizeof(int) * (reuse->list->count * 2 + 1));
+        }
+        reuse->valuesAlloc = newAlloc;
+    }
+    return reuse->values[len];
+}
+
+static void _heuristic_reuse_inherit(HeuristicReuse * reuse, const uint8_t * affects,
+                                     const int * parent, int * row) {
+    int i;
+    for (i = 0; i < reuse->list->count; i++) {
+        if (affects[i] || parent[i] < 0) {
+            row[i] = -1;
+        } else {
+            row[i] = parent[i];
+            reuse->reused++;
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef __HEURISTIC_REUSE_H__
+#define __HEURISTIC_REUSE_H__
+
+#include "heuristic_list.h"
+#include "notation/alg_list.h"
+
+/***
+ * A heuristic reuse tracks the values of the sparse heuristics along the
+ * path which a search thread is currently exploring, so that a node can
+ * take its parent's value for every heuristic which the last operation
+ * cannot change (see heuristic_operation_affects()). For instance, a
+ * slice turn never changes a corners table.
+ *
+ * With inverses, the values of each node's inverse are tracked as well.
+ * An operation changes fewer of those (see
+ * heuristic_operation_affects_inverse()): a U turn moves D-layer edges
+ * around, but the inverse keeps its value for a table of them.
+ *
+ * Like a HeuristicPath, this relies on a node's parent being the last
+ * node of its length which was checked.
+ */
+
+typedef struct {
+    HeuristicList * list;
+    AlgList * operations;
+    
+    // affects[op * list->count + i] is set if op may change heuristic i,
+    // and inverseAffects likewise for the inverse; NULL without inverses
+    uint8_t * affects;
+    uint8_t * inverseAffects;
+    
+    // values[len] holds the values of the node of length len, or -1,
+    // followed by those of its inverse if inverses are tracked
+    int ** values;
+    int valuesAlloc;
+    
+    unsigned long long reused;
+} HeuristicReuse;
+
+/**
+ * Returns NULL if every operation may change every sparse heuristic,
+ * since there would be nothing to reuse. `inverses` is set if the
+ * heuristics are also looked up on the inverse of each node.
+ */
+HeuristicReuse * heuristic_reuse_create(HeuristicList * list, AlgList * operations,
+                                        int inverses);
+void heuristic_reuse_free(HeuristicReuse * reuse);
+
+/**
+ * Starts the row of values for the node `sequence` of length `len`. Values
+ * which are inherited from the parent are filled in and the rest are -1;
+ * the caller fills in whatever it looks up, e.g. with
+ * heuristic_order_exceeds(). With inverses, the values of the inverse
+ * start at row[list->count].
+ */
+int * heuristic_reuse_row(HeuristicReuse * reuse, const int * sequence, int len);
+
+#endif
@@ -0,0 +1,99 @@
+#include "heuristic_stats.h"
+
+static void _heuristic_stats_sum(HeuristicStats ** stats, int count, int index,
+                                 HeuristicStatsEntry * sum);
+
+HeuristicStats * heuristic_stats_create(HeuristicList * list) {
+    HeuristicStats * stats = (HeuristicStats *)malloc(sizeof(HeuristicStats));
+    stats->list = list;
+    int size = sizeof(HeuristicStatsEntry) * (list->count + 1);
+    stats->entries = (HeuristicStatsEntry *)malloc(size);
+    bzero(stats->entries, size);
+    return stats;
+}
+
+void heuristic_stats_free(HeuristicStats * stats) {
+    free(stats->entries);
+    free(stats);
+}
+
+int heuristic_stats_should_sample(HeuristicStats * stats, int index) {
+    return (stats->entries[index].lookups % kHeuristicStatsSampleRate == 0);
+}
+
+void heuristic_stats_add_lookup(HeuristicStats * stats, int index, int value,
+                                int sampled, double seconds) {
+    HeuristicStatsEntry * entry = &stats->entries[index];
+    Heuristic * heuristic = stats->list->heuristics[index];
+    entry->lookups++;
+    if (value > heuristic->params.maxDepth) entry->misses++;
+    if (value >= kHeuristicStatsValueCount) value = kHeuristicStatsValueCount - 1;
+    entry->histogram[value]++;
+    if (sampled) {
+        entry->sampledLookups++;
+        entry->sampledSeconds += seconds;
+    }
+}
+
+void heuristic_stats_add_prune(HeuristicStats * stats, int index) {
+    stats->entries[index].prunes++;
+}
+
+void heuristic_stats_print(HeuristicStats ** stats, int count, FILE * fp) {
+    if (count == 0) return;
+    HeuristicList * list = stats[0]->list;
+    HeuristicStatsEntry sum;
+    int i, value;
+    for (i = 0; i < list->count; i++) {
+        _heuristic_stats_sum(stats, count, i, &sum);
+        Heuristic * heuristic = list->heuristics[i];
+        unsigned long long hits = sum.lookups - sum.misses;
+        double hitRate = (sum.lookups ? (double)hits * 100.0 / (double)sum.lookups : 0.0);
+        double pruneRate = (sum.lookups ? (double)sum.prunes * 100.0 / (double)sum.lookups : 0.0);
+        double latency = 0;
+        if (sum.sampledLookups) {
+            latency = sum.sampledSeconds * 1e9 / (double)sum.sampledLookups;
+        }
+        double megabytes = (double)heuristic_resident_size(heuristic) / (double)(1 << 20);
+        fprintf(fp, "heuristic %s: %.1f MB, %llu lookups, %llu hits (%.1f%%), "
+                "%llu prunes (%.1f%%), %.0f ns per lookup\n",
+                list->fileNames[i], megabytes, sum.lookups, hits, hitRate,
+                sum.prunes, pruneRate, latency);
+        if (sum.lookups == 0) continue;
+        
+        fprintf(fp, "  values:");
+        for (value = 0; value < kHeuristicStatsValueCount; value++) {
+            if (!sum.histogram[value]) continue;
+            fprintf(fp, " %d%s=%llu", value,
+                    (value == kHeuristicStatsValueCount - 1 ? "+" : ""), sum.histogram[value]);
+        }
+        fprintf(fp, "\n");
+    }
+}
+
+double heuristic_stats_seconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/***********
+ * Private *
+ ***********/
+
+static void _heuristic_stats_sum(HeuristicStats ** stats, int count, int index,
+                                 HeuristicStatsEntry * sum) {
+    bzero(sum, sizeof(HeuristicStatsEntry));
+    int i, value;
+    for (i = 0; i < count; i++) {
+        HeuristicStatsEntry * entry = &stats[i]->entries[index];
+        sum->lookups += entry->lookups;
+        sum->misses += entry->misses;
+        sum->prunes += entry->prunes;
+        for (value = 0; value < kHeuristicStatsValueCount; value++) {
+            sum->histogram[value] += entry->histogram[value];
+        }
+        sum->sampledLookups += entry->sampledLookups;
+        sum->sampledSeconds += entry->sampledSeconds;
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef __HEURISTIC_STATS_H__
+#define __HEURISTIC_STATS_H__
+
+#include <stdio.h>
+#include <time.h>
+#include "heuristic_list.h"
+
+// values at or above this share the last bucket of the histogram
+#define kHeuristicStatsValueCount 24
+
+// one lookup in this many is timed
+#define kHeuristicStatsSampleRate 64
+
+/***
+ *
+ * Heuristic stats count what each heuristic of a list does during a
+ * search, so that tables which do not earn their memory can be found.
+ * A lookup either hits, or misses and returns maxDepth + 1. A prune is
+ * counted for every heuristic whose value (or whose group's sum) was
+ * above the remaining depth.
+ *
+ * Unlike the statistics of a HeuristicOrder, these are never decayed.
+ * They are not thread safe, so each search thread should have its own;
+ * heuristic_stats_print() adds up all of them.
+ *
+ */
+
+typedef struct {
+    unsigned long long lookups;
+    unsigned long long misses;
+    unsigned long long prunes;
+    unsigned long long histogram[kHeuristicStatsValueCount];
+    
+    unsigned long long sampledLookups;
+    double sampledSeconds;
+} HeuristicStatsEntry;
+
+typedef struct {
+    HeuristicList * list;
+    HeuristicStatsEntry * entries;
+} HeuristicStats;
+
+HeuristicStats * heuristic_stats_create(HeuristicList * list);
+void heuristic_stats_free(HeuristicStats * stats);
+
+// returns 1 if the next lookup of heuristic `index` should be timed
+int heuristic_stats_should_sample(HeuristicStats * stats, int index);
+
+// `seconds` is ignored unless the lookup was sampled
+void heuristic_stats_add_lookup(HeuristicStats * stats, int index, int value,
+                                int sampled, double seconds);
+void heuristic_stats_add_prune(HeuristicStats * stats, int index);
+
+/**
+ * Prints a line for every heuristic, with the counts of all `count` stats
+ * added up, followed by the value histogram of the heuristics which were
+ * looked up.
+ */
+void heuristic_stats_print(HeuristicStats ** stats, int count, FILE * fp);
+
+double heuristic_stats_seconds();
+
+#endif
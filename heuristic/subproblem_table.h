@@ -9,6 +9,9 @@
 #include "subproblems/cco/cco_index.h"
 #include "subproblems/dedgepair/dedgepair_index.h"
 #include "subproblems/centergroup/centergroup_index.h"
+#include "subproblems/dedgecost/dedgecost_index.h"
+#include "subproblems/centerorbit/centerorbit_index.h"
+#include "subproblems/wingorbit/wingorbit_index.h"
 
 const static HSubproblem HSubproblemTable[] = {
     {
@@ -23,6 +26,11 @@ const static HSubproblem HSubproblemTable[] = {
         corner_index_angles_are_equivalent,
         corner_index_get_data,
         corner_index_completed,
+        NULL,
+        corner_index_piece_types,
+        NULL,
+        NULL,
+        NULL,
         NULL
     },
     {
@@ -37,7 +45,12 @@ const static HSubproblem HSubproblemTable[] = {
         eo_index_angles_are_equivalent,
         eo_index_get_data,
         eo_index_completed,
-        eo_index_data_symmetries
+        eo_index_data_symmetries,
+        eo_index_piece_types,
+        NULL,
+        eo_index_get_all_angles,
+        eo_index_transition,
+        NULL
     },
     {
         "dedges", "a set of physical dedges",
@@ -51,7 +64,12 @@ const static HSubproblem HSubproblemTable[] = {
         dedge_index_angles_are_equivalent,
         dedge_index_get_data,
         dedge_index_completed,
-        NULL
+        NULL,
+        dedge_index_piece_types,
+        NULL,
+        NULL,
+        NULL,
+        dedge_index_tracks_piece
     },
     {
         "omnia", "an index for everything",
@@ -65,6 +83,11 @@ const static HSubproblem HSubproblemTable[] = {
         omnia_index_angles_are_equivalent,
         omnia_index_get_data,
         omnia_index_completed,
+        NULL,
+        omnia_index_piece_types,
+        NULL,
+        NULL,
+        NULL,
         NULL
     },
     {
@@ -79,6 +102,11 @@ const static HSubproblem HSubproblemTable[] = {
         center_index_angles_are_equivalent,
         center_index_get_data,
         center_index_completed,
+        NULL,
+        center_index_piece_types,
+        NULL,
+        NULL,
+        NULL,
         NULL
     },
     {
@@ -93,7 +121,12 @@ const static HSubproblem HSubproblemTable[] = {
         cco_index_angles_are_equivalent,
         cco_index_get_data,
         cco_index_completed,
-        cco_index_data_symmetries
+        cco_index_data_symmetries,
+        cco_index_piece_types,
+        NULL,
+        cco_index_get_all_angles,
+        cco_index_transition,
+        NULL
     },
     {
         "dedgepair", "compact information about edge pairing",
@@ -107,7 +140,12 @@ const static HSubproblem HSubproblemTable[] = {
         dedgepair_index_angles_are_equivalent,
         dedgepair_index_get_data,
         dedgepair_index_completed,
-        dedgepair_index_data_symmetries
+        dedgepair_index_data_symmetries,
+        dedgepair_index_piece_types,
+        NULL,
+        NULL,
+        NULL,
+        NULL
     },
     {
         "centergroup", "compact information about center grouping",
@@ -121,7 +159,69 @@ const static HSubproblem HSubproblemTable[] = {
         centergroup_index_angles_are_equivalent,
         centergroup_index_get_data,
         centergroup_index_completed,
-        centergroup_index_data_symmetries
+        centergroup_index_data_symmetries,
+        centergroup_index_piece_types,
+        NULL,
+        NULL,
+        NULL,
+        NULL
+    },
+    {
+        "dedgecost", "a set of physical dedges, counting only its own moves",
+        dedgecost_index_default_arguments,
+        dedgecost_index_initialize,
+        dedgecost_index_load,
+        dedgecost_index_save,
+        dedgecost_index_supports_dimensions,
+        dedgecost_index_data_size,
+        dedgecost_index_angle_count,
+        dedgecost_index_angles_are_equivalent,
+        dedgecost_index_get_data,
+        dedgecost_index_completed,
+        NULL,
+        dedgecost_index_piece_types,
+        dedgecost_index_operation_cost,
+        NULL,
+        NULL,
+        dedgecost_index_tracks_piece
+    },
+    {
+        "centerorbit", "ranks the centers of selected faces in one orbit",
+        centerorbit_index_default_arguments,
+        centerorbit_index_initialize,
+        centerorbit_index_load,
+        centerorbit_index_save,
+        centerorbit_index_supports_dimensions,
+        centerorbit_index_data_size,
+        centerorbit_index_angle_count,
+        centerorbit_index_angles_are_equivalent,
+        centerorbit_index_get_data,
+        centerorbit_index_completed,
+        NULL,
+        centerorbit_index_piece_types,
+        NULL,
+        NULL,
+        NULL,
+        NULL
+    },
+    {
+        "wingorbit", "ranks the pairing or the pieces of one edge orbit",
+        wingorbit_index_default_arguments,
+        wingorbit_index_initialize,
+        wingorbit_index_load,
+        wingorbit_index_save,
+        wingorbit_index_supports_dimensions,
+        wingorbit_index_data_size,
+        wingorbit_index_angle_count,
+        wingorbit_index_angles_are_equivalent,
+        wingorbit_index_get_data,
+        wingorbit_index_completed,
+        wingorbit_index_data_symmetries,
+        wingorbit_index_piece_types,
+        NULL,
+        NULL,
+        NULL,
+        NULL
     }
 };
 
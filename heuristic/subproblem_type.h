@@ -11,6 +11,25 @@ typedef struct {
     int maxDepth;
 } HSParameters;
 
+// the kinds of pieces which a subproblem may read; see piece_types below
+#define kHSPieceCorners 1
+#define kHSPieceEdges 2
+#define kHSPieceCenters 4
+
+/***
+ *
+ * A field is a group of one or two bits in the data of a subproblem. When
+ * an operation is applied to a cuboid, each field of the new data is a
+ * function of a single field of the old data; see transition below.
+ *
+ */
+typedef struct {
+    uint16_t position; // the bit offset of the field in the new data
+    uint16_t source; // the bit offset of the field in the old data
+    uint8_t width; // 1 or 2
+    uint8_t values[4]; // the new value for each old value
+} HSField;
+
 /***
  * 
  * This structure defines a set of methods which the heuristic indexer
@@ -60,6 +79,49 @@ typedef struct {
     void (*completed)(void * userData);
     
     RotationBasis (*data_symmetries)(void * userData);
+    
+    /*
+     * returns the kHSPiece flags for every kind of piece get_data reads.
+     * an operation which leaves all of those pieces alone cannot change the
+     * data. may be NULL, in which case every kind of piece is assumed.
+     */
+    int (*piece_types)(void * userData);
+    
+    /*
+     * returns the number of moves (0 or 1) which `operation` counts as in
+     * the index. a subproblem which only counts some of the moves can be
+     * summed with others whose counted moves are disjoint; see
+     * heuristic_list_add_additive(). may be NULL, in which case every
+     * move counts.
+     */
+    int (*operation_cost)(void * userData, const Cuboid * operation);
+    
+    /*
+     * writes the data for every angle at once, angle i at out[i * stride].
+     * this must match calling get_data once per angle, but may share work
+     * between the angles. may be NULL, in which case get_data is used.
+     */
+    void (*get_all_angles)(void * userData, const Cuboid * cb, uint8_t * out, int stride);
+    
+    /*
+     * describes how the data for `angle` changes when `operation` is
+     * applied to a cuboid, so that a search may carry the data along its
+     * path instead of recomputing it at every node. `fields` has room for
+     * one field per bit of data; bits which no field covers are 0.
+     * returns the number of fields, or -1 if the new data does not follow
+     * from the old data alone. may be NULL.
+     */
+    int (*transition)(void * userData, const Cuboid * operation, int angle,
+                      HSField * fields);
+    
+    /*
+     * returns 1 if get_data reads where piece `index` of the kHSPiece kind
+     * `type` is, for every angle. pieces are numbered by the slots they
+     * take up in a solved cuboid. a subproblem which implements this only
+     * reads where its tracked pieces are, never what is in a slot. may be
+     * NULL.
+     */
+    int (*tracks_piece)(void * userData, int type, int index);
 } HSubproblem;
 
 #endif
@@ -81,6 +81,52 @@ void cco_index_get_data(void * userData, const Cuboid * cb, uint8_t * out, int a
     out[1] = (coData >> 8) & 0xff;
 }
 
+void cco_index_get_all_angles(void * userData, const Cuboid * cb, uint8_t * out, int stride) {
+    CCOContext * context = (CCOContext *)userData;
+    uint16_t coData[3];
+    int angle;
+    co_context_get_all_data(context->coContext, cb, coData);
+    for (angle = 0; angle < 3; angle++) {
+        bzero(&out[angle * stride], cco_index_data_size(userData));
+        out[angle * stride] = coData[angle] & 0xff;
+        out[angle * stride + 1] = (coData[angle] >> 8) & 0xff;
+    }
+    ceo_context_get_all_data(context->ceoContext, cb, &out[2], stride);
+}
+
+int cco_index_transition(void * userData, const Cuboid * operation, int angle,
+                         HSField * fields) {
+    CCOContext * context = (CCOContext *)userData;
+    uint8_t coSources[8], coValues[24];
+    if (!co_context_transition(context->coContext, operation, angle, coSources, coValues)) {
+        return -1;
+    }
+    
+    // two bits per corner, followed by one bit per center from byte 2 on
+    int i, count = 0, centerCount = cuboid_count_centers(operation);
+    for (i = 0; i < 8; i++) {
+        HSField * field = &fields[count++];
+        field->position = i * 2;
+        field->source = coSources[i] * 2;
+        field->width = 2;
+        memcpy(field->values, &coValues[i * 3], 3);
+        field->values[3] = 0;
+    }
+    
+    uint16_t * ceoSources = (uint16_t *)malloc(sizeof(uint16_t) * (centerCount + 1));
+    ceo_context_transition(context->ceoContext, operation, angle, ceoSources);
+    for (i = 0; i < centerCount; i++) {
+        HSField * field = &fields[count++];
+        field->position = 16 + i;
+        field->source = 16 + ceoSources[i];
+        field->width = 1;
+        field->values[0] = 0;
+        field->values[1] = 1;
+    }
+    free(ceoSources);
+    return count;
+}
+
 void cco_index_completed(void * userData) {
     CCOContext * context = (CCOContext *)userData;
     co_context_free(context->coContext);
@@ -97,3 +143,7 @@ RotationBasis cco_index_data_symmetries(void * userData) {
     if (sym.zPower == 0) basis.zPower = 0;
     return basis;
 }
+
+int cco_index_piece_types(void * userData) {
+    return kHSPieceCorners | kHSPieceCenters;
+}
@@ -20,5 +20,9 @@ int cco_index_data_size(void * userData);
 int cco_index_angle_count(void * userData);
 int cco_index_angles_are_equivalent(void * userData, int a1, int a2);
 void cco_index_get_data(void * userData, const Cuboid * cb, uint8_t * out, int angle);
+void cco_index_get_all_angles(void * userData, const Cuboid * cb, uint8_t * out, int stride);
+int cco_index_transition(void * userData, const Cuboid * operation, int angle,
+                         HSField * fields);
 void cco_index_completed(void * userData);
 RotationBasis cco_index_data_symmetries(void * userData);
+int cco_index_piece_types(void * userData);
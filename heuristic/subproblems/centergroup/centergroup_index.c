@@ -94,3 +94,7 @@ RotationBasis centergroup_index_data_symmetries(void * userData) {
     CGIndexData * data = (CGIndexData *)userData;
     return data->symmetries;
 }
+
+int centergroup_index_piece_types(void * userData) {
+    return kHSPieceCenters;
+}
@@ -14,3 +14,4 @@ int centergroup_index_angles_are_equivalent(void * userData, int a1, int a2);
 void centergroup_index_get_data(void * userData, const Cuboid * cb, uint8_t * out, int angle);
 void centergroup_index_completed(void * userData);
 RotationBasis centergroup_index_data_symmetries(void * userData);
+int centergroup_index_piece_types(void * userData);
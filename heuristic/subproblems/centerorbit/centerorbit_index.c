@@ -0,0 +1,205 @@
+#include "centerorbit_index.h"
+
+typedef struct {
+    uint8_t centerFlags[6];
+    uint8_t oppCenters; // does not distinguish between 1 and 2, 3 and 4, etc.
+    uint16_t orbitCenter; // a center on face 1 which is in the orbit
+    CuboidDimensions dims;
+    
+    // the class of the centers of each face; classCount if untracked
+    uint8_t faceClasses[6];
+    int classCount;
+    int classSizes[6];
+    
+    uint16_t * slots;
+    int slotCount;
+    int dataSize;
+} CenterOrbitIndexData;
+
+static int _process_center_flags(uint8_t * flagsOut, const char * str);
+static int _centerorbit_index_setup(CenterOrbitIndexData * data);
+
+CLArgumentList * centerorbit_index_default_arguments() {
+    CLArgumentList * list = cl_argument_list_new();
+    cl_argument_list_add(list, cl_argument_new_string("centers", "111111"));
+    cl_argument_list_add(list, cl_argument_new_flag("oppcenters", 0));
+    cl_argument_list_add(list, cl_argument_new_integer("orbit", 0));
+    return list;
+}
+
+int centerorbit_index_initialize(HSParameters params, CLArgumentList * arguments, void ** userData) {
+    int centersIndex = cl_argument_list_find(arguments, "centers");
+    int oppIndex = cl_argument_list_find(arguments, "oppcenters");
+    int orbitIndex = cl_argument_list_find(arguments, "orbit");
+    if (centersIndex < 0 || oppIndex < 0 || orbitIndex < 0) return 0;
+    
+    CenterOrbitIndexData * data = (CenterOrbitIndexData *)malloc(sizeof(CenterOrbitIndexData));
+    bzero(data, sizeof(CenterOrbitIndexData));
+    data->dims = params.symmetries.dims;
+    CLArgument * arg = cl_argument_list_get(arguments, centersIndex);
+    if (!_process_center_flags(data->centerFlags, arg->contents.string.value)) {
+        free(data);
+        return 0;
+    }
+    arg = cl_argument_list_get(arguments, oppIndex);
+    data->oppCenters = arg->contents.flag.boolValue;
+    arg = cl_argument_list_get(arguments, orbitIndex);
+    if (arg->contents.integer.value < 0) {
+        free(data);
+        return 0;
+    }
+    data->orbitCenter = arg->contents.integer.value;
+    
+    if (!_centerorbit_index_setup(data)) {
+        free(data);
+        return 0;
+    }
+    *userData = data;
+    return 1;
+}
+
+int centerorbit_index_load(HSParameters params, FILE * fp, void ** userData) {
+    uint8_t saved, oppCenters;
+    uint16_t orbitCenter;
+    if (!load_uint8(&saved, fp)) return 0;
+    if (!load_uint8(&oppCenters, fp)) return 0;
+    if (!load_uint16(&orbitCenter, fp)) return 0;
+    
+    CenterOrbitIndexData * data = (CenterOrbitIndexData *)malloc(sizeof(CenterOrbitIndexData));
+    bzero(data, sizeof(CenterOrbitIndexData));
+    int i;
+    for (i = 0; i < 6; i++) {
+        data->centerFlags[i] = (saved >> i) & 1;
+    }
+    data->oppCenters = oppCenters;
+    data->orbitCenter = orbitCenter;
+    if (!load_cuboid_dimensions(&data->dims, fp)) {
+        free(data);
+        return 0;
+    }
+    if (!centerorbit_index_supports_dimensions(data, params.symmetries.dims)) {
+        free(data);
+        return 0;
+    }
+    if (!_centerorbit_index_setup(data)) {
+        free(data);
+        return 0;
+    }
+    *userData = data;
+    return 1;
+}
+
+void centerorbit_index_save(void * userData, FILE * fp) {
+    CenterOrbitIndexData * data = (CenterOrbitIndexData *)userData;
+    uint8_t flags = 0;
+    int i;
+    for (i = 0; i < 6; i++) {
+        if (data->centerFlags[i]) {
+            flags |= (1 << i);
+        }
+    }
+    save_uint8(flags, fp);
+    save_uint8(data->oppCenters, fp);
+    save_uint16(data->orbitCenter, fp);
+    save_cuboid_dimensions(data->dims, fp);
+}
+
+int centerorbit_index_supports_dimensions(void * userData, CuboidDimensions dims) {
+    CenterOrbitIndexData * data = (CenterOrbitIndexData *)userData;
+    return cuboid_dimensions_equal(dims, data->dims);
+}
+
+int centerorbit_index_data_size(void * userData) {
+    CenterOrbitIndexData * data = (CenterOrbitIndexData *)userData;
+    return data->dataSize;
+}
+
+int centerorbit_index_angle_count(void * userData) {
+    return 1;
+}
+
+int centerorbit_index_angles_are_equivalent(void * userData, int a1, int a2) {
+    puts("error: centerorbit_index_angles_are_equivalent() should never be called.");
+    abort();
+}
+
+void centerorbit_index_get_data(void * userData, const Cuboid * cb, uint8_t * out, int angle) {
+    CenterOrbitIndexData * data = (CenterOrbitIndexData *)userData;
+    uint8_t classes[data->slotCount];
+    int i;
+    for (i = 0; i < data->slotCount; i++) {
+        classes[i] = data->faceClasses[cb->centers[data->slots[i]].side - 1];
+    }
+    uint64_t rank = orbit_rank_classes(classes, data->slotCount, data->classSizes,
+                                       data->classCount);
+    orbit_save_rank(rank, out, data->dataSize);
+}
+
+void centerorbit_index_completed(void * userData) {
+    CenterOrbitIndexData * data = (CenterOrbitIndexData *)userData;
+    free(data->slots);
+    free(data);
+}
+
+int centerorbit_index_piece_types(void * userData) {
+    return kHSPieceCenters;
+}
+
+/***********
+ * Private *
+ ***********/
+
+static int _process_center_flags(uint8_t * flagsOut, const char * str) {
+    if (strlen(str) != 6) return 0;
+    int i;
+    for (i = 0; i < 6; i++) {
+        if (str[i] == '1') {
+            flagsOut[i] = 1;
+        } else if (str[i] == '0') {
+            flagsOut[i] = 0;
+        } else {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int _centerorbit_index_setup(CenterOrbitIndexData * data) {
+    Cuboid * solved = cuboid_create(data->dims);
+    if (data->orbitCenter >= cuboid_count_centers_for_face(solved, 1)) {
+        cuboid_free(solved);
+        return 0;
+    }
+    
+    // with oppcenters, opposite faces share a class
+    int face, i;
+    data->classCount = 0;
+    for (face = 0; face < 6; face++) {
+        if (!data->centerFlags[face]) {
+            data->faceClasses[face] = 0xff;
+        } else if (data->oppCenters && face % 2 == 1 && data->centerFlags[face - 1]) {
+            data->faceClasses[face] = data->faceClasses[face - 1];
+        } else {
+            data->faceClasses[face] = data->classCount++;
+        }
+    }
+    for (face = 0; face < 6; face++) {
+        if (data->faceClasses[face] == 0xff) {
+            data->faceClasses[face] = data->classCount;
+        }
+    }
+    
+    data->slots = (uint16_t *)malloc(sizeof(uint16_t) * cuboid_count_centers(solved));
+    int slot = cuboid_center_index(solved, 1, data->orbitCenter);
+    data->slotCount = orbit_center_slots(data->dims, slot, data->slots);
+    for (i = 0; i < data->slotCount; i++) {
+        int class = data->faceClasses[solved->centers[data->slots[i]].side - 1];
+        if (class < data->classCount) data->classSizes[class]++;
+    }
+    cuboid_free(solved);
+    
+    uint64_t rankCount = orbit_classes_rank_count(data->slotCount, data->classSizes,
+                                                  data->classCount);
+    data->dataSize = orbit_rank_bytes(rankCount);
+    return 1;
+}
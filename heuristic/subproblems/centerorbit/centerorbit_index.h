@@ -0,0 +1,17 @@
+#include "heuristic/subproblem_type.h"
+#include "arguments/arguments.h"
+#include "saving/save_cuboid.h"
+#include "saving/save_tools.h"
+#include "pieces/orbit.h"
+
+CLArgumentList * centerorbit_index_default_arguments();
+int centerorbit_index_initialize(HSParameters params, CLArgumentList * arguments, void ** userData);
+int centerorbit_index_load(HSParameters params, FILE * fp, void ** userData);
+void centerorbit_index_save(void * userData, FILE * fp);
+int centerorbit_index_supports_dimensions(void * userData, CuboidDimensions dims);
+int centerorbit_index_data_size(void * userData);
+int centerorbit_index_angle_count(void * userData);
+int centerorbit_index_angles_are_equivalent(void * userData, int a1, int a2);
+void centerorbit_index_get_data(void * userData, const Cuboid * cb, uint8_t * out, int angle);
+void centerorbit_index_completed(void * userData);
+int centerorbit_index_piece_types(void * userData);
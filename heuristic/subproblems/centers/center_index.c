@@ -188,3 +188,7 @@ static int _centers_can_be_one_byte(CenterIndexData * data) {
     int topCount = (dims.x - 2) * (dims.z - 2);
     return (frontCount < 32 && rightCount < 32 && topCount < 32);
 }
+
+int center_index_piece_types(void * userData) {
+    return kHSPieceCenters;
+}
@@ -13,3 +13,4 @@ int center_index_angle_count(void * userData);
 int center_index_angles_are_equivalent(void * userData, int a1, int a2);
 void center_index_get_data(void * userData, const Cuboid * cb, uint8_t * out, int angle);
 void center_index_completed(void * userData);
+int center_index_piece_types(void * userData);
@@ -84,3 +84,7 @@ void corner_index_get_data(void * userData, const Cuboid * cb, uint8_t * out, in
 void corner_index_completed(void * userData) {
     free(userData);
 }
+
+int corner_index_piece_types(void * userData) {
+    return kHSPieceCorners;
+}
@@ -11,3 +11,4 @@ int corner_index_angle_count(void * userData);
 int corner_index_angles_are_equivalent(void * userData, int a1, int a2);
 void corner_index_get_data(void * userData, const Cuboid * cb, uint8_t * out, int angle);
 void corner_index_completed(void * userData);
+int corner_index_piece_types(void * userData);
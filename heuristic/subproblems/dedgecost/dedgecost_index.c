@@ -0,0 +1,132 @@
+#include "dedgecost_index.h"
+
+typedef struct {
+    void * dedges;
+    char * owned;
+    AlgList * operations;
+} DedgeCostIndexData;
+
+static DedgeCostIndexData * _create_owned(const char * owned, CuboidDimensions dims);
+static void _free_owned(DedgeCostIndexData * data);
+
+CLArgumentList * dedgecost_index_default_arguments() {
+    CLArgumentList * list = dedge_index_default_arguments();
+    cl_argument_list_add(list, cl_argument_new_string("owned", ""));
+    return list;
+}
+
+int dedgecost_index_initialize(HSParameters params, CLArgumentList * arguments, void ** userData) {
+    int index = cl_argument_list_find(arguments, "owned");
+    if (index < 0) return 0;
+    CLArgument * arg = cl_argument_list_get(arguments, index);
+    
+    DedgeCostIndexData * data = _create_owned(arg->contents.string.value,
+                                              params.symmetries.dims);
+    if (!data) return 0;
+    if (!dedge_index_initialize(params, arguments, &data->dedges)) {
+        _free_owned(data);
+        return 0;
+    }
+    
+    *userData = data;
+    return 1;
+}
+
+int dedgecost_index_load(HSParameters params, FILE * fp, void ** userData) {
+    void * dedges;
+    if (!dedge_index_load(params, fp, &dedges)) return 0;
+    char * owned = load_string(fp);
+    if (!owned) {
+        dedge_index_completed(dedges);
+        return 0;
+    }
+    
+    DedgeCostIndexData * data = _create_owned(owned, params.symmetries.dims);
+    free(owned);
+    if (!data) {
+        dedge_index_completed(dedges);
+        return 0;
+    }
+    data->dedges = dedges;
+    *userData = data;
+    return 1;
+}
+
+void dedgecost_index_save(void * userData, FILE * fp) {
+    DedgeCostIndexData * data = (DedgeCostIndexData *)userData;
+    dedge_index_save(data->dedges, fp);
+    save_string(data->owned, fp);
+}
+
+int dedgecost_index_supports_dimensions(void * userData, CuboidDimensions dims) {
+    DedgeCostIndexData * data = (DedgeCostIndexData *)userData;
+    return dedge_index_supports_dimensions(data->dedges, dims);
+}
+
+int dedgecost_index_data_size(void * userData) {
+    DedgeCostIndexData * data = (DedgeCostIndexData *)userData;
+    return dedge_index_data_size(data->dedges);
+}
+
+int dedgecost_index_angle_count(void * userData) {
+    return 1;
+}
+
+int dedgecost_index_angles_are_equivalent(void * userData, int a1, int a2) {
+    puts("error: dedgecost_index_angles_are_equivalent() should never be called.");
+    abort();
+}
+
+void dedgecost_index_get_data(void * userData, const Cuboid * cb, uint8_t * out, int angle) {
+    DedgeCostIndexData * data = (DedgeCostIndexData *)userData;
+    dedge_index_get_data(data->dedges, cb, out, angle);
+}
+
+void dedgecost_index_completed(void * userData) {
+    DedgeCostIndexData * data = (DedgeCostIndexData *)userData;
+    if (data->dedges) dedge_index_completed(data->dedges);
+    _free_owned(data);
+}
+
+int dedgecost_index_piece_types(void * userData) {
+    return kHSPieceEdges;
+}
+
+int dedgecost_index_tracks_piece(void * userData, int type, int index) {
+    DedgeCostIndexData * data = (DedgeCostIndexData *)userData;
+    return dedge_index_tracks_piece(data->dedges, type, index);
+}
+
+int dedgecost_index_operation_cost(void * userData, const Cuboid * operation) {
+    DedgeCostIndexData * data = (DedgeCostIndexData *)userData;
+    int i;
+    for (i = 0; i < data->operations->entryCount; i++) {
+        Cuboid * owned = data->operations->entries[i].cuboid;
+        if (cuboid_light_comparison(owned, operation) == 0) return 1;
+    }
+    return 0;
+}
+
+/***********
+ * Private *
+ ***********/
+
+static DedgeCostIndexData * _create_owned(const char * owned, CuboidDimensions dims) {
+    // a table which owns nothing would always be zero
+    if (strlen(owned) == 0) return NULL;
+    AlgList * operations = alg_list_parse(owned, dims);
+    if (!operations) return NULL;
+    
+    DedgeCostIndexData * data = (DedgeCostIndexData *)malloc(sizeof(DedgeCostIndexData));
+    bzero(data, sizeof(DedgeCostIndexData));
+    data->owned = (char *)malloc(strlen(owned) + 1);
+    strcpy(data->owned, owned);
+    data->operations = operations;
+    return data;
+}
+
+static void _free_owned(DedgeCostIndexData * data) {
+    alg_list_release(data->operations);
+    free(data->owned);
+    free(data);
+}
@@ -0,0 +1,28 @@
+#include "heuristic/subproblem_type.h"
+#include "heuristic/subproblems/dedges/dedge_index.h"
+#include "notation/alg_list.h"
+
+/***
+ *
+ * The same index as `dedges`, except that only the "owned" operations
+ * count as moves. Any other operation is free, so the value of a state
+ * is the least number of owned moves needed to solve its dedges.
+ *
+ * Tables whose owned operations are disjoint never count the same move
+ * twice, so their values may be added together.
+ *
+ */
+
+CLArgumentList * dedgecost_index_default_arguments();
+int dedgecost_index_initialize(HSParameters params, CLArgumentList * arguments, void ** userData);
+int dedgecost_index_load(HSParameters params, FILE * fp, void ** userData);
+void dedgecost_index_save(void * userData, FILE * fp);
+int dedgecost_index_supports_dimensions(void * userData, CuboidDimensions dims);
+int dedgecost_index_data_size(void * userData);
+int dedgecost_index_angle_count(void * userData);
+int dedgecost_index_angles_are_equivalent(void * userData, int a1, int a2);
+void dedgecost_index_get_data(void * userData, const Cuboid * cb, uint8_t * out, int angle);
+void dedgecost_index_completed(void * userData);
+int dedgecost_index_piece_types(void * userData);
+int dedgecost_index_tracks_piece(void * userData, int type, int index);
+int dedgecost_index_operation_cost(void * userData, const Cuboid * operation);
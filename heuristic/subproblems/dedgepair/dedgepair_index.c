@@ -92,3 +92,7 @@ RotationBasis dedgepair_index_data_symmetries(void * userData) {
     DPIndexData * data = (DPIndexData *)userData;
     return data->symmetries;
 }
+
+int dedgepair_index_piece_types(void * userData) {
+    return kHSPieceEdges;
+}
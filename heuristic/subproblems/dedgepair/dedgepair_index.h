@@ -14,3 +14,4 @@ int dedgepair_index_angles_are_equivalent(void * userData, int a1, int a2);
 void dedgepair_index_get_data(void * userData, const Cuboid * cb, uint8_t * out, int angle);
 void dedgepair_index_completed(void * userData);
 RotationBasis dedgepair_index_data_symmetries(void * userData);
+int dedgepair_index_piece_types(void * userData);
@@ -2,6 +2,7 @@
 
 static int _process_dedge_flags(uint8_t * flagsOut, const char * str);
 static void _find_and_copy_dedge(const Cuboid * cb, uint8_t * out, int dedgeIndex);
+static void _count_edges_per_dedge(CuboidDimensions dims, int * countsOut);
 
 typedef struct {
     uint8_t dedgeFlags[12];
@@ -70,10 +71,8 @@ int dedge_index_supports_dimensions(void * userData, CuboidDimensions dims) {
 
 int dedge_index_data_size(void * userData) {
     DedgeIndexData * data = (DedgeIndexData *)userData;
-    int xCount = data->dims.x - 2, yCount = data->dims.y - 2,
-        zCount = data->dims.z - 2;
-    int countPerDedge[12] = {xCount, yCount, xCount, yCount, zCount, zCount,
-                             xCount, yCount, xCount, yCount, zCount, zCount};
+    int countPerDedge[12];
+    _count_edges_per_dedge(data->dims, countPerDedge);
     int i, edgeCount = 0;
     for (i = 0; i < 12; i++) {
         if (data->dedgeFlags[i]) {
@@ -150,3 +149,28 @@ static void _find_and_copy_dedge(const Cuboid * cb, uint8_t * out, int dedgeInde
     }
     assert(gottenCount == expected);
 }
+
+int dedge_index_piece_types(void * userData) {
+    return kHSPieceEdges;
+}
+
+int dedge_index_tracks_piece(void * userData, int type, int index) {
+    DedgeIndexData * data = (DedgeIndexData *)userData;
+    if (type != kHSPieceEdges) return 0;
+    
+    // the edges of a solved cuboid are in the order of their dedges
+    int countPerDedge[12], dedge;
+    _count_edges_per_dedge(data->dims, countPerDedge);
+    for (dedge = 0; dedge < 12; dedge++) {
+        if (index < countPerDedge[dedge]) return data->dedgeFlags[dedge];
+        index -= countPerDedge[dedge];
+    }
+    return 0;
+}
+
+static void _count_edges_per_dedge(CuboidDimensions dims, int * countsOut) {
+    int xCount = dims.x - 2, yCount = dims.y - 2, zCount = dims.z - 2;
+    int counts[12] = {xCount, yCount, xCount, yCount, zCount, zCount,
+                      xCount, yCount, xCount, yCount, zCount, zCount};
+    memcpy(countsOut, counts, sizeof(counts));
+}
@@ -13,3 +13,5 @@ int dedge_index_angle_count(void * userData);
 int dedge_index_angles_are_equivalent(void * userData, int a1, int a2);
 void dedge_index_get_data(void * userData, const Cuboid * cb, uint8_t * out, int angle);
 void dedge_index_completed(void * userData);
+int dedge_index_piece_types(void * userData);
+int dedge_index_tracks_piece(void * userData, int type, int index);
@@ -63,6 +63,34 @@ void eo_index_get_data(void * userData, const Cuboid * cb, uint8_t * out, int an
     eo_context_get_compact_data(context, cb, out, angle);
 }
 
+void eo_index_get_all_angles(void * userData, const Cuboid * cb, uint8_t * out, int stride) {
+    EOContext * context = (EOContext *)userData;
+    eo_context_get_all_compact_data(context, cb, out, stride);
+}
+
+int eo_index_transition(void * userData, const Cuboid * operation, int angle,
+                        HSField * fields) {
+    EOContext * context = (EOContext *)userData;
+    int i, edgeCount = cuboid_count_edges(operation);
+    uint16_t * sources = (uint16_t *)malloc(sizeof(uint16_t) * edgeCount);
+    uint8_t * values = (uint8_t *)malloc(edgeCount * 2);
+    if (!eo_context_transition(context, operation, angle, sources, values)) {
+        free(sources);
+        free(values);
+        return -1;
+    }
+    for (i = 0; i < edgeCount; i++) {
+        fields[i].position = i;
+        fields[i].source = sources[i];
+        fields[i].width = 1;
+        fields[i].values[0] = values[i * 2];
+        fields[i].values[1] = values[i * 2 + 1];
+    }
+    free(sources);
+    free(values);
+    return edgeCount;
+}
+
 void eo_index_completed(void * userData) {
     EOContext * context = (EOContext *)userData;
     eo_context_free(context);
@@ -77,3 +105,7 @@ RotationBasis eo_index_data_symmetries(void * userData) {
     return basis;
     
 }
+
+int eo_index_piece_types(void * userData) {
+    return kHSPieceEdges;
+}
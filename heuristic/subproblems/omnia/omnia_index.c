@@ -94,3 +94,7 @@ static void _omnia_copy_edges(uint8_t * data, const Cuboid * cb) {
         data[i] = e.dedgeIndex | (e.symmetry << 4);
     }
 }
+
+int omnia_index_piece_types(void * userData) {
+    return kHSPieceCorners | kHSPieceEdges | kHSPieceCenters;
+}
@@ -16,3 +16,4 @@ int omnia_index_angle_count(void * userData);
 int omnia_index_angles_are_equivalent(void * userData, int a1, int a2);
 void omnia_index_get_data(void * userData, const Cuboid * cb, uint8_t * out, int angle);
 void omnia_index_completed(void * userData);
+int omnia_index_piece_types(void * userData);
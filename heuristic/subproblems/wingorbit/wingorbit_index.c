@@ -0,0 +1,252 @@
+#include "wingorbit_index.h"
+
+typedef struct {
+    RotationBasis symmetries;
+    uint8_t dedgeFlags[12];
+    uint16_t orbitEdge; // an edge of dedge 0 which is in the orbit
+    uint8_t permutation; // index where the pieces are rather than the pairing
+    
+    uint16_t * slots;
+    int slotCount;
+    int groupSize;
+    
+    // pieceNumbers[s] is the number of the piece which is solved in slot s,
+    // or 0xff if it is not tracked
+    uint8_t * pieceNumbers;
+    int pieceCount;
+    int dataSize;
+} WingOrbitIndexData;
+
+static int _process_dedge_flags(uint8_t * flagsOut, const char * str);
+static int _wingorbit_index_setup(WingOrbitIndexData * data);
+static void _wingorbit_index_release(WingOrbitIndexData * data);
+
+CLArgumentList * wingorbit_index_default_arguments() {
+    CLArgumentList * list = cl_argument_list_new();
+    cl_argument_list_add(list, cl_argument_new_string("dedges", "111111111111"));
+    cl_argument_list_add(list, cl_argument_new_integer("orbit", 0));
+    cl_argument_list_add(list, cl_argument_new_flag("permutation", 0));
+    return list;
+}
+
+int wingorbit_index_initialize(HSParameters params, CLArgumentList * arguments, void ** userData) {
+    int dedgesIndex = cl_argument_list_find(arguments, "dedges");
+    int orbitIndex = cl_argument_list_find(arguments, "orbit");
+    int permutationIndex = cl_argument_list_find(arguments, "permutation");
+    if (dedgesIndex < 0 || orbitIndex < 0 || permutationIndex < 0) return 0;
+    
+    WingOrbitIndexData * data = (WingOrbitIndexData *)malloc(sizeof(WingOrbitIndexData));
+    bzero(data, sizeof(WingOrbitIndexData));
+    data->symmetries = params.symmetries;
+    CLArgument * arg = cl_argument_list_get(arguments, dedgesIndex);
+    if (!_process_dedge_flags(data->dedgeFlags, arg->contents.string.value)) {
+        free(data);
+        return 0;
+    }
+    arg = cl_argument_list_get(arguments, orbitIndex);
+    if (arg->contents.integer.value < 0) {
+        free(data);
+        return 0;
+    }
+    data->orbitEdge = arg->contents.integer.value;
+    arg = cl_argument_list_get(arguments, permutationIndex);
+    data->permutation = arg->contents.flag.boolValue;
+    
+    if (!_wingorbit_index_setup(data)) {
+        free(data);
+        return 0;
+    }
+    *userData = data;
+    return 1;
+}
+
+int wingorbit_index_load(HSParameters params, FILE * fp, void ** userData) {
+    uint16_t saved, orbitEdge;
+    uint8_t permutation;
+    if (!load_uint16(&saved, fp)) return 0;
+    if (!load_uint16(&orbitEdge, fp)) return 0;
+    if (!load_uint8(&permutation, fp)) return 0;
+    
+    WingOrbitIndexData * data = (WingOrbitIndexData *)malloc(sizeof(WingOrbitIndexData));
+    bzero(data, sizeof(WingOrbitIndexData));
+    data->symmetries = params.symmetries;
+    int i;
+    for (i = 0; i < 12; i++) {
+        data->dedgeFlags[i] = (saved >> i) & 1;
+    }
+    data->orbitEdge = orbitEdge;
+    data->permutation = permutation;
+    
+    CuboidDimensions dims;
+    if (!load_cuboid_dimensions(&dims, fp)) {
+        free(data);
+        return 0;
+    }
+    if (!cuboid_dimensions_equal(dims, params.symmetries.dims)) {
+        free(data);
+        return 0;
+    }
+    if (!_wingorbit_index_setup(data)) {
+        free(data);
+        return 0;
+    }
+    *userData = data;
+    return 1;
+}
+
+void wingorbit_index_save(void * userData, FILE * fp) {
+    WingOrbitIndexData * data = (WingOrbitIndexData *)userData;
+    uint16_t flags = 0;
+    int i;
+    for (i = 0; i < 12; i++) {
+        if (data->dedgeFlags[i]) {
+            flags |= (1 << i);
+        }
+    }
+    save_uint16(flags, fp);
+    save_uint16(data->orbitEdge, fp);
+    save_uint8(data->permutation, fp);
+    save_cuboid_dimensions(data->symmetries.dims, fp);
+}
+
+int wingorbit_index_supports_dimensions(void * userData, CuboidDimensions dims) {
+    WingOrbitIndexData * data = (WingOrbitIndexData *)userData;
+    return cuboid_dimensions_equal(dims, data->symmetries.dims);
+}
+
+int wingorbit_index_data_size(void * userData) {
+    WingOrbitIndexData * data = (WingOrbitIndexData *)userData;
+    return data->dataSize;
+}
+
+int wingorbit_index_angle_count(void * userData) {
+    return 1;
+}
+
+int wingorbit_index_angles_are_equivalent(void * userData, int a1, int a2) {
+    puts("error: wingorbit_index_angles_are_equivalent() should never be called.");
+    abort();
+}
+
+void wingorbit_index_get_data(void * userData, const Cuboid * cb, uint8_t * out, int angle) {
+    WingOrbitIndexData * data = (WingOrbitIndexData *)userData;
+    uint64_t rank;
+    int i;
+    if (data->permutation) {
+        uint8_t positions[data->pieceCount];
+        for (i = 0; i < data->slotCount; i++) {
+            CuboidEdge edge = cb->edges[data->slots[i]];
+            int home = cuboid_edge_index(cb, edge.dedgeIndex, edge.edgeIndex);
+            int number = data->pieceNumbers[home];
+            if (number != 0xff) positions[number] = i;
+        }
+        rank = orbit_rank_positions(positions, data->pieceCount, data->slotCount);
+    } else {
+        uint8_t labels[data->slotCount];
+        for (i = 0; i < data->slotCount; i++) {
+            labels[i] = cb->edges[data->slots[i]].dedgeIndex;
+        }
+        rank = orbit_rank_groups(labels, data->slotCount, data->groupSize);
+    }
+    orbit_save_rank(rank, out, data->dataSize);
+}
+
+void wingorbit_index_completed(void * userData) {
+    WingOrbitIndexData * data = (WingOrbitIndexData *)userData;
+    _wingorbit_index_release(data);
+    free(data);
+}
+
+RotationBasis wingorbit_index_data_symmetries(void * userData) {
+    WingOrbitIndexData * data = (WingOrbitIndexData *)userData;
+    if (data->permutation) {
+        RotationBasis zeroBasis = {data->symmetries.dims, 0, 0, 0};
+        return zeroBasis;
+    }
+    // paired states are the same up to any rotation, like with dedgepair
+    return data->symmetries;
+}
+
+int wingorbit_index_piece_types(void * userData) {
+    return kHSPieceEdges;
+}
+
+/***********
+ * Private *
+ ***********/
+
+static int _process_dedge_flags(uint8_t * flagsOut, const char * str) {
+    if (strlen(str) != 12) return 0;
+    int i;
+    for (i = 0; i < 12; i++) {
+        if (str[i] == '1') {
+            flagsOut[i] = 1;
+        } else if (str[i] == '0') {
+            flagsOut[i] = 0;
+        } else {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int _wingorbit_index_setup(WingOrbitIndexData * data) {
+    Cuboid * solved = cuboid_create(data->symmetries.dims);
+    if (data->orbitEdge >= cuboid_count_edges_for_dedge(solved, 0)) {
+        cuboid_free(solved);
+        return 0;
+    }
+    int edgeCount = cuboid_count_edges(solved);
+    data->slots = (uint16_t *)malloc(sizeof(uint16_t) * edgeCount);
+    data->pieceNumbers = (uint8_t *)malloc(edgeCount);
+    memset(data->pieceNumbers, 0xff, edgeCount);
+    int slot = cuboid_edge_index(solved, 0, data->orbitEdge);
+    data->slotCount = orbit_edge_slots(data->symmetries.dims, slot, data->slots);
+    
+    int i, dedgeCounts[12];
+    int firstDedge = solved->edges[data->slots[0]].dedgeIndex;
+    bzero(dedgeCounts, sizeof(dedgeCounts));
+    for (i = 0; i < data->slotCount; i++) {
+        CuboidEdge edge = solved->edges[data->slots[i]];
+        dedgeCounts[edge.dedgeIndex]++;
+        if (data->dedgeFlags[edge.dedgeIndex]) {
+            data->pieceNumbers[data->slots[i]] = data->pieceCount++;
+        }
+    }
+    cuboid_free(solved);
+    
+    uint64_t rankCount = 1;
+    if (data->permutation) {
+        // the rank must fit in 64 bits
+        for (i = 0; i < data->pieceCount; i++) {
+            if (rankCount > UINT64_MAX / (data->slotCount - i)) {
+                _wingorbit_index_release(data);
+                return 0;
+            }
+            rankCount *= data->slotCount - i;
+        }
+    } else {
+        // pairing only has a single goal if every dedge of the orbit is
+        // tracked, and only means something if they have equal wing counts
+        data->groupSize = dedgeCounts[firstDedge];
+        for (i = 0; i < 12; i++) {
+            if (!dedgeCounts[i]) continue;
+            if (!data->dedgeFlags[i] || dedgeCounts[i] != data->groupSize) {
+                _wingorbit_index_release(data);
+                return 0;
+            }
+        }
+        if (data->groupSize < 2) {
+            _wingorbit_index_release(data);
+            return 0;
+        }
+        rankCount = orbit_groups_rank_count(data->slotCount, data->groupSize);
+    }
+    data->dataSize = orbit_rank_bytes(rankCount);
+    return 1;
+}
+
+static void _wingorbit_index_release(WingOrbitIndexData * data) {
+    free(data->slots);
+    free(data->pieceNumbers);
+}
@@ -0,0 +1,18 @@
+#include "heuristic/subproblem_type.h"
+#include "arguments/arguments.h"
+#include "saving/save_cuboid.h"
+#include "saving/save_tools.h"
+#include "pieces/orbit.h"
+
+CLArgumentList * wingorbit_index_default_arguments();
+int wingorbit_index_initialize(HSParameters params, CLArgumentList * arguments, void ** userData);
+int wingorbit_index_load(HSParameters params, FILE * fp, void ** userData);
+void wingorbit_index_save(void * userData, FILE * fp);
+int wingorbit_index_supports_dimensions(void * userData, CuboidDimensions dims);
+int wingorbit_index_data_size(void * userData);
+int wingorbit_index_angle_count(void * userData);
+int wingorbit_index_angles_are_equivalent(void * userData, int a1, int a2);
+void wingorbit_index_get_data(void * userData, const Cuboid * cb, uint8_t * out, int angle);
+void wingorbit_index_completed(void * userData);
+RotationBasis wingorbit_index_data_symmetries(void * userData);
+int wingorbit_index_piece_types(void * userData);
@@ -0,0 +1,175 @@
+#include "cost_search.h"
+
+typedef struct {
+    HeuristicIndex * index;
+    AlgList * operations;
+    const int * costs;
+    Cuboid ** inverses;
+    Cuboid * cache;
+    int coset;
+    long long added;
+    
+    // the entries of the coset which have yet to be merged into it
+    HashDataList * pending;
+    
+    // the operations and costs of the current path
+    int * sequence;
+    int * pathCosts;
+    int pathAlloc;
+} CostSearch;
+
+static void _cost_search_pass(CostSearch * search, int bound);
+static int _cost_search_visit(CostSearch * search, const Cuboid * node, int cost, int bound);
+static void _cost_search_merge(CostSearch * search);
+static int _operation_index(AlgList * operations, const Cuboid * cuboid);
+
+long long cost_search_run(HeuristicIndex * index, AlgList * operations,
+                          const int * costs, int maxCost) {
+    CostSearch search;
+    bzero(&search, sizeof(search));
+    search.index = index;
+    search.operations = operations;
+    search.costs = costs;
+    search.cache = cuboid_create(operations->entries[0].cuboid->dimensions);
+    search.pathAlloc = 16;
+    search.sequence = (int *)malloc(sizeof(int) * search.pathAlloc);
+    search.pathCosts = (int *)malloc(sizeof(int) * search.pathAlloc);
+    search.pending = hash_data_list_create(heuristic_data_size(index->heuristic),
+                                           kHeuristicIndexHeaderLen);
+    
+    int i, opCount = operations->entryCount;
+    search.inverses = (Cuboid **)malloc(sizeof(Cuboid *) * opCount);
+    for (i = 0; i < opCount; i++) {
+        search.inverses[i] = cuboid_inverse(operations->entries[i].cuboid);
+    }
+    
+    // the cosets are searched one at a time; pruning by all of them at
+    // once would expand nearly every node that chains of free moves reach
+    int bound, cosetCount = index->heuristic->cosetCount;
+    for (search.coset = 0; search.coset < cosetCount; search.coset++) {
+        if (cosetCount > 1) {
+            printf("Indexing coset %d of %d.\n", search.coset + 1, cosetCount);
+        }
+        for (bound = 0; bound <= maxCost; bound++) {
+            printf("Exploring cost of %d.\n", bound);
+            _cost_search_pass(&search, bound);
+            _cost_search_merge(&search);
+            printf("Found %lld.\n", search.added);
+        }
+    }
+    
+    for (i = 0; i < opCount; i++) {
+        cuboid_free(search.inverses[i]);
+    }
+    free(search.inverses);
+    free(search.sequence);
+    free(search.pathCosts);
+    hash_data_list_free(search.pending);
+    cuboid_free(search.cache);
+    return search.added;
+}
+
+int cost_search_costs_are_symmetric(RotationBasis symmetries, AlgList * operations,
+                                    const int * costs) {
+    RotationGroup * group = rotation_group_create_basis(symmetries);
+    Cuboid * temp = cuboid_create(symmetries.dims);
+    Cuboid * conjugate = cuboid_create(symmetries.dims);
+    int i, j, symmetric = 1;
+    for (i = 0; i < rotation_group_count(group) && symmetric; i++) {
+        Cuboid * rotation = rotation_group_get(group, i);
+        Cuboid * inverse = cuboid_inverse(rotation);
+        for (j = 0; j < operations->entryCount && symmetric; j++) {
+            cuboid_multiply(temp, rotation, operations->entries[j].cuboid);
+            cuboid_multiply(conjugate, temp, inverse);
+            int index = _operation_index(operations, conjugate);
+            if (index < 0 || costs[index] != costs[j]) symmetric = 0;
+        }
+        cuboid_free(inverse);
+    }
+    cuboid_free(temp);
+    cuboid_free(conjugate);
+    rotation_group_release(group);
+    return symmetric;
+}
+
+/***********
+ * Private *
+ ***********/
+
+static void _cost_search_pass(CostSearch * search, int bound) {
+    CuboidDimensions dims = search->cache->dimensions;
+    Cuboid * node = cuboid_create(dims);
+    Cuboid * temp = cuboid_create(dims);
+    int opCount = search->operations->entryCount;
+    
+    // the path is walked with a single cuboid; going back up undoes a move
+    _cost_search_visit(search, node, 0, bound);
+    int len = 0;
+    search->sequence[0] = -1;
+    search->pathCosts[0] = 0;
+    while (len >= 0) {
+        int op = ++search->sequence[len];
+        if (op == opCount) {
+            if (len > 0) {
+                int last = search->sequence[len - 1];
+                cuboid_multiply(temp, search->inverses[last], node);
+                cuboid_copy_to(node, temp);
+            }
+            len--;
+            continue;
+        }
+        
+        int cost = search->pathCosts[len] + search->costs[op];
+        if (cost > bound) continue;
+        cuboid_multiply(temp, search->operations->entries[op].cuboid, node);
+        if (!_cost_search_visit(search, temp, cost, bound)) continue;
+        cuboid_copy_to(node, temp);
+        
+        len++;
+        if (len == search->pathAlloc) {
+            search->pathAlloc *= 2;
+            int size = sizeof(int) * search->pathAlloc;
+            search->sequence = (int *)realloc(search->sequence, size);
+            search->pathCosts = (int *)realloc(search->pathCosts, size);
+        }
+        search->sequence[len] = -1;
+        search->pathCosts[len] = cost;
+    }
+    
+    cuboid_free(node);
+    cuboid_free(temp);
+}
+
+static int _cost_search_visit(CostSearch * search, const Cuboid * node, int cost, int bound) {
+    HeuristicIndex * index = search->index;
+    int coset = search->coset;
+    if (!heuristic_index_accepts_pending(index, coset, cost, bound, node, search->cache,
+                                         search->pending)) {
+        return 0;
+    }
+    
+    // pending right away, so that the node is pruned when it comes up again
+    heuristic_index_add_pending(index, coset, node, search->cache, cost, bound,
+                                search->pending);
+    if (search->pending->count >= kHeuristicIndexBatchLimit) {
+        _cost_search_merge(search);
+    }
+    return 1;
+}
+
+static void _cost_search_merge(CostSearch * search) {
+    if (search->pending->count == 0) return;
+    HeuristicIndex * index = search->index;
+    search->added += heuristic_index_merge_pending(index, 0, search->coset, search->pending);
+    hash_data_list_free(search->pending);
+    search->pending = hash_data_list_create(heuristic_data_size(index->heuristic),
+                                            kHeuristicIndexHeaderLen);
+}
+
+static int _operation_index(AlgList * operations, const Cuboid * cuboid) {
+    int i;
+    for (i = 0; i < operations->entryCount; i++) {
+        if (cuboid_light_comparison(operations->entries[i].cuboid, cuboid) == 0) return i;
+    }
+    return -1;
+}
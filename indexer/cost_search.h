@@ -0,0 +1,28 @@
+#include "heuristic_index.h"
+
+/***
+ *
+ * Builds an index for a subproblem which does not count every operation
+ * as a move (see operation_cost in subproblem_type.h).
+ *
+ * The regular indexer searches by the length of a sequence, which cannot
+ * bound a search with free moves. Instead, this search deepens the cost
+ * of a sequence, and every node that it reaches at a cost is added to the
+ * index right away. A node which the index already has at a lower cost,
+ * or at the same cost during the same pass, is not expanded again, which
+ * keeps chains of free moves finite. Each coset of the index is searched
+ * on its own, since a node is only redundant to the coset whose data it
+ * repeats.
+ *
+ * The search runs on one thread.
+ *
+ */
+
+// returns the number of entries added to the index.
+long long cost_search_run(HeuristicIndex * index, AlgList * operations,
+                          const int * costs, int maxCost);
+
+// returns 1 if the rotations of the moveset's symmetries map every
+// operation to one with the same cost.
+int cost_search_costs_are_symmetric(RotationBasis symmetries, AlgList * operations,
+                                    const int * costs);
@@ -3,43 +3,42 @@
 #define kNodeDepth 3
 
 static HSParameters _process_heuristic_parameters(IndexerArguments args);
-static int _data_list_append(DataList * dl, const uint8_t * data, const uint8_t * header);
+static int _heuristic_index_header_rejects(const uint8_t * header, int depth, int mark);
+static HeuristicIndex * _heuristic_index_setup(Heuristic * heuristic, IndexerArguments indexArgs,
+                                               DataList ** previous, int previousCount);
+static void _heuristic_index_copy(DataList * list, DataList * previous);
+static void _heuristic_index_copy_entry(void * context, const uint8_t * body,
+                                        const uint8_t * header);
 
 HeuristicIndex * heuristic_index_create(CLArgumentList * args, IndexerArguments indexArgs,
                                         const char * name) {
     HSParameters params = _process_heuristic_parameters(indexArgs);
     Heuristic * heuristic = heuristic_create(params, args, name);
     if (!heuristic) return 0;
-    
-    int dataSize = heuristic_data_size(heuristic);
-    int shardDepth = indexArgs.shardDepth;
-    int nodeDepth = dataSize < shardDepth ? dataSize : shardDepth;
-    
-    // generate cosets
-    RotationBasis basis = rotation_basis_standard(heuristic->params.symmetries.dims);
-    RotationGroup * subgroup = rotation_group_create_basis(heuristic->params.symmetries);
-    RotationGroup * group = rotation_group_create_basis(basis);
-    RotationCosets * cosets = rotation_cosets_create(group, subgroup);
-    
-    int cosetCount = rotation_cosets_count(cosets);
-    Cuboid ** inverseTriggers = (Cuboid **)malloc(sizeof(void *) * cosetCount);
-    
+    return _heuristic_index_setup(heuristic, indexArgs, NULL, 0);
+}
+
+HeuristicIndex * heuristic_index_extend(Heuristic * heuristic, IndexerArguments indexArgs) {
+    if (heuristic_is_dense(heuristic)) return NULL;
     int i;
-    for (i = 0; i < cosetCount; i++) {
-        DataList * dl = data_list_create(dataSize, 2, nodeDepth);
-        heuristic_add_coset(heuristic, dl);
-        Cuboid * cuboid = rotation_cosets_get_trigger(cosets, i);
-        Cuboid * inv = cuboid_inverse(cuboid);
-        inverseTriggers[i] = inv;
+    for (i = 0; i < heuristic->cosetCount; i++) {
+        if (heuristic->cosets[i]->hash) return NULL;
     }
     
-    rotation_group_release(group);
-    rotation_cosets_release(cosets);
-    rotation_group_release(subgroup);
-    
-    HeuristicIndex * index = (HeuristicIndex *)malloc(sizeof(HeuristicIndex));
-    index->heuristic = heuristic;
-    index->invTriggers = inverseTriggers;
+    // the old cosets are replaced by ones which are set up like those of
+    // a new index, and emptied into them one at a time
+    DataList ** previous = heuristic->cosets;
+    int previousCount = heuristic->cosetCount;
+    heuristic->cosets = NULL;
+    heuristic->cosetCount = 0;
+    HeuristicIndex * index = _heuristic_index_setup(heuristic, indexArgs, previous, previousCount);
+    if (!index) {
+        heuristic->cosets = previous;
+        heuristic->cosetCount = previousCount;
+        return NULL;
+    }
+    heuristic->params.maxDepth = indexArgs.maxDepth;
+    free(previous);
     return index;
 }
 
@@ -49,15 +48,37 @@ void heuristic_index_free(HeuristicIndex * index) {
         cuboid_free(index->invTriggers[i]);
     }
     free(index->invTriggers);
+    for (i = 0; i < index->threadCount * cosetCount; i++) {
+        data_list_batch_free(index->batches[i]);
+    }
+    free(index->batches);
     heuristic_free(index->heuristic);
     free(index);
 }
 
-int heuristic_index_accepts_node(HeuristicIndex * index, int depth, int idaDepth,
+int heuristic_index_accepts_node(HeuristicIndex * index, int depth, int mark,
                                  const Cuboid * cb, Cuboid * cache) {
+    // each coset sees different pieces, so a node which is old news to
+    // one coset may still be new to another.
+    int i, accepts = 0;
+    for (i = 0; i < index->heuristic->cosetCount; i++) {
+        if (heuristic_index_accepts_coset(index, i, depth, mark, cb, cache)) {
+            accepts = 1;
+        }
+    }
+    return accepts;
+}
+
+int heuristic_index_accepts_coset(HeuristicIndex * index, int coset, int depth,
+                                  int mark, const Cuboid * cb, Cuboid * cache) {
+    return heuristic_index_accepts_pending(index, coset, depth, mark, cb, cache, NULL);
+}
+
+int heuristic_index_accepts_pending(HeuristicIndex * index, int coset, int depth, int mark,
+                                    const Cuboid * cb, Cuboid * cache, HashDataList * pending) {
     // we must check all the angles to see if we have
     // found a shorter path to a Cuboid than previously.
-    cuboid_multiply(cache, cb, index->invTriggers[0]);
+    cuboid_multiply(cache, cb, index->invTriggers[coset]);
     uint8_t * indexData = (uint8_t *)malloc(heuristic_data_size(index->heuristic));
     Cuboid * temp = cuboid_copy(cb);
     int i, numAngles = index->heuristic->angles->numDistinct;
@@ -65,30 +86,23 @@ int heuristic_index_accepts_node(HeuristicIndex * index, int depth, int idaDepth
     for (i = 0; i < numAngles; i++) {
         int angle = index->heuristic->angles->distinct[i];
         heuristic_get_data(index->heuristic, cache, temp, angle, indexData);
-        DataList * dataList = index->heuristic->cosets[0];
-        DataListNode * base = data_list_find_base(dataList, indexData, 0);
-        if (!base) {
-            accepts = 1;
+        DataList * dataList = index->heuristic->cosets[coset];
+        uint8_t * header, * pendingHeader;
+        int found = data_list_find(dataList, indexData, &header);
+        if (found && _heuristic_index_header_rejects(header, depth, mark)) {
             continue;
         }
-        
-        uint8_t * header;
-        int found = data_list_base_find(base, indexData, &header);
-        if (!found) {
-            accepts = 1;
-            continue;
-        }
-    
-        int value = header[0];
-        if (value < depth) {
-            continue;
-        }
-        if (value == depth && idaDepth == header[1]) {
-            continue;
+        int pendingFound = 0;
+        if (pending) {
+            pendingFound = hash_data_list_find(pending, indexData, &pendingHeader);
+            if (pendingFound && _heuristic_index_header_rejects(pendingHeader, depth, mark)) {
+                continue;
+            }
         }
         
         // if we found it at a new depth, we should set that here
-        header[1] = idaDepth;
+        if (found) header[1] = mark;
+        if (pendingFound) pendingHeader[1] = mark;
         accepts = 1;
     }
     free(indexData);
@@ -96,29 +110,81 @@ int heuristic_index_accepts_node(HeuristicIndex * index, int depth, int idaDepth
     return accepts;
 }
 
-int heuristic_index_add_node(HeuristicIndex * index, const Cuboid * cb, Cuboid * cache, int depth) {
-    uint8_t headerData[2] = {depth, depth};
+void heuristic_index_add_node(HeuristicIndex * index, int thread, const Cuboid * cb,
+                              Cuboid * cache, int depth, int mark) {
+    int i;
+    for (i = 0; i < index->heuristic->cosetCount; i++) {
+        heuristic_index_add_coset(index, thread, i, cb, cache, depth, mark);
+    }
+}
+
+void heuristic_index_add_coset(HeuristicIndex * index, int thread, int coset,
+                               const Cuboid * cb, Cuboid * cache, int depth, int mark) {
+    uint8_t headerData[2] = {depth, mark};
     
     uint8_t * data = (uint8_t *)malloc(heuristic_data_size(index->heuristic));
-    int i, j, cosetCount = index->heuristic->cosetCount;
-    int addedSomething = 0;
+    int i, cosetCount = index->heuristic->cosetCount;
     Cuboid * temp = cuboid_copy(cb);
     
-    for (i = 0; i < cosetCount; i++) {
-        DataList * coset = index->heuristic->cosets[i];
-        Cuboid * rot = index->invTriggers[i];
-        cuboid_multiply(cache, cb, rot); // cache now contains our coset cube
-        for (j = 0; j < index->heuristic->angles->numDistinct; j++) {
-            int angle = index->heuristic->angles->distinct[j];
-            heuristic_get_data(index->heuristic, cache, temp, angle, data);
-            if (_data_list_append(coset, data, headerData)) {
-                addedSomething = 1;
-            }
+    DataListBatch * batch = index->batches[thread * cosetCount + coset];
+    Cuboid * rot = index->invTriggers[coset];
+    cuboid_multiply(cache, cb, rot); // cache now contains our coset cube
+    for (i = 0; i < index->heuristic->angles->numDistinct; i++) {
+        int angle = index->heuristic->angles->distinct[i];
+        heuristic_get_data(index->heuristic, cache, temp, angle, data);
+        data_list_batch_add(batch, data, headerData);
+    }
+    free(data);
+    cuboid_free(temp);
+}
+
+void heuristic_index_add_pending(HeuristicIndex * index, int coset, const Cuboid * cb,
+                                 Cuboid * cache, int depth, int mark, HashDataList * pending) {
+    uint8_t headerData[2] = {depth, mark};
+    
+    uint8_t * data = (uint8_t *)malloc(heuristic_data_size(index->heuristic));
+    Cuboid * temp = cuboid_copy(cb);
+    cuboid_multiply(cache, cb, index->invTriggers[coset]);
+    int i;
+    for (i = 0; i < index->heuristic->angles->numDistinct; i++) {
+        int angle = index->heuristic->angles->distinct[i];
+        heuristic_get_data(index->heuristic, cache, temp, angle, data);
+        uint8_t * header;
+        if (!hash_data_list_find(pending, data, &header)) {
+            hash_data_list_add(pending, data, headerData);
+        } else if (depth <= header[0]) {
+            memcpy(header, headerData, 2);
         }
     }
     free(data);
     cuboid_free(temp);
-    return addedSomething;
+}
+
+long long heuristic_index_merge_pending(HeuristicIndex * index, int thread, int coset,
+                                        HashDataList * pending) {
+    DataListBatch * batch = index->batches[thread * index->heuristic->cosetCount + coset];
+    unsigned long long slot, slotCount = pending->groupCount * kHashDataListGroupSlots;
+    for (slot = 0; slot < slotCount; slot++) {
+        uint8_t * record = hash_data_list_slot(pending, slot);
+        if (!record) continue;
+        data_list_batch_add(batch, &record[pending->headerLen], record);
+    }
+    return data_list_batch_merge(batch);
+}
+
+int heuristic_index_batch_is_full(HeuristicIndex * index, int thread) {
+    int cosetCount = index->heuristic->cosetCount;
+    DataListBatch * batch = index->batches[thread * cosetCount];
+    return (batch->count >= kHeuristicIndexBatchLimit);
+}
+
+long long heuristic_index_merge(HeuristicIndex * index, int thread) {
+    int i, cosetCount = index->heuristic->cosetCount;
+    long long added = 0;
+    for (i = 0; i < cosetCount; i++) {
+        added += data_list_batch_merge(index->batches[thread * cosetCount + i]);
+    }
+    return added;
 }
 
 /***********
@@ -132,7 +198,84 @@ static HSParameters _process_heuristic_parameters(IndexerArguments args) {
     return params;
 }
 
-static int _data_list_append(DataList * dl, const uint8_t * data, const uint8_t * header) {
-    DataListNode * base = data_list_find_base(dl, data, 1);
-    return data_list_base_add(base, data, header);
+static int _heuristic_index_header_rejects(const uint8_t * header, int depth, int mark) {
+    // an entry rejects a node which is no closer than it, unless the node
+    // is at the entry's depth and has not been seen with this mark
+    if (header[0] < depth) return 1;
+    return (header[0] == depth && header[1] == mark);
+}
+
+static HeuristicIndex * _heuristic_index_setup(Heuristic * heuristic, IndexerArguments indexArgs,
+                                               DataList ** previous, int previousCount) {
+    int dataSize = heuristic_data_size(heuristic);
+    int shardDepth = indexArgs.shardDepth;
+    int nodeDepth = dataSize < shardDepth ? dataSize : shardDepth;
+    
+    // generate cosets
+    RotationBasis basis = rotation_basis_standard(heuristic->params.symmetries.dims);
+    RotationGroup * subgroup = rotation_group_create_basis(heuristic->params.symmetries);
+    RotationGroup * group = rotation_group_create_basis(basis);
+    RotationCosets * cosets = rotation_cosets_create(group, subgroup);
+    
+    int cosetCount = rotation_cosets_count(cosets);
+    if (previous && previousCount != cosetCount) {
+        rotation_group_release(group);
+        rotation_cosets_release(cosets);
+        rotation_group_release(subgroup);
+        return NULL;
+    }
+    Cuboid ** inverseTriggers = (Cuboid **)malloc(sizeof(void *) * cosetCount);
+    
+    int i;
+    for (i = 0; i < cosetCount; i++) {
+        DataList * dl;
+        if (indexArgs.hashFlag) {
+            dl = data_list_create_hashed(dataSize, kHeuristicIndexHeaderLen);
+        } else if (shardDepth < 0) {
+            dl = data_list_create_adaptive(dataSize, kHeuristicIndexHeaderLen, dataSize,
+                                           kDataListTargetSize * 2);
+        } else {
+            dl = data_list_create(dataSize, kHeuristicIndexHeaderLen, nodeDepth);
+        }
+        if (previous) _heuristic_index_copy(dl, previous[i]);
+        heuristic_add_coset(heuristic, dl);
+        Cuboid * cuboid = rotation_cosets_get_trigger(cosets, i);
+        Cuboid * inv = cuboid_inverse(cuboid);
+        inverseTriggers[i] = inv;
+    }
+    
+    rotation_group_release(group);
+    rotation_cosets_release(cosets);
+    rotation_group_release(subgroup);
+    
+    HeuristicIndex * index = (HeuristicIndex *)malloc(sizeof(HeuristicIndex));
+    index->heuristic = heuristic;
+    index->invTriggers = inverseTriggers;
+    index->threadCount = indexArgs.threadCount;
+    
+    int batchCount = indexArgs.threadCount * cosetCount;
+    index->batches = (DataListBatch **)malloc(sizeof(void *) * batchCount);
+    for (i = 0; i < batchCount; i++) {
+        index->batches[i] = data_list_batch_create(heuristic->cosets[i % cosetCount]);
+    }
+    return index;
+}
+
+static void _heuristic_index_copy(DataList * list, DataList * previous) {
+    DataListBatch * batch = data_list_batch_create(list);
+    data_list_remove_from(previous, 0, _heuristic_index_copy_entry, batch);
+    data_list_batch_merge(batch);
+    data_list_batch_free(batch);
+    data_list_free(previous);
+}
+
+static void _heuristic_index_copy_entry(void * context, const uint8_t * body,
+                                        const uint8_t * header) {
+    // no pass has seen the entry yet
+    DataListBatch * batch = (DataListBatch *)context;
+    uint8_t indexHeader[2] = {header[0], kHeuristicIndexNoMark};
+    data_list_batch_add(batch, body, indexHeader);
+    if (batch->count >= kHeuristicIndexBatchLimit) {
+        data_list_batch_merge(batch);
+    }
 }
@@ -1,16 +1,77 @@
+#ifndef __HEURISTIC_INDEX_H__
+#define __HEURISTIC_INDEX_H__
+
 #include "indexer_arguments.h"
 #include "heuristic/heuristic.h"
+#include "heuristic/data_list_batch.h"
 #include "algebra/rotation_cosets.h"
 
 typedef struct {
     Heuristic * heuristic;
     Cuboid ** invTriggers;
+    
+    // batches[thread * cosetCount + coset] collects the nodes each
+    // thread adds until they are merged into the heuristic.
+    int threadCount;
+    DataListBatch ** batches;
 } HeuristicIndex;
 
+// the number of entries a thread may batch for a coset before merging
+#define kHeuristicIndexBatchLimit (1 << 22)
+
+// entries have the depth they were found at and a mark; see below
+#define kHeuristicIndexHeaderLen 2
+
+// the mark of an entry which no node has been accepted with yet
+#define kHeuristicIndexNoMark 0xff
+
 HeuristicIndex * heuristic_index_create(CLArgumentList * args, IndexerArguments indexArgs,
                                         const char * name);
+
+/**
+ * Creates an index whose entries so far are those of a heuristic which was
+ * loaded from a file, and which takes over the heuristic. Returns NULL, and
+ * leaves the heuristic as it was, if its cosets are dense, hashed or do
+ * not match the symmetries of `indexArgs`.
+ */
+HeuristicIndex * heuristic_index_extend(Heuristic * heuristic, IndexerArguments indexArgs);
 void heuristic_index_free(HeuristicIndex * index);
 
-int heuristic_index_accepts_node(HeuristicIndex * index, int depth, int idaDepth,
+/**
+ * A node is accepted if it is new to any of the cosets. An entry whose value
+ * is `depth` accepts a node once, and records `mark` in its second header
+ * byte; it rejects the node from then on while it is given the same mark.
+ */
+int heuristic_index_accepts_node(HeuristicIndex * index, int depth, int mark,
                                  const Cuboid * cb, Cuboid * cache);
-int heuristic_index_add_node(HeuristicIndex * index, const Cuboid * cb, Cuboid * cache, int depth);
+void heuristic_index_add_node(HeuristicIndex * index, int thread, const Cuboid * cb,
+                              Cuboid * cache, int depth, int mark);
+
+// like the functions above, but for one coset only
+int heuristic_index_accepts_coset(HeuristicIndex * index, int coset, int depth,
+                                  int mark, const Cuboid * cb, Cuboid * cache);
+void heuristic_index_add_coset(HeuristicIndex * index, int thread, int coset,
+                               const Cuboid * cb, Cuboid * cache, int depth, int mark);
+
+/**
+ * Like the coset functions above, but for a search which has to see the
+ * nodes it adds right away. Entries go into `pending` rather than a
+ * batch, and a node is also rejected by what is pending for the coset.
+ */
+int heuristic_index_accepts_pending(HeuristicIndex * index, int coset, int depth, int mark,
+                                    const Cuboid * cb, Cuboid * cache, HashDataList * pending);
+void heuristic_index_add_pending(HeuristicIndex * index, int coset, const Cuboid * cb,
+                                 Cuboid * cache, int depth, int mark, HashDataList * pending);
+
+// merges the pending entries of a coset through a thread's batch; returns
+// the number of new entries. The pending list is left as it was.
+long long heuristic_index_merge_pending(HeuristicIndex * index, int thread, int coset,
+                                        HashDataList * pending);
+
+// returns 1 if a thread's batches should be merged before it adds more nodes
+int heuristic_index_batch_is_full(HeuristicIndex * index, int thread);
+
+// merges the nodes added by a thread; returns the number of new entries.
+long long heuristic_index_merge(HeuristicIndex * index, int thread);
+
+#endif
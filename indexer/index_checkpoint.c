@@ -0,0 +1,190 @@
+#include "index_checkpoint.h"
+#include <unistd.h>
+
+static void _index_checkpoint_save_table(HeuristicIndex * index, FILE * fp);
+static void _index_checkpoint_save_spill(IndexSpill * spill, FILE * fp);
+
+static IndexCheckpoint * _index_checkpoint_read(FILE * fp);
+static int _index_checkpoint_read_table(IndexCheckpointTable * table, FILE * fp);
+static int _index_checkpoint_read_spill(IndexCheckpointTable * table, FILE * fp);
+
+int index_checkpoint_save(const char * fileName, int argc, const char ** argv,
+                          HeuristicIndex ** indexes, IndexSpill ** spills, int count,
+                          long long added, long long pruned, CSSearchState * search) {
+    char * tempName = (char *)malloc(strlen(fileName) + 5);
+    sprintf(tempName, "%s.tmp", fileName);
+    FILE * fp = fopen(tempName, "w");
+    if (!fp) {
+        free(tempName);
+        return 0;
+    }
+
+    int i;
+    save_uint32(argc, fp);
+    for (i = 0; i < argc; i++) {
+        save_string(argv[i], fp);
+    }
+    save_uint64(added, fp);
+    save_uint64(pruned, fp);
+
+    save_uint32(count, fp);
+    for (i = 0; i < count; i++) {
+        _index_checkpoint_save_table(indexes[i], fp);
+        _index_checkpoint_save_spill(spills[i], fp);
+    }
+    save_cuboid_search(search, fp);
+
+    int failed = ferror(fp);
+    if (fclose(fp) || failed || rename(tempName, fileName)) {
+        unlink(tempName);
+        free(tempName);
+        return 0;
+    }
+    free(tempName);
+    return 1;
+}
+
+IndexCheckpoint * index_checkpoint_load(const char * fileName) {
+    FILE * fp = fopen(fileName, "r");
+    if (!fp) return NULL;
+    IndexCheckpoint * checkpoint = _index_checkpoint_read(fp);
+    fclose(fp);
+    return checkpoint;
+}
+
+int index_checkpoint_restore(IndexCheckpoint * checkpoint, int table, HeuristicIndex * index) {
+    Heuristic * heuristic = index->heuristic;
+    if (table >= checkpoint->tableCount) return 0;
+    IndexCheckpointTable * entry = &checkpoint->tables[table];
+    if (entry->cosetCount != heuristic->cosetCount) return 0;
+    int i;
+    for (i = 0; i < heuristic->cosetCount; i++) {
+        DataList * list = heuristic->cosets[i];
+        DataList * saved = entry->cosets[i];
+        if (saved->dataSize != list->dataSize) return 0;
+        if (saved->headerLen != list->headerLen) return 0;
+        if (!saved->hash != !list->hash) return 0;
+    }
+
+    for (i = 0; i < heuristic->cosetCount; i++) {
+        // adaptive shards keep splitting from where they left off
+        entry->cosets[i]->splitSize = heuristic->cosets[i]->splitSize;
+        data_list_free(heuristic->cosets[i]);
+        heuristic->cosets[i] = entry->cosets[i];
+    }
+    for (i = 0; i < index->threadCount * heuristic->cosetCount; i++) {
+        index->batches[i]->list = heuristic->cosets[i % heuristic->cosetCount];
+    }
+    free(entry->cosets);
+    entry->cosets = NULL;
+    entry->cosetCount = 0;
+    return 1;
+}
+
+void index_checkpoint_free(IndexCheckpoint * checkpoint) {
+    int i, j;
+    for (i = 0; i < checkpoint->argc; i++) {
+        free(checkpoint->argv[i]);
+    }
+    free(checkpoint->argv);
+    for (i = 0; i < checkpoint->tableCount; i++) {
+        IndexCheckpointTable * table = &checkpoint->tables[i];
+        for (j = 0; j < table->cosetCount; j++) {
+            data_list_free(table->cosets[j]);
+        }
+        if (table->cosets) free(table->cosets);
+        if (table->spill) index_spill_free(table->spill);
+    }
+    if (checkpoint->tables) free(checkpoint->tables);
+    if (checkpoint->search) cs_search_state_free(checkpoint->search);
+    free(checkpoint);
+}
+
+/***********
+ * Private *
+ ***********/
+
+static void _index_checkpoint_save_table(HeuristicIndex * index, FILE * fp) {
+    Heuristic * heuristic = index->heuristic;
+    int i;
+    save_uint32(heuristic->cosetCount, fp);
+    for (i = 0; i < heuristic->cosetCount; i++) {
+        save_data_list(heuristic->cosets[i], fp);
+    }
+}
+
+static void _index_checkpoint_save_spill(IndexSpill * spill, FILE * fp) {
+    save_uint8(spill != NULL, fp);
+    if (spill) index_spill_save(spill, fp);
+}
+
+static IndexCheckpoint * _index_checkpoint_read(FILE * fp) {
+    IndexCheckpoint * checkpoint = (IndexCheckpoint *)malloc(sizeof(IndexCheckpoint));
+    bzero(checkpoint, sizeof(IndexCheckpoint));
+
+    uint32_t count;
+    if (!load_uint32(&count, fp) || count < 2) {
+        index_checkpoint_free(checkpoint);
+        return NULL;
+    }
+    checkpoint->argv = (char **)malloc(sizeof(char *) * count);
+    for (; checkpoint->argc < count; checkpoint->argc++) {
+        char * argument = load_string(fp);
+        if (!argument) {
+            index_checkpoint_free(checkpoint);
+            return NULL;
+        }
+        checkpoint->argv[checkpoint->argc] = argument;
+    }
+
+    uint64_t added, pruned;
+    if (!load_uint64(&added, fp) || !load_uint64(&pruned, fp)) {
+        index_checkpoint_free(checkpoint);
+        return NULL;
+    }
+    checkpoint->nodesAdded = added;
+    checkpoint->nodesPruned = pruned;
+
+    if (!load_uint32(&count, fp) || count == 0) {
+        index_checkpoint_free(checkpoint);
+        return NULL;
+    }
+    checkpoint->tables = (IndexCheckpointTable *)malloc(sizeof(IndexCheckpointTable) * count);
+    bzero(checkpoint->tables, sizeof(IndexCheckpointTable) * count);
+    checkpoint->tableCount = count;
+    int i;
+    for (i = 0; i < count; i++) {
+        IndexCheckpointTable * table = &checkpoint->tables[i];
+        if (!_index_checkpoint_read_table(table, fp) || !_index_checkpoint_read_spill(table, fp)) {
+            index_checkpoint_free(checkpoint);
+            return NULL;
+        }
+    }
+
+    checkpoint->search = load_cuboid_search(fp);
+    if (!checkpoint->search) {
+        index_checkpoint_free(checkpoint);
+        return NULL;
+    }
+    return checkpoint;
+}
+
+static int _index_checkpoint_read_table(IndexCheckpointTable * table, FILE * fp) {
+    uint32_t count;
+    if (!load_uint32(&count, fp)) return 0;
+    table->cosets = (DataList **)malloc(sizeof(DataList *) * (count + 1));
+    for (; table->cosetCount < count; table->cosetCount++) {
+        DataList * list = load_data_list(fp);
+        if (!list) return 0;
+        table->cosets[table->cosetCount] = list;
+    }
+    return 1;
+}
+
+static int _index_checkpoint_read_spill(IndexCheckpointTable * table, FILE * fp) {
+    uint8_t hasSpill;
+    if (!load_uint8(&hasSpill, fp)) return 0;
+    if (!hasSpill) return 1;
+    table->spill = index_spill_load(fp);
+    return (table->spill != NULL);
+}
@@ -0,0 +1,53 @@
+#include "index_spill.h"
+#include "saving/save_search.h"
+
+/***
+ *
+ * A checkpoint holds everything needed to continue an interrupted index
+ * build: the indexer's command line, which recreates the heuristic and
+ * the arguments, the entries which every coset of every index has so far
+ * (with both header bytes), the node counters and the state of the base
+ * search. With a memory limit, it also names the runs which hold the
+ * entries that were spilled to disk.
+ *
+ * A checkpoint is written to a temporary file which then replaces the
+ * old one, so an interruption while saving never loses the last one.
+ *
+ */
+
+// what a checkpoint holds for each index of the build
+typedef struct {
+    int cosetCount;
+    DataList ** cosets;
+    IndexSpill * spill; // NULL without a memory limit
+} IndexCheckpointTable;
+
+typedef struct {
+    // the command line from the index type on, as `indexer` was run
+    int argc;
+    char ** argv;
+    
+    long long nodesAdded;
+    long long nodesPruned;
+    
+    int tableCount;
+    IndexCheckpointTable * tables;
+    CSSearchState * search;
+} IndexCheckpoint;
+
+// returns 0 if the checkpoint could not be written. `spills` may hold NULLs.
+int index_checkpoint_save(const char * fileName, int argc, const char ** argv,
+                          HeuristicIndex ** indexes, IndexSpill ** spills, int count,
+                          long long added, long long pruned, CSSearchState * search);
+
+IndexCheckpoint * index_checkpoint_load(const char * fileName);
+
+/**
+ * Replaces the cosets of `index` with those of table `table` of the
+ * checkpoint, which gives up ownership of them. Returns 0 if the cosets
+ * do not match.
+ */
+int index_checkpoint_restore(IndexCheckpoint * checkpoint, int table, HeuristicIndex * index);
+
+// frees the search state, spills and cosets too, unless they were taken.
+void index_checkpoint_free(IndexCheckpoint * checkpoint);
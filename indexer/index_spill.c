@@ -0,0 +1,408 @@
+#include "index_spill.h"
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+typedef struct {
+    FILE * fp;
+    int keyLen;
+    unsigned long long count;
+} IndexRunWriter;
+
+static long long _index_spill_layer(IndexSpill * spill, HeuristicIndex * index, int minValue);
+static void _index_spill_write_record(void * context, const uint8_t * body, const uint8_t * header);
+
+static FILE * _index_spill_create_run(IndexSpill * spill, int coset, IndexRun * run);
+static int _index_spill_close_run(IndexSpill * spill, int coset, FILE * fp, IndexRun * run);
+static void _index_spill_retire_run(IndexSpill * spill, IndexRun * run);
+
+static int _index_spill_merge_coset(IndexSpill * spill, int coset);
+static void _index_spill_sift(int * heap, int size, int index,
+                              const uint8_t * records, int recordSize);
+
+static unsigned long long _index_spill_save_coset(IndexSpill * spill, int coset, FILE * fp);
+static unsigned long long _index_spill_writer_size(void * context, int coset);
+static int _index_spill_writer_save(void * context, int coset, FILE * fp);
+
+IndexSpill * index_spill_create(const char * prefix, HeuristicIndex * index,
+                                unsigned long long memoryLimit) {
+    Heuristic * heuristic = index->heuristic;
+    DataList * list = heuristic->cosets[0];
+    IndexSpill * spill = (IndexSpill *)malloc(sizeof(IndexSpill));
+    bzero(spill, sizeof(IndexSpill));
+    spill->prefix = (char *)malloc(strlen(prefix) + 1);
+    strcpy(spill->prefix, prefix);
+    spill->memoryLimit = memoryLimit;
+    spill->keyLen = list->dataSize;
+    spill->cosetCount = heuristic->cosetCount;
+    spill->listDepth = list->depth;
+    spill->targetSize = list->splitSize ? kDataListTargetSize : 0;
+    spill->runs = (IndexRun **)malloc(sizeof(IndexRun *) * spill->cosetCount);
+    spill->runCounts = (int *)malloc(sizeof(int) * spill->cosetCount);
+    bzero(spill->runs, sizeof(IndexRun *) * spill->cosetCount);
+    bzero(spill->runCounts, sizeof(int) * spill->cosetCount);
+    return spill;
+}
+
+void index_spill_free(IndexSpill * spill) {
+    int i, j;
+    for (i = 0; i < spill->cosetCount; i++) {
+        for (j = 0; j < spill->runCounts[i]; j++) {
+            free(spill->runs[i][j].fileName);
+        }
+        if (spill->runs[i]) free(spill->runs[i]);
+    }
+    for (i = 0; i < spill->mergedCount; i++) {
+        free(spill->merged[i]);
+    }
+    if (spill->merged) free(spill->merged);
+    free(spill->runs);
+    free(spill->runCounts);
+    free(spill->prefix);
+    free(spill);
+}
+
+int index_spill_is_over(IndexSpill * spill, HeuristicIndex * index) {
+    Heuristic * heuristic = index->heuristic;
+    unsigned long long size = 0;
+    int i;
+    for (i = 0; i < heuristic->cosetCount; i++) {
+        size += data_list_resident_size(heuristic->cosets[i]);
+    }
+    return size > spill->memoryLimit;
+}
+
+long long index_spill_layers(IndexSpill * spill, HeuristicIndex * index, int deepest) {
+    long long spilled = 0;
+    int layer;
+    for (layer = deepest; layer >= 0 && index_spill_is_over(spill, index); layer--) {
+        long long count = _index_spill_layer(spill, index, layer);
+        if (count < 0) return -1;
+        spilled += count;
+    }
+    return spilled;
+}
+
+int index_spill_merge(IndexSpill * spill) {
+    int i;
+    for (i = 0; i < spill->cosetCount; i++) {
+        if (!_index_spill_merge_coset(spill, i)) return 0;
+    }
+    return 1;
+}
+
+int index_spill_finish(IndexSpill * spill, HeuristicIndex * index) {
+    if (_index_spill_layer(spill, index, 0) < 0) return 0;
+    return index_spill_merge(spill);
+}
+
+HeuristicCosetWriter index_spill_writer(IndexSpill * spill) {
+    HeuristicCosetWriter writer;
+    writer.context = spill;
+    writer.coset_size = _index_spill_writer_size;
+    writer.save_coset = _index_spill_writer_save;
+    return writer;
+}
+
+void index_spill_collect(IndexSpill * spill, int all) {
+    int i, j;
+    for (i = 0; i < spill->mergedCount; i++) {
+        unlink(spill->merged[i]);
+        free(spill->merged[i]);
+    }
+    spill->mergedCount = 0;
+    if (!all) return;
+    for (i = 0; i < spill->cosetCount; i++) {
+        for (j = 0; j < spill->runCounts[i]; j++) {
+            unlink(spill->runs[i][j].fileName);
+            free(spill->runs[i][j].fileName);
+        }
+        spill->runCounts[i] = 0;
+    }
+}
+
+void index_spill_save(IndexSpill * spill, FILE * fp) {
+    int i, j;
+    save_string(spill->prefix, fp);
+    save_uint64(spill->memoryLimit, fp);
+    save_uint32(spill->keyLen, fp);
+    save_uint32(spill->cosetCount, fp);
+    save_uint32(spill->nextId, fp);
+    save_uint32(spill->listDepth, fp);
+    save_uint64(spill->targetSize, fp);
+    for (i = 0; i < spill->cosetCount; i++) {
+        save_uint32(spill->runCounts[i], fp);
+        for (j = 0; j < spill->runCounts[i]; j++) {
+            save_string(spill->runs[i][j].fileName, fp);
+            save_uint64(spill->runs[i][j].count, fp);
+        }
+    }
+}
+
+IndexSpill * index_spill_load(FILE * fp) {
+    char * prefix = load_string(fp);
+    if (!prefix) return NULL;
+    IndexSpill * spill = (IndexSpill *)malloc(sizeof(IndexSpill));
+    bzero(spill, sizeof(IndexSpill));
+    spill->prefix = prefix;
+    
+    uint64_t memoryLimit, targetSize;
+    uint32_t keyLen, cosetCount, nextId, listDepth;
+    if (!load_uint64(&memoryLimit, fp) || !load_uint32(&keyLen, fp)
+        || !load_uint32(&cosetCount, fp) || !load_uint32(&nextId, fp)
+        || !load_uint32(&listDepth, fp) || !load_uint64(&targetSize, fp)) {
+        free(prefix);
+        free(spill);
+        return NULL;
+    }
+    spill->memoryLimit = memoryLimit;
+    spill->keyLen = keyLen;
+    spill->cosetCount = cosetCount;
+    spill->nextId = nextId;
+    spill->listDepth = listDepth;
+    spill->targetSize = targetSize;
+    spill->runs = (IndexRun **)malloc(sizeof(IndexRun *) * (cosetCount + 1));
+    spill->runCounts = (int *)malloc(sizeof(int) * (cosetCount + 1));
+    bzero(spill->runs, sizeof(IndexRun *) * (cosetCount + 1));
+    bzero(spill->runCounts, sizeof(int) * (cosetCount + 1));
+    
+    int i;
+    for (i = 0; i < spill->cosetCount; i++) {
+        uint32_t runCount;
+        if (!load_uint32(&runCount, fp)) {
+            index_spill_free(spill);
+            return NULL;
+        }
+        spill->runs[i] = (IndexRun *)malloc(sizeof(IndexRun) * (runCount + 1));
+        for (; spill->runCounts[i] < runCount; spill->runCounts[i]++) {
+            IndexRun * run = &spill->runs[i][spill->runCounts[i]];
+            uint64_t count;
+            run->fileName = load_string(fp);
+            if (!run->fileName) {
+                index_spill_free(spill);
+                return NULL;
+            }
+            if (!load_uint64(&count, fp) || access(run->fileName, R_OK)) {
+                // the run must still be there for the spill to be resumed
+                spill->runCounts[i]++;
+                index_spill_free(spill);
+                return NULL;
+            }
+            run->count = count;
+        }
+    }
+    return spill;
+}
+
+/***********
+ * Private *
+ ***********/
+
+static long long _index_spill_layer(IndexSpill * spill, HeuristicIndex * index, int minValue) {
+    Heuristic * heuristic = index->heuristic;
+    long long spilled = 0;
+    int i;
+    for (i = 0; i < heuristic->cosetCount; i++) {
+        IndexRun run;
+        IndexRunWriter writer;
+        writer.fp = _index_spill_create_run(spill, i, &run);
+        if (!writer.fp) return -1;
+        writer.keyLen = spill->keyLen;
+        writer.count = 0;
+        data_list_remove_from(heuristic->cosets[i], minValue,
+                              _index_spill_write_record, &writer);
+        run.count = writer.count;
+        if (!_index_spill_close_run(spill, i, writer.fp, &run)) return -1;
+        spilled += writer.count;
+        
+        if (spill->runCounts[i] >= kIndexSpillMaxRuns) {
+            if (!_index_spill_merge_coset(spill, i)) return -1;
+        }
+    }
+    return spilled;
+}
+
+static void _index_spill_write_record(void * context, const uint8_t * body, const uint8_t * header) {
+    IndexRunWriter * writer = (IndexRunWriter *)context;
+    fwrite(body, 1, writer->keyLen, writer->fp);
+    fwrite(header, 1, 1, writer->fp);
+    writer->count++;
+}
+
+static FILE * _index_spill_create_run(IndexSpill * spill, int coset, IndexRun * run) {
+    run->fileName = (char *)malloc(strlen(spill->prefix) + 32);
+    sprintf(run->fileName, "%s.%d.%d", spill->prefix, coset, spill->nextId++);
+    run->count = 0;
+    FILE * fp = fopen(run->fileName, "w");
+    if (!fp) {
+        free(run->fileName);
+        return NULL;
+    }
+    setvbuf(fp, NULL, _IOFBF, kIndexSpillBufferSize);
+    return fp;
+}
+
+static int _index_spill_close_run(IndexSpill * spill, int coset, FILE * fp, IndexRun * run) {
+    int failed = ferror(fp);
+    if (fclose(fp) || failed) {
+        unlink(run->fileName);
+        free(run->fileName);
+        return 0;
+    }
+    if (!run->count) {
+        unlink(run->fileName);
+        free(run->fileName);
+        return 1;
+    }
+    int count = spill->runCounts[coset];
+    spill->runs[coset] = (IndexRun *)realloc(spill->runs[coset], sizeof(IndexRun) * (count + 1));
+    spill->runs[coset][count] = *run;
+    spill->runCounts[coset]++;
+    return 1;
+}
+
+static void _index_spill_retire_run(IndexSpill * spill, IndexRun * run) {
+    if (!spill->keepMerged) {
+        unlink(run->fileName);
+        free(run->fileName);
+        return;
+    }
+    spill->merged = (char **)realloc(spill->merged, sizeof(char *) * (spill->mergedCount + 1));
+    spill->merged[spill->mergedCount++] = run->fileName;
+}
+
+static int _index_spill_merge_coset(IndexSpill * spill, int coset) {
+    int count = spill->runCounts[coset];
+    if (count < 2) return 1;
+    
+    // records are ordered by key and then by depth, so the first record
+    // of each key holds its lowest depth.
+    int recordSize = spill->keyLen + 1;
+    IndexRun * runs = spill->runs[coset];
+    FILE ** inputs = (FILE **)malloc(sizeof(FILE *) * count);
+    uint8_t * records = (uint8_t *)malloc(recordSize * count);
+    uint8_t * last = (uint8_t *)malloc(recordSize);
+    int * heap = (int *)malloc(sizeof(int) * count);
+    int i, heapSize = 0, failed = 0;
+    for (i = 0; i < count; i++) {
+        inputs[i] = fopen(runs[i].fileName, "r");
+        if (!inputs[i]) {
+            failed = 1;
+            continue;
+        }
+        setvbuf(inputs[i], NULL, _IOFBF, kIndexSpillBufferSize);
+        if (fread(&records[i * recordSize], recordSize, 1, inputs[i]) == 1) {
+            heap[heapSize++] = i;
+        }
+    }
+    
+    IndexRun output;
+    FILE * fp = failed ? NULL : _index_spill_create_run(spill, coset, &output);
+    if (fp) {
+        for (i = heapSize / 2 - 1; i >= 0; i--) {
+            _index_spill_sift(heap, heapSize, i, records, recordSize);
+        }
+        int hasLast = 0;
+        while (heapSize > 0) {
+            uint8_t * record = &records[heap[0] * recordSize];
+            if (!hasLast || memcmp(last, record, spill->keyLen)) {
+                fwrite(record, 1, recordSize, fp);
+                memcpy(last, record, recordSize);
+                output.count++;
+                hasLast = 1;
+            }
+            if (fread(record, recordSize, 1, inputs[heap[0]]) != 1) {
+                heap[0] = heap[--heapSize];
+            }
+            _index_spill_sift(heap, heapSize, 0, records, recordSize);
+        }
+    }
+    
+    for (i = 0; i < count; i++) {
+        if (!inputs[i]) continue;
+        if (ferror(inputs[i])) failed = 1;
+        fclose(inputs[i]);
+    }
+    free(inputs);
+    free(records);
+    free(last);
+    free(heap);
+    
+    if (!fp) return 0;
+    if (failed) {
+        fclose(fp);
+        unlink(output.fileName);
+        free(output.fileName);
+        return 0;
+    }
+    
+    // the merged run is added after its inputs, which are then dropped
+    if (!_index_spill_close_run(spill, coset, fp, &output)) return 0;
+    runs = spill->runs[coset];
+    for (i = 0; i < count; i++) {
+        _index_spill_retire_run(spill, &runs[i]);
+    }
+    spill->runCounts[coset] -= count;
+    memmove(runs, &runs[count], sizeof(IndexRun) * spill->runCounts[coset]);
+    return 1;
+}
+
+static void _index_spill_sift(int * heap, int size, int index,
+                              const uint8_t * records, int recordSize) {
+    while (1) {
+        int smallest = index;
+        int child = index * 2 + 1;
+        int i;
+        for (i = child; i < child + 2 && i < size; i++) {
+            if (memcmp(&records[heap[i] * recordSize],
+                       &records[heap[smallest] * recordSize], recordSize) < 0) {
+                smallest = i;
+            }
+        }
+        if (smallest == index) return;
+        int temp = heap[index];
+        heap[index] = heap[smallest];
+        heap[smallest] = temp;
+        index = smallest;
+    }
+}
+
+static unsigned long long _index_spill_save_coset(IndexSpill * spill, int coset, FILE * fp) {
+    // the run is mapped rather than read in, so a coset which does not fit
+    // in memory is paged through as it is written
+    IndexRun * run = spill->runCounts[coset] ? &spill->runs[coset][0] : NULL;
+    int recordSize = spill->keyLen + 1;
+    const uint8_t * records = NULL;
+    size_t size = 0;
+    int fd = -1;
+    if (run) {
+        fd = open(run->fileName, O_RDONLY);
+        if (fd < 0) return 0;
+        size = run->count * recordSize;
+        void * mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            return 0;
+        }
+        madvise(mapped, size, MADV_SEQUENTIAL);
+        records = (const uint8_t *)mapped;
+    }
+    
+    unsigned long long written = save_data_list_records(records, run ? run->count : 0,
+                                                        spill->keyLen, 1, spill->listDepth,
+                                                        spill->targetSize,
+                                                        kHeuristicIndexHeaderLen, fp);
+    if (run) {
+        munmap((void *)records, size);
+        close(fd);
+    }
+    return written;
+}
+
+static unsigned long long _index_spill_writer_size(void * context, int coset) {
+    return _index_spill_save_coset((IndexSpill *)context, coset, NULL);
+}
+
+static int _index_spill_writer_save(void * context, int coset, FILE * fp) {
+    return _index_spill_save_coset((IndexSpill *)context, coset, fp) && !ferror(fp);
+}
@@ -0,0 +1,86 @@
+#include "heuristic_index.h"
+#include "heuristic/heuristic_io.h"
+
+/***
+ *
+ * A spill keeps an index build within a memory budget. Once the cosets
+ * take up more than the budget, the entries of their deepest layers are
+ * moved out to sorted runs on disk, each record being a key followed by
+ * its depth. The deepest layers go first because they prune the least:
+ * their nodes are mostly found again near the leaves of a pass.
+ *
+ * A spilled entry can no longer prune the search, so its node may be
+ * expanded and added again later, at the same depth or a deeper one.
+ * Merging the runs keeps the lowest depth of each key, which is the
+ * depth the node was first found at. The runs of a coset are merged at
+ * every depth boundary, and whenever there are kIndexSpillMaxRuns of
+ * them. When the search is done, the remaining entries are spilled as
+ * well, and each coset is written to the output file from its one run.
+ *
+ */
+
+// records are read and written through buffers of this many bytes
+#define kIndexSpillBufferSize (1 << 20)
+
+// the most runs a coset may have before they are merged
+#define kIndexSpillMaxRuns 32
+
+typedef struct {
+    char * fileName;
+    unsigned long long count;
+} IndexRun;
+
+typedef struct {
+    // run files are named <prefix>.<coset>.<id>
+    char * prefix;
+    unsigned long long memoryLimit;
+    int keyLen;
+    int cosetCount;
+    int nextId;
+    
+    // how the cosets are sharded in the output file (see
+    // save_data_list_records())
+    int listDepth;
+    unsigned long long targetSize;
+    
+    // the runs of each coset, in no particular order
+    IndexRun ** runs;
+    int * runCounts;
+    
+    // merged runs which a checkpoint may still name; they are only
+    // deleted by index_spill_collect() if keepMerged is set
+    int keepMerged;
+    char ** merged;
+    int mergedCount;
+} IndexSpill;
+
+IndexSpill * index_spill_create(const char * prefix, HeuristicIndex * index,
+                                unsigned long long memoryLimit);
+void index_spill_free(IndexSpill * spill);
+
+// returns 1 if the cosets take up more memory than the budget
+int index_spill_is_over(IndexSpill * spill, HeuristicIndex * index);
+
+/**
+ * Spills the layers of every coset from `deepest` on up until the cosets
+ * are within the budget. Returns the number of entries spilled, or -1 if
+ * a run could not be written.
+ */
+long long index_spill_layers(IndexSpill * spill, HeuristicIndex * index, int deepest);
+
+// merges the runs of each coset into one; returns 0 on failure
+int index_spill_merge(IndexSpill * spill);
+
+/**
+ * Spills every entry which is left and merges the runs. After this, the
+ * writer saves the cosets from their runs, stripped down to one header
+ * byte as the indexer always saves them.
+ */
+int index_spill_finish(IndexSpill * spill, HeuristicIndex * index);
+HeuristicCosetWriter index_spill_writer(IndexSpill * spill);
+
+// deletes the merged runs, or every run if `all` is set
+void index_spill_collect(IndexSpill * spill, int all);
+
+void index_spill_save(IndexSpill * spill, FILE * fp);
+IndexSpill * index_spill_load(FILE * fp);
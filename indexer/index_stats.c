@@ -0,0 +1,125 @@
+#include "index_stats.h"
+#include <sys/resource.h>
+
+static IndexStatsCounts _index_stats_difference(IndexStatsCounts end, IndexStatsCounts start);
+static void _index_stats_print_rate(FILE * fp, const char * name, double count, double seconds);
+static long long _index_stats_peak_rss();
+
+IndexStats * index_stats_create(const char * fileName) {
+    FILE * fp = fopen(fileName, "a");
+    if (!fp) return NULL;
+    IndexStats * stats = (IndexStats *)malloc(sizeof(IndexStats));
+    bzero(stats, sizeof(IndexStats));
+    stats->fp = fp;
+    stats->depth = -1;
+    stats->lastDepth = -1;
+    return stats;
+}
+
+void index_stats_free(IndexStats * stats) {
+    fclose(stats->fp);
+    free(stats);
+}
+
+void index_stats_begin(IndexStats * stats, int depth, int partial, IndexStatsCounts counts) {
+    stats->depth = depth;
+    stats->partial = partial;
+    stats->startTime = heuristic_stats_seconds();
+    stats->start = counts;
+}
+
+int index_stats_end(IndexStats * stats, IndexStatsCounts counts,
+                    HeuristicIndex ** indexes, int count) {
+    if (stats->depth < 0) return 1;
+    double seconds = heuristic_stats_seconds() - stats->startTime;
+    IndexStatsCounts done = _index_stats_difference(counts, stats->start);
+    
+    unsigned long long memory = 0, buckets[kIndexStatsShardBuckets];
+    bzero(buckets, sizeof(buckets));
+    int i, j;
+    for (i = 0; i < count; i++) {
+        Heuristic * heuristic = indexes[i]->heuristic;
+        for (j = 0; j < heuristic->cosetCount; j++) {
+            memory += data_list_memory_size(heuristic->cosets[j]);
+            data_list_shard_histogram(heuristic->cosets[j], buckets, kIndexStatsShardBuckets);
+        }
+    }
+    
+    FILE * fp = stats->fp;
+    fprintf(fp, "{\"depth\": %d, \"partial\": %s, \"seconds\": %.3f", stats->depth,
+            stats->partial ? "true" : "false", seconds);
+    fprintf(fp, ", \"added\": %lld, \"pruned\": %lld, \"nodes\": %lld, \"inserts\": %lld",
+            done.added, done.pruned, done.nodes, done.inserts);
+    if (done.inserts > 0) {
+        double duplicates = 1 - (double)done.added / (double)done.inserts;
+        fprintf(fp, ", \"duplicate_ratio\": %.4f", duplicates);
+    } else {
+        fprintf(fp, ", \"duplicate_ratio\": null");
+    }
+    _index_stats_print_rate(fp, "nodes_per_second", done.nodes, seconds);
+    _index_stats_print_rate(fp, "inserts_per_second", done.inserts, seconds);
+    fprintf(fp, ", \"total_added\": %lld, \"memory_bytes\": %llu, \"peak_rss_kb\": %lld",
+            counts.added, memory, _index_stats_peak_rss());
+    fprintf(fp, ", \"shard_bytes_log2\": [");
+    for (i = 0; i < kIndexStatsShardBuckets; i++) {
+        fprintf(fp, "%s%llu", i ? ", " : "", buckets[i]);
+    }
+    fprintf(fp, "]");
+    
+    // the growth of a depth over a partial one would be too low
+    int projects = (stats->lastDepth == stats->depth - 1 && !stats->lastPartial &&
+                    !stats->partial && stats->last.added > 0 && stats->last.nodes > 0);
+    if (projects) {
+        double growth = (double)done.added / (double)stats->last.added;
+        double nodeGrowth = (double)done.nodes / (double)stats->last.nodes;
+        double nextAdded = done.added * growth;
+        double nextBytes = memory;
+        if (counts.added > 0) {
+            nextBytes = memory * ((counts.added + nextAdded) / (double)counts.added);
+        }
+        fprintf(fp, ", \"growth\": %.4f, \"next_added\": %.0f, \"next_bytes\": %.0f"
+                ", \"next_seconds\": %.1f", growth, nextAdded, nextBytes, seconds * nodeGrowth);
+    } else {
+        fprintf(fp, ", \"growth\": null, \"next_added\": null, \"next_bytes\": null"
+                ", \"next_seconds\": null");
+    }
+    fprintf(fp, "}\n");
+    
+    stats->lastDepth = stats->depth;
+    stats->lastPartial = stats->partial;
+    stats->last = done;
+    stats->depth = -1;
+    return (fflush(fp) == 0 && !ferror(fp));
+}
+
+/***********
+ * Private *
+ ***********/
+
+static IndexStatsCounts _index_stats_difference(IndexStatsCounts end, IndexStatsCounts start) {
+    IndexStatsCounts result;
+    result.added = end.added - start.added;
+    result.pruned = end.pruned - start.pruned;
+    result.nodes = end.nodes - start.nodes;
+    result.inserts = end.inserts - start.inserts;
+    return result;
+}
+
+static void _index_stats_print_rate(FILE * fp, const char * name, double count, double seconds) {
+    if (seconds > 0) {
+        fprintf(fp, ", \"%s\": %.0f", name, count / seconds);
+    } else {
+        fprintf(fp, ", \"%s\": null", name);
+    }
+}
+
+static long long _index_stats_peak_rss() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage)) return -1;
+#ifdef __APPLE__
+    // macOS reports bytes rather than kilobytes
+    return usage.ru_maxrss >> 10;
+#else
+    return usage.ru_maxrss;
+#endif
+}
@@ -0,0 +1,60 @@
+#include "heuristic_index.h"
+#include "heuristic/heuristic_stats.h"
+#include <stdio.h>
+
+// shards of 2^n bytes or more share the last bucket of the histogram
+#define kIndexStatsShardBuckets 24
+
+/***
+ *
+ * Index stats report how a build is going, so that a scheduler can tell
+ * whether a deeper build would finish in time. Every depth the search
+ * finishes adds one JSON object to the stats file, on a line of its own,
+ * with what that depth did: the entries it added, how many of the nodes
+ * handed to the indexes were already there, how fast it went, how the
+ * shards are filled and how much memory the indexer has used.
+ *
+ * The number of entries tends to grow by a steady factor from one depth
+ * to the next, and so does the number of nodes. A depth which follows
+ * another full depth is thus also given a guess at what the next depth
+ * will add, how big the entries will be after it, and how long it will
+ * take. After a resume, the depth which the search resumed in is marked
+ * as partial, since only the rest of it is counted.
+ *
+ */
+
+typedef struct {
+    long long added; // new entries, over all the cosets
+    long long pruned;
+    long long nodes; // nodes which the search looked at
+    long long inserts; // entries handed to the indexes, new or not
+} IndexStatsCounts;
+
+typedef struct {
+    FILE * fp;
+    
+    // the depth being measured, or -1
+    int depth;
+    int partial;
+    double startTime;
+    IndexStatsCounts start;
+    
+    // what the last depth which was written did, or lastDepth = -1
+    int lastDepth;
+    int lastPartial;
+    IndexStatsCounts last;
+} IndexStats;
+
+// appends to the file, so a resumed build continues it; NULL on failure
+IndexStats * index_stats_create(const char * fileName);
+void index_stats_free(IndexStats * stats);
+
+void index_stats_begin(IndexStats * stats, int depth, int partial, IndexStatsCounts counts);
+
+/**
+ * Writes the line of the depth being measured, given the counts and the
+ * indexes now that it is done. Does nothing if no depth is being
+ * measured, and returns 0 if the line could not be written.
+ */
+int index_stats_end(IndexStats * stats, IndexStatsCounts counts,
+                    HeuristicIndex ** indexes, int count);
@@ -4,16 +4,22 @@ static int _process_rotation_args(CLArgumentList * args, IndexerArguments * out)
 static int _process_numerical_args(CLArgumentList * args, IndexerArguments * out);
 static int _process_dimensions(CLArgumentList * args, IndexerArguments * out);
 static int _process_operations(CLArgumentList * args, IndexerArguments * out);
+static void _process_stats_file(CLArgumentList * args, IndexerArguments * out);
 static int _parse_rotation_axes(const unsigned char * axes, RotationBasis * basis);
 
 CLArgumentList * indexer_default_arguments() {
     CLArgumentList * args = cl_argument_list_new();
     cl_argument_list_add(args, cl_argument_new_string("symmetries", ""));
     cl_argument_list_add(args, cl_argument_new_string("operations", ""));
+    cl_argument_list_add(args, cl_argument_new_string("stats", ""));
     cl_argument_list_add(args, cl_argument_new_string("dimensions", "3x3x3"));
     cl_argument_list_add(args, cl_argument_new_integer("threads", 1));
     cl_argument_list_add(args, cl_argument_new_integer("maxdepth", 8));
-    cl_argument_list_add(args, cl_argument_new_integer("sharddepth", 3));
+    cl_argument_list_add(args, cl_argument_new_integer("sharddepth", -1));
+    cl_argument_list_add(args, cl_argument_new_integer("checkpoint", 0));
+    cl_argument_list_add(args, cl_argument_new_integer("memorylimit", 0));
+    cl_argument_list_add(args, cl_argument_new_flag("dense", 0));
+    cl_argument_list_add(args, cl_argument_new_flag("hashtable", 0));
     return args;
 }
 
@@ -22,6 +28,7 @@ int indexer_process_arguments(CLArgumentList * args, IndexerArguments * out) {
     if (!_process_rotation_args(args, out)) return 0;
     if (!_process_numerical_args(args, out)) return 0;
     if (!_process_operations(args, out)) return 0;
+    _process_stats_file(args, out);
     return 1;
 }
 
@@ -77,6 +84,28 @@ static int _process_numerical_args(CLArgumentList * args, IndexerArguments * out
     arg = cl_argument_list_get(args, index);
     out->shardDepth = arg->contents.integer.value;
     
+    index = cl_argument_list_find(args, "checkpoint");
+    assert(index >= 0);
+    arg = cl_argument_list_get(args, index);
+    out->checkpointInterval = arg->contents.integer.value;
+    if (out->checkpointInterval < 0) return 0;
+    
+    index = cl_argument_list_find(args, "memorylimit");
+    assert(index >= 0);
+    arg = cl_argument_list_get(args, index);
+    out->memoryLimit = arg->contents.integer.value;
+    if (out->memoryLimit < 0) return 0;
+    
+    index = cl_argument_list_find(args, "dense");
+    assert(index >= 0);
+    arg = cl_argument_list_get(args, index);
+    out->denseFlag = arg->contents.flag.boolValue;
+    
+    index = cl_argument_list_find(args, "hashtable");
+    assert(index >= 0);
+    arg = cl_argument_list_get(args, index);
+    out->hashFlag = arg->contents.flag.boolValue;
+    
     return 1;
 }
 
@@ -99,6 +128,15 @@ static int _process_operations(CLArgumentList * args, IndexerArguments * out) {
     return (out->operations != NULL);
 }
 
+static void _process_stats_file(CLArgumentList * args, IndexerArguments * out) {
+    int index = cl_argument_list_find(args, "stats");
+    if (index < 0) {
+        out->statsFile = NULL;
+    } else {
+        out->statsFile = strdup(cl_argument_list_get(args, index)->contents.string.value);
+    }
+}
+
 static int _parse_rotation_axes(const unsigned char * axes, RotationBasis * basis) {
     if (strlen((const char *)axes) != 3) return 0;
     int exponents[3] = {0, 0, 0};
@@ -5,9 +5,14 @@
 typedef struct {
     RotationBasis symmetries;
     int maxDepth;
-    int shardDepth;
+    int shardDepth; // negative for adaptive shards
+    int checkpointInterval; // minutes between checkpoints, or 0
+    int memoryLimit; // megabytes of entries to keep in memory, or 0
     int threadCount;
+    int denseFlag;
+    int hashFlag;
     AlgList * operations;
+    char * statsFile; // NULL unless --stats is given
 } IndexerArguments;
 
 CLArgumentList * indexer_default_arguments();
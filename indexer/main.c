@@ -1,39 +1,122 @@
-#include "heuristic_index.h"
+#include "cost_search.h"
+#include "index_checkpoint.h"
+#include "index_stats.h"
 #include "arguments/parser.h"
 #include "heuristic/heuristic_io.h"
 #include "search/cuboid.h"
 #include <stdio.h>
 #include <unistd.h>
+#include <signal.h>
 
-static HeuristicIndex * heuristicIndex = NULL;
+// the most indexes one search can build, since each is a bit of a mask
+#define kIndexerMaxTables 32
+
+typedef struct {
+    const char * fileName;
+    IndexerArguments arguments;
+    HeuristicIndex * index;
+    IndexSpill * spill; // holds the entries which did not fit in --memorylimit
+} IndexerTable;
+
+static IndexerTable * tables = NULL;
+static int tableCount = 0;
+
+// the arguments of the first index, which all of them share, but with
+// the deepest --maxdepth of any index
 static IndexerArguments arguments;
 static CSSearchContext * searchContext;
 static pthread_mutex_t globalMutex = PTHREAD_MUTEX_INITIALIZER;
 static int currentDepth = 0;
 static volatile long long nodesAdded = 0;
 static volatile long long nodesPruned = 0;
-static const char * fileName;
+
+// the depth which an extended index went to, or -1
+static int extendedDepth = -1;
+
+// the command line, which goes into each checkpoint
+static int commandCount;
+static const char ** commandLine;
+static char * checkpointName = NULL;
+
+// set by the callbacks once a checkpoint is saved; resumeState is only
+// kept if the search should continue afterwards
+static volatile sig_atomic_t interrupted = 0;
+static CSSearchState * resumeState = NULL;
+static int savedCheckpoint = 0;
+
+// the options which the indexes after the first take from it, since they
+// are built by the same search
+static const char * sharedOptions[] = {
+    "threads", "operations", "dimensions", "checkpoint", "stats"
+};
+
+// activeTables[thread][len] has a bit for each index which accepted the
+// last node of length len that the thread looked at. The children of a
+// node are only looked up in and added to those indexes, which is how
+// each index prunes the search as it would on its own. The root is new
+// to every index which goes as deep as the current depth.
+static uint32_t ** activeTables = NULL;
+static uint32_t rootTables = 0;
+
+// with --stats, the nodes each thread has looked at and the entries it has
+// handed to the indexes; they are only added up while the threads are stopped
+static IndexStats * indexStats = NULL;
+static long long * threadNodes = NULL;
+static long long * threadInserts = NULL;
+
+// set until the first depth of a resumed search begins
+static int resumedSearch = 0;
 
 CLArgumentList * subproblem_default_arguments(const char * spName);
 
 void print_usage(const char * name);
 void print_index_usage(const char * indexType);
-CLArgumentList * process_arguments(int argc, const char * argv[]);
+CLArgumentList * process_arguments(const char * type, const char ** options, int count,
+                                   CLArgumentList * shared);
+CLArgumentList * shared_arguments(CLArgumentList * list);
 
-int generate_heuristic(const char * name, CLArgumentList * args);
+int handle_index(int argc, const char * argv[]);
+int handle_resume(const char * command, const char * file);
+int handle_extend(int argc, const char * argv[]);
+int load_index(int argc, const char * argv[]);
+int load_table(const char ** spec, int count, CLArgumentList ** shared);
+int load_extension(int argc, const char * argv[]);
+void add_table(const char * fileName, IndexerArguments tableArgs, HeuristicIndex * index);
+void free_tables();
+int check_arguments();
+
+void allocate_thread_caches();
+int open_stats();
+int * operation_costs(HeuristicIndex * index);
 int run_search();
+int run_cost_search(int * costs);
+void wait_for_search();
+void save_index();
+
+int save_table(IndexerTable * table);
+int save_spilled_table(IndexerTable * table);
+
+void indexer_handle_interrupt(int dummy);
+void indexer_clear_marks();
+void indexer_spill_layers(IndexerTable * table, int deepest);
+IndexStatsCounts indexer_stats_counts();
+void indexer_write_stats();
 
 CSCallbacks generate_callbacks();
 
 void indexer_handle_progress(void * data);
 void indexer_handle_depth(void * data, int len);
 int indexer_accepts_sequence(void * data, const int * sequence, int len, int depthRem);
-int indexer_accepts_cuboid(void * data, const Cuboid * cuboid, Cuboid * cache, int depthRem);
+int indexer_accepts_cuboid(void * data, const Cuboid * cuboid, Cuboid * cache,
+                           int thread, int depthRem);
 void indexer_handle_cuboid(void * data, const Cuboid * cuboid, Cuboid * cache,
-                           const int * sequence, int len);
+                           int thread, const int * sequence, int len);
 void indexer_handle_save_data(void * data, CSSearchState * save);
 void indexer_handle_finished(void * data);
 
+uint32_t indexer_parent_tables(int thread, int len);
+void indexer_merge_batches();
+
 int main(int argc, const char * argv[]) {
     if (argc < 3) {
         print_usage(argv[0]);
@@ -47,35 +130,21 @@ int main(int argc, const char * argv[]) {
         }
         print_index_usage(argv[2]);
         return 1;
+    } else if (strcmp(argv[1], "resume") == 0) {
+        if (argc != 3) {
+            fprintf(stderr, "Error: resume takes exactly one argument\n");
+            return 1;
+        }
+        return handle_resume(argv[0], argv[2]);
+    } else if (strcmp(argv[1], "extend") == 0) {
+        if (argc < 4) {
+            fprintf(stderr, "Error: extend takes an index and an output file\n");
+            return 1;
+        }
+        return handle_extend(argc, argv);
     }
     
-    fileName = argv[2];
-    
-    IndexerArguments args;
-    CLArgumentList * list = process_arguments(argc, argv);
-    if (!list) return 1;
-    if (!indexer_process_arguments(list, &arguments)) {
-        fprintf(stderr, "error: failed to process arguments.\n");
-        cl_argument_list_free(list);
-        return 1;
-    }
-    
-    indexer_remove_all_defaults(list);
-    int result = generate_heuristic(argv[1], list);
-    cl_argument_list_free(list);
-    if (!result) {
-        alg_list_release(arguments.operations);
-        fprintf(stderr, "error: failed to create heuristic.\n");
-        return 1;
-    }
-    result = run_search();
-    if (!result) {
-        fprintf(stderr, "error: failed to launch search.\n");
-        alg_list_release(arguments.operations);
-        heuristic_index_free(heuristicIndex);
-        return 1;
-    }
-    return 0;
+    return handle_index(argc, argv);
 }
 
 CLArgumentList * subproblem_default_arguments(const char * spName) {
@@ -90,13 +159,20 @@ CLArgumentList * subproblem_default_arguments(const char * spName) {
 }
 
 void print_usage(const char * name) {
-    printf("Usage: [help <type> | %s <index type> <output> options]\n", name);
+    printf("Usage: [help <type> | resume <checkpoint> | extend <index> <output> options |\n"
+           "        %s <index type> <output> options [--and <index type> <output> options]...]\n",
+           name);
     puts("Options:");
     puts("--maxdepth=n      The maximum search depth [8]");
     puts("--threads=n       The number of threads for the search [1]");
     puts("--operations ...  The moves to make in indexing");
     puts("--symmetries xyz  The rotational symmetries of the moveset [111]");
-    puts("--sharddepth=n    The optional shard table depth [3]");
+    puts("--sharddepth=n    A fixed shard table depth instead of adaptive shards");
+    puts("--dense           Save 2-bit depth tables (solve with the same operations)");
+    puts("--hashtable       Store entries in hash tables instead of sorted shards");
+    puts("--checkpoint=n    Save <output>.checkpoint every n minutes, and on ^C");
+    puts("--memorylimit=n   Spill entries beyond n megabytes to sorted runs on disk");
+    puts("--stats <file>    Append a JSON line of statistics for each depth to a file");
     puts("\nAvailable solvers:\n");
     int i, entryCount = sizeof(HSubproblemTable) / sizeof(HSubproblem);;
     for (i = 0; i < entryCount; i++) {
@@ -121,33 +197,359 @@ void print_index_usage(const char * indexType) {
     fprintf(stderr, "Error: index type `%s` does not exist.\n", indexType);
 }
 
-CLArgumentList * process_arguments(int argc, const char * argv[]) {
-    CLArgumentList * spDefs = subproblem_default_arguments(argv[1]);
+CLArgumentList * process_arguments(const char * type, const char ** options, int count,
+                                   CLArgumentList * shared) {
+    CLArgumentList * spDefs = subproblem_default_arguments(type);
     if (!spDefs) {
-        fprintf(stderr, "Error: invalid indexer `%s`.\n", argv[1]);
+        fprintf(stderr, "Error: invalid indexer `%s`.\n", type);
         return NULL;
     }
     
     CLArgumentList * defaults = indexer_default_arguments();
+    if (shared) {
+        // an index after the first may not give the shared options at all
+        int i, j, sharedCount = sizeof(sharedOptions) / sizeof(const char *);
+        for (i = 0; i < sharedCount; i++) {
+            while ((j = cl_argument_list_find(defaults, sharedOptions[i])) >= 0) {
+                cl_argument_list_remove(defaults, j);
+            }
+        }
+    }
     cl_argument_list_add_all(defaults, spDefs);
     cl_argument_list_free(spDefs);
     
     int failIndex;
-    CLArgumentList * result = cl_parse_arguments(&argv[3], argc - 3, defaults, &failIndex);
+    CLArgumentList * result = cl_parse_arguments(options, count, defaults, &failIndex);
     cl_argument_list_free(defaults);
     if (!result) {
-        fprintf(stderr, "error: invalid argument near `%s`\n", argv[3 + failIndex]);
+        fprintf(stderr, "error: invalid argument near `%s`\n", options[failIndex]);
+    } else if (shared) {
+        cl_argument_list_add_all(result, shared);
     }
     return result;
 }
 
+CLArgumentList * shared_arguments(CLArgumentList * list) {
+    CLArgumentList * shared = cl_argument_list_new();
+    int i, index, sharedCount = sizeof(sharedOptions) / sizeof(const char *);
+    for (i = 0; i < sharedCount; i++) {
+        index = cl_argument_list_find(list, sharedOptions[i]);
+        if (index < 0) continue;
+        cl_argument_list_add(shared, cl_argument_copy(cl_argument_list_get(list, index)));
+    }
+    return shared;
+}
+
+
+/*********************************
+ * Different kinds of invocation *
+ *********************************/
+
+int handle_index(int argc, const char * argv[]) {
+    if (!load_index(argc, argv)) return 1;
+    
+    const char * fileName = tables[0].fileName;
+    checkpointName = (char *)malloc(strlen(fileName) + 12);
+    sprintf(checkpointName, "%s.checkpoint", fileName);
+    
+    int i, result, * costs = NULL;
+    for (i = 0; i < tableCount && !costs; i++) {
+        costs = operation_costs(tables[i].index);
+    }
+    if (costs && tableCount > 1) {
+        fprintf(stderr, "error: an index with free moves must be built on its own.\n");
+        free(costs);
+        free_tables();
+        return 1;
+    }
+    if (costs) {
+        result = run_cost_search(costs);
+    } else {
+        result = run_search();
+    }
+    if (!result) {
+        fprintf(stderr, "error: failed to launch search.\n");
+        free_tables();
+        return 1;
+    }
+    return 0;
+}
+
+int handle_resume(const char * command, const char * file) {
+    IndexCheckpoint * checkpoint = index_checkpoint_load(file);
+    if (!checkpoint) {
+        fprintf(stderr, "error: failed to load the checkpoint.\n");
+        return 1;
+    }
+    
+    // the recorded command line takes the place of our own for good
+    int argc = checkpoint->argc + 1;
+    const char ** argv = (const char **)malloc(sizeof(char *) * argc);
+    argv[0] = command;
+    memcpy(&argv[1], checkpoint->argv, sizeof(char *) * checkpoint->argc);
+    free(checkpoint->argv);
+    checkpoint->argv = NULL;
+    checkpoint->argc = 0;
+    
+    int loaded;
+    if (strcmp(argv[1], "extend") == 0) {
+        loaded = load_extension(argc, argv);
+    } else {
+        loaded = load_index(argc, argv);
+    }
+    if (!loaded) {
+        index_checkpoint_free(checkpoint);
+        return 1;
+    }
+    int i, matches = (checkpoint->tableCount == tableCount);
+    for (i = 0; i < tableCount && matches; i++) {
+        matches = index_checkpoint_restore(checkpoint, i, tables[i].index);
+    }
+    if (!matches) {
+        fprintf(stderr, "error: the checkpoint does not match its index.\n");
+        index_checkpoint_free(checkpoint);
+        free_tables();
+        return 1;
+    }
+    nodesAdded = checkpoint->nodesAdded;
+    nodesPruned = checkpoint->nodesPruned;
+    CSSearchState * state = checkpoint->search;
+    checkpoint->search = NULL;
+    for (i = 0; i < tableCount; i++) {
+        tables[i].spill = checkpoint->tables[i].spill;
+        checkpoint->tables[i].spill = NULL;
+        if (tables[i].spill) {
+            tables[i].spill->keepMerged = (arguments.checkpointInterval > 0);
+        }
+    }
+    index_checkpoint_free(checkpoint);
+    
+    checkpointName = strdup(file);
+    if (!open_stats()) {
+        cs_search_state_free(state);
+        free_tables();
+        return 1;
+    }
+    resumedSearch = 1;
+    searchContext = cs_resume(state, generate_callbacks());
+    wait_for_search();
+    return 0;
+}
+
+int handle_extend(int argc, const char * argv[]) {
+    if (!load_extension(argc, argv)) return 1;
+    
+    const char * fileName = tables[0].fileName;
+    checkpointName = (char *)malloc(strlen(fileName) + 12);
+    sprintf(checkpointName, "%s.checkpoint", fileName);
+    
+    int * costs = operation_costs(tables[0].index);
+    if (costs) {
+        fprintf(stderr, "error: an index with free moves cannot be extended.\n");
+        free(costs);
+        free_tables();
+        return 1;
+    }
+    if (!run_search()) {
+        free_tables();
+        return 1;
+    }
+    return 0;
+}
+
+int load_index(int argc, const char * argv[]) {
+    commandCount = argc - 1;
+    commandLine = &argv[1];
+    
+    // each index is a type, an output file and its options, and every
+    // index after the first follows an --and
+    CLArgumentList * shared = NULL;
+    int i, start = 1, result = 1;
+    for (i = 1; i <= argc && result; i++) {
+        if (i < argc && strcmp(argv[i], "--and")) continue;
+        result = load_table(&argv[start], i - start, &shared);
+        start = i + 1;
+    }
+    if (shared) cl_argument_list_free(shared);
+    if (!result) {
+        free_tables();
+        return 0;
+    }
+    
+    arguments = tables[0].arguments;
+    for (i = 1; i < tableCount; i++) {
+        if (tables[i].arguments.maxDepth > arguments.maxDepth) {
+            arguments.maxDepth = tables[i].arguments.maxDepth;
+        }
+    }
+    allocate_thread_caches();
+    return check_arguments();
+}
+
+int load_table(const char ** spec, int count, CLArgumentList ** shared) {
+    if (count < 2) {
+        fprintf(stderr, "error: each index takes a type and an output file.\n");
+        return 0;
+    }
+    if (tableCount == kIndexerMaxTables) {
+        fprintf(stderr, "error: at most %d indexes can be built at once.\n", kIndexerMaxTables);
+        return 0;
+    }
+    
+    CLArgumentList * list = process_arguments(spec[0], &spec[2], count - 2, *shared);
+    if (!list) return 0;
+    IndexerArguments tableArgs;
+    if (!indexer_process_arguments(list, &tableArgs)) {
+        fprintf(stderr, "error: failed to process arguments.\n");
+        cl_argument_list_free(list);
+        return 0;
+    }
+    if (!*shared) *shared = shared_arguments(list);
+    
+    indexer_remove_all_defaults(list);
+    HeuristicIndex * index = heuristic_index_create(list, tableArgs, spec[0]);
+    cl_argument_list_free(list);
+    if (!index) {
+        alg_list_release(tableArgs.operations);
+        fprintf(stderr, "error: failed to create heuristic.\n");
+        return 0;
+    }
+    add_table(spec[1], tableArgs, index);
+    return 1;
+}
+
+int load_extension(int argc, const char * argv[]) {
+    commandCount = argc - 1;
+    commandLine = &argv[1];
+    
+    // the index type, its own arguments and the symmetries all come from
+    // the index which is extended
+    int failIndex;
+    CLArgumentList * defaults = indexer_default_arguments();
+    CLArgumentList * list = cl_parse_arguments(&argv[4], argc - 4, defaults, &failIndex);
+    cl_argument_list_free(defaults);
+    if (!list) {
+        fprintf(stderr, "error: invalid argument near `%s`\n", argv[4 + failIndex]);
+        return 0;
+    }
+    int result = indexer_process_arguments(list, &arguments);
+    cl_argument_list_free(list);
+    if (!result) {
+        fprintf(stderr, "error: failed to process arguments.\n");
+        return 0;
+    }
+    
+    Heuristic * heuristic = heuristic_from_file(argv[2], arguments.symmetries.dims);
+    if (!heuristic) {
+        fprintf(stderr, "error: failed to load the index `%s`.\n", argv[2]);
+        alg_list_release(arguments.operations);
+        return 0;
+    }
+    extendedDepth = heuristic->params.maxDepth;
+    if (arguments.maxDepth <= extendedDepth) {
+        fprintf(stderr, "error: the index already goes to depth %d.\n", extendedDepth);
+        heuristic_free(heuristic);
+        alg_list_release(arguments.operations);
+        return 0;
+    }
+    
+    arguments.symmetries = heuristic->params.symmetries;
+    HeuristicIndex * index = heuristic_index_extend(heuristic, arguments);
+    if (!index) {
+        fprintf(stderr, "error: only sorted indexes can be extended, not dense or hashed ones.\n");
+        heuristic_free(heuristic);
+        alg_list_release(arguments.operations);
+        return 0;
+    }
+    add_table(argv[3], arguments, index);
+    allocate_thread_caches();
+    return check_arguments();
+}
+
+void add_table(const char * fileName, IndexerArguments tableArgs, HeuristicIndex * index) {
+    int size = sizeof(IndexerTable) * (tableCount + 1);
+    tables = (IndexerTable *)realloc(tables, size);
+    IndexerTable * table = &tables[tableCount++];
+    bzero(table, sizeof(IndexerTable));
+    table->fileName = fileName;
+    table->arguments = tableArgs;
+    table->index = index;
+}
+
+void free_tables() {
+    int i;
+    for (i = 0; i < tableCount; i++) {
+        alg_list_release(tables[i].arguments.operations);
+        if (tables[i].arguments.statsFile) free(tables[i].arguments.statsFile);
+        if (tables[i].index) heuristic_index_free(tables[i].index);
+        if (tables[i].spill) index_spill_free(tables[i].spill);
+    }
+    free(tables);
+    tables = NULL;
+    tableCount = 0;
+}
+
+int check_arguments() {
+    // the search threads mark the entries they have accepted nodes with
+    // by their own index, so one mark has to be left over
+    if (arguments.threadCount >= kHeuristicIndexNoMark) {
+        fprintf(stderr, "error: --threads must be below %d.\n", kHeuristicIndexNoMark);
+        free_tables();
+        return 0;
+    }
+    int i;
+    for (i = 0; i < tableCount; i++) {
+        IndexerArguments tableArgs = tables[i].arguments;
+        if (tableArgs.memoryLimit && (tableArgs.denseFlag || tableArgs.hashFlag)) {
+            fprintf(stderr, "error: --memorylimit cannot be used with --dense or --hashtable.\n");
+            free_tables();
+            return 0;
+        }
+    }
+    return 1;
+}
+
 /*********************
  * Commencing action *
  *********************/
 
-int generate_heuristic(const char * name, CLArgumentList * args) {
-    heuristicIndex = heuristic_index_create(args, arguments, name);
-    return (heuristicIndex != NULL);
+void allocate_thread_caches() {
+    int i;
+    activeTables = (uint32_t **)malloc(sizeof(uint32_t *) * arguments.threadCount);
+    for (i = 0; i < arguments.threadCount; i++) {
+        activeTables[i] = (uint32_t *)malloc(sizeof(uint32_t) * (arguments.maxDepth + 1));
+        bzero(activeTables[i], sizeof(uint32_t) * (arguments.maxDepth + 1));
+    }
+    threadNodes = (long long *)malloc(sizeof(long long) * arguments.threadCount);
+    threadInserts = (long long *)malloc(sizeof(long long) * arguments.threadCount);
+    bzero(threadNodes, sizeof(long long) * arguments.threadCount);
+    bzero(threadInserts, sizeof(long long) * arguments.threadCount);
+}
+
+int open_stats() {
+    if (!arguments.statsFile) return 1;
+    indexStats = index_stats_create(arguments.statsFile);
+    if (!indexStats) {
+        fprintf(stderr, "error: failed to open the stats file `%s`.\n", arguments.statsFile);
+        return 0;
+    }
+    return 1;
+}
+
+int * operation_costs(HeuristicIndex * index) {
+    // returns NULL if every operation counts as a move
+    int i, count = arguments.operations->entryCount, partial = 0;
+    int * costs = (int *)malloc(sizeof(int) * count);
+    for (i = 0; i < count; i++) {
+        Cuboid * operation = arguments.operations->entries[i].cuboid;
+        costs[i] = heuristic_operation_cost(index->heuristic, operation);
+        if (!costs[i]) partial = 1;
+    }
+    if (!partial) {
+        free(costs);
+        return NULL;
+    }
+    return costs;
 }
 
 int run_search() {
@@ -156,19 +558,137 @@ int run_search() {
     settings.rootNode = cuboid_create(arguments.symmetries.dims);
     settings.algorithms = arguments.operations;
     settings.cacheCuboid = 1;
+    settings.cacheInverse = 0;
     BSSettings bsSettings;
     bsSettings.threadCount = arguments.threadCount;
-    bsSettings.minDepth = 0;
+    bsSettings.minDepth = extendedDepth + 1;
     bsSettings.maxDepth = arguments.maxDepth;
     bsSettings.nodeInterval = 1000000;
+    if (!open_stats()) return 0;
     
-    searchContext = cs_run(settings, bsSettings, cbs);
+    int i;
+    for (i = 0; i < tableCount; i++) {
+        IndexerTable * table = &tables[i];
+        if (!table->arguments.memoryLimit) continue;
+        
+        // a checkpoint names the runs it needs, so merged runs are only
+        // deleted once a newer checkpoint replaces it
+        char * prefix = (char *)malloc(strlen(table->fileName) + 5);
+        sprintf(prefix, "%s.run", table->fileName);
+        table->spill = index_spill_create(prefix, table->index,
+                                          (unsigned long long)table->arguments.memoryLimit << 20);
+        table->spill->keepMerged = (arguments.checkpointInterval > 0);
+        free(prefix);
+    }
     
+    searchContext = cs_run(settings, bsSettings, cbs);
+    wait_for_search();
+    return 1;
+}
+
+int run_cost_search(int * costs) {
+    int result = 0;
+    if (arguments.denseFlag) {
+        fprintf(stderr, "error: an index with free moves cannot be dense.\n");
+    } else if (!cost_search_costs_are_symmetric(arguments.symmetries,
+                                                arguments.operations, costs)) {
+        fprintf(stderr, "error: the --symmetries must map owned moves to owned moves.\n");
+    } else {
+        if (arguments.checkpointInterval) {
+            fprintf(stderr, "note: an index with free moves is built without checkpoints.\n");
+        }
+        if (arguments.memoryLimit) {
+            fprintf(stderr, "note: an index with free moves is built without a memory limit.\n");
+        }
+        if (arguments.statsFile) {
+            fprintf(stderr, "note: an index with free moves is built without stats.\n");
+        }
+        cost_search_run(tables[0].index, arguments.operations, costs, arguments.maxDepth);
+        save_index();
+        result = 1;
+    }
+    free(costs);
+    return result;
+}
+
+void wait_for_search() {
+    // the search is only stopped from this thread, since stopping waits
+    // for the search threads and a signal may arrive on any of them
+    signal(SIGINT, indexer_handle_interrupt);
+    time_t lastCheckpoint = time(NULL);
     while (1) {
         sleep(1);
+        int interval = arguments.checkpointInterval * 60;
+        int periodic = (interval > 0 && time(NULL) - lastCheckpoint >= interval);
+        if (!interrupted && !periodic) continue;
+        
+        // unless the search goes on after the checkpoint, the callbacks
+        // exit once they are done
+        cs_context_stop(searchContext, 1);
+        if (!resumeState) continue;
+        
+        cs_context_release(searchContext);
+        searchContext = cs_resume(resumeState, generate_callbacks());
+        resumeState = NULL;
+        lastCheckpoint = time(NULL);
+    }
+}
+
+void indexer_handle_interrupt(int dummy) {
+    interrupted = 1;
+}
+
+void indexer_clear_marks() {
+    // a thread only expands the part of a node's subtree which falls in
+    // its range of sequences, so each thread accepts a node once under its
+    // own mark. The marks start over with every depth, including the one
+    // a resumed search starts in, since its threads revisit the nodes on
+    // the paths to where they stopped.
+    int i, j;
+    for (i = 0; i < tableCount; i++) {
+        Heuristic * heuristic = tables[i].index->heuristic;
+        for (j = 0; j < heuristic->cosetCount; j++) {
+            data_list_set_header_byte(heuristic->cosets[j], 1, kHeuristicIndexNoMark);
+        }
     }
-    
-    return 1;
+}
+
+void indexer_spill_layers(IndexerTable * table, int deepest) {
+    // callers hold the global mutex or have stopped the search threads
+    if (!index_spill_is_over(table->spill, table->index)) return;
+    long long spilled = index_spill_layers(table->spill, table->index, deepest);
+    if (spilled < 0) {
+        fprintf(stderr, "error: failed to write a run of spilled entries.\n");
+        exit(1);
+    }
+    printf("Spilled %lld entries of %s to disk.\n", spilled, table->fileName);
+}
+
+IndexStatsCounts indexer_stats_counts() {
+    // the search threads are stopped while this is called
+    IndexStatsCounts counts;
+    counts.added = nodesAdded;
+    counts.pruned = nodesPruned;
+    counts.nodes = 0;
+    counts.inserts = 0;
+    int i;
+    for (i = 0; i < arguments.threadCount; i++) {
+        counts.nodes += threadNodes[i];
+        counts.inserts += threadInserts[i];
+    }
+    return counts;
+}
+
+void indexer_write_stats() {
+    HeuristicIndex ** indexes = (HeuristicIndex **)malloc(sizeof(HeuristicIndex *) * tableCount);
+    int i;
+    for (i = 0; i < tableCount; i++) {
+        indexes[i] = tables[i].index;
+    }
+    if (!index_stats_end(indexStats, indexer_stats_counts(), indexes, tableCount)) {
+        fprintf(stderr, "error: failed to write the stats file.\n");
+    }
+    free(indexes);
 }
 
 /*************
@@ -181,6 +701,8 @@ CSCallbacks generate_callbacks() {
     cbs.handle_depth = indexer_handle_depth;
     cbs.accepts_sequence = indexer_accepts_sequence;
     cbs.accepts_cuboid = indexer_accepts_cuboid;
+    cbs.accepts_path = NULL;
+    cbs.accepts_cuboids = NULL;
     cbs.handle_cuboid = indexer_handle_cuboid;
     cbs.handle_save_data = indexer_handle_save_data;
     cbs.handle_finished = indexer_handle_finished;
@@ -191,18 +713,48 @@ void indexer_handle_progress(void * data) {
     pthread_mutex_lock(&globalMutex);
     long long value = __sync_fetch_and_or(&nodesAdded, 0);
     long long pruned = __sync_fetch_and_or(&nodesPruned, 0);
-    printf("Found %lld, pruned %lld [depth=%d, cosets=%d, angles=%d, syms=%d, data_cosets=%d].\n", 
-           value, pruned, currentDepth, heuristicIndex->heuristic->cosetCount,
-           heuristicIndex->heuristic->angles->numDistinct,
-           rotation_group_count(heuristicIndex->heuristic->dataSymmetries),
-           rotation_cosets_count(heuristicIndex->heuristic->dataCosets));
+    if (tableCount > 1) {
+        printf("Found %lld, pruned %lld [depth=%d, indexes=%d].\n",
+               value, pruned, currentDepth, tableCount);
+    } else {
+        Heuristic * heuristic = tables[0].index->heuristic;
+        printf("Found %lld, pruned %lld [depth=%d, cosets=%d, angles=%d, syms=%d, data_cosets=%d].\n",
+               value, pruned, currentDepth, heuristic->cosetCount,
+               heuristic->angles->numDistinct,
+               rotation_group_count(heuristic->dataSymmetries),
+               rotation_cosets_count(heuristic->dataCosets));
+    }
     pthread_mutex_unlock(&globalMutex);
 }
 
 void indexer_handle_depth(void * data, int len) {
+    // the search threads are stopped while this is called
+    indexer_merge_batches();
+    int i;
+    for (i = 0; i < tableCount; i++) {
+        if (!tables[i].spill) continue;
+        indexer_spill_layers(&tables[i], currentDepth);
+        if (!index_spill_merge(tables[i].spill)) {
+            fprintf(stderr, "error: failed to merge the runs of spilled entries.\n");
+            exit(1);
+        }
+    }
+    indexer_clear_marks();
+    
+    // a periodic checkpoint resumes the search in the depth it was in
+    if (indexStats && len != currentDepth) {
+        indexer_write_stats();
+        index_stats_begin(indexStats, len, resumedSearch, indexer_stats_counts());
+    }
+    resumedSearch = 0;
+    
     pthread_mutex_lock(&globalMutex);
     printf("Exploring depth of %d.\n", len);
     currentDepth = len;
+    rootTables = 0;
+    for (i = 0; i < tableCount; i++) {
+        if (tables[i].arguments.maxDepth >= len) rootTables |= 1U << i;
+    }
     pthread_mutex_unlock(&globalMutex);
 }
 
@@ -210,51 +762,198 @@ int indexer_accepts_sequence(void * data, const int * sequence, int len, int dep
     return 1;
 }
 
-int indexer_accepts_cuboid(void * data, const Cuboid * cuboid, Cuboid * cache, int depthRem) {
+int indexer_accepts_cuboid(void * data, const Cuboid * cuboid, Cuboid * cache,
+                           int thread, int depthRem) {
+    int depth = currentDepth - depthRem;
+    uint32_t parent = indexer_parent_tables(thread, depth);
+    uint32_t accepted = 0;
     if (arguments.threadCount > 1) {
         pthread_mutex_lock(&globalMutex);
     }
-    int depth = currentDepth - depthRem;
-    int flag = heuristic_index_accepts_node(heuristicIndex, depth, currentDepth,
-                                            cuboid, cache);
+    int i;
+    for (i = 0; i < tableCount; i++) {
+        if (!(parent & (1U << i))) continue;
+        if (heuristic_index_accepts_node(tables[i].index, depth, thread, cuboid, cache)) {
+            accepted |= 1U << i;
+        }
+    }
     if (arguments.threadCount > 1) {
         pthread_mutex_unlock(&globalMutex);
     }
+    activeTables[thread][depth] = accepted;
+    if (indexStats) threadNodes[thread]++;
     
-    if (!flag) {
+    if (!accepted) {
         __sync_add_and_fetch(&nodesPruned, 1);
     }
-
-    return flag;
+    
+    return (accepted != 0);
 }
 
 void indexer_handle_cuboid(void * data, const Cuboid * cuboid, Cuboid * cache,
-                           const int * sequence, int len) {
-    if (arguments.threadCount > 1) {
-        pthread_mutex_lock(&globalMutex);
-    }
-    int added = heuristic_index_add_node(heuristicIndex, cuboid, cache, len);
-    if (arguments.threadCount > 1) {
-        pthread_mutex_unlock(&globalMutex);
-    }
-    if (added) {
-        __sync_fetch_and_add(&nodesAdded, 1);
+                           int thread, const int * sequence, int len) {
+    // nodes go into the thread's own batches, so no lock is needed until
+    // the batches fill up and have to be merged
+    uint32_t parent = indexer_parent_tables(thread, len);
+    if (indexStats) threadNodes[thread]++;
+    int i;
+    for (i = 0; i < tableCount; i++) {
+        if (!(parent & (1U << i))) continue;
+        IndexerTable * table = &tables[i];
+        heuristic_index_add_node(table->index, thread, cuboid, cache, len,
+                                 kHeuristicIndexNoMark);
+        if (indexStats) {
+            Heuristic * heuristic = table->index->heuristic;
+            threadInserts[thread] += heuristic->cosetCount * heuristic->angles->numDistinct;
+        }
+        if (!heuristic_index_batch_is_full(table->index, thread)) continue;
+        
+        if (arguments.threadCount > 1) {
+            pthread_mutex_lock(&globalMutex);
+        }
+        long long added = heuristic_index_merge(table->index, thread);
+        if (table->spill) indexer_spill_layers(table, currentDepth);
+        if (arguments.threadCount > 1) {
+            pthread_mutex_unlock(&globalMutex);
+        }
+        __sync_fetch_and_add(&nodesAdded, added);
     }
 }
 
 void indexer_handle_save_data(void * data, CSSearchState * save) {
-    puts("handle_save_data should never be called!");
-    abort();
+    if (!save->bsState->threadCount) {
+        // the last depth was finished before the stop was seen
+        cs_search_state_free(save);
+        return;
+    }
+    
+    indexer_merge_batches();
+    printf("Saving a checkpoint at depth %d to %s.\n", save->bsState->depth, checkpointName);
+    HeuristicIndex ** indexes = (HeuristicIndex **)malloc(sizeof(HeuristicIndex *) * tableCount);
+    IndexSpill ** spills = (IndexSpill **)malloc(sizeof(IndexSpill *) * tableCount);
+    int i;
+    for (i = 0; i < tableCount; i++) {
+        indexes[i] = tables[i].index;
+        spills[i] = tables[i].spill;
+    }
+    if (!index_checkpoint_save(checkpointName, commandCount, commandLine, indexes, spills,
+                               tableCount, nodesAdded, nodesPruned, save)) {
+        fprintf(stderr, "error: failed to write the checkpoint.\n");
+    } else {
+        for (i = 0; i < tableCount; i++) {
+            if (spills[i]) index_spill_collect(spills[i], 0);
+        }
+    }
+    free(indexes);
+    free(spills);
+    if (interrupted) {
+        cs_search_state_free(save);
+        savedCheckpoint = 1;
+    } else {
+        resumeState = save;
+    }
 }
 
 void indexer_handle_finished(void * data) {
-    cs_context_release(searchContext);
+    // the main thread owns the search context, and resumes it after a
+    // periodic checkpoint
+    if (resumeState) return;
+    if (savedCheckpoint) exit(0);
+    indexer_merge_batches();
+    if (indexStats) indexer_write_stats();
+    save_index();
+    exit(0);
+}
+
+void save_index() {
+    // the runs of spilled entries are kept until every index is written,
+    // since the checkpoint still needs them if one of them fails
+    int i, saved = 1;
+    for (i = 0; i < tableCount; i++) {
+        if (tables[i].spill) {
+            if (!save_spilled_table(&tables[i])) saved = 0;
+        } else {
+            if (!save_table(&tables[i])) saved = 0;
+        }
+    }
+    if (!saved) return;
+    if (checkpointName) unlink(checkpointName);
+    for (i = 0; i < tableCount; i++) {
+        if (tables[i].spill) index_spill_collect(tables[i].spill, 1);
+    }
+}
+
+int save_table(IndexerTable * table) {
+    // the second header byte is the mark which the indexer last accepted
+    // a node with; lookups only read the first
+    Heuristic * heuristic = table->index->heuristic;
+    IndexerArguments tableArgs = table->arguments;
+    int i;
+    for (i = 0; i < heuristic->cosetCount; i++) {
+        data_list_strip_header(heuristic->cosets[i], 1);
+    }
     
-    puts("Writing to output file...");
-    FILE * fp = fopen(fileName, "w");
-    save_heuristic(heuristicIndex->heuristic, fp);
-    fclose(fp);
-    heuristic_index_free(heuristicIndex);
+    if (tableArgs.shardDepth < 0 && !tableArgs.hashFlag) {
+        // splitting only ever made base nodes smaller, so sparse subtrees
+        // may be left with many tiny ones
+        for (i = 0; i < heuristic->cosetCount; i++) {
+            data_list_reshard(heuristic->cosets[i], kDataListTargetSize);
+        }
+    }
     
-    exit(0);
+    if (tableArgs.denseFlag) {
+        puts("Packing dense tables...");
+        if (!heuristic_make_dense(heuristic)) {
+            fprintf(stderr, "error: keys are too large for a dense table.\n");
+            fprintf(stderr, "note: saving the sorted table instead.\n");
+        }
+    }
+    
+    printf("Writing to %s...\n", table->fileName);
+    int result = heuristic_to_file(heuristic, table->fileName);
+    if (!result) {
+        fprintf(stderr, "error: failed to write the output file.\n");
+    }
+    heuristic_index_free(table->index);
+    table->index = NULL;
+    return result;
+}
+
+int save_spilled_table(IndexerTable * table) {
+    // every entry goes out to the runs, which are then written as the
+    // cosets of the output file with only their first header byte
+    puts("Merging spilled entries...");
+    int result = index_spill_finish(table->spill, table->index);
+    if (result) {
+        printf("Writing to %s...\n", table->fileName);
+        HeuristicCosetWriter writer = index_spill_writer(table->spill);
+        result = heuristic_to_file_with(table->index->heuristic, table->fileName, &writer);
+    }
+    if (!result) {
+        fprintf(stderr, "error: failed to write the output file.\n");
+    }
+    heuristic_index_free(table->index);
+    table->index = NULL;
+    return result;
+}
+
+/***********
+ * Batches *
+ ***********/
+
+uint32_t indexer_parent_tables(int thread, int len) {
+    // the search goes depth first, so the last node of length len - 1
+    // which a thread looked at is the parent of the node it is at
+    if (len > 1) return activeTables[thread][len - 1];
+    return rootTables;
+}
+
+void indexer_merge_batches() {
+    int i, j;
+    for (i = 0; i < tableCount; i++) {
+        for (j = 0; j < arguments.threadCount; j++) {
+            long long added = heuristic_index_merge(tables[i].index, j);
+            __sync_fetch_and_add(&nodesAdded, added);
+        }
+    }
 }
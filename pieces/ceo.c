@@ -1,6 +1,7 @@
 #include "ceo.h"
 
 static void _generate_center_map(const Cuboid * cuboid, uint16_t * centers);
+static void _generate_axis_maps(CEOContext * context);
 static void _generate_ceo_data(const Cuboid * cuboid, uint8_t * out,
                                const uint16_t * map, uint8_t axis);
 
@@ -46,6 +47,7 @@ CEOContext * ceo_context_create(RotationBasis sym) {
         cuboid_free(rot);
     }
     
+    _generate_axis_maps(context);
     return context;
 }
 
@@ -83,28 +85,45 @@ int ceo_context_data_size(CEOContext * context) {
 
 void ceo_context_get_data(CEOContext * context, const Cuboid * cb,
                           uint8_t * out, uint8_t axis) {
-    const uint16_t * map = NULL;
-    if (axis == 1) {
-      if (ceo_context_axis_compatibility(context, 1, 0)) {
-          map = context->z;
-          assert(map != NULL);
-      }
-    } else if (axis == 2) {
-      if (ceo_context_axis_compatibility(context, 2, 0)) {
-          map = context->y;
-          assert(map != NULL);
-      } else if (ceo_context_axis_compatibility(context, 2, 1)) {
-          map = context->x;
-          assert(map != NULL);
-      }
+    _generate_ceo_data(cb, out, context->axisMaps[axis], axis);
+}
+
+void ceo_context_get_all_data(CEOContext * context, const Cuboid * cb,
+                              uint8_t * out, int stride) {
+    // bit `axis` of faceAxes[side] is set if the face is normal to that axis
+    const static uint8_t faceAxes[7] = {0, 4, 4, 2, 2, 1, 1};
+    int i, axis, count = cuboid_count_centers(cb);
+    for (i = 0; i < count; i++) {
+        uint8_t bit = 1 << (i % 8);
+        uint8_t * bytes = &out[i / 8];
+        for (axis = 0; axis < 3; axis++) {
+            const uint16_t * map = context->axisMaps[axis];
+            CuboidCenter c = cb->centers[map ? map[i] : i];
+            if (faceAxes[c.side] & (1 << axis)) bytes[axis * stride] |= bit;
+        }
+    }
+}
+
+void ceo_context_transition(CEOContext * context, const Cuboid * operation,
+                            uint8_t axis, uint16_t * sources) {
+    const uint16_t * map = context->axisMaps[axis];
+    int i, count = cuboid_count_centers(operation);
+    uint16_t * unmapped = (uint16_t *)malloc(sizeof(uint16_t) * count);
+    for (i = 0; i < count; i++) {
+        unmapped[map ? map[i] : i] = i;
+    }
+    for (i = 0; i < count; i++) {
+        CuboidCenter opCenter = operation->centers[map ? map[i] : i];
+        int from = cuboid_center_index(operation, opCenter.side, opCenter.index);
+        sources[i] = unmapped[from];
     }
-    _generate_ceo_data(cb, out, map, axis);
+    free(unmapped);
 }
 
 void ceo_context_free(CEOContext * context) {
     if (context->x) free(context->x);
-    if (context->z) free(context->y);
-    if (context->y) free(context->z);
+    if (context->y) free(context->y);
+    if (context->z) free(context->z);
     free(context);
 }
 
@@ -120,6 +139,21 @@ static void _generate_center_map(const Cuboid * cuboid, uint16_t * centers) {
     }
 }
 
+static void _generate_axis_maps(CEOContext * context) {
+    // use the axis as our way of determining the rotation to use
+    if (ceo_context_axis_compatibility(context, 1, 0)) {
+        context->axisMaps[1] = context->z;
+        assert(context->z != NULL);
+    }
+    if (ceo_context_axis_compatibility(context, 2, 0)) {
+        context->axisMaps[2] = context->y;
+        assert(context->y != NULL);
+    } else if (ceo_context_axis_compatibility(context, 2, 1)) {
+        context->axisMaps[2] = context->x;
+        assert(context->x != NULL);
+    }
+}
+
 static void _generate_ceo_data(const Cuboid * cuboid, uint8_t * out,
                                const uint16_t * map, uint8_t axis) {
     int i, count = cuboid_count_centers(cuboid);
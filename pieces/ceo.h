@@ -10,6 +10,8 @@
 typedef struct {
     RotationBasis symmetries;
     uint16_t * x, * y, * z;
+    // the center map each axis is read through
+    const uint16_t * axisMaps[3];
 } CEOContext;
 
 uint8_t cuboid_center_orientation(int face, uint8_t axis);
@@ -19,4 +21,17 @@ int ceo_context_axis_compatibility(CEOContext * context, uint8_t a1, uint8_t a2)
 int ceo_context_data_size(CEOContext * context);
 void ceo_context_get_data(CEOContext * context, const Cuboid * cb,
                           uint8_t * out, uint8_t axis);
+
+/**
+ * Generates the data for all three axes in one pass over the centers.
+ * The data for axis i is written to out[i * stride]; like
+ * ceo_context_get_data(), this only sets bits, so `out` should be zeroed.
+ */
+void ceo_context_get_all_data(CEOContext * context, const Cuboid * cb,
+                              uint8_t * out, int stride);
+
+// when `operation` is applied, bit i of the data for `axis` becomes the old
+// bit sources[i]; centers never change which face they belong to.
+void ceo_context_transition(CEOContext * context, const Cuboid * operation,
+                            uint8_t axis, uint16_t * sources);
 void ceo_context_free(CEOContext * context);
@@ -1,6 +1,7 @@
 #include "co.h"
 
 static void _generate_corner_map(const Cuboid * cb, uint8_t * translation);
+static void _generate_axis_maps(COContext * context);
 static uint16_t _corner_orientations(const Cuboid * cb, const uint8_t * map,
                                      uint8_t symmetry, uint8_t axis);
 
@@ -47,6 +48,7 @@ COContext * co_context_create(RotationBasis sym) {
         cuboid_free(rot);
     }
     
+    _generate_axis_maps(context);
     return context;
 }
 
@@ -72,32 +74,58 @@ int co_context_axis_compatibility(COContext * context, uint8_t a1, uint8_t a2) {
 }
 
 uint16_t co_context_get_data(COContext * context, const Cuboid * cb, uint8_t axis) {
-    uint8_t rotSymmetry = 0;
-    const uint8_t * map = NULL;
-    if (axis == 1) {
-        if (co_context_axis_compatibility(context, 1, 0)) {
-            map = context->z;
-            rotSymmetry = 1;
-            assert(map != NULL);
+    return _corner_orientations(cb, context->axisMaps[axis],
+                                context->axisSymmetries[axis], axis);
+}
+
+void co_context_get_all_data(COContext * context, const Cuboid * cb, uint16_t * out) {
+    int i, axis;
+    out[0] = out[1] = out[2] = 0;
+    for (i = 0; i < 8; i++) {
+        for (axis = 0; axis < 3; axis++) {
+            const uint8_t * map = context->axisMaps[axis];
+            CuboidCorner c = cb->corners[map ? map[i] : i];
+            uint8_t useSym = symmetry3_operation_compose(context->axisSymmetries[axis],
+                                                         c.symmetry);
+            uint8_t orientation = cuboid_corner_orientation(useSym, axis);
+            out[axis] |= (orientation << (i * 2));
         }
-    } else if (axis == 2) {
-        if (co_context_axis_compatibility(context, 2, 0)) {
-            map = context->y;
-            rotSymmetry = 3;
-            assert(map != NULL);
-        } else if (co_context_axis_compatibility(context, 2, 1)) {
-            map = context->x;
-            rotSymmetry = 2;
-            assert(map != NULL);
+    }
+}
+
+int co_context_transition(COContext * context, const Cuboid * operation, uint8_t axis,
+                          uint8_t * sources, uint8_t * values) {
+    const uint8_t * map = context->axisMaps[axis];
+    uint8_t rotSymmetry = context->axisSymmetries[axis];
+    uint8_t unmapped[8];
+    int i, symmetry;
+    for (i = 0; i < 8; i++) {
+        unmapped[map ? map[i] : i] = i;
+    }
+    
+    for (i = 0; i < 8; i++) {
+        CuboidCorner opCorner = operation->corners[map ? map[i] : i];
+        sources[i] = unmapped[opCorner.index];
+        
+        int known[3] = {0, 0, 0};
+        for (symmetry = 0; symmetry < 6; symmetry++) {
+            int newSymmetry = symmetry3_operation_compose(opCorner.symmetry, symmetry);
+            int oldValue = cuboid_corner_orientation(symmetry3_operation_compose(rotSymmetry,
+                                                                                 symmetry), axis);
+            int newValue = cuboid_corner_orientation(symmetry3_operation_compose(rotSymmetry,
+                                                                                 newSymmetry), axis);
+            if (known[oldValue] && values[i * 3 + oldValue] != newValue) return 0;
+            known[oldValue] = 1;
+            values[i * 3 + oldValue] = newValue;
         }
     }
-    return _corner_orientations(cb, map, rotSymmetry, axis);
+    return 1;
 }
 
 void co_context_free(COContext * context) {
     if (context->x) free(context->x);
-    if (context->z) free(context->y);
-    if (context->y) free(context->z);
+    if (context->y) free(context->y);
+    if (context->z) free(context->z);
     free(context);
 }
 
@@ -112,6 +140,24 @@ static void _generate_corner_map(const Cuboid * cb, uint8_t * translation) {
     }
 }
 
+static void _generate_axis_maps(COContext * context) {
+    // use the axis as our way of determining the rotation to use
+    if (co_context_axis_compatibility(context, 1, 0)) {
+        context->axisMaps[1] = context->z;
+        context->axisSymmetries[1] = 1;
+        assert(context->z != NULL);
+    }
+    if (co_context_axis_compatibility(context, 2, 0)) {
+        context->axisMaps[2] = context->y;
+        context->axisSymmetries[2] = 3;
+        assert(context->y != NULL);
+    } else if (co_context_axis_compatibility(context, 2, 1)) {
+        context->axisMaps[2] = context->x;
+        context->axisSymmetries[2] = 2;
+        assert(context->x != NULL);
+    }
+}
+
 static uint16_t _corner_orientations(const Cuboid * cb, const uint8_t * map,
                                      uint8_t symmetry, uint8_t axis) {
     int i;
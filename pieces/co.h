@@ -10,6 +10,9 @@
 typedef struct {
     RotationBasis symmetries;
     uint8_t * x, * y, * z;
+    // the corner map and symmetry each axis is read through
+    const uint8_t * axisMaps[3];
+    uint8_t axisSymmetries[3];
 } COContext;
 
 uint8_t cuboid_corner_orientation(uint8_t symmetry, uint8_t axis);
@@ -17,4 +20,11 @@ uint8_t cuboid_corner_orientation(uint8_t symmetry, uint8_t axis);
 COContext * co_context_create(RotationBasis sym);
 int co_context_axis_compatibility(COContext * context, uint8_t a1, uint8_t a2);
 uint16_t co_context_get_data(COContext * context, const Cuboid * cb, uint8_t axis);
+void co_context_get_all_data(COContext * context, const Cuboid * cb, uint16_t * out);
+
+// finds how the data for `axis` changes when `operation` is applied: the
+// orientation of corner i becomes values[i * 3 + o], where o is the old
+// orientation of corner sources[i]. Returns 0 if it cannot be derived.
+int co_context_transition(COContext * context, const Cuboid * operation, uint8_t axis,
+                          uint8_t * sources, uint8_t * values);
 void co_context_free(COContext * context);
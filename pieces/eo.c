@@ -1,6 +1,11 @@
 #include "eo.h"
+#include "algebra/basis.h"
 
 static void _rotation_to_map(const Cuboid * rotation, uint16_t * edgeSlots);
+static void _generate_orientation_table(EOContext * context);
+static void _generate_reachable_table(EOContext * context);
+static void _add_reachable_steps(const Cuboid * move, uint8_t steps[12][12]);
+static uint16_t * _axis_rotation(EOContext * context, int axis);
 static void _generate_edge_data(uint8_t * out, uint16_t * rotation,
                                 const Cuboid * cb, int axis);
 
@@ -35,6 +40,20 @@ uint8_t cuboid_edge_orientation(CuboidEdge edge, int physicalDedge,
     }
 }
 
+int cuboid_count_flippable_edges(const Cuboid * operation, int relativeAxis) {
+    // an edge changes its orientation exactly when the operation's own edge
+    // in that slot is bad, whatever piece sits there
+    int i, j, count = 0;
+    for (i = 0; i < 12; i++) {
+        int edgeCount = cuboid_count_edges_for_dedge(operation, i);
+        for (j = 0; j < edgeCount; j++) {
+            CuboidEdge edge = operation->edges[cuboid_edge_index(operation, i, j)];
+            if (!cuboid_edge_orientation(edge, i, relativeAxis)) count++;
+        }
+    }
+    return count;
+}
+
 EOContext * eo_context_create(RotationBasis symmetries) {
     CuboidDimensions dims = symmetries.dims;
     EOContext * context = (EOContext *)malloc(sizeof(EOContext));
@@ -72,7 +91,9 @@ EOContext * eo_context_create(RotationBasis symmetries) {
         _rotation_to_map(rot, context->z);
         cuboid_free(rot);
     }
-        
+    
+    _generate_orientation_table(context);
+    _generate_reachable_table(context);
     return context;
 }
 
@@ -110,24 +131,99 @@ int eo_context_compact_data_length(EOContext * context) {
 
 void eo_context_get_compact_data(EOContext * context, const Cuboid * cb,
                                  uint8_t * out, int axis) {
-    uint16_t * dedgeRotation = NULL;
-    // use the axis as our way of determining the rotation to use
-    if (axis == 1) {
-        if (eo_context_axis_compatibility(context, 1, 0)) {
-            dedgeRotation = context->z;
-            assert(dedgeRotation != NULL);
+    uint16_t * dedgeRotation = _axis_rotation(context, axis);
+    bzero(out, eo_context_compact_data_length(context));
+    _generate_edge_data(out, dedgeRotation, cb, axis);
+}
+
+void eo_context_get_all_compact_data(EOContext * context, const Cuboid * cb,
+                                     uint8_t * out, int stride) {
+    uint16_t * rotations[3];
+    int axis;
+    for (axis = 0; axis < 3; axis++) {
+        rotations[axis] = _axis_rotation(context, axis);
+        bzero(&out[axis * stride], eo_context_compact_data_length(context));
+    }
+    int sameRotation = (rotations[0] == rotations[1] && rotations[1] == rotations[2]);
+    
+    int dedgeIndex, edgeIndex;
+    for (dedgeIndex = 0; dedgeIndex < 12; dedgeIndex++) {
+        int edgeCount = cuboid_count_edges_for_dedge(cb, dedgeIndex);
+        for (edgeIndex = 0; edgeIndex < edgeCount; edgeIndex++) {
+            int i = cuboid_edge_index(cb, dedgeIndex, edgeIndex);
+            uint8_t bit = 1 << (i % 8);
+            uint8_t * bytes = &out[i / 8];
+            
+            if (sameRotation) {
+                // every axis reads the same edge, so one lookup gives all three
+                CuboidEdge edge = cb->edges[rotations[0] ? rotations[0][i] : i];
+                uint8_t mask = context->orientations[dedgeIndex][edge.dedgeIndex][edge.symmetry];
+                if (mask & 1) bytes[0] |= bit;
+                if (mask & 2) bytes[stride] |= bit;
+                if (mask & 4) bytes[stride * 2] |= bit;
+                continue;
+            }
+            
+            for (axis = 0; axis < 3; axis++) {
+                int index = rotations[axis] ? rotations[axis][i] : i;
+                CuboidEdge edge = cb->edges[index];
+                uint8_t mask = context->orientations[dedgeIndex][edge.dedgeIndex][edge.symmetry];
+                if (mask & (1 << axis)) bytes[axis * stride] |= bit;
+            }
         }
-    } else if (axis == 2) {
-        if (eo_context_axis_compatibility(context, 2, 0)) {
-            dedgeRotation = context->y;
-            assert(dedgeRotation != NULL);
-        } else if (eo_context_axis_compatibility(context, 2, 1)) {
-            dedgeRotation = context->x;
-            assert(dedgeRotation != NULL);
+    }
+}
+
+int eo_context_transition(EOContext * context, const Cuboid * operation, int axis,
+                          uint16_t * sources, uint8_t * values) {
+    uint16_t * rotation = _axis_rotation(context, axis);
+    int i, edgeCount = cuboid_count_edges(operation);
+    uint16_t * unrotated = (uint16_t *)malloc(sizeof(uint16_t) * edgeCount);
+    uint8_t * slotDedges = (uint8_t *)malloc(edgeCount);
+    
+    int dedgeIndex, edgeIndex;
+    for (dedgeIndex = 0; dedgeIndex < 12; dedgeIndex++) {
+        int count = cuboid_count_edges_for_dedge(operation, dedgeIndex);
+        for (edgeIndex = 0; edgeIndex < count; edgeIndex++) {
+            i = cuboid_edge_index(operation, dedgeIndex, edgeIndex);
+            slotDedges[i] = dedgeIndex;
+            unrotated[rotation ? rotation[i] : i] = i;
         }
     }
-    bzero(out, eo_context_compact_data_length(context));
-    _generate_edge_data(out, dedgeRotation, cb, axis);
+    
+    int consistent = 1;
+    for (i = 0; i < edgeCount && consistent; i++) {
+        // the edge which bit i reads comes from the old edge at `from`
+        CuboidEdge opEdge = operation->edges[rotation ? rotation[i] : i];
+        int from = cuboid_edge_index(operation, opEdge.dedgeIndex, opEdge.edgeIndex);
+        int source = unrotated[from];
+        sources[i] = source;
+        
+        // the new bit has to be the same function of the old bit for
+        // every piece and symmetry which could be there
+        int piece, symmetry, known[2] = {0, 0};
+        values[i * 2] = values[i * 2 + 1] = 0;
+        for (piece = 0; piece < 12; piece++) {
+            for (symmetry = 0; symmetry < 6; symmetry++) {
+                // the old edge physically sits in the slot it moves from
+                if (!(context->reachable[slotDedges[from]][piece] & (1 << symmetry))) {
+                    continue;
+                }
+                int newSymmetry = symmetry3_operation_compose(opEdge.symmetry, symmetry);
+                int oldBit = (context->orientations[slotDedges[source]][piece][symmetry] >> axis) & 1;
+                int newBit = (context->orientations[slotDedges[i]][piece][newSymmetry] >> axis) & 1;
+                if (known[oldBit] && values[i * 2 + oldBit] != newBit) {
+                    consistent = 0;
+                }
+                known[oldBit] = 1;
+                values[i * 2 + oldBit] = newBit;
+            }
+        }
+    }
+    
+    free(unrotated);
+    free(slotDedges);
+    return consistent;
 }
 
 void eo_context_free(EOContext * context) {
@@ -150,6 +246,106 @@ static void _rotation_to_map(const Cuboid * rotation, uint16_t * edgeSlots) {
     }
 }
 
+static void _generate_orientation_table(EOContext * context) {
+    int slot, piece, symmetry, axis;
+    for (slot = 0; slot < 12; slot++) {
+        for (piece = 0; piece < 12; piece++) {
+            for (symmetry = 0; symmetry < 6; symmetry++) {
+                CuboidEdge edge;
+                bzero(&edge, sizeof(edge));
+                edge.dedgeIndex = piece;
+                edge.symmetry = symmetry;
+                uint8_t mask = 0;
+                for (axis = 0; axis < 3; axis++) {
+                    if (cuboid_edge_orientation(edge, slot, axis)) {
+                        mask |= 1 << axis;
+                    }
+                }
+                context->orientations[slot][piece][symmetry] = mask;
+            }
+        }
+    }
+}
+
+static void _generate_reachable_table(EOContext * context) {
+    // steps[from][to] has bit t set if some move takes an edge from dedge
+    // `from` to dedge `to` and composes its symmetry with t
+    uint8_t steps[12][12];
+    bzero(steps, sizeof(steps));
+    
+    CuboidDimensions dims = context->symmetries.dims;
+    AlgList * basis = cuboid_standard_basis(dims);
+    int i;
+    for (i = 0; i < basis->entryCount; i++) {
+        _add_reachable_steps(basis->entries[i].cuboid, steps);
+    }
+    alg_list_release(basis);
+    
+    RotationGroup * rotations = rotation_group_create_basis(rotation_basis_standard(dims));
+    for (i = 0; i < rotation_group_count(rotations); i++) {
+        _add_reachable_steps(rotation_group_get(rotations, i), steps);
+    }
+    rotation_group_release(rotations);
+    
+    // every edge starts out solved, then spreads until nothing changes
+    int from, to, piece, step, symmetry, changed = 1;
+    bzero(context->reachable, sizeof(context->reachable));
+    for (piece = 0; piece < 12; piece++) {
+        context->reachable[piece][piece] = 1;
+    }
+    while (changed) {
+        changed = 0;
+        for (from = 0; from < 12; from++) {
+            for (to = 0; to < 12; to++) {
+                if (!steps[from][to]) continue;
+                for (piece = 0; piece < 12; piece++) {
+                    uint8_t old = context->reachable[to][piece];
+                    for (step = 0; step < 6; step++) {
+                        if (!(steps[from][to] & (1 << step))) continue;
+                        for (symmetry = 0; symmetry < 6; symmetry++) {
+                            if (!(context->reachable[from][piece] & (1 << symmetry))) continue;
+                            int result = symmetry3_operation_compose(step, symmetry);
+                            context->reachable[to][piece] |= 1 << result;
+                        }
+                    }
+                    if (context->reachable[to][piece] != old) changed = 1;
+                }
+            }
+        }
+    }
+}
+
+static void _add_reachable_steps(const Cuboid * move, uint8_t steps[12][12]) {
+    int dedgeIndex, edgeIndex;
+    for (dedgeIndex = 0; dedgeIndex < 12; dedgeIndex++) {
+        int count = cuboid_count_edges_for_dedge(move, dedgeIndex);
+        for (edgeIndex = 0; edgeIndex < count; edgeIndex++) {
+            CuboidEdge edge = move->edges[cuboid_edge_index(move, dedgeIndex, edgeIndex)];
+            steps[edge.dedgeIndex][dedgeIndex] |= 1 << edge.symmetry;
+        }
+    }
+}
+
+static uint16_t * _axis_rotation(EOContext * context, int axis) {
+    uint16_t * dedgeRotation = NULL;
+    // use the axis as our way of determining the rotation to use
+    if (axis == 1) {
+        if (eo_context_axis_compatibility(context, 1, 0)) {
+            dedgeRotation = context->z;
+            assert(dedgeRotation != NULL);
+        }
+    } else if (axis == 2) {
+        if (eo_context_axis_compatibility(context, 2, 0)) {
+            dedgeRotation = context->y;
+            assert(dedgeRotation != NULL);
+        } else if (eo_context_axis_compatibility(context, 2, 1)) {
+            dedgeRotation = context->x;
+            assert(dedgeRotation != NULL);
+        }
+    }
+    return dedgeRotation;
+}
+
 static void _generate_edge_data(uint8_t * out, uint16_t * rotation,
                                 const Cuboid * cuboid, int axis) {
     int dedgeIndex, edgeIndex;
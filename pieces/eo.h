@@ -7,6 +7,12 @@ typedef struct {
     RotationBasis symmetries;
     // edge coordinate translations
     uint16_t * x, * y, * z;
+    // orientations[slot dedge][piece dedge][symmetry] has bit `axis` set
+    // if an edge is good along that axis
+    uint8_t orientations[12][12][6];
+    // reachable[slot dedge][piece dedge] has bit `symmetry` set if the
+    // standard moves and rotations can put such an edge there
+    uint8_t reachable[12][12];
 } EOContext;
 
 /**
@@ -22,9 +28,31 @@ typedef struct {
 uint8_t cuboid_edge_orientation(CuboidEdge edge, int physicalDedge,
                                 int relativeAxis);
 
+/**
+ * Counts the edges whose orientation along `relativeAxis` applying
+ * `operation` to a cuboid may change, whatever the cuboid is.
+ */
+int cuboid_count_flippable_edges(const Cuboid * operation, int relativeAxis);
+
 EOContext * eo_context_create(RotationBasis symmetries);
 int eo_context_axis_compatibility(EOContext * context, int a1, int a2);
 int eo_context_compact_data_length(EOContext * context);
 void eo_context_get_compact_data(EOContext * context, const Cuboid * cb,
                                  uint8_t * out, int axis);
+
+/**
+ * Generates the compact data for all three axes in one pass over the
+ * edges. The data for axis i is written to out[i * stride].
+ */
+void eo_context_get_all_compact_data(EOContext * context, const Cuboid * cb,
+                                     uint8_t * out, int stride);
+
+/**
+ * Finds how the compact data for `axis` changes when `operation` is
+ * applied to a cuboid: bit i of the new data is values[i * 2 + v],
+ * where v is bit sources[i] of the old data.
+ * @return 0 if the new data does not follow from the old data alone.
+ */
+int eo_context_transition(EOContext * context, const Cuboid * operation, int axis,
+                          uint16_t * sources, uint8_t * values);
 void eo_context_free(EOContext * context);
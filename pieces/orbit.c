@@ -0,0 +1,186 @@
+#include "orbit.h"
+
+static int _orbit_find(int * parents, int slot);
+static int _orbit_slots(CuboidDimensions dims, int slot, int isEdge,
+                        uint16_t * slotsOut);
+
+int orbit_center_slots(CuboidDimensions dims, int slot, uint16_t * slotsOut) {
+    return _orbit_slots(dims, slot, 0, slotsOut);
+}
+
+int orbit_edge_slots(CuboidDimensions dims, int slot, uint16_t * slotsOut) {
+    return _orbit_slots(dims, slot, 1, slotsOut);
+}
+
+uint64_t orbit_binomial(int n, int k) {
+    if (k < 0 || k > n) return 0;
+    if (k > n - k) k = n - k;
+    uint64_t result = 1;
+    int i;
+    for (i = 0; i < k; i++) {
+        result = result * (n - i) / (i + 1);
+    }
+    return result;
+}
+
+uint64_t orbit_rank_classes(const uint8_t * classes, int count,
+                            const int * classSizes, int classCount) {
+    // each class is a combination of the slots which the classes before it
+    // left over, and the combinations are the digits of a mixed radix number
+    uint64_t rank = 0, scale = 1;
+    int c, i, remaining = count;
+    for (c = 0; c < classCount; c++) {
+        uint64_t digit = 0;
+        int position = 0, chosen = 0;
+        for (i = 0; i < count; i++) {
+            if (classes[i] < c) continue;
+            if (classes[i] == c) {
+                chosen++;
+                digit += orbit_binomial(position, chosen);
+            }
+            position++;
+        }
+        rank += digit * scale;
+        scale *= orbit_binomial(remaining, classSizes[c]);
+        remaining -= classSizes[c];
+    }
+    return rank;
+}
+
+uint64_t orbit_classes_rank_count(int count, const int * classSizes, int classCount) {
+    uint64_t result = 1;
+    int c, remaining = count;
+    for (c = 0; c < classCount; c++) {
+        result *= orbit_binomial(remaining, classSizes[c]);
+        remaining -= classSizes[c];
+    }
+    return result;
+}
+
+uint64_t orbit_rank_positions(const uint8_t * positions, int pieceCount, int count) {
+    // piece i is in one of the count - i slots which the pieces before it
+    // left over
+    uint64_t rank = 0, scale = 1;
+    int i, j;
+    for (i = 0; i < pieceCount; i++) {
+        int digit = positions[i];
+        for (j = 0; j < i; j++) {
+            if (positions[j] < positions[i]) digit--;
+        }
+        rank += digit * scale;
+        scale *= count - i;
+    }
+    return rank;
+}
+
+uint64_t orbit_positions_rank_count(int pieceCount, int count) {
+    uint64_t result = 1;
+    int i;
+    for (i = 0; i < pieceCount; i++) {
+        result *= count - i;
+    }
+    return result;
+}
+
+uint64_t orbit_rank_groups(const uint8_t * labels, int count, int groupSize) {
+    // the first free slot starts each group, so a group's digit is the
+    // combination of its other slots among the free slots after that one
+    uint8_t used[count];
+    bzero(used, count);
+    uint64_t rank = 0, scale = 1;
+    int i, j, remaining = count;
+    for (i = 0; i < count; i++) {
+        if (used[i]) continue;
+        uint64_t digit = 0;
+        int position = 0, chosen = 0;
+        used[i] = 1;
+        for (j = i + 1; j < count; j++) {
+            if (used[j]) continue;
+            if (labels[j] == labels[i]) {
+                used[j] = 1;
+                chosen++;
+                digit += orbit_binomial(position, chosen);
+            }
+            position++;
+        }
+        rank += digit * scale;
+        scale *= orbit_binomial(remaining - 1, groupSize - 1);
+        remaining -= groupSize;
+    }
+    return rank;
+}
+
+uint64_t orbit_groups_rank_count(int count, int groupSize) {
+    uint64_t result = 1;
+    int remaining;
+    for (remaining = count; remaining > 0; remaining -= groupSize) {
+        result *= orbit_binomial(remaining - 1, groupSize - 1);
+    }
+    return result;
+}
+
+int orbit_rank_bytes(uint64_t rankCount) {
+    int bytes = 1;
+    uint64_t maxRank = rankCount - 1;
+    while (bytes < 8 && (maxRank >> (bytes * 8))) bytes++;
+    return bytes;
+}
+
+void orbit_save_rank(uint64_t rank, uint8_t * out, int byteCount) {
+    int i;
+    for (i = 0; i < byteCount; i++) {
+        out[i] = (rank >> (i * 8)) & 0xff;
+    }
+}
+
+/***********
+ * Private *
+ ***********/
+
+static int _orbit_find(int * parents, int slot) {
+    while (parents[slot] != slot) {
+        parents[slot] = parents[parents[slot]];
+        slot = parents[slot];
+    }
+    return slot;
+}
+
+static int _orbit_slots(CuboidDimensions dims, int slot, int isEdge,
+                        uint16_t * slotsOut) {
+    AlgList * basis = cuboid_standard_basis(dims);
+    Cuboid * reference = cuboid_create(dims);
+    int slotCount = isEdge ? cuboid_count_edges(reference) : cuboid_count_centers(reference);
+    int * parents = (int *)malloc(sizeof(int) * slotCount);
+    int i, j;
+    for (i = 0; i < slotCount; i++) {
+        parents[i] = i;
+    }
+    
+    // every move joins the slot a piece comes from with the slot it goes to
+    for (i = 0; i < basis->entryCount; i++) {
+        Cuboid * op = basis->entries[i].cuboid;
+        for (j = 0; j < slotCount; j++) {
+            int source;
+            if (isEdge) {
+                CuboidEdge edge = op->edges[j];
+                source = cuboid_edge_index(op, edge.dedgeIndex, edge.edgeIndex);
+            } else {
+                CuboidCenter center = op->centers[j];
+                source = cuboid_center_index(op, center.side, center.index);
+            }
+            parents[_orbit_find(parents, source)] = _orbit_find(parents, j);
+        }
+    }
+    
+    int count = 0, root = _orbit_find(parents, slot);
+    for (i = 0; i < slotCount; i++) {
+        if (_orbit_find(parents, i) == root) {
+            slotsOut[count++] = i;
+        }
+    }
+    
+    free(parents);
+    cuboid_free(reference);
+    alg_list_release(basis);
+    return count;
+}
@@ -0,0 +1,40 @@
+/**
+ * Orbits of center and edge pieces
+ *
+ * On a big cube, the moves can only bring a center or an edge to a subset
+ * of the slots, its orbit. The pieces of an orbit can be indexed by ranking
+ * how they are arranged among its slots.
+ */
+
+#include "representation/cuboid_base.h"
+#include "algebra/basis.h"
+
+// finds the slots which the moves of the standard basis can bring the piece
+// in `slot` to, in increasing order. `slotsOut` must have room for all of
+// the slots of that kind. Returns the number of slots in the orbit.
+int orbit_center_slots(CuboidDimensions dims, int slot, uint16_t * slotsOut);
+int orbit_edge_slots(CuboidDimensions dims, int slot, uint16_t * slotsOut);
+
+uint64_t orbit_binomial(int n, int k);
+
+// ranks which slots hold the pieces of each class; classes[i] is the class
+// of the piece in slot i, and classCount stands for an untracked piece.
+// classSizes[c] is how many slots hold class c.
+uint64_t orbit_rank_classes(const uint8_t * classes, int count,
+                            const int * classSizes, int classCount);
+uint64_t orbit_classes_rank_count(int count, const int * classSizes, int classCount);
+
+// ranks where `pieceCount` distinct pieces are; positions[i] is the slot of
+// piece i, and no two pieces share a slot.
+uint64_t orbit_rank_positions(const uint8_t * positions, int pieceCount, int count);
+uint64_t orbit_positions_rank_count(int pieceCount, int count);
+
+// ranks how the slots are split into groups of `groupSize`; slots i and j
+// are in the same group if labels[i] == labels[j]. The groups are ordered by
+// their first slot, so the rank does not depend on the labels themselves.
+uint64_t orbit_rank_groups(const uint8_t * labels, int count, int groupSize);
+uint64_t orbit_groups_rank_count(int count, int groupSize);
+
+// the number of bytes which hold any rank below `rankCount`
+int orbit_rank_bytes(uint64_t rankCount);
+void orbit_save_rank(uint64_t rank, uint8_t * out, int byteCount);
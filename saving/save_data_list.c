@@ -1,13 +1,39 @@
 #include "save_data_list.h"
 
+// set in the saved depth if the list is backed by a HashDataList
+#define kDataListHashedFlag 0x80000000
+
+// the parameters of save_data_list_records()
+typedef struct {
+    int dataSize;
+    int headerLen;
+    int depth;
+    unsigned long long targetSize;
+    int buildHeaderLen;
+    FILE * fp;
+} SaveRecords;
+
 static void _save_data_list_node(DataListNode * node, FILE * fp);
+static unsigned long long _save_data_list_node_size(DataListNode * node);
 static DataListNode * _load_data_list_node(DataList * parent, FILE * fp);
 static DataListNode ** _load_subnodes(DataList * parent, int count, FILE * fp);
 static int _load_data(uint64_t * lenOut, uint8_t ** dataOut, FILE * fp);
+static void _save_hash_data_list(HashDataList * hash, FILE * fp);
+static HashDataList * _load_hash_data_list(int dataSize, int headerLen, FILE * fp);
+
+static unsigned long long _save_records_node(SaveRecords * save, const uint8_t * records,
+                                             unsigned long long count, int depth,
+                                             uint8_t nodeByte);
 
 void save_data_list(DataList * list, FILE * fp) {
+    assert(!list->frozen);
     save_uint32(list->dataSize, fp);
     save_uint32(list->headerLen, fp);
+    if (list->hash) {
+        save_uint32(kDataListHashedFlag, fp);
+        _save_hash_data_list(list->hash, fp);
+        return;
+    }
     save_uint32(list->depth, fp);
     _save_data_list_node((DataListNode *)list->rootNode, fp);
 }
@@ -18,9 +44,20 @@ DataList * load_data_list(FILE * fp) {
     if (!load_uint32(&headerLen, fp)) return NULL;
     if (!load_uint32(&depth, fp)) return NULL;
     DataList * list = (DataList *)malloc(sizeof(DataList));
+    bzero(list, sizeof(DataList));
     list->dataSize = dataSize;
     list->headerLen = headerLen;
     list->depth = depth;
+    if (depth & kDataListHashedFlag) {
+        list->depth = 0;
+        list->rootNode = NULL;
+        list->hash = _load_hash_data_list(dataSize, headerLen, fp);
+        if (!list->hash) {
+            free(list);
+            return NULL;
+        }
+        return list;
+    }
     DataListNode * root = _load_data_list_node(list, fp);
     if (!root) {
         free(list);
@@ -30,6 +67,28 @@ DataList * load_data_list(FILE * fp) {
     return list;
 }
 
+unsigned long long save_data_list_size(DataList * list) {
+    assert(!list->frozen);
+    unsigned long long size = 12;
+    if (list->hash) {
+        return size + 16 + list->hash->groupCount * list->hash->groupSize;
+    }
+    return size + _save_data_list_node_size((DataListNode *)list->rootNode);
+}
+
+unsigned long long save_data_list_records(const uint8_t * records, unsigned long long count,
+                                          int dataSize, int headerLen, int depth,
+                                          unsigned long long targetSize, int buildHeaderLen,
+                                          FILE * fp) {
+    SaveRecords save = {dataSize, headerLen, depth, targetSize, buildHeaderLen, fp};
+    if (fp) {
+        save_uint32(dataSize, fp);
+        save_uint32(headerLen, fp);
+        save_uint32(depth, fp);
+    }
+    return 12 + _save_records_node(&save, records, count, 0, 0);
+}
+
 /***********
  * Private *
  ***********/
@@ -37,10 +96,10 @@ DataList * load_data_list(FILE * fp) {
 static void _save_data_list_node(DataListNode * node, FILE * fp) {
     int i;
     
-    save_uint8(node->nodeByte, fp);
-    save_uint8(node->depth, fp);
-    
-    save_uint16(node->subnodeCount, fp);
+    // the header goes out in one write, since there is one per node
+    uint8_t header[] = {node->nodeByte, node->depth, node->subnodeCount & 0xff,
+                        (node->subnodeCount >> 8) & 0xff};
+    fwrite(header, 1, 4, fp);
     for (i = 0; i < node->subnodeCount; i++) {
         DataListNode * subnode = (DataListNode *)node->subnodes[i];
         _save_data_list_node(subnode, fp);
@@ -52,6 +111,15 @@ static void _save_data_list_node(DataListNode * node, FILE * fp) {
     }
 }
 
+static unsigned long long _save_data_list_node_size(DataListNode * node) {
+    unsigned long long size = 12 + node->dataSize;
+    int i;
+    for (i = 0; i < node->subnodeCount; i++) {
+        size += _save_data_list_node_size((DataListNode *)node->subnodes[i]);
+    }
+    return size;
+}
+
 static DataListNode * _load_data_list_node(DataList * parent, FILE * fp) {
     int i;
     uint8_t nodeByte, depth;
@@ -122,3 +190,79 @@ static int _load_data(uint64_t * lenOut, uint8_t ** dataOut, FILE * fp) {
     *dataOut = data;
     return 1;
 }
+
+static unsigned long long _save_records_node(SaveRecords * save, const uint8_t * records,
+                                             unsigned long long count, int depth,
+                                             uint8_t nodeByte) {
+    // the entries of a node leave out the bytes which its path gives
+    int recordSize = save->dataSize + save->headerLen;
+    unsigned long long i, entrySize = recordSize - depth;
+    int isBase = (depth >= save->depth);
+    if (save->targetSize) {
+        // the list splits a base node once it outgrows twice the target,
+        // and data_list_reshard() joins the nodes which fit in the target
+        unsigned long long buildSize = count * (save->dataSize + save->buildHeaderLen - depth);
+        if (buildSize <= save->targetSize * 2) isBase = 1;
+        if (count * entrySize <= save->targetSize) isBase = 1;
+    }
+    
+    unsigned long long groups = 0;
+    if (!isBase) {
+        for (i = 0; i < count; i++) {
+            if (i == 0 || records[i * recordSize + depth] != records[(i - 1) * recordSize + depth]) {
+                groups++;
+            }
+        }
+    }
+    if (save->fp) {
+        uint8_t header[] = {nodeByte, depth, groups & 0xff, (groups >> 8) & 0xff};
+        fwrite(header, 1, 4, save->fp);
+    }
+    
+    unsigned long long size = 12;
+    if (isBase) {
+        size += count * entrySize;
+        if (!save->fp) return size;
+        save_uint64(count * entrySize, save->fp);
+        for (i = 0; i < count; i++) {
+            const uint8_t * record = &records[i * recordSize];
+            fwrite(&record[save->dataSize], 1, save->headerLen, save->fp);
+            fwrite(&record[depth], 1, save->dataSize - depth, save->fp);
+        }
+        return size;
+    }
+    
+    unsigned long long start = 0;
+    for (i = 1; i <= count; i++) {
+        if (i < count && records[i * recordSize + depth] == records[start * recordSize + depth]) {
+            continue;
+        }
+        size += _save_records_node(save, &records[start * recordSize], i - start, depth + 1,
+                                   records[start * recordSize + depth]);
+        start = i;
+    }
+    if (save->fp) save_uint64(0, save->fp);
+    return size;
+}
+
+static void _save_hash_data_list(HashDataList * hash, FILE * fp) {
+    save_uint64(hash->groupCount, fp);
+    save_uint64(hash->count, fp);
+    fwrite(hash->groups, 1, hash->groupCount * hash->groupSize, fp);
+}
+
+static HashDataList * _load_hash_data_list(int dataSize, int headerLen, FILE * fp) {
+    uint64_t groupCount, count;
+    if (!load_uint64(&groupCount, fp)) return NULL;
+    if (!load_uint64(&count, fp)) return NULL;
+    if (groupCount == 0 || (groupCount & (groupCount - 1))) return NULL;
+    
+    HashDataList * hash = hash_data_list_create_groups(dataSize, headerLen, groupCount);
+    hash->count = count;
+    unsigned long long size = groupCount * hash->groupSize;
+    if (fread(hash->groups, 1, size, fp) != size) {
+        hash_data_list_free(hash);
+        return NULL;
+    }
+    return hash;
+}
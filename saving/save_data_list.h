@@ -3,3 +3,21 @@
 
 void save_data_list(DataList * list, FILE * fp);
 DataList * load_data_list(FILE * fp);
+
+// the number of bytes save_data_list() writes for the list
+unsigned long long save_data_list_size(DataList * list);
+
+/**
+ * Writes `count` sorted records, each a body followed by a header, as
+ * save_data_list() would write a list of them. The list is sharded to a
+ * fixed `depth`, or, if `targetSize` is set, as an adaptive list of the
+ * same records would be after data_list_reshard(targetSize): a node is
+ * split only if the list would have split it while it was built with
+ * `buildHeaderLen` byte headers, and only while its entries do not fit
+ * in `targetSize` bytes. With a NULL file, nothing is written.
+ * @return The number of bytes the list takes up in the file.
+ */
+unsigned long long save_data_list_records(const uint8_t * records, unsigned long long count,
+                                          int dataSize, int headerLen, int depth,
+                                          unsigned long long targetSize, int buildHeaderLen,
+                                          FILE * fp);
@@ -0,0 +1,47 @@
+#include "save_dense_table.h"
+
+void save_dense_table(DenseTable * table, FILE * fp) {
+    save_uint32(table->dataSize, fp);
+    fwrite(table->masks, 1, table->dataSize, fp);
+    unsigned long long byteCount = (table->entryCount + 3) / 4;
+    save_uint64(byteCount, fp);
+    fwrite(table->entries, 1, byteCount, fp);
+}
+
+DenseTable * load_dense_table(FILE * fp) {
+    uint32_t dataSize;
+    uint64_t byteCount;
+    if (!load_uint32(&dataSize, fp)) return NULL;
+    uint8_t * masks = (uint8_t *)malloc(dataSize);
+    if (fread(masks, 1, dataSize, fp) != dataSize) {
+        free(masks);
+        return NULL;
+    }
+    
+    int i, j, bits = 0;
+    for (i = 0; i < dataSize; i++) {
+        for (j = 0; j < 8; j++) {
+            if (masks[i] & (1 << j)) bits++;
+        }
+    }
+    if (bits > kDenseTableMaxKeyBits) {
+        free(masks);
+        return NULL;
+    }
+    
+    DenseTable * table = dense_table_create(dataSize, masks);
+    free(masks);
+    if (!load_uint64(&byteCount, fp) || byteCount != (table->entryCount + 3) / 4) {
+        dense_table_free(table);
+        return NULL;
+    }
+    if (fread(table->entries, 1, byteCount, fp) != byteCount) {
+        dense_table_free(table);
+        return NULL;
+    }
+    return table;
+}
+
+unsigned long long save_dense_table_size(DenseTable * table) {
+    return 12 + table->dataSize + (table->entryCount + 3) / 4;
+}
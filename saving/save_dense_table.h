@@ -0,0 +1,8 @@
+#include "heuristic/dense_table.h"
+#include "save_tools.h"
+
+void save_dense_table(DenseTable * table, FILE * fp);
+DenseTable * load_dense_table(FILE * fp);
+
+// the number of bytes save_dense_table() writes for the table
+unsigned long long save_dense_table_size(DenseTable * table);
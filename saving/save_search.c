@@ -231,7 +231,9 @@ static int _load_cs_settings(CSSettings * settings, FILE * fp) {
         return 0;
     }
     
+    // the inverses are not saved, so it is up to the caller to turn them on
     settings->cacheCuboid = cache;
+    settings->cacheInverse = 0;
     settings->rootNode = c;
     settings->algorithms = list;
     return 1;
@@ -12,6 +12,9 @@ typedef struct {
     int currentDepth;
     int depth;
     
+    // results of should_expand_children for each depth
+    int * accepts;
+    
     time_t lastUpdate;
 } BSThreadContext;
 
@@ -22,12 +25,15 @@ static void _bs_thread_context_free(BSThreadContext * context);
 
 static BSSearchState * _bs_search_state_create(BSSearchContext * context);
 static void _bs_search_state_add_thread(BSSearchState * state, BSThreadState * thread);
+static void _bs_search_state_add_depth(BSSearchState * state, int depth);
 
 static void * _bs_run_dispatch(void * context);
 static void * _bs_resume_dispatch(void * context);
 
 static void * _bs_search_thread(void * threadContext);
 static int _bs_recursive_search(BSThreadContext * context);
+static int _bs_recursive_search_expand(BSThreadContext * context);
+static int _bs_recursive_search_batch(BSThreadContext * context, int min, int max);
 static int _bs_recursive_search_hit_base(BSThreadContext * context);
 static int _bs_recursive_search_progress_update(BSThreadContext * context);
 
@@ -184,6 +190,7 @@ static BSThreadContext * _bs_thread_context_create(SRange range, int depth,
     BSThreadContext * tc = (BSThreadContext *)malloc(sizeof(BSThreadContext));
     bzero(tc, sizeof(BSThreadContext));
     tc->sequence = (int *)malloc(sizeof(int) * depth + 1);
+    tc->accepts = (int *)malloc(sizeof(int) * (depth * context->settings.operationCount + 1));
     tc->depth = depth;
     tc->context = context;
     tc->range = range;
@@ -200,6 +207,7 @@ static BSThreadContext * _bs_thread_context_load(BSThreadState * save, int depth
     BSThreadContext * tc = (BSThreadContext *)malloc(sizeof(BSThreadContext));
     bzero(tc, sizeof(BSThreadContext));
     tc->sequence = (int *)malloc(sizeof(int) * depth + 1);
+    tc->accepts = (int *)malloc(sizeof(int) * (depth * ctx->settings.operationCount + 1));
     tc->depth = depth;
     tc->context = ctx;
     tc->range = range;
@@ -239,6 +247,7 @@ static BSThreadState * _bs_thread_context_save(BSThreadContext * context) {
 
 static void _bs_thread_context_free(BSThreadContext * context) {
     free(context->sequence);
+    free(context->accepts);
     sboundary_destroy(context->range.lower);
     sboundary_destroy(context->range.upper);
     free(context);
@@ -266,6 +275,20 @@ static void _bs_search_state_add_thread(BSSearchState * state, BSThreadState * t
     state->threadCount++;
 }
 
+static void _bs_search_state_add_depth(BSSearchState * state, int depth) {
+    // the whole depth, divided among the threads as the dispatch would
+    int i, count = state->settings.threadCount;
+    SRange * ranges = (SRange *)malloc(sizeof(SRange) * count);
+    count = srange_division(depth, state->settings.operationCount, count, ranges);
+    for (i = 0; i < count; i++) {
+        BSThreadState * thread = (BSThreadState *)malloc(sizeof(BSThreadState));
+        thread->range = ranges[i];
+        _bs_search_state_add_thread(state, thread);
+    }
+    free(ranges);
+    state->depth = depth;
+}
+
 /*******************
  * Search Dispatch *
  *******************/
@@ -301,7 +324,14 @@ static void * _bs_run_dispatch(void * _context) {
         }
         state->depth = depth;
         state->progress = context->progress;
-        if (bs_context_is_stopped(context)) break;
+        if (bs_context_is_stopped(context)) {
+            // if every thread finished before it saw the stop, the search
+            // resumes from the start of the next depth
+            if (!state->threadCount && depth < context->settings.maxDepth) {
+                _bs_search_state_add_depth(state, depth + 1);
+            }
+            break;
+        }
     }
     
     if (bs_context_should_save(context)) {
@@ -364,6 +394,10 @@ static void * _bs_resume_dispatch(void * _context) {
         return _bs_run_dispatch(_context);
     }
     
+    if (!state->threadCount && depth < context->settings.maxDepth) {
+        _bs_search_state_add_depth(state, depth + 1);
+    }
+    
     if (bs_context_should_save(context)) {
         context->callbacks.handle_save_data(context->callbacks.userData,
                                             state);
@@ -408,6 +442,11 @@ static int _bs_recursive_search(BSThreadContext * context) {
         context->pruneCount++;
         return 1;
     }
+    return _bs_recursive_search_expand(context);
+}
+
+static int _bs_recursive_search_expand(BSThreadContext * context) {
+    BSCallbacks callbacks = context->context->callbacks;
     context->nodeCount++;
     if (context->nodeCount > context->context->settings.nodeInterval ||
         context->lastUpdate < time(NULL)) {
@@ -416,6 +455,10 @@ static int _bs_recursive_search(BSThreadContext * context) {
     
     int min = srange_minimum_digit(context->range, context->currentDepth, context->sequence);
     int max = srange_maximum_digit(context->range, context->currentDepth, context->sequence);
+    if (callbacks.should_expand_children && context->currentDepth + 1 < context->depth) {
+        return _bs_recursive_search_batch(context, min, max);
+    }
+    
     int i;
     for (i = min; i <= max; i++) {
         context->sequence[context->currentDepth] = i;
@@ -427,6 +470,29 @@ static int _bs_recursive_search(BSThreadContext * context) {
     return 1;
 }
 
+static int _bs_recursive_search_batch(BSThreadContext * context, int min, int max) {
+    BSCallbacks callbacks = context->context->callbacks;
+    int len = context->currentDepth;
+    int * accepts = &context->accepts[len * context->context->settings.operationCount];
+    callbacks.should_expand_children(callbacks.userData, context->sequence, len,
+                                     min, max, context->depth, context->threadIndex,
+                                     accepts);
+    
+    int i;
+    for (i = min; i <= max; i++) {
+        if (!accepts[i - min]) {
+            context->pruneCount++;
+            continue;
+        }
+        context->sequence[len] = i;
+        context->currentDepth++;
+        if (!_bs_recursive_search_expand(context)) return 0;
+        context->currentDepth--;
+    }
+    
+    return 1;
+}
+
 static int _bs_recursive_search_hit_base(BSThreadContext * context) {
     BSCallbacks callbacks = context->context->callbacks;
     callbacks.handle_reached_node(callbacks.userData, context->sequence,
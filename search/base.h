@@ -39,6 +39,12 @@ typedef struct {
     int (*should_expand)(void * data, const int * sequence, int len,
                          int depth, int threadIndex);
     
+    // optional; called instead of should_expand for all of a node's children
+    // at once when they are not leaves. The children are given by setting
+    // sequence[len] from first to last; accepts[i] is the result for first + i.
+    void (*should_expand_children)(void * data, int * sequence, int len, int first,
+                                   int last, int depth, int threadIndex, int * accepts);
+    
     // called to give the delegate save data
     void (*handle_save_data)(void * data, void * save); // save will be a BSSearchState
     
@@ -1,4 +1,5 @@
 #include "cuboid.h"
+#include "algebra/inverse.h"
 
 static CSSearchContext * _cs_search_context_create(CSSettings s, BSSettings bs, CSCallbacks c);
 static void _cs_search_context_free(CSSearchContext * context);
@@ -7,6 +8,8 @@ static BSCallbacks _cs_standard_bs_callbacks(void * data);
 static void _cs_handle_reached(void * data, const int * sequence, int depth, int th);
 static void _cs_handle_depth_increase(void * data, int depth);
 static int _cs_should_expand(void * data, const int * sequence, int len, int depth, int th);
+static void _cs_should_expand_children(void * data, int * sequence, int len, int first,
+                                       int last, int depth, int th, int * accepts);
 static void _cs_handle_save_data(void * data, void * save);
 static void _cs_handle_progress_update(void * data);
 static void _cs_handle_search_complete(void * data);
@@ -90,6 +93,33 @@ static CSSearchContext * _cs_search_context_create(CSSettings s, BSSettings bs,
     context->caches = (SequenceCache **)malloc(sizeof(SequenceCache *) * tc);
     for (i = 0; i < tc; i++) {
         context->caches[i] = sequence_cache_create(s.rootNode, s.cacheCuboid);
+        context->caches[i]->threadIndex = i;
+    }
+    context->threadCount = tc;
+    
+    if (s.cacheInverse) {
+        int opCount = s.algorithms->entryCount;
+        context->rootInverse = cuboid_inverse(s.rootNode);
+        context->inverseOperations = (Cuboid **)malloc(sizeof(Cuboid *) * opCount);
+        for (i = 0; i < opCount; i++) {
+            context->inverseOperations[i] = cuboid_inverse(s.algorithms->entries[i].cuboid);
+        }
+        for (i = 0; i < tc; i++) {
+            sequence_cache_track_inverses(context->caches[i], context->rootInverse,
+                                          context->inverseOperations);
+        }
+    }
+    
+    // allocate buffers for checking children in batches
+    int j, opCount = s.algorithms->entryCount;
+    context->children = (Cuboid ***)malloc(sizeof(Cuboid **) * tc);
+    context->childBatches = (const Cuboid ***)malloc(sizeof(Cuboid **) * tc);
+    for (i = 0; i < tc; i++) {
+        context->children[i] = (Cuboid **)malloc(sizeof(Cuboid *) * opCount);
+        context->childBatches[i] = (const Cuboid **)malloc(sizeof(Cuboid *) * opCount);
+        for (j = 0; j < opCount; j++) {
+            context->children[i][j] = cuboid_create(s.rootNode->dimensions);
+        }
     }
     
     context->settings = s;
@@ -102,11 +132,29 @@ static CSSearchContext * _cs_search_context_create(CSSettings s, BSSettings bs,
 
 static void _cs_search_context_free(CSSearchContext * context) {
     int i;
-    int tc = context->bsContext->settings.threadCount;
+    int tc = context->threadCount;
     for (i = 0; i < tc; i++) {
         sequence_cache_free(context->caches[i]);
     }
     free(context->caches);
+    
+    int j, opCount = context->settings.algorithms->entryCount;
+    if (context->inverseOperations) {
+        for (i = 0; i < opCount; i++) {
+            cuboid_free(context->inverseOperations[i]);
+        }
+        free(context->inverseOperations);
+        cuboid_free(context->rootInverse);
+    }
+    for (i = 0; i < tc; i++) {
+        for (j = 0; j < opCount; j++) {
+            cuboid_free(context->children[i][j]);
+        }
+        free(context->children[i]);
+        free(context->childBatches[i]);
+    }
+    free(context->children);
+    free(context->childBatches);
     pthread_mutex_destroy(&context->mutex);
     
     bs_context_release(context->bsContext);
@@ -120,11 +168,16 @@ static void _cs_search_context_free(CSSearchContext * context) {
 }
 
 static BSCallbacks _cs_standard_bs_callbacks(void * data) {
+    CSSearchContext * context = (CSSearchContext *)data;
     BSCallbacks cbs;
     cbs.userData = data;
     cbs.handle_reached_node = _cs_handle_reached;
     cbs.handle_depth_increase = _cs_handle_depth_increase;
     cbs.should_expand = _cs_should_expand;
+    cbs.should_expand_children = NULL;
+    if (context->callbacks.accepts_cuboids && !context->callbacks.accepts_path) {
+        cbs.should_expand_children = _cs_should_expand_children;
+    }
     cbs.handle_save_data = _cs_handle_save_data;
     cbs.handle_progress_update = _cs_handle_progress_update;
     cbs.handle_search_complete = _cs_handle_search_complete;
@@ -139,14 +192,14 @@ static void _cs_handle_reached(void * data, const int * sequence, int depth, int
     CSSearchContext * ctx = (CSSearchContext *)data;
     if (ctx->isStopping) return;
     
-    assert(th < ctx->bsContext->settings.threadCount);
+    assert(th < ctx->threadCount);
     SequenceCache * cache = ctx->caches[th];
     const Cuboid * useCuboid = sequence_cache_make_cuboid(cache,
                                                           ctx->settings.algorithms,
                                                           sequence, depth);
     CSCallbacks cb = ctx->callbacks;
     if (cb.handle_cuboid) {
-        cb.handle_cuboid(cb.userData, useCuboid, cache->userCache,
+        cb.handle_cuboid(cb.userData, useCuboid, cache->userCache, th,
                          sequence, depth);
     }
 }
@@ -158,7 +211,7 @@ static void _cs_handle_depth_increase(void * data, int depth) {
     CSSearchContext * ctx = (CSSearchContext *)data;
     
     // clear all caches
-    int i, threadCount = ctx->bsContext->settings.threadCount;
+    int i, threadCount = ctx->threadCount;
     for (i = 0; i < threadCount; i++) {
         sequence_cache_clear(ctx->caches[i]);
     }
@@ -173,7 +226,7 @@ static int _cs_should_expand(void * data, const int * sequence, int len, int dep
     if (len == 0) return 1;
     
     CSSearchContext * ctx = (CSSearchContext *)data;
-    assert(th < ctx->bsContext->settings.threadCount);
+    assert(th < ctx->threadCount);
     
     // filter the sequence
     CSCallbacks cb = ctx->callbacks;
@@ -187,7 +240,12 @@ static int _cs_should_expand(void * data, const int * sequence, int len, int dep
     const Cuboid * cuboid = sequence_cache_make_cuboid(cache, ctx->settings.algorithms,
                                                        sequence, len);
     if (cb.accepts_cuboid) {
-        if (!cb.accepts_cuboid(cb.userData, cuboid, cache->userCache, depth - len)) {
+        if (!cb.accepts_cuboid(cb.userData, cuboid, cache->userCache, th, depth - len)) {
+            return 0;
+        }
+    }
+    if (cb.accepts_path) {
+        if (!cb.accepts_path(cb.userData, cuboid, cache, sequence, len, depth - len)) {
             return 0;
         }
     }
@@ -195,6 +253,42 @@ static int _cs_should_expand(void * data, const int * sequence, int len, int dep
     return 1;
 }
 
+static void _cs_should_expand_children(void * data, int * sequence, int len, int first,
+                                       int last, int depth, int th, int * accepts) {
+    CSSearchContext * ctx = (CSSearchContext *)data;
+    CSCallbacks cb = ctx->callbacks;
+    int i, count = last - first + 1;
+    
+    // far from the bottom of the search, the children are checked one by one
+    if (depth - len > kCSBatchDepth) {
+        for (i = 0; i < count; i++) {
+            sequence[len] = first + i;
+            accepts[i] = _cs_should_expand(data, sequence, len + 1, depth, th);
+        }
+        return;
+    }
+    
+    SequenceCache * cache = ctx->caches[th];
+    AlgList * algorithms = ctx->settings.algorithms;
+    const Cuboid * parent = sequence_cache_make_cuboid(cache, algorithms, sequence, len);
+    const Cuboid ** batch = ctx->childBatches[th];
+    for (i = 0; i < count; i++) {
+        sequence[len] = first + i;
+        batch[i] = NULL;
+        accepts[i] = 1;
+        if (cb.accepts_sequence) {
+            accepts[i] = cb.accepts_sequence(cb.userData, sequence, len + 1,
+                                             depth - len - 1);
+            if (!accepts[i]) continue;
+        }
+        Cuboid * child = ctx->children[th][i];
+        cuboid_multiply(child, algorithms->entries[first + i].cuboid, parent);
+        batch[i] = child;
+    }
+    cb.accepts_cuboids(cb.userData, batch, count, cache->userCache, th,
+                       depth - len - 1, accepts);
+}
+
 static void _cs_handle_save_data(void * data, void * save) {
     CSSearchContext * ctx = (CSSearchContext *)data;
     if (!ctx->callbacks.handle_save_data) return;
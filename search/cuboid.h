@@ -8,9 +8,15 @@
 #include "sequence_cache.h"
 #include "base.h"
 
+// children whose remaining depth is below this are checked in batches
+#define kCSBatchDepth 3
+
 typedef struct {
     uint8_t cacheCuboid;
     
+    // keep the inverse of every node; see sequence_cache_inverse()
+    uint8_t cacheInverse;
+    
     Cuboid * rootNode;
     AlgList * algorithms;
 } CSSettings;
@@ -34,13 +40,29 @@ typedef struct {
                             int len, int depthRemaining);
     
     // Called to validate a cuboid. The StickerMap argument
-    // will be non-NULL unless cacheStickerMaps is set to 0.
-    int (*accepts_cuboid)(void * data, const Cuboid * cuboid,
-                          Cuboid * cache, int depthRemaining);
+    // will be non-NULL unless cacheStickerMaps is set to 0. The thread
+    // argument is the index of the search thread, from 0 up to the
+    // thread count, and stays the same across a pause and resume.
+    int (*accepts_cuboid)(void * data, const Cuboid * cuboid, Cuboid * cache,
+                          int thread, int depthRemaining);
+    
+    // Optional; called after accepts_cuboid with the thread's sequence
+    // cache so that the delegate may keep state along the current path.
+    int (*accepts_path)(void * data, const Cuboid * cuboid, SequenceCache * cache,
+                        const int * sequence, int len, int depthRemaining);
                           
+    // Optional; replaces accepts_cuboid near the bottom of the search,
+    // where all children of a node are checked at once. A child whose
+    // accepts entry is 0 was rejected by accepts_sequence and has a NULL
+    // cuboid; set the entry to 0 for any other child which is rejected.
+    // This is not used when accepts_path is set.
+    void (*accepts_cuboids)(void * data, const Cuboid ** cuboids, int count,
+                            Cuboid * cache, int thread, int depthRemaining,
+                            int * accepts);
+    
     // Called for each root node which is found
     void (*handle_cuboid)(void * data, const Cuboid * cuboid, Cuboid * cache,
-                          const int * sequence, int len);
+                          int thread, const int * sequence, int len);
                           
     // Called if the context was saved
     void (*handle_save_data)(void * data, CSSearchState * save);
@@ -62,6 +84,15 @@ typedef struct {
     time_t startTime;
     
     SequenceCache ** caches;
+    int threadCount;
+    
+    // per-thread children for accepts_cuboids
+    Cuboid *** children;
+    const Cuboid *** childBatches;
+    
+    // shared by the sequence caches if settings.cacheInverse is set
+    Cuboid * rootInverse;
+    Cuboid ** inverseOperations;
 } CSSearchContext;
 
 /**
@@ -13,25 +13,35 @@ SequenceCache * sequence_cache_create(Cuboid * baseCuboid, int userCache) {
 const Cuboid * sequence_cache_make_cuboid(SequenceCache * cache, AlgList * list,
                                     const int * sequence, int len) {
     if (len == 0) return cache->baseCuboid;
-    assert(len - cache->lastLength < 2);
     
     int allocLen = cache->cuboidsAlloc;
     if (len > allocLen && allocLen > 0) {
         int newSize = sizeof(Cuboid *) * len;
         cache->cuboids = (Cuboid **)realloc(cache->cuboids, newSize);
+        if (cache->inverseOperations) {
+            cache->inverses = (Cuboid **)realloc(cache->inverses, newSize);
+        }
+        cache->sequence = (int *)realloc(cache->sequence, sizeof(int) * len);
         cache->cuboidsAlloc = len;
     } else if (allocLen == 0) {
         int size = sizeof(Cuboid *) * len;
         cache->cuboids = (Cuboid **)malloc(size);
+        if (cache->inverseOperations) {
+            cache->inverses = (Cuboid **)malloc(size);
+        }
+        cache->sequence = (int *)malloc(sizeof(int) * len);
         cache->cuboidsAlloc = len;
     }
     
-    int i, start;
-    if (len <= cache->lastLength) {
-        start = len - 1;
-    } else {
-        start = cache->lastLength;
+    // reuse the cuboids whose operations still match the sequence; the
+    // searcher may jump between siblings when it checks them in batches.
+    int i, start = 0;
+    int validLength = (len < cache->lastLength ? len : cache->lastLength);
+    while (start < validLength && cache->sequence[start] == sequence[start]) {
+        start++;
     }
+    if (start == len) return cache->cuboids[len - 1];
+    
     for (i = start; i <= len - 1; i++) {
         Cuboid * opCuboid = list->entries[sequence[i]].cuboid;
         
@@ -48,18 +58,46 @@ const Cuboid * sequence_cache_make_cuboid(SequenceCache * cache, AlgList * list,
         } else {
             cuboid_multiply(spotCuboid, opCuboid, cache->cuboids[i - 1]);
         }
+        cache->sequence[i] = sequence[i];
+        
+        if (cache->inverseOperations) {
+            if (i >= allocLen) {
+                cache->inverses[i] = cuboid_create(cache->baseCuboid->dimensions);
+            }
+            const Cuboid * last = (i == 0 ? cache->baseInverse : cache->inverses[i - 1]);
+            cuboid_multiply(cache->inverses[i], last, cache->inverseOperations[sequence[i]]);
+        }
     }
         
     cache->lastLength = len;
     return cache->cuboids[len - 1];
 }
 
+void sequence_cache_track_inverses(SequenceCache * cache, const Cuboid * baseInverse,
+                                   Cuboid ** inverseOperations) {
+    sequence_cache_clear(cache);
+    cache->baseInverse = baseInverse;
+    cache->inverseOperations = inverseOperations;
+}
+
+const Cuboid * sequence_cache_inverse(SequenceCache * cache, int len) {
+    assert(cache->inverseOperations != NULL);
+    if (len == 0) return cache->baseInverse;
+    return cache->inverses[len - 1];
+}
+
 void sequence_cache_clear(SequenceCache * cache) {
     int i;
     for (i = 0; i < cache->cuboidsAlloc; i++) {
         cuboid_free(cache->cuboids[i]);
+        if (cache->inverses) cuboid_free(cache->inverses[i]);
     }
     free(cache->cuboids);
+    free(cache->sequence);
+    if (cache->inverses) free(cache->inverses);
+    cache->inverses = NULL;
+    cache->cuboids = NULL;
+    cache->sequence = NULL;
     cache->lastLength = 0;
     cache->cuboidsAlloc = 0;
 }
@@ -68,10 +106,13 @@ void sequence_cache_free(SequenceCache * cache) {
     int i;
     for (i = 0; i < cache->cuboidsAlloc; i++) {
         cuboid_free(cache->cuboids[i]);
+        if (cache->inverses) cuboid_free(cache->inverses[i]);
     }
+    if (cache->inverses) free(cache->inverses);
     if (cache->userCache) {
         cuboid_free(cache->userCache);
     }
     if (cache->cuboids) free(cache->cuboids);
+    if (cache->sequence) free(cache->sequence);
     free(cache);
 }
@@ -15,10 +15,30 @@ typedef struct {
     Cuboid ** cuboids;
     int cuboidsAlloc;
     int lastLength;
+    
+    // the operation which produced each of the cached cuboids
+    int * sequence;
+    
+    // the index of the search thread which owns the cache
+    int threadIndex;
+    
+    // when set, the inverse of every cached cuboid is kept as well; since
+    // (op * c)^-1 = c^-1 * op^-1, each one costs a single multiplication
+    const Cuboid * baseInverse;
+    Cuboid ** inverseOperations;
+    Cuboid ** inverses;
 } SequenceCache;
 
 SequenceCache * sequence_cache_create(Cuboid * baseCuboid, int userCache);
 const Cuboid * sequence_cache_make_cuboid(SequenceCache * cache, AlgList * list,
                                     const int * sequence, int len);
+
+// inverseOperations[i] must be the inverse of operation i; neither argument
+// is owned by the cache.
+void sequence_cache_track_inverses(SequenceCache * cache, const Cuboid * baseInverse,
+                                   Cuboid ** inverseOperations);
+
+// the inverse of the cuboid which make_cuboid last returned for length len
+const Cuboid * sequence_cache_inverse(SequenceCache * cache, int len);
 void sequence_cache_clear(SequenceCache * cache);
 void sequence_cache_free(SequenceCache * cache);
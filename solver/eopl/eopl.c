@@ -1,8 +1,12 @@
 #include "eopl.h"
+#include "algebra/inverse.h"
+#include "algebra/sticker_algebra.h"
 
 static RotationCosets * generate_eo_cosets(CuboidDimensions dims, int axis);
 static int _eo_are_centers_solved(const Cuboid * cb);
 static int _eo_are_edges_oriented(const Cuboid * cb, int axis);
+static void _eo_find_maximums(EOPluginContext * context, AlgList * operations);
+static int _eo_count_bad_edges(const Cuboid * cb, int axis);
 
 CLArgumentList * eopl_default_arguments() {
     CLArgumentList * list = cl_argument_list_new();
@@ -29,6 +33,7 @@ int eopl_run(CLSearchParameters * params, CLArgumentList * list, void ** userDat
     idx = cl_argument_list_find(list, "centers");
     argument = cl_argument_list_get(list, idx);
     context->solveCenters = argument->contents.flag.boolValue;
+    _eo_find_maximums(context, params->operations);
     
     *userData = context;
     return 1;
@@ -45,6 +50,7 @@ int eopl_resume(CLSearchParameters * params, FILE * fp, void ** userData) {
     context->axis = axisNumber;
     context->solveCenters = centerFlag;
     context->cosets = generate_eo_cosets(params->dimensions, axisNumber);
+    _eo_find_maximums(context, params->operations);
     
     *userData = context;
     return 1;
@@ -61,6 +67,7 @@ void eopl_save(void * data, FILE * fp) {
 void eopl_completed(void * data) {
     EOPluginContext * context = (EOPluginContext *)data;
     rotation_cosets_release(context->cosets);
+    free(context->maxFlips);
     free(context);
 }
 
@@ -81,6 +88,27 @@ int eopl_is_goal(void * data, const Cuboid * cb, Cuboid * cache) {
     return 0;
 }
 
+int eopl_lower_bound(void * data, const Cuboid * cb, Cuboid * cache) {
+    // each coset may be the one which reaches the goal, so the bound is the
+    // lowest of theirs
+    EOPluginContext * context = (EOPluginContext *)data;
+    int i, best = -1;
+    for (i = 0; i < rotation_cosets_count(context->cosets); i++) {
+        Cuboid * rotation = rotation_cosets_get_trigger(context->cosets, i);
+        cuboid_multiply(cache, rotation, cb);
+        int bound = cuboid_moves_needed(_eo_count_bad_edges(cache, context->axis),
+                                        context->maxFlips[i]);
+        if (context->solveCenters) {
+            // a center on the wrong axis can never be part of a solved face
+            int centers = cuboid_moves_needed(cuboid_count_off_axis_centers(cache),
+                                              context->maxCenters);
+            if (centers > bound) bound = centers;
+        }
+        if (best < 0 || bound < best) best = bound;
+    }
+    return best;
+}
+
 /***********
  * Private *
  ***********/
@@ -114,6 +142,45 @@ static int _eo_are_centers_solved(const Cuboid * cb) {
     return 1;
 }
 
+static void _eo_find_maximums(EOPluginContext * context, AlgList * operations) {
+    // after the rotation r, applying op looks like applying r * op * r^-1
+    int i, j, count = rotation_cosets_count(context->cosets);
+    context->maxFlips = (int *)malloc(sizeof(int) * count);
+    context->maxCenters = 0;
+    for (i = 0; i < count; i++) {
+        Cuboid * rotation = rotation_cosets_get_trigger(context->cosets, i);
+        Cuboid * inverse = cuboid_inverse(rotation);
+        Cuboid * temp = cuboid_create(rotation->dimensions);
+        Cuboid * conjugate = cuboid_create(rotation->dimensions);
+        context->maxFlips[i] = 0;
+        for (j = 0; j < operations->entryCount; j++) {
+            cuboid_multiply(temp, rotation, operations->entries[j].cuboid);
+            cuboid_multiply(conjugate, temp, inverse);
+            int flips = cuboid_count_flippable_edges(conjugate, context->axis);
+            if (flips > context->maxFlips[i]) context->maxFlips[i] = flips;
+        }
+        cuboid_free(inverse);
+        cuboid_free(temp);
+        cuboid_free(conjugate);
+    }
+    for (j = 0; j < operations->entryCount; j++) {
+        int moved = cuboid_count_moved_centers(operations->entries[j].cuboid);
+        if (moved > context->maxCenters) context->maxCenters = moved;
+    }
+}
+
+static int _eo_count_bad_edges(const Cuboid * cb, int axis) {
+    int i, j, count = 0;
+    for (i = 0; i < 12; i++) {
+        int edgeCount = cuboid_count_edges_for_dedge(cb, i);
+        for (j = 0; j < edgeCount; j++) {
+            CuboidEdge edge = cb->edges[cuboid_edge_index(cb, i, j)];
+            if (!cuboid_edge_orientation(edge, i, axis)) count++;
+        }
+    }
+    return count;
+}
+
 static int _eo_are_edges_oriented(const Cuboid * cb, int axis) {
     int i, j;
     for (i = 0; i < 12; i++) {
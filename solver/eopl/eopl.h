@@ -6,6 +6,11 @@ typedef struct {
     RotationCosets * cosets;
     int axis;
     int solveCenters;
+    
+    // the most edges one operation can flip after each coset's rotation,
+    // and the most centers it can move
+    int * maxFlips;
+    int maxCenters;
 } EOPluginContext;
 
 CLArgumentList * eopl_default_arguments();
@@ -14,3 +19,4 @@ int eopl_resume(CLSearchParameters * params, FILE * fp, void ** userData);
 void eopl_save(void * data, FILE * fp);
 void eopl_completed(void * data);
 int eopl_is_goal(void * data, const Cuboid * cb, Cuboid * cache);
+int eopl_lower_bound(void * data, const Cuboid * cb, Cuboid * cache);
@@ -5,6 +5,11 @@
 #include "solvers.h"
 #include "notation/print.h"
 #include "solve_context.h"
+#include "heuristic/heuristic_path.h"
+#include "heuristic/heuristic_order.h"
+#include "heuristic/heuristic_reuse.h"
+#include "heuristic/heuristic_coords.h"
+#include "algebra/inverse.h"
 
 #define MANUAL_HEURISTIC_CHECK 1
 
@@ -12,6 +17,12 @@
 static SolveContext solveContext;
 static pthread_mutex_t printMutex = PTHREAD_MUTEX_INITIALIZER;
 static int foundSolution = 0;
+static HeuristicPath ** heuristicPaths = NULL;
+static HeuristicCache ** heuristicCaches = NULL;
+static HeuristicOrder ** heuristicOrders = NULL;
+static HeuristicReuse ** heuristicReuses = NULL;
+static HeuristicCoords ** heuristicCoords = NULL;
+static HeuristicStats ** heuristicStats = NULL;
 
 void handle_interrupt(int dummy);
 void print_usage(const char * command);
@@ -22,18 +33,43 @@ int handle_solver(int argc, const char * argv[]);
 
 void dispatch_search(Cuboid * root);
 void dispatch_resume(CSSearchState * state);
+void create_heuristic_paths();
+void free_heuristic_paths();
+void create_heuristic_caches();
+void free_heuristic_caches();
+void create_heuristic_orders();
+void free_heuristic_orders();
+void create_heuristic_reuses();
+void free_heuristic_reuses();
+void create_heuristic_coords();
+void free_heuristic_coords();
+void print_heuristic_cache_stats();
+void create_heuristic_stats();
+void free_heuristic_stats();
+void print_heuristic_stats();
 
 CSCallbacks generate_callbacks();
 
 void search_handle_progress(void * data);
 void search_handle_depth(void * data, int depth);
 int search_accepts_sequence(void * data, const int * seq, int len, int depthRem);
-int search_accepts_cuboid(void * data, const Cuboid * cuboid, Cuboid * cache, int depthRem);
+int search_accepts_cuboid(void * data, const Cuboid * cuboid, Cuboid * cache,
+                          int thread, int depthRem);
+int search_accepts_path(void * data, const Cuboid * cuboid, SequenceCache * cache,
+                        const int * sequence, int len, int depthRem);
+void search_accepts_cuboids(void * data, const Cuboid ** cuboids, int count,
+                            Cuboid * cache, int thread, int depthRem, int * accepts);
 void search_handle_cuboid(void * data, const Cuboid * cuboid, Cuboid * cache,
-                          const int * sequence, int len);
+                          int thread, const int * sequence, int len);
 void search_handle_save_data(void * data, CSSearchState * save);
 void search_handle_finished(void * data);
 
+int check_lower_bound(const Cuboid * cuboid, Cuboid * cache, int depthRem);
+int check_heuristics(const Cuboid * cuboid, const Cuboid * inverse, Cuboid * cache,
+                     int thread, const int * sequence, int len, int depthRem);
+int supports_dual_lookups(CLSearchParameters params);
+int alg_list_contains(AlgList * list, const Cuboid * cuboid);
+
 int main(int argc, const char * argv[]) {
     if (argc < 2) {
         print_usage(argv[0]);
@@ -72,12 +108,20 @@ void print_usage(const char * command) {
     puts("Options:");
     puts(" --multiple        find multiple solutions");
     puts(" --verbose         display periodic updates");
+    puts(" --batch           look up the heuristics of sibling nodes together,");
+    puts("                   unless --dual or a dense heuristic is used");
+    puts(" --dual            also look up the heuristics of each inverse state");
+    puts(" --filter          keep a filter of the keys of each large heuristic");
+    puts(" --compress        front-code the records of each large heuristic");
+    puts(" --stats           count the lookups and prunes of each heuristic");
     puts(" --mindepth=n      the minimum search depth [0]");
     puts(" --maxdepth=n      the maximum search depth [20]");
     puts(" --threads=n       the number of search threads to use [8]");
+    puts(" --cachelines=n    heuristic cache lines per thread, 0 to disable [4096]");
     puts(" --operations <x>  the , separated operations to use");
     puts(" --dimensions <x>  the dimensions in XxYxZ format. [3x3x3]");
     puts(" --heuristic <x>   a heuristic database to use.");
+    puts(" --additive <x>    a heuristic database to add to the previous one.");
     puts("\nAvailable solvers:\n");
     int i;
     for (i = 0; i < SolverTableCount; i++) {
@@ -130,6 +174,17 @@ int handle_solver(int argc, const char * argv[]) {
         return 1;
     }
     
+    if (solveContext.searchParameters.dualFlag &&
+        !supports_dual_lookups(solveContext.searchParameters)) {
+        fprintf(stderr, "Error: --dual needs a solver with a symmetric goal, a moveset "
+                "closed under inverses and rotations, heuristics which count every "
+                "move, and no indistinguishable pieces.\n");
+        cuboid_free(cuboid);
+        solveContext.solver.completed(solveContext.userData);
+        sc_release_resources(&solveContext);
+        return 1;
+    }
+    
     // solve the cubiod!
     dispatch_search(cuboid);
     
@@ -143,6 +198,12 @@ int handle_solver(int argc, const char * argv[]) {
  ***************************/
 
 void dispatch_search(Cuboid * root) {
+    create_heuristic_paths();
+    create_heuristic_caches();
+    create_heuristic_orders();
+    create_heuristic_reuses();
+    create_heuristic_coords();
+    create_heuristic_stats();
     CSCallbacks callbacks = generate_callbacks();
     CSSettings settings = sc_generate_cs_settings(&solveContext, root);
     BSSettings bsSettings = sc_generate_bs_settings(&solveContext);
@@ -150,10 +211,178 @@ void dispatch_search(Cuboid * root) {
 }
 
 void dispatch_resume(CSSearchState * state) {
+    create_heuristic_paths();
+    create_heuristic_caches();
+    create_heuristic_orders();
+    create_heuristic_reuses();
+    create_heuristic_coords();
+    create_heuristic_stats();
     CSCallbacks callbacks = generate_callbacks();
     solveContext.searchContext = cs_resume(state, callbacks);
 }
 
+void create_heuristic_paths() {
+    CLSearchParameters params = solveContext.searchParameters;
+    if (!heuristic_list_has_dense(params.heuristics)) return;
+    
+    // each search thread keeps its own path through the dense tables
+    int i, count = params.threadCount;
+    heuristicPaths = (HeuristicPath **)malloc(sizeof(void *) * count);
+    for (i = 0; i < count; i++) {
+        heuristicPaths[i] = heuristic_path_create(params.heuristics,
+                                                  params.operations);
+    }
+}
+
+void free_heuristic_paths() {
+    if (!heuristicPaths) return;
+    int i;
+    for (i = 0; i < solveContext.searchParameters.threadCount; i++) {
+        heuristic_path_free(heuristicPaths[i]);
+    }
+    free(heuristicPaths);
+    heuristicPaths = NULL;
+}
+
+void create_heuristic_caches() {
+    CLSearchParameters params = solveContext.searchParameters;
+    if (params.heuristics->count == 0 || params.cacheLines == 0) return;
+    
+    int i, count = params.threadCount;
+    heuristicCaches = (HeuristicCache **)malloc(sizeof(void *) * count);
+    for (i = 0; i < count; i++) {
+        heuristicCaches[i] = heuristic_cache_create(params.cacheLines);
+    }
+}
+
+void free_heuristic_caches() {
+    if (!heuristicCaches) return;
+    int i;
+    for (i = 0; i < solveContext.searchParameters.threadCount; i++) {
+        heuristic_cache_free(heuristicCaches[i]);
+    }
+    free(heuristicCaches);
+    heuristicCaches = NULL;
+}
+
+void create_heuristic_orders() {
+    CLSearchParameters params = solveContext.searchParameters;
+    if (params.heuristics->count == 0) return;
+    
+    // each search thread learns its own order
+    int i, count = params.threadCount;
+    heuristicOrders = (HeuristicOrder **)malloc(sizeof(void *) * count);
+    for (i = 0; i < count; i++) {
+        heuristicOrders[i] = heuristic_order_create(params.heuristics);
+    }
+}
+
+void free_heuristic_orders() {
+    if (!heuristicOrders) return;
+    int i;
+    for (i = 0; i < solveContext.searchParameters.threadCount; i++) {
+        heuristic_order_free(heuristicOrders[i]);
+    }
+    free(heuristicOrders);
+    heuristicOrders = NULL;
+}
+
+void print_heuristic_cache_stats() {
+    if (!heuristicCaches) return;
+    unsigned long long lookups = 0, hits = 0;
+    int i;
+    for (i = 0; i < solveContext.searchParameters.threadCount; i++) {
+        lookups += heuristicCaches[i]->lookups;
+        hits += heuristicCaches[i]->hits;
+    }
+    double rate = (lookups ? (double)hits * 100.0 / (double)lookups : 0.0);
+    printf("heuristic cache: %llu lookups, %llu hits (%.1f%%)\n", lookups, hits, rate);
+}
+
+void create_heuristic_reuses() {
+    CLSearchParameters params = solveContext.searchParameters;
+    if (params.heuristics->count == 0 || params.batchFlag) return;
+    
+    HeuristicReuse * first = heuristic_reuse_create(params.heuristics, params.operations,
+                                                    params.dualFlag);
+    if (!first) return;
+    
+    int i, count = params.threadCount;
+    heuristicReuses = (HeuristicReuse **)malloc(sizeof(void *) * count);
+    heuristicReuses[0] = first;
+    for (i = 1; i < count; i++) {
+        heuristicReuses[i] = heuristic_reuse_create(params.heuristics, params.operations,
+                                                    params.dualFlag);
+    }
+}
+
+void free_heuristic_reuses() {
+    if (!heuristicReuses) return;
+    int i;
+    for (i = 0; i < solveContext.searchParameters.threadCount; i++) {
+        heuristic_reuse_free(heuristicReuses[i]);
+    }
+    free(heuristicReuses);
+    heuristicReuses = NULL;
+}
+
+void create_heuristic_coords() {
+    CLSearchParameters params = solveContext.searchParameters;
+    if (params.heuristics->count == 0 || params.batchFlag) return;
+    
+    HeuristicCoords * first = heuristic_coords_create(params.heuristics, params.operations);
+    if (!first) return;
+    
+    // each thread's order looks up the nodes of that thread's coordinates
+    int i, count = params.threadCount;
+    heuristicCoords = (HeuristicCoords **)malloc(sizeof(void *) * count);
+    heuristicCoords[0] = first;
+    for (i = 1; i < count; i++) {
+        heuristicCoords[i] = heuristic_coords_create(params.heuristics, params.operations);
+    }
+    for (i = 0; i < count; i++) {
+        heuristicOrders[i]->coords = heuristicCoords[i];
+    }
+}
+
+void free_heuristic_coords() {
+    if (!heuristicCoords) return;
+    int i;
+    for (i = 0; i < solveContext.searchParameters.threadCount; i++) {
+        heuristic_coords_free(heuristicCoords[i]);
+    }
+    free(heuristicCoords);
+    heuristicCoords = NULL;
+}
+
+void create_heuristic_stats() {
+    CLSearchParameters params = solveContext.searchParameters;
+    if (!heuristicOrders || !params.statsFlag) return;
+    
+    int i, count = params.threadCount;
+    heuristicStats = (HeuristicStats **)malloc(sizeof(void *) * count);
+    for (i = 0; i < count; i++) {
+        heuristicStats[i] = heuristic_stats_create(params.heuristics);
+        heuristicOrders[i]->counters = heuristicStats[i];
+    }
+}
+
+void free_heuristic_stats() {
+    if (!heuristicStats) return;
+    int i;
+    for (i = 0; i < solveContext.searchParameters.threadCount; i++) {
+        heuristic_stats_free(heuristicStats[i]);
+    }
+    free(heuristicStats);
+    heuristicStats = NULL;
+}
+
+void print_heuristic_stats() {
+    // the counters of the other threads may be a few lookups behind
+    if (!heuristicStats) return;
+    heuristic_stats_print(heuristicStats, solveContext.searchParameters.threadCount, stdout);
+}
+
 CSCallbacks generate_callbacks() {
     CSCallbacks cbs;
     cbs.userData = NULL;
@@ -161,6 +390,20 @@ CSCallbacks generate_callbacks() {
     cbs.handle_depth = search_handle_depth;
     cbs.accepts_sequence = search_accepts_sequence;
     cbs.accepts_cuboid = search_accepts_cuboid;
+    cbs.accepts_path = NULL;
+    if (heuristicPaths || heuristicReuses || heuristicCoords ||
+        solveContext.searchParameters.dualFlag) {
+        cbs.accepts_path = search_accepts_path;
+    }
+    cbs.accepts_cuboids = NULL;
+    if (solveContext.searchParameters.batchFlag) {
+        // the path callback looks up each node on its own
+        if (cbs.accepts_path) {
+            fprintf(stderr, "note: --batch is ignored with --dual or a dense heuristic.\n");
+        } else {
+            cbs.accepts_cuboids = search_accepts_cuboids;
+        }
+    }
     cbs.handle_cuboid = search_handle_cuboid;
     cbs.handle_save_data = search_handle_save_data;
     cbs.handle_finished = search_handle_finished;
@@ -177,6 +420,8 @@ void search_handle_progress(void * data) {
     int depth = bs_context_current_depth(solveContext.searchContext->bsContext);
     printf("expanded %llu, pruned %llu, depth %d\n",
            progress.nodesExpanded, progress.nodesPruned, depth);
+    print_heuristic_cache_stats();
+    print_heuristic_stats();
 }
 
 void search_handle_depth(void * data, int depth) {
@@ -188,23 +433,87 @@ int search_accepts_sequence(void * data, const int * seq, int len, int depthRem)
     return 1;
 }
 
-int search_accepts_cuboid(void * data, const Cuboid * cuboid, Cuboid * cache, int depthRem) {
-    CLSearchParameters params = solveContext.searchParameters;
-    if (MANUAL_HEURISTIC_CHECK) {
-        int i;
-        for (i = 0; i < params.heuristics->count; i++) {
-            Heuristic * h = params.heuristics->heuristics[i];
-            int value = heuristic_pruning_value(h, cuboid, cache);
-            if (value > depthRem) return 0;
-        }
+int search_accepts_cuboid(void * data, const Cuboid * cuboid, Cuboid * cache,
+                          int thread, int depthRem) {
+    if (!check_lower_bound(cuboid, cache, depthRem)) return 0;
+    
+    // reused values, coordinates and inverses come from the path, so those
+    // are checked there
+    if (heuristicReuses || heuristicCoords || solveContext.searchParameters.dualFlag) {
         return 1;
-    } else {
-        return !heuristic_list_exceeds(params.heuristics, cuboid, cache, depthRem);
+    }
+    return check_heuristics(cuboid, NULL, cache, thread, NULL, 0, depthRem);
+}
+
+int search_accepts_path(void * data, const Cuboid * cuboid, SequenceCache * cache,
+                        const int * sequence, int len, int depthRem) {
+    if (heuristicReuses || heuristicCoords || solveContext.searchParameters.dualFlag) {
+        const Cuboid * inverse = NULL;
+        if (heuristicCoords) {
+            HeuristicCoords * coords = heuristicCoords[cache->threadIndex];
+            heuristic_coords_update(coords, cache->baseCuboid, sequence, len);
+        }
+        if (cache->inverseOperations) {
+            inverse = sequence_cache_inverse(cache, len);
+        }
+        if (!check_heuristics(cuboid, inverse, cache->userCache, cache->threadIndex,
+                              sequence, len, depthRem)) {
+            return 0;
+        }
+    }
+    if (!heuristicPaths) return 1;
+    HeuristicPath * path = heuristicPaths[cache->threadIndex];
+    return !heuristic_path_exceeds(path, cache->baseCuboid, cuboid, len, depthRem);
+}
+
+void search_accepts_cuboids(void * data, const Cuboid ** cuboids, int count,
+                            Cuboid * cache, int thread, int depthRem, int * accepts) {
+    HeuristicList * list = solveContext.searchParameters.heuristics;
+    int i, * exceeds = (int *)malloc(sizeof(int) * count);
+    
+    // children which the solver's own bound prunes need no lookups
+    for (i = 0; i < count; i++) {
+        if (!cuboids[i] || check_lower_bound(cuboids[i], cache, depthRem)) continue;
+        accepts[i] = 0;
+        cuboids[i] = NULL;
+    }
+    
+    // children which the cache settles are left out of the batch
+    HeuristicCache * valueCache = NULL;
+    uint64_t * hashes = NULL;
+    const Cuboid ** misses = cuboids;
+    if (heuristicCaches) {
+        valueCache = heuristicCaches[thread];
+        hashes = (uint64_t *)malloc(sizeof(uint64_t) * count);
+        misses = (const Cuboid **)malloc(sizeof(void *) * count);
+        for (i = 0; i < count; i++) {
+            misses[i] = NULL;
+            if (!cuboids[i]) continue;
+            int cachedExceeds;
+            hashes[i] = heuristic_cache_hash(cuboids[i]);
+            if (heuristic_cache_lookup(valueCache, hashes[i], depthRem, &cachedExceeds)) {
+                if (cachedExceeds) accepts[i] = 0;
+            } else {
+                misses[i] = cuboids[i];
+            }
+        }
+    }
+    
+    heuristic_list_exceeds_batch(list, misses, count, cache, depthRem, exceeds);
+    for (i = 0; i < count; i++) {
+        if (!misses[i] || !exceeds[i]) continue;
+        accepts[i] = 0;
+        if (valueCache) heuristic_cache_store(valueCache, hashes[i], depthRem + 1, 0);
+    }
+    free(exceeds);
+    if (valueCache) {
+        free(hashes);
+        free(misses);
     }
 }
 
 void search_handle_cuboid(void * data, const Cuboid * cuboid, Cuboid * cache,
-                          const int * sequence, int len) {
+                          int thread, const int * sequence, int len) {
     if (solveContext.solver.is_goal(solveContext.userData, cuboid, cache)) {
         pthread_mutex_lock(&printMutex);
         if (foundSolution && !solveContext.searchParameters.multipleFlag) {
@@ -249,6 +558,116 @@ void search_handle_save_data(void * data, CSSearchState * save) {
 
 void search_handle_finished(void * data) {
     solveContext.solver.completed(solveContext.userData);
+    if (solveContext.searchParameters.verboseFlag) print_heuristic_cache_stats();
+    print_heuristic_stats();
+    free_heuristic_paths();
+    free_heuristic_caches();
+    free_heuristic_orders();
+    free_heuristic_reuses();
+    free_heuristic_coords();
+    free_heuristic_stats();
     sc_release_resources(&solveContext);
     exit(0);
 }
+
+/*********************
+ * Heuristic lookups *
+ *********************/
+
+int check_lower_bound(const Cuboid * cuboid, Cuboid * cache, int depthRem) {
+    if (!solveContext.solver.lower_bound) return 1;
+    return solveContext.solver.lower_bound(solveContext.userData, cuboid, cache) <= depthRem;
+}
+
+int check_heuristics(const Cuboid * cuboid, const Cuboid * inverse, Cuboid * cache,
+                     int thread, const int * sequence, int len, int depthRem) {
+    CLSearchParameters params = solveContext.searchParameters;
+    if (!heuristicOrders) return 1;
+    
+    int * values = NULL;
+    if (heuristicReuses) {
+        values = heuristic_reuse_row(heuristicReuses[thread], sequence, len);
+    }
+    
+    HeuristicCache * valueCache = NULL;
+    uint64_t hash = 0;
+    if (heuristicCaches) {
+        valueCache = heuristicCaches[thread];
+        hash = heuristic_cache_hash(cuboid);
+        int exceeds;
+        if (heuristic_cache_lookup(valueCache, hash, depthRem, &exceeds)) {
+            return !exceeds;
+        }
+    }
+    
+    if (MANUAL_HEURISTIC_CHECK) {
+        int value, exact;
+        int exceeds = heuristic_order_exceeds(heuristicOrders[thread], cuboid, inverse,
+                                              cache, depthRem, values, &value, &exact);
+        if (valueCache && (exceeds || exact)) {
+            heuristic_cache_store(valueCache, hash, value, exact);
+        }
+        return !exceeds;
+    } else {
+        int exceeds = heuristic_list_exceeds(params.heuristics, cuboid, cache, depthRem);
+        if (valueCache && exceeds) {
+            heuristic_cache_store(valueCache, hash, depthRem + 1, 0);
+        }
+        return !exceeds;
+    }
+}
+
+int supports_dual_lookups(CLSearchParameters params) {
+    // a state and its inverse are only equally far from a symmetric goal
+    if (!solveContext.solver.symmetricGoal) return 0;
+    
+    // pieces which look alike make the inverse of a sticker map ambiguous
+    Cuboid * solved = cuboid_create(params.dimensions);
+    int i, j, ok = 1;
+    for (i = 0; i < 12; i++) {
+        if (cuboid_count_edges_for_dedge(solved, i) > 1) ok = 0;
+    }
+    for (i = 1; i <= 6; i++) {
+        if (cuboid_count_centers_for_face(solved, i) > 1) ok = 0;
+    }
+    
+    // if x * s reaches a rotation r, then x^-1 is solved by r * s^-1 * r^-1
+    AlgList * ops = params.operations;
+    
+    // a heuristic with free moves would have to be free in the same way there
+    for (i = 0; i < params.heuristics->count; i++) {
+        for (j = 0; j < ops->entryCount; j++) {
+            Cuboid * op = ops->entries[j].cuboid;
+            if (!heuristic_operation_cost(params.heuristics->heuristics[i], op)) ok = 0;
+        }
+    }
+    RotationBasis basis = rotation_basis_standard(params.dimensions);
+    RotationGroup * group = rotation_group_create_basis(basis);
+    Cuboid * temp = cuboid_create(params.dimensions);
+    for (i = 0; i < ops->entryCount && ok; i++) {
+        Cuboid * op = ops->entries[i].cuboid;
+        Cuboid * inverse = cuboid_inverse(op);
+        ok = alg_list_contains(ops, inverse);
+        cuboid_free(inverse);
+        for (j = 0; j < rotation_group_count(group) && ok; j++) {
+            Cuboid * rotation = rotation_group_get(group, j);
+            Cuboid * rotationInverse = cuboid_inverse(rotation);
+            cuboid_multiply(solved, rotation, op);
+            cuboid_multiply(temp, solved, rotationInverse);
+            ok = alg_list_contains(ops, temp);
+            cuboid_free(rotationInverse);
+        }
+    }
+    rotation_group_release(group);
+    cuboid_free(temp);
+    cuboid_free(solved);
+    return ok;
+}
+
+int alg_list_contains(AlgList * list, const Cuboid * cuboid) {
+    int i;
+    for (i = 0; i < list->entryCount; i++) {
+        if (cuboid_light_comparison(list->entries[i].cuboid, cuboid) == 0) return 1;
+    }
+    return 0;
+}
@@ -1,11 +1,16 @@
 #include "pairpl.h"
 
-static int _pair_are_centers_solved(const Cuboid * cb);
-
 typedef struct {
     uint8_t solveCenters;
+    
+    // the most dedges, and centers, which one operation moves
+    int maxDedges;
+    int maxCenters;
 } PairPLContext;
 
+static int _pair_are_centers_solved(const Cuboid * cb);
+static void _pair_find_maximums(PairPLContext * context, AlgList * operations);
+
 CLArgumentList * pairpl_default_arguments() {
     CLArgumentList * list = cl_argument_list_new();
     
@@ -21,6 +26,7 @@ int pairpl_run(CLSearchParameters * params, CLArgumentList * list, void ** userD
     int idx = cl_argument_list_find(list, "centers");
     CLArgument * argument = cl_argument_list_get(list, idx);
     context->solveCenters = argument->contents.flag.boolValue;
+    _pair_find_maximums(context, params->operations);
     
     *userData = context;
     return 1;
@@ -33,6 +39,7 @@ int pairpl_resume(CLSearchParameters * params, FILE * fp, void ** userData) {
     
     PairPLContext * context = (PairPLContext *)malloc(sizeof(PairPLContext));
     context->solveCenters = centerFlag;
+    _pair_find_maximums(context, params->operations);
     *userData = context;
     
     return 1;
@@ -63,6 +70,39 @@ int pairpl_is_goal(void * data, const Cuboid * cb, Cuboid * cache) {
     return 1;
 }
 
+int pairpl_lower_bound(void * data, const Cuboid * cb, Cuboid * cache) {
+    // a dedge only becomes paired if a move touches it
+    PairPLContext * context = (PairPLContext *)data;
+    int i, unpaired = 0;
+    for (i = 0; i < 12; i++) {
+        if (!cuboid_is_dedge_paired(cb, i)) unpaired++;
+    }
+    int bound = cuboid_moves_needed(unpaired, context->maxDedges);
+    if (context->solveCenters) {
+        int centers = cuboid_moves_needed(cuboid_count_misplaced_centers(cb),
+                                          context->maxCenters);
+        if (centers > bound) bound = centers;
+    }
+    return bound;
+}
+
+/***********
+ * Private *
+ ***********/
+
+static void _pair_find_maximums(PairPLContext * context, AlgList * operations) {
+    int i;
+    context->maxDedges = 0;
+    context->maxCenters = 0;
+    for (i = 0; i < operations->entryCount; i++) {
+        Cuboid * operation = operations->entries[i].cuboid;
+        int dedges = cuboid_count_moved_dedges(operation);
+        int centers = cuboid_count_moved_centers(operation);
+        if (dedges > context->maxDedges) context->maxDedges = dedges;
+        if (centers > context->maxCenters) context->maxCenters = centers;
+    }
+}
+
 static int _pair_are_centers_solved(const Cuboid * cb) {
     int face, i;
     for (face = 1; face <= 6; face++) {
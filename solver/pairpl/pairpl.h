@@ -8,3 +8,4 @@ int pairpl_resume(CLSearchParameters * params, FILE * fp, void ** userData);
 void pairpl_save(void * data, FILE * fp);
 void pairpl_completed(void * data);
 int pairpl_is_goal(void * data, const Cuboid * cb, Cuboid * cache);
+int pairpl_lower_bound(void * data, const Cuboid * cb, Cuboid * cache);
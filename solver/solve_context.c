@@ -48,6 +48,11 @@ CSSearchState * sc_load(SolveContext * context, const char * fileName) {
         return NULL;
     }
     
+    // the saved search does not keep the inverses, so they are turned back
+    // on as a fresh solve would
+    int hasHeuristics = context->searchParameters.heuristics->count > 0;
+    state->settings.cacheInverse = context->searchParameters.dualFlag && hasHeuristics;
+    
     int result = context->solver.resume(&context->searchParameters, fp, &context->userData);
     fclose(fp);
     if (!result) {
@@ -65,8 +70,11 @@ void sc_save(SolveContext * context, CSSearchState * state, const char * fileNam
     
     uint8_t verboseFlag = context->searchParameters.verboseFlag;
     uint8_t multipleFlag = context->searchParameters.multipleFlag;
+    uint8_t dualFlag = context->searchParameters.dualFlag;
     fwrite(&verboseFlag, 1, 1, fp);
     fwrite(&multipleFlag, 1, 1, fp);
+    fwrite(&dualFlag, 1, 1, fp);
+    save_uint32(context->searchParameters.cacheLines, fp);
     
     save_cuboid_search(state, fp);
     save_heuristic_list(context->searchParameters.heuristics, fp);
@@ -124,6 +132,7 @@ CSSettings sc_generate_cs_settings(SolveContext * context, Cuboid * root) {
     
     CSSettings settings;
     settings.cacheCuboid = context->solver.cacheCuboid | hasHeuristics;
+    settings.cacheInverse = context->searchParameters.dualFlag && hasHeuristics;
     settings.rootNode = root;
     settings.algorithms = context->searchParameters.operations;
     return settings;
@@ -194,11 +203,16 @@ static int _load_solver(SolveContext * context, FILE * fp) {
 }
 
 static int _load_search_parameters(SolveContext * context, FILE * fp) {
-    uint8_t verboseFlag, multipleFlag;
+    uint8_t verboseFlag, multipleFlag, dualFlag;
+    uint32_t cacheLines;
     if (fread(&verboseFlag, 1, 1, fp) != 1) return 0;
     if (fread(&multipleFlag, 1, 1, fp) != 1) return 0;
+    if (fread(&dualFlag, 1, 1, fp) != 1) return 0;
+    if (!load_uint32(&cacheLines, fp)) return 0;
     context->searchParameters.verboseFlag = verboseFlag;
     context->searchParameters.multipleFlag = multipleFlag;
+    context->searchParameters.dualFlag = dualFlag;
+    context->searchParameters.cacheLines = cacheLines;
     return 1;
 }
 
@@ -19,6 +19,10 @@ typedef struct {
     const char * description;
     int cacheCuboid;
     
+    // set if a state and its inverse are always equally far from the goal,
+    // which makes --dual lookups admissible
+    int symmetricGoal;
+    
     // ** lifecycle **
     
     CLArgumentList * (*default_arguments)();
@@ -32,35 +36,42 @@ typedef struct {
     // ** search **
     
     int (*is_goal)(void * data, const Cuboid * cb, Cuboid * cache);
+    
+    // optional; a number of moves which the goal is at least away from,
+    // found from the cuboid alone. `cache` may be used as scratch.
+    int (*lower_bound)(void * data, const Cuboid * cb, Cuboid * cache);
 } Solver;
 
 static const Solver SolverTable[] = {
     {
-        "standard", "the standard sticker based cuboid solver", 0,
+        "standard", "the standard sticker based cuboid solver", 0, 1,
         standardpl_default_arguments,
         standardpl_run,
         standardpl_resume,
         standardpl_save,
         standardpl_completed,
-        standardpl_is_goal
+        standardpl_is_goal,
+        NULL
      },
      {
-         "eo", "solves the edge orientation along one axis", 1,
+         "eo", "solves the edge orientation along one axis", 1, 0,
          eopl_default_arguments,
          eopl_run,
          eopl_resume,
          eopl_save,
          eopl_completed,
-         eopl_is_goal
+         eopl_is_goal,
+         eopl_lower_bound
       },
       {
-          "pair", "pairs the edges of a cuboid", 0,
+          "pair", "pairs the edges of a cuboid", 0, 0,
           pairpl_default_arguments,
           pairpl_run,
           pairpl_resume,
           pairpl_save,
           pairpl_completed,
-          pairpl_is_goal
+          pairpl_is_goal,
+          pairpl_lower_bound
        }
 };
 
@@ -7,12 +7,14 @@ void test_superflip();
 void test_rl_orientation();
 void test_ud_orientation();
 void test_fb_orientation();
+void test_flippable_edges();
 
 int main(int argc, const char * argv[]) {
     test_superflip();
     test_rl_orientation();
     test_ud_orientation();
     test_fb_orientation();
+    test_flippable_edges();
     
     tests_completed();
     return 0;
@@ -109,3 +111,27 @@ void test_fb_orientation() {
     cuboid_free(cuboid);
     test_completed();
 }
+
+void test_flippable_edges() {
+    test_initiated("flippable edge counts");
+    
+    CuboidDimensions dims = {3, 3, 3};
+    const char * moves[] = {"F", "F2", "R", "U"};
+    int expected[4][3] = {{0, 0, 4}, {0, 0, 0}, {4, 0, 0}, {0, 4, 0}};
+    int i, axis;
+    
+    for (i = 0; i < 4; i++) {
+        Algorithm * algo = algorithm_for_string(moves[i]);
+        Cuboid * cuboid = algorithm_to_cuboid(algo, dims);
+        algorithm_free(algo);
+        for (axis = 0; axis < 3; axis++) {
+            int count = cuboid_count_flippable_edges(cuboid, axis);
+            if (count != expected[i][axis]) {
+                printf("Error: %s flips %d edges on axis %d.\n", moves[i], count, axis);
+            }
+        }
+        cuboid_free(cuboid);
+    }
+    
+    test_completed();
+}
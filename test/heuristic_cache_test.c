@@ -0,0 +1,105 @@
+#include "heuristic/heuristic_cache.h"
+#include "representation/cuboid_qtmoves.h"
+#include "test.h"
+
+void test_hash();
+void test_lookup();
+void test_bounds();
+
+int main(int argc, const char * argv[]) {
+    test_hash();
+    test_lookup();
+    test_bounds();
+    
+    tests_completed();
+    return 0;
+}
+
+void test_hash() {
+    test_initiated("heuristic_cache_hash");
+    
+    CuboidDimensions dims = {3, 3, 3, 0};
+    Cuboid * identity = cuboid_create(dims);
+    Cuboid * turn = cuboid_quarter_face_turn(dims, CuboidMovesAxisY, 1);
+    Cuboid * copy = cuboid_copy(turn);
+    
+    if (heuristic_cache_hash(turn) != heuristic_cache_hash(copy)) {
+        puts("Error: equal cuboids have different hashes.");
+    }
+    if (heuristic_cache_hash(turn) == heuristic_cache_hash(identity)) {
+        puts("Error: a turn has the same hash as the identity.");
+    }
+    
+    cuboid_free(identity);
+    cuboid_free(turn);
+    cuboid_free(copy);
+    
+    test_completed();
+}
+
+void test_lookup() {
+    test_initiated("heuristic_cache_lookup");
+    
+    HeuristicCache * cache = heuristic_cache_create(4);
+    if (cache->mask != 4 * kHeuristicCacheLineEntries - 1) {
+        printf("Error: unexpected mask %llx.\n", cache->mask);
+    }
+    
+    int exceeds = -1;
+    if (heuristic_cache_lookup(cache, 0x1234567800, 5, &exceeds)) {
+        puts("Error: empty cache had a hit.");
+    }
+    heuristic_cache_store(cache, 0x1234567800, 4, 1);
+    if (!heuristic_cache_lookup(cache, 0x1234567800, 5, &exceeds) || exceeds) {
+        puts("Error: exact value did not settle a lookup below it.");
+    }
+    if (!heuristic_cache_lookup(cache, 0x1234567800, 3, &exceeds) || !exceeds) {
+        puts("Error: exact value did not settle a lookup above it.");
+    }
+    
+    // same slot, different tag
+    if (heuristic_cache_lookup(cache, 0x8765432100, 5, &exceeds)) {
+        puts("Error: a different hash had a hit.");
+    }
+    heuristic_cache_store(cache, 0x8765432100, 2, 1);
+    if (heuristic_cache_lookup(cache, 0x1234567800, 5, &exceeds)) {
+        puts("Error: replaced entry had a hit.");
+    }
+    if (cache->hits != 2 || cache->lookups != 5) {
+        printf("Error: expected 2/5 hits but got %llu/%llu.\n", cache->hits, cache->lookups);
+    }
+    heuristic_cache_free(cache);
+    
+    if (heuristic_cache_create(0)) {
+        puts("Error: created a cache with no lines.");
+    }
+    
+    test_completed();
+}
+
+void test_bounds() {
+    test_initiated("heuristic_cache_store lower bounds");
+    
+    HeuristicCache * cache = heuristic_cache_create(1);
+    int exceeds = -1;
+    
+    heuristic_cache_store(cache, 0xabcdef00, 6, 0);
+    if (!heuristic_cache_lookup(cache, 0xabcdef00, 5, &exceeds) || !exceeds) {
+        puts("Error: lower bound did not prune.");
+    }
+    if (heuristic_cache_lookup(cache, 0xabcdef00, 6, &exceeds)) {
+        puts("Error: lower bound settled a lookup it could not prune.");
+    }
+    
+    // values which do not fit are stored as bounds
+    heuristic_cache_store(cache, 0xabcdef00, 200, 1);
+    if (!heuristic_cache_lookup(cache, 0xabcdef00, 100, &exceeds) || !exceeds) {
+        puts("Error: clamped value did not prune.");
+    }
+    if (heuristic_cache_lookup(cache, 0xabcdef00, 150, &exceeds)) {
+        puts("Error: clamped value was treated as exact.");
+    }
+    heuristic_cache_free(cache);
+    
+    test_completed();
+}
@@ -0,0 +1,110 @@
+#include "heuristic/heuristic_coords.h"
+#include "algebra/basis.h"
+#include "test.h"
+
+void test_untracked();
+void test_transitions();
+void test_subproblem_transitions(const char * name, RotationBasis symmetries);
+
+HeuristicList * create_test_list(const char * name, RotationBasis symmetries);
+void free_test_list(HeuristicList * list);
+
+int main(int argc, const char * argv[]) {
+    test_untracked();
+    test_transitions();
+    
+    tests_completed();
+    return 0;
+}
+
+void test_untracked() {
+    test_initiated("heuristic_coords_untracked");
+    
+    // the corners subproblem has no transition
+    CuboidDimensions dims = {3, 3, 3, 0};
+    RotationBasis symmetries = {dims, 1, 1, 1};
+    HeuristicList * list = create_test_list("corners", symmetries);
+    AlgList * operations = cuboid_standard_basis(dims);
+    if (heuristic_coords_create(list, operations)) {
+        puts("Error: corners should not be tracked.");
+    }
+    alg_list_release(operations);
+    free_test_list(list);
+    
+    test_completed();
+}
+
+void test_transitions() {
+    test_initiated("heuristic_coords_transitions");
+    
+    CuboidDimensions dims3 = {3, 3, 3, 0};
+    CuboidDimensions dims4 = {4, 4, 4, 0};
+    RotationBasis bases[] = {
+        {dims3, 0, 0, 0}, {dims3, 1, 1, 1}, {dims3, 0, 1, 0}, {dims4, 1, 1, 1}
+    };
+    const char * names[] = {"eo", "cco"};
+    int i, j;
+    for (i = 0; i < 2; i++) {
+        for (j = 0; j < sizeof(bases) / sizeof(RotationBasis); j++) {
+            test_subproblem_transitions(names[i], bases[j]);
+        }
+    }
+    
+    test_completed();
+}
+
+void test_subproblem_transitions(const char * name, RotationBasis symmetries) {
+    HeuristicList * list = create_test_list(name, symmetries);
+    AlgList * operations = cuboid_standard_basis(symmetries.dims);
+    HeuristicCoords * coords = heuristic_coords_create(list, operations);
+    HeuristicCoords * fresh = heuristic_coords_create(list, operations);
+    if (!coords || !fresh) {
+        printf("Error: %s should be tracked.\n", name);
+        return;
+    }
+    
+    // the data carried along a random path must match the data which is
+    // read from each node directly
+    Cuboid * root = cuboid_create(symmetries.dims);
+    Cuboid * node = cuboid_create(symmetries.dims);
+    int sequence[12], len;
+    for (len = 1; len <= 12; len++) {
+        sequence[len - 1] = rand() % operations->entryCount;
+        cuboid_multiply_to(operations->entries[sequence[len - 1]].cuboid, node);
+        heuristic_coords_update(coords, root, sequence, len);
+        heuristic_coords_update(fresh, node, NULL, 0);
+        if (memcmp(coords->rows[len], fresh->rows[0], coords->rowSize)) {
+            printf("Error: %s data differs after %d moves.\n", name, len);
+            break;
+        }
+    }
+    
+    cuboid_free(root);
+    cuboid_free(node);
+    heuristic_coords_free(coords);
+    heuristic_coords_free(fresh);
+    alg_list_release(operations);
+    free_test_list(list);
+}
+
+HeuristicList * create_test_list(const char * name, RotationBasis symmetries) {
+    HSParameters params = {symmetries, 5};
+    CLArgumentList * args = cl_argument_list_new();
+    Heuristic * heuristic = heuristic_create(params, args, name);
+    cl_argument_list_free(args);
+    
+    HeuristicList * list = heuristic_list_new();
+    heuristic_list_add(list, heuristic, name);
+    return list;
+}
+
+void free_test_list(HeuristicList * list) {
+    int i;
+    for (i = 0; i < list->count; i++) {
+        heuristic_free(list->heuristics[i]);
+        free(list->fileNames[i]);
+    }
+    free(list->heuristics);
+    free(list->fileNames);
+    heuristic_list_free(list);
+}
@@ -1,17 +1,44 @@
 #include "heuristic/data_list.h"
+#include "heuristic/data_list_batch.h"
 #include "test.h"
 
 void test_full_sharded();
 void test_half_sharded();
 void test_no_sharded();
+void test_frozen();
+void test_filtered();
+void test_compressed();
+void test_batch();
+void test_hashed();
+void test_adaptive();
+void test_reshard();
+void test_strip_header();
+void test_set_header_byte();
+void test_remove_from();
+void test_shard_histogram();
 
 void test_data_list(DataList * list);
+void test_list_lookups(DataList * list);
+void test_base_sizes(DataListNode * node, unsigned long long maxSize, int * minDepth,
+                     int * maxDepth);
 uint8_t make_checksum(const uint8_t * ptr, int len);
+void check_removed(void * context, const uint8_t * body, const uint8_t * header);
 
 int main(int argc, const char * argv[]) {
     test_full_sharded();
     test_half_sharded();
     test_no_sharded();
+    test_frozen();
+    test_filtered();
+    test_compressed();
+    test_batch();
+    test_hashed();
+    test_adaptive();
+    test_reshard();
+    test_strip_header();
+    test_set_header_byte();
+    test_remove_from();
+    test_shard_histogram();
     
     tests_completed();
     return 0;
@@ -47,6 +74,397 @@ void test_no_sharded() {
     test_completed();
 }
 
+void test_frozen() {
+    test_initiated("data_list_freeze");
+    
+    int i;
+    for (i = 0; i <= 4; i += 2) {
+        DataList * list = data_list_create(4, 1, i);
+        test_data_list(list);
+        if (!data_list_freeze(list)) {
+            puts("Error: failed to freeze list.");
+        } else {
+            test_list_lookups(list);
+        }
+        data_list_free(list);
+    }
+    
+    test_completed();
+}
+
+void test_filtered() {
+    test_initiated("data_list_freeze_filtered");
+    
+    DataList * list = data_list_create(4, 1, 2);
+    test_data_list(list);
+    if (!data_list_freeze_filtered(list)) {
+        puts("Error: failed to freeze list.");
+    } else if (!list->filter) {
+        puts("Error: the frozen list has no filter.");
+    } else {
+        test_list_lookups(list);
+        
+        // keys with a byte of 0x21 were never added
+        uint8_t key[4] = {0x21, 0, 0, 0};
+        int i, passed = 0;
+        for (i = 0; i < 0x10000; i++) {
+            key[2] = i >> 8;
+            key[3] = i & 0xff;
+            passed += data_filter_may_contain(list->filter, key);
+        }
+        if (passed > 0x10000 / 20) {
+            printf("Error: %d of 65536 missing keys passed the filter.\n", passed);
+        }
+    }
+    data_list_free(list);
+    
+    test_completed();
+}
+
+void test_compressed() {
+    test_initiated("compressed data_list_freeze");
+    
+    int i;
+    for (i = 0; i <= 4; i += 2) {
+        DataList * list = data_list_create(4, 1, i);
+        test_data_list(list);
+        if (!data_list_freeze_options(list, kDataListFreezeCompress)) {
+            puts("Error: failed to freeze list.");
+        } else if (!list->frozen->restartInterval) {
+            puts("Error: the frozen list is not compressed.");
+        } else {
+            test_list_lookups(list);
+        }
+        data_list_free(list);
+    }
+    
+    test_completed();
+}
+
+void test_batch() {
+    test_initiated("data_list_batch");
+    
+    DataList * list = data_list_create(4, 1, 2);
+    DataListBatch * batch = data_list_batch_create(list);
+    uint8_t key[4];
+    uint8_t header;
+    int i, j;
+    
+    // every key starts at depth 5 and is added again at depth (i % 7)
+    for (i = 0; i < 0x4000; i += 2) {
+        key[0] = 0; key[1] = 0; key[2] = i >> 8; key[3] = i & 0xff;
+        header = 5;
+        data_list_batch_add(batch, key, &header);
+    }
+    if (data_list_batch_merge(batch) != 0x2000) {
+        puts("Error: unexpected number of entries added.");
+    }
+    for (j = 0; j < 2; j++) {
+        for (i = 0x3fff; i >= 0; i--) {
+            key[0] = 0; key[1] = 0; key[2] = i >> 8; key[3] = i & 0xff;
+            header = i % 7;
+            data_list_batch_add(batch, key, &header);
+        }
+    }
+    if (data_list_batch_merge(batch) != 0x2000) {
+        puts("Error: unexpected number of entries added.");
+    }
+    data_list_batch_free(batch);
+    
+    for (i = 0; i < 0x4000; i++) {
+        key[0] = 0; key[1] = 0; key[2] = i >> 8; key[3] = i & 0xff;
+        int expected = i % 7;
+        if (i % 2 == 0 && expected > 5) expected = 5;
+        uint8_t * found;
+        if (!data_list_find(list, key, &found)) {
+            printf("Error: entry %d was not found.\n", i);
+            break;
+        } else if (*found != expected) {
+            printf("Error: expected %d but got %d for %d.\n", expected, *found, i);
+            break;
+        }
+    }
+    data_list_free(list);
+    
+    test_completed();
+}
+
+void test_hashed() {
+    test_initiated("hashed data_list");
+    
+    DataList * list = data_list_create_hashed(4, 1);
+    uint8_t key[4];
+    int a, b, c, d;
+    for (a = 0; a <= 0x20; a++) {
+        for (b = 0; b <= 0x20; b++) {
+            for (c = 0; c <= 0x20; c++) {
+                for (d = 0; d <= 0x20; d++) {
+                    key[0] = d;
+                    key[1] = c;
+                    key[2] = b;
+                    key[3] = a;
+                    uint8_t header = make_checksum(key, 4);
+                    if (!data_list_add(list, key, &header)) {
+                        printf("Error: %d %d %d %d was already added.\n", d, c, b, a);
+                    }
+                }
+            }
+        }
+    }
+    key[0] = key[1] = key[2] = key[3] = 0;
+    uint8_t header = 0;
+    if (data_list_add(list, key, &header)) {
+        puts("Error: a duplicate key was added.");
+    }
+    test_list_lookups(list);
+    data_list_free(list);
+    
+    test_completed();
+}
+
+void test_adaptive() {
+    test_initiated("adaptive data_list");
+    
+    DataList * list = data_list_create_adaptive(4, 1, 3, 0x400);
+    test_data_list(list);
+    test_list_lookups(list);
+    
+    // a lone key stays in a shallow base node, while the dense ones split
+    // down to the maximum depth
+    uint8_t key[4] = {0x30, 0, 0, 0};
+    uint8_t header = 0;
+    data_list_add(list, key, &header);
+    int minDepth = 4, maxDepth = 0;
+    test_base_sizes((DataListNode *)list->rootNode, 0x400, &minDepth, &maxDepth);
+    if (minDepth != 1 || maxDepth != 3) {
+        printf("Error: base nodes have depths %d through %d.\n", minDepth, maxDepth);
+    }
+    
+    DataListBatch * batch = data_list_batch_create(list);
+    int i;
+    key[0] = 0x31;
+    for (i = 0; i < 0x1000; i++) {
+        key[2] = i >> 8;
+        key[3] = i & 0xff;
+        data_list_batch_add(batch, key, &header);
+    }
+    if (data_list_batch_merge(batch) != 0x1000) {
+        puts("Error: unexpected number of entries added.");
+    }
+    data_list_batch_free(batch);
+    uint8_t * found;
+    if (!data_list_find(list, key, &found)) {
+        puts("Error: a merged entry was not found.");
+    }
+    
+    if (!data_list_freeze(list)) {
+        puts("Error: failed to freeze list.");
+    } else if (!data_list_find(list, key, &found)) {
+        puts("Error: a merged entry was not found after freezing.");
+    }
+    data_list_free(list);
+    
+    test_completed();
+}
+
+void test_reshard() {
+    test_initiated("data_list_reshard");
+    
+    // the base nodes of a fully sharded list hold one entry each, so they
+    // are gathered into their parents
+    DataList * list = data_list_create(4, 1, 4);
+    test_data_list(list);
+    data_list_reshard(list, 0x800);
+    int minDepth = 4, maxDepth = 0;
+    test_base_sizes((DataListNode *)list->rootNode, 0x1000, &minDepth, &maxDepth);
+    if (minDepth != 3 || maxDepth != 3) {
+        printf("Error: base nodes have depths %d through %d.\n", minDepth, maxDepth);
+    }
+    test_list_lookups(list);
+    
+    // everything fits in one base node
+    data_list_reshard(list, 0x1000000);
+    if (((DataListNode *)list->rootNode)->subnodeCount != 0) {
+        puts("Error: the list was not gathered into its root.");
+    }
+    test_list_lookups(list);
+    
+    // and is split again, but only until the base nodes are below twice
+    // the target size
+    data_list_reshard(list, 0x800);
+    minDepth = 4;
+    maxDepth = 0;
+    test_base_sizes((DataListNode *)list->rootNode, 0x1000, &minDepth, &maxDepth);
+    if (minDepth != 2 || maxDepth != 2) {
+        printf("Error: base nodes have depths %d through %d.\n", minDepth, maxDepth);
+    }
+    test_list_lookups(list);
+    data_list_free(list);
+    
+    test_completed();
+}
+
+void test_strip_header() {
+    test_initiated("data_list_strip_header");
+    
+    // the second header byte is garbage which should go away
+    DataList * lists[2] = {data_list_create(4, 2, 2), data_list_create_hashed(4, 2)};
+    int i, a, b, c, d;
+    for (i = 0; i < 2; i++) {
+        uint8_t key[4], header[2];
+        for (a = 0; a <= 0x20; a++) {
+            for (b = 0; b <= 0x20; b++) {
+                for (c = 0; c <= 0x20; c++) {
+                    for (d = 0; d <= 0x20; d++) {
+                        key[0] = a;
+                        key[1] = b;
+                        key[2] = c;
+                        key[3] = d;
+                        header[0] = make_checksum(key, 4);
+                        header[1] = 0xff - d;
+                        data_list_add(lists[i], key, header);
+                    }
+                }
+            }
+        }
+        data_list_strip_header(lists[i], 1);
+        if (lists[i]->headerLen != 1) {
+            puts("Error: the header was not stripped.");
+        }
+        test_list_lookups(lists[i]);
+        data_list_free(lists[i]);
+    }
+    
+    test_completed();
+}
+
+void test_set_header_byte() {
+    test_initiated("data_list_set_header_byte");
+    
+    DataList * lists[2] = {data_list_create(4, 2, 2), data_list_create_hashed(4, 2)};
+    int i, j;
+    for (i = 0; i < 2; i++) {
+        uint8_t key[4] = {0, 0, 0, 0}, header[2];
+        for (j = 0; j < 0x10000; j++) {
+            key[1] = j >> 8;
+            key[3] = j & 0xff;
+            header[0] = make_checksum(key, 4);
+            header[1] = j & 0xff;
+            data_list_add(lists[i], key, header);
+        }
+        data_list_set_header_byte(lists[i], 1, 0xfe);
+        for (j = 0; j < 0x10000; j++) {
+            key[1] = j >> 8;
+            key[3] = j & 0xff;
+            uint8_t * found;
+            if (!data_list_find(lists[i], key, &found)) {
+                puts("Error: an entry went missing.");
+                break;
+            }
+            if (found[0] != make_checksum(key, 4) || found[1] != 0xfe) {
+                puts("Error: the wrong header byte was set.");
+                break;
+            }
+        }
+        data_list_free(lists[i]);
+    }
+    
+    test_completed();
+}
+
+void test_remove_from() {
+    test_initiated("data_list_remove_from");
+    
+    DataList * lists[2] = {data_list_create(4, 2, 2),
+                           data_list_create_adaptive(4, 2, 4, 0x1000)};
+    int i, j;
+    for (i = 0; i < 2; i++) {
+        uint8_t key[4] = {0, 0, 0, 0}, header[2] = {0, 0};
+        for (j = 0; j < 0x10000; j++) {
+            key[1] = j >> 8;
+            key[3] = j & 0xff;
+            header[0] = j & 7;
+            data_list_add(lists[i], key, header);
+        }
+        
+        // entries come out in order, so each must follow the last
+        uint8_t last[4] = {0, 0, 0, 0};
+        unsigned long long count = data_list_remove_from(lists[i], 5, check_removed, last);
+        if (count != 0x10000 * 3 / 8) {
+            printf("Error: removed %llu entries.\n", count);
+        }
+        for (j = 0; j < 0x10000; j++) {
+            key[1] = j >> 8;
+            key[3] = j & 0xff;
+            uint8_t * found;
+            if (data_list_find(lists[i], key, &found) != ((j & 7) < 5)) {
+                puts("Error: the wrong entries were removed.");
+                break;
+            }
+        }
+        data_list_free(lists[i]);
+    }
+    
+    test_completed();
+}
+
+void check_removed(void * context, const uint8_t * body, const uint8_t * header) {
+    uint8_t * last = (uint8_t *)context;
+    if (header[0] < 5) puts("Error: removed an entry below the minimum.");
+    if (memcmp(body, last, 4) <= 0) puts("Error: entries were removed out of order.");
+    memcpy(last, body, 4);
+}
+
+void test_shard_histogram() {
+    test_initiated("data_list_shard_histogram");
+    
+    // each entry of a list sharded by one byte takes up four bytes
+    DataList * list = data_list_create(4, 1, 1);
+    int counts[4] = {1, 2, 4, 3};
+    int i, j;
+    for (i = 0; i < 4; i++) {
+        for (j = 0; j < counts[i]; j++) {
+            uint8_t key[4] = {i, 0, 0, j};
+            uint8_t header = 1;
+            data_list_add(list, key, &header);
+        }
+    }
+    
+    unsigned long long buckets[8], expected[8] = {0, 0, 1, 2, 1, 0, 0, 0};
+    bzero(buckets, sizeof(buckets));
+    data_list_shard_histogram(list, buckets, 8);
+    if (memcmp(buckets, expected, sizeof(buckets))) {
+        puts("Error: wrong shard histogram.");
+    }
+    
+    // the last bucket takes the bigger nodes too
+    bzero(buckets, sizeof(buckets));
+    data_list_shard_histogram(list, buckets, 4);
+    if (buckets[2] != 1 || buckets[3] != 3) {
+        puts("Error: bigger nodes should go in the last bucket.");
+    }
+    data_list_free(list);
+    
+    test_completed();
+}
+
+void test_base_sizes(DataListNode * node, unsigned long long maxSize, int * minDepth,
+                     int * maxDepth) {
+    if (node->subnodeCount == 0) {
+        if (node->dataSize > maxSize && node->depth < node->list->depth) {
+            printf("Error: a base node has %llu bytes.\n", node->dataSize);
+        }
+        if (node->depth < *minDepth) *minDepth = node->depth;
+        if (node->depth > *maxDepth) *maxDepth = node->depth;
+        return;
+    }
+    if (node->dataSize > 0) puts("Error: a node has entries and subnodes.");
+    int i;
+    for (i = 0; i < node->subnodeCount; i++) {
+        test_base_sizes((DataListNode *)node->subnodes[i], maxSize, minDepth, maxDepth);
+    }
+}
+
 void test_data_list(DataList * list) {
     uint8_t counters[4] = {0, 0, 0, 0};
     uint8_t zeros[4] = {0, 0, 0, 0};
@@ -116,6 +534,36 @@ void test_data_list(DataList * list) {
     printf("\n");
 }
 
+void test_list_lookups(DataList * list) {
+    // every entry has bytes up to 0x20, so 0x21 should never be found
+    uint8_t key[4];
+    int a, b, c, d;
+    for (a = 0; a <= 0x21; a++) {
+        for (b = 0; b <= 0x21; b++) {
+            for (c = 0; c <= 0x21; c++) {
+                for (d = 0; d <= 0x21; d++) {
+                    key[0] = a;
+                    key[1] = b;
+                    key[2] = c;
+                    key[3] = d;
+                    int expected = (a < 0x21 && b < 0x21 && c < 0x21 && d < 0x21);
+                    uint8_t * header;
+                    int found = data_list_find(list, key, &header);
+                    if (found != expected) {
+                        printf("Error: expected found = %d for %d %d %d %d.\n",
+                               expected, a, b, c, d);
+                        return;
+                    }
+                    if (found && *header != make_checksum(key, 4)) {
+                        printf("Error: bad header for %d %d %d %d.\n", a, b, c, d);
+                        return;
+                    }
+                }
+            }
+        }
+    }
+}
+
 uint8_t make_checksum(const uint8_t * ptr, int len) {
     uint8_t chk = 0xc4;
     int i;
@@ -0,0 +1,126 @@
+#include "heuristic/dense_table.h"
+#include "saving/save_dense_table.h"
+#include "test.h"
+
+void test_from_list();
+void test_save_load();
+void test_exact_depth();
+
+DenseTable * create_test_table();
+int test_table_entries(DenseTable * table);
+int make_depth(const uint8_t * key);
+
+int main(int argc, const char * argv[]) {
+    test_from_list();
+    test_save_load();
+    test_exact_depth();
+    
+    tests_completed();
+    return 0;
+}
+
+void test_from_list() {
+    test_initiated("dense_table_create_from_list");
+    
+    DenseTable * table = create_test_table();
+    if (table->keyBits != 15) {
+        printf("Error: expected 15 key bits but got %d.\n", table->keyBits);
+    }
+    test_table_entries(table);
+    
+    uint8_t badKey[3] = {0x20, 0, 0};
+    if (dense_table_get(table, badKey) != kDenseTableNotFound) {
+        puts("Error: key with unused bits was found.");
+    }
+    dense_table_free(table);
+    
+    test_completed();
+}
+
+void test_save_load() {
+    test_initiated("dense table saving");
+    
+    DenseTable * table = create_test_table();
+    FILE * temp = tmpfile();
+    save_dense_table(table, temp);
+    fseek(temp, 0, SEEK_SET);
+    DenseTable * loaded = load_dense_table(temp);
+    fclose(temp);
+    dense_table_free(table);
+    
+    if (!loaded) {
+        puts("Error: failed to load dense table.");
+    } else {
+        test_table_entries(loaded);
+        dense_table_free(loaded);
+    }
+    
+    test_completed();
+}
+
+void test_exact_depth() {
+    test_initiated("dense_table_exact_depth");
+    
+    int depth, neighbor;
+    for (depth = 0; depth < 10; depth++) {
+        for (neighbor = depth - 1; neighbor <= depth + 1; neighbor++) {
+            if (neighbor < 0) continue;
+            int value = dense_table_exact_depth(depth % 3, neighbor);
+            if (value != depth) {
+                printf("Error: expected %d from neighbor %d but got %d.\n",
+                       depth, neighbor, value);
+            }
+        }
+    }
+    if (dense_table_exact_depth(kDenseTableNotFound, 3) != -1) {
+        puts("Error: missing entry should have no depth.");
+    }
+    
+    test_completed();
+}
+
+DenseTable * create_test_table() {
+    DataList * list = data_list_create(3, 1, 2);
+    uint8_t key[3];
+    int a, b, c;
+    for (a = 0; a < 0x20; a++) {
+        for (b = 0; b < 0x20; b++) {
+            for (c = 0; c < 0x20; c++) {
+                key[0] = a;
+                key[1] = b;
+                key[2] = c;
+                uint8_t header = make_depth(key);
+                DataListNode * node = data_list_find_base(list, key, 1);
+                data_list_base_add(node, key, &header);
+            }
+        }
+    }
+    DenseTable * table = dense_table_create_from_list(list);
+    data_list_free(list);
+    return table;
+}
+
+int test_table_entries(DenseTable * table) {
+    uint8_t key[3];
+    int a, b, c;
+    for (a = 0; a < 0x20; a++) {
+        for (b = 0; b < 0x20; b++) {
+            for (c = 0; c < 0x20; c++) {
+                key[0] = a;
+                key[1] = b;
+                key[2] = c;
+                int value = dense_table_get(table, key);
+                if (value != make_depth(key) % 3) {
+                    printf("Error: expected %d but got %d for %d %d %d.\n",
+                           make_depth(key) % 3, value, a, b, c);
+                    return 0;
+                }
+            }
+        }
+    }
+    return 1;
+}
+
+int make_depth(const uint8_t * key) {
+    return (key[0] + key[1] * 3 + key[2]) % 11;
+}
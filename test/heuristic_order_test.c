@@ -0,0 +1,120 @@
+#include "heuristic/heuristic_order.h"
+#include "test.h"
+
+void test_update();
+void test_groups();
+
+HeuristicList * create_test_list(int count);
+void free_test_list(HeuristicList * list);
+
+int main(int argc, const char * argv[]) {
+    test_update();
+    test_groups();
+    
+    tests_completed();
+    return 0;
+}
+
+void test_update() {
+    test_initiated("heuristic_order_update");
+    
+    HeuristicList * list = create_test_list(3);
+    HeuristicOrder * order = heuristic_order_create(list);
+    int i;
+    for (i = 0; i < 3; i++) {
+        if (order->order[i] != i) {
+            puts("Error: initial order is not the list order.");
+        }
+    }
+    
+    // 0 is slow and rarely prunes; 2 is fast and prunes often
+    HeuristicOrderStats stats[3] = {
+        {1000, 10, 100, 1e-3},
+        {1000, 500, 100, 1e-3},
+        {1000, 500, 100, 1e-4, }
+    };
+    memcpy(order->stats, stats, sizeof(stats));
+    heuristic_order_update(order);
+    if (order->order[0] != 2 || order->order[1] != 1 || order->order[2] != 0) {
+        printf("Error: got order %d, %d, %d.\n", order->order[0],
+               order->order[1], order->order[2]);
+    }
+    if (order->stats[0].lookups != 500 || order->stats[2].prunes != 250) {
+        puts("Error: statistics were not halved.");
+    }
+    
+    heuristic_order_free(order);
+    free_test_list(list);
+    
+    test_completed();
+}
+
+void test_groups() {
+    test_initiated("heuristic_order_groups");
+    
+    // heuristics 1, 2 and 3 form one additive group
+    HeuristicList * list = create_test_list(2);
+    int i;
+    for (i = 0; i < 2; i++) {
+        Heuristic * heuristic = (Heuristic *)malloc(sizeof(Heuristic));
+        bzero(heuristic, sizeof(Heuristic));
+        heuristic->params.maxDepth = 5;
+        heuristic_list_add_additive(list, heuristic, "test");
+    }
+    if (!heuristic_list_has_groups(list)) {
+        puts("Error: the list has no groups.");
+    }
+    if (heuristic_list_group_end(list, 1) != 4 || heuristic_list_group_end(list, 0) != 1) {
+        puts("Error: invalid group ends.");
+    }
+    if (heuristic_list_group_depth(list, 1) != 17) {
+        printf("Error: got group depth %d.\n", heuristic_list_group_depth(list, 1));
+    }
+    
+    HeuristicOrder * order = heuristic_order_create(list);
+    if (order->count != 2) {
+        printf("Error: got %d entries in the order.\n", order->count);
+    }
+    
+    // known values are summed within the group without any lookups
+    int values[4] = {3, 2, 2, 2};
+    int value, exact;
+    int exceeds = heuristic_order_exceeds(order, NULL, NULL, NULL, 5, values,
+                                          &value, &exact);
+    if (!exceeds || value != 6 || !exact) {
+        printf("Error: got exceeds=%d, value=%d, exact=%d.\n", exceeds, value, exact);
+    }
+    exceeds = heuristic_order_exceeds(order, NULL, NULL, NULL, 6, values,
+                                      &value, &exact);
+    if (exceeds || value != 6) {
+        printf("Error: got exceeds=%d, value=%d.\n", exceeds, value);
+    }
+    
+    heuristic_order_free(order);
+    free_test_list(list);
+    
+    test_completed();
+}
+
+HeuristicList * create_test_list(int count) {
+    HeuristicList * list = heuristic_list_new();
+    int i;
+    for (i = 0; i < count; i++) {
+        Heuristic * heuristic = (Heuristic *)malloc(sizeof(Heuristic));
+        bzero(heuristic, sizeof(Heuristic));
+        heuristic->params.maxDepth = 5;
+        heuristic_list_add(list, heuristic, "test");
+    }
+    return list;
+}
+
+void free_test_list(HeuristicList * list) {
+    int i;
+    for (i = 0; i < list->count; i++) {
+        free(list->heuristics[i]);
+        free(list->fileNames[i]);
+    }
+    free(list->heuristics);
+    free(list->fileNames);
+    heuristic_list_free(list);
+}
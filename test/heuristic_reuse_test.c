@@ -0,0 +1,205 @@
+#include "heuristic/heuristic.h"
+#include "heuristic/heuristic_reuse.h"
+#include "heuristic/subproblem_table.h"
+#include "representation/cuboid_qtmoves.h"
+#include "algebra/basis.h"
+#include "algebra/inverse.h"
+#include "test.h"
+
+void test_operation_affects();
+void test_inverse_reuse();
+void test_all_angles();
+
+Heuristic * create_test_heuristic(const char * name);
+
+int main(int argc, const char * argv[]) {
+    test_operation_affects();
+    test_inverse_reuse();
+    test_all_angles();
+    
+    tests_completed();
+    return 0;
+}
+
+void test_operation_affects() {
+    test_initiated("heuristic_operation_affects");
+    
+    CuboidDimensions dims = {3, 3, 3, 0};
+    Cuboid * face = cuboid_quarter_face_turn(dims, CuboidMovesAxisY, 1);
+    Cuboid * slice = cuboid_quarter_slice(dims, CuboidMovesAxisY, 0);
+    
+    Heuristic * corners = create_test_heuristic("corners");
+    if (!heuristic_operation_affects(corners, face)) {
+        puts("Error: a face turn should affect the corners.");
+    }
+    if (heuristic_operation_affects(corners, slice)) {
+        puts("Error: a slice should not affect the corners.");
+    }
+    
+    Heuristic * centers = create_test_heuristic("centers");
+    if (heuristic_operation_affects(centers, face)) {
+        puts("Error: a face turn should not affect the 3x3x3 centers.");
+    }
+    if (!heuristic_operation_affects(centers, slice)) {
+        puts("Error: a slice should affect the centers.");
+    }
+    
+    // without piece_types, every operation is assumed to matter
+    corners->subproblem.piece_types = NULL;
+    if (!heuristic_operation_affects(corners, slice)) {
+        puts("Error: an unknown subproblem should always be affected.");
+    }
+    
+    free(corners);
+    free(centers);
+    cuboid_free(face);
+    cuboid_free(slice);
+    
+    test_completed();
+}
+
+void test_inverse_reuse() {
+    test_initiated("heuristic_reuse_inverse");
+    
+    // front bottom, back bottom, bottom left and bottom right
+    CuboidDimensions dims = {3, 3, 3, 0};
+    HSParameters params = {{dims, 0, 0, 0}, 0};
+    Heuristic * dedges = create_test_heuristic("dedges");
+    CLArgumentList * args = cl_argument_list_new();
+    cl_argument_list_add(args, cl_argument_new_string("dedges", "001000001011"));
+    dedges->params = params;
+    dedges->subproblem.initialize(params, args, &dedges->spUserData);
+    cl_argument_list_free(args);
+    
+    AlgList * operations = alg_list_parse("U,D", dims);
+    Cuboid * up = operations->entries[0].cuboid;
+    Cuboid * down = operations->entries[1].cuboid;
+    if (!heuristic_operation_affects(dedges, up)) {
+        puts("Error: a U turn can move D-layer dedges which are on top.");
+    }
+    if (heuristic_operation_affects_inverse(dedges, up)) {
+        puts("Error: a U turn should not affect the inverse of the D-layer dedges.");
+    }
+    if (!heuristic_operation_affects_inverse(dedges, down)) {
+        puts("Error: a D turn should affect the inverse of the D-layer dedges.");
+    }
+    
+    // the inverse keeps its data after a U turn, wherever the dedges are
+    AlgList * moves = cuboid_standard_basis(dims);
+    Cuboid * cuboid = cuboid_create(dims);
+    Cuboid * child = cuboid_create(dims);
+    uint8_t before[8], after[8];
+    int i;
+    for (i = 0; i < 50; i++) {
+        cuboid_multiply_to(moves->entries[rand() % moves->entryCount].cuboid, cuboid);
+        cuboid_multiply(child, up, cuboid);
+        Cuboid * inverse = cuboid_inverse(cuboid);
+        Cuboid * childInverse = cuboid_inverse(child);
+        dedges->subproblem.get_data(dedges->spUserData, inverse, before, 0);
+        dedges->subproblem.get_data(dedges->spUserData, childInverse, after, 0);
+        if (memcmp(before, after, 8)) {
+            puts("Error: a U turn changed the inverse of the D-layer dedges.");
+        }
+        cuboid_free(inverse);
+        cuboid_free(childInverse);
+    }
+    
+    // so the U turn takes its parent's inverse value, but not the other
+    HeuristicList * list = heuristic_list_new();
+    heuristic_list_add(list, dedges, "dedges");
+    HeuristicReuse * reuse = heuristic_reuse_create(list, operations, 1);
+    if (!reuse) {
+        puts("Error: a reuse should be created for the inverse values.");
+    } else {
+        int sequence[] = {0};
+        int * root = heuristic_reuse_row(reuse, sequence, 0);
+        root[0] = 4;
+        root[1] = 5;
+        int * row = heuristic_reuse_row(reuse, sequence, 1);
+        if (row[0] != -1) {
+            puts("Error: a U turn should not reuse the D-layer dedges value.");
+        }
+        if (row[1] != 5) {
+            puts("Error: a U turn should reuse the inverse D-layer dedges value.");
+        }
+        heuristic_reuse_free(reuse);
+    }
+    if (heuristic_reuse_create(list, operations, 0)) {
+        puts("Error: nothing should be reused without inverses.");
+    }
+    
+    heuristic_list_free(list);
+    dedges->subproblem.completed(dedges->spUserData);
+    free(dedges);
+    cuboid_free(cuboid);
+    cuboid_free(child);
+    alg_list_release(moves);
+    alg_list_release(operations);
+    
+    test_completed();
+}
+
+void test_all_angles() {
+    test_initiated("heuristic_all_angles");
+    
+    CuboidDimensions dims[] = {{3, 3, 3, 0}, {4, 4, 4, 0}, {3, 4, 5, 0}};
+    int powers[][3] = {{0, 0, 0}, {1, 1, 1}, {0, 1, 0}, {1, 0, 0}, {2, 2, 2}, {0, 2, 0}};
+    int i, j, k, trial, angle;
+    for (i = 0; i < sizeof(HSubproblemTable) / sizeof(HSubproblem); i++) {
+        HSubproblem sp = HSubproblemTable[i];
+        if (!sp.get_all_angles) continue;
+        for (j = 0; j < sizeof(dims) / sizeof(CuboidDimensions); j++) {
+            int symmetric = (dims[j].x == dims[j].y && dims[j].y == dims[j].z);
+            AlgList * moves = cuboid_standard_basis(dims[j]);
+            Cuboid * cuboid = cuboid_create(dims[j]);
+            for (k = 0; k < sizeof(powers) / sizeof(powers[0]); k++) {
+                // quarter rotations only make sense on cubes
+                int quarter = (powers[k][0] == 1 || powers[k][1] == 1 || powers[k][2] == 1);
+                if (quarter && !symmetric) continue;
+                RotationBasis basis = {dims[j], powers[k][0], powers[k][1], powers[k][2]};
+                HSParameters params = {basis, 0};
+                CLArgumentList * args = sp.default_arguments();
+                void * userData;
+                sp.initialize(params, args, &userData);
+                cl_argument_list_free(args);
+                
+                int dataSize = sp.data_size(userData);
+                int angleCount = sp.angle_count(userData);
+                uint8_t * all = (uint8_t *)malloc(dataSize * angleCount);
+                uint8_t * single = (uint8_t *)malloc(dataSize);
+                for (trial = 0; trial < 20; trial++) {
+                    int move = rand() % moves->entryCount;
+                    cuboid_multiply_to(moves->entries[move].cuboid, cuboid);
+                    sp.get_all_angles(userData, cuboid, all, dataSize);
+                    for (angle = 0; angle < angleCount; angle++) {
+                        bzero(single, dataSize);
+                        sp.get_data(userData, cuboid, single, angle);
+                        if (memcmp(single, &all[angle * dataSize], dataSize)) {
+                            printf("Error: %s angle %d differs from get_data.\n",
+                                   sp.name, angle);
+                        }
+                    }
+                }
+                free(all);
+                free(single);
+                sp.completed(userData);
+            }
+            cuboid_free(cuboid);
+            alg_list_release(moves);
+        }
+    }
+    
+    test_completed();
+}
+
+Heuristic * create_test_heuristic(const char * name) {
+    Heuristic * heuristic = (Heuristic *)malloc(sizeof(Heuristic));
+    bzero(heuristic, sizeof(Heuristic));
+    int i;
+    for (i = 0; i < sizeof(HSubproblemTable) / sizeof(HSubproblem); i++) {
+        if (strcmp(HSubproblemTable[i].name, name) == 0) {
+            heuristic->subproblem = HSubproblemTable[i];
+        }
+    }
+    return heuristic;
+}
@@ -1,8 +1,12 @@
 #include "heuristic/heuristic_io.h"
 #include "test.h"
 
-void find_move_counts(DataList * list);
+void profile_list(DataList * list);
+void profile_dense_table(DenseTable * table);
 void recursive_count(DataListNode * node, uint64_t * counts);
+void recursive_shards(DataListNode * node, uint64_t * shards, uint64_t * minBytes,
+                      uint64_t * maxBytes, int * minDepth, int * maxDepth);
+void print_counts(uint64_t * counts, int valueCount);
 
 int main(int argc, const char * argv[]) {
     if (argc != 5) {
@@ -25,11 +29,28 @@ int main(int argc, const char * argv[]) {
         rotation_group_count(h->dataSymmetries),
         rotation_cosets_count(h->dataCosets),
         h->cosetCount);
+    printf("%llu bytes of entries, %llu bytes resident\n",
+           heuristic_memory_size(h), heuristic_resident_size(h));
     
     int i;
     for (i = 0; i < h->cosetCount; i++) {
         printf("Distribution for coset %d:\n", i);
-        find_move_counts(h->cosets[i]);
+        if (h->cosets) {
+            profile_list(h->cosets[i]);
+        } else {
+            profile_dense_table(h->denseCosets[i]);
+        }
+    }
+    
+    // the solver freezes the cosets when it loads them; compare the plain
+    // records to the front-coded ones
+    if (h->cosets) {
+        Heuristic * compressed = heuristic_from_file(argv[1], dims);
+        heuristic_freeze(h, 0);
+        heuristic_freeze(compressed, kDataListFreezeCompress);
+        printf("%llu bytes frozen, %llu bytes frozen and compressed\n",
+               heuristic_memory_size(h), heuristic_memory_size(compressed));
+        heuristic_free(compressed);
     }
     
     heuristic_free(h);
@@ -37,16 +58,41 @@ int main(int argc, const char * argv[]) {
     return 0;
 }
 
-void find_move_counts(DataList * list) {
+void profile_list(DataList * list) {
+    if (!list->rootNode) {
+        // hashed and frozen lists have no shards to walk
+        unsigned long long count = (list->frozen ? list->frozen->entryCount : list->hash->count);
+        printf("%llu entries, %llu bytes\n", count, data_list_memory_size(list));
+        return;
+    }
+    
     uint64_t counts[256];
     bzero(counts, sizeof(uint64_t) * 256);
     recursive_count((DataListNode *)list->rootNode, counts);
-    int i;
-    for (i = 0; i < 256; i++) {
-        if (counts[i] > 0) {
-            printf("%d - %llu\n", i, (unsigned long long)counts[i]);
-        }
+    print_counts(counts, 256);
+    
+    uint64_t shards = 0, minBytes = ~0ULL, maxBytes = 0;
+    int minDepth = list->depth, maxDepth = 0;
+    recursive_shards((DataListNode *)list->rootNode, &shards, &minBytes, &maxBytes,
+                     &minDepth, &maxDepth);
+    if (shards == 0) return;
+    double mean = (double)data_list_memory_size(list) / (double)shards;
+    printf("%llu shards of depth %d to %d: %llu min, %.1f mean, %llu max bytes\n",
+           (unsigned long long)shards, minDepth, maxDepth, (unsigned long long)minBytes,
+           mean, (unsigned long long)maxBytes);
+}
+
+void profile_dense_table(DenseTable * table) {
+    // only the depth modulo 3 is stored
+    uint64_t counts[4];
+    bzero(counts, sizeof(uint64_t) * 4);
+    unsigned long long i;
+    for (i = 0; i < table->entryCount; i++) {
+        counts[(table->entries[i >> 2] >> ((i & 3) * 2)) & 3]++;
     }
+    printf("dense table of %d key bits, depths modulo 3:\n", table->keyBits);
+    print_counts(counts, kDenseTableNotFound);
+    printf("%llu keys not found\n", (unsigned long long)counts[kDenseTableNotFound]);
 }
 
 void recursive_count(DataListNode * node, uint64_t * counts) {
@@ -64,3 +110,31 @@ void recursive_count(DataListNode * node, uint64_t * counts) {
         recursive_count(subnode, counts);
     }
 }
+
+void recursive_shards(DataListNode * node, uint64_t * shards, uint64_t * minBytes,
+                      uint64_t * maxBytes, int * minDepth, int * maxDepth) {
+    // adaptive lists have base nodes at different depths
+    if (node->subnodeCount == 0) {
+        if (node->dataSize == 0) return;
+        (*shards)++;
+        if (node->dataSize < *minBytes) *minBytes = node->dataSize;
+        if (node->dataSize > *maxBytes) *maxBytes = node->dataSize;
+        if (node->depth < *minDepth) *minDepth = node->depth;
+        if (node->depth > *maxDepth) *maxDepth = node->depth;
+        return;
+    }
+    int i;
+    for (i = 0; i < node->subnodeCount; i++) {
+        DataListNode * subnode = (DataListNode *)node->subnodes[i];
+        recursive_shards(subnode, shards, minBytes, maxBytes, minDepth, maxDepth);
+    }
+}
+
+void print_counts(uint64_t * counts, int valueCount) {
+    int i;
+    for (i = 0; i < valueCount; i++) {
+        if (counts[i] > 0) {
+            printf("%d - %llu\n", i, (unsigned long long)counts[i]);
+        }
+    }
+}
@@ -1,12 +1,17 @@
 #include "test.h"
 #include "representation/cuboid_qtmoves.h"
 #include "algebra/inverse.h"
+#include "search/sequence_cache.h"
+#include "notation/alg_list.h"
 
 void test_inverse();
+void test_sequence_cache_inverses();
+void ensure_cache_inverse(SequenceCache * cache, AlgList * list, const int * seq, int len);
 void ensure_identity(Cuboid * cuboid);
 
 int main() {
     test_inverse();
+    test_sequence_cache_inverses();
     
     tests_completed();
     return 0;
@@ -40,6 +45,50 @@ void test_inverse() {
     test_completed();
 }
 
+void test_sequence_cache_inverses() {
+    test_initiated("sequence cache inverses");
+    
+    CuboidDimensions dims = {4, 4, 4};
+    AlgList * list = alg_list_parse("R,U,F',B2,D", dims);
+    Cuboid * base = cuboid_quarter_face_turn(dims, CuboidMovesAxisZ, 1);
+    Cuboid * baseInverse = cuboid_inverse(base);
+    Cuboid ** inverses = (Cuboid **)malloc(sizeof(Cuboid *) * list->entryCount);
+    int i;
+    for (i = 0; i < list->entryCount; i++) {
+        inverses[i] = cuboid_inverse(list->entries[i].cuboid);
+    }
+    
+    SequenceCache * cache = sequence_cache_create(base, 0);
+    sequence_cache_track_inverses(cache, baseInverse, inverses);
+    
+    // the second sequence shares a prefix with the first
+    int first[] = {0, 1, 2, 3};
+    int second[] = {0, 1, 4, 4, 2};
+    ensure_cache_inverse(cache, list, first, 0);
+    ensure_cache_inverse(cache, list, first, 4);
+    ensure_cache_inverse(cache, list, second, 5);
+    ensure_cache_inverse(cache, list, second, 2);
+    
+    sequence_cache_free(cache);
+    for (i = 0; i < list->entryCount; i++) {
+        cuboid_free(inverses[i]);
+    }
+    free(inverses);
+    cuboid_free(baseInverse);
+    cuboid_free(base);
+    alg_list_release(list);
+    
+    test_completed();
+}
+
+void ensure_cache_inverse(SequenceCache * cache, AlgList * list, const int * seq, int len) {
+    const Cuboid * cuboid = sequence_cache_make_cuboid(cache, list, seq, len);
+    Cuboid * product = cuboid_copy(cuboid);
+    cuboid_multiply_to(sequence_cache_inverse(cache, len), product);
+    ensure_identity(product);
+    cuboid_free(product);
+}
+
 void ensure_identity(Cuboid * cuboid) {
     int i, j;
     for (i = 0; i < 12; i++) {
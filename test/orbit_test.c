@@ -0,0 +1,178 @@
+#include "test.h"
+#include "pieces/orbit.h"
+
+void test_orbit_sizes();
+void test_class_ranks();
+void test_position_ranks();
+void test_group_ranks();
+
+int main(int argc, const char * argv[]) {
+    test_orbit_sizes();
+    test_class_ranks();
+    test_position_ranks();
+    test_group_ranks();
+    
+    tests_completed();
+    return 0;
+}
+
+void test_orbit_sizes() {
+    test_initiated("orbit sizes on a 5x5x5");
+    
+    CuboidDimensions dims = {5, 5, 5, 0};
+    Cuboid * cuboid = cuboid_create(dims);
+    uint16_t slots[54];
+    
+    // the corner x-centers, the middle center and the t-centers of face 1;
+    // the standard basis never turns a middle slice
+    int centers[] = {0, 4, 1};
+    int centerSizes[] = {24, 1, 24};
+    int i, j;
+    for (i = 0; i < 3; i++) {
+        int slot = cuboid_center_index(cuboid, 1, centers[i]);
+        int count = orbit_center_slots(dims, slot, slots);
+        if (count != centerSizes[i]) {
+            printf("Error: center %d has an orbit of %d.\n", centers[i], count);
+        }
+        for (j = 0; j < count; j++) {
+            CuboidCenter center = cuboid->centers[slots[j]];
+            if (center.index != centers[i] && center.index != 8 - centers[i] &&
+                center.index % 2 != centers[i] % 2) {
+                printf("Error: center %d shares an orbit with %d.\n", centers[i], center.index);
+            }
+        }
+    }
+    
+    // the wings and the midges
+    int edgeSizes[] = {24, 12, 24};
+    for (i = 0; i < 3; i++) {
+        int slot = cuboid_edge_index(cuboid, 0, i);
+        int count = orbit_edge_slots(dims, slot, slots);
+        if (count != edgeSizes[i]) {
+            printf("Error: edge %d has an orbit of %d.\n", i, count);
+        }
+    }
+    
+    cuboid_free(cuboid);
+    test_completed();
+}
+
+void test_class_ranks() {
+    test_initiated("orbit class ranks");
+    
+    // two pieces of class 0, two of class 1 and two untracked in six slots
+    int sizes[] = {2, 2};
+    uint64_t rankCount = orbit_classes_rank_count(6, sizes, 2);
+    if (rankCount != 90) {
+        printf("Error: expected 90 ranks, got %llu.\n", (unsigned long long)rankCount);
+    }
+    
+    uint8_t seen[729];
+    bzero(seen, sizeof(seen));
+    int value, i, total = 0;
+    for (value = 0; value < 729; value++) {
+        uint8_t classes[6];
+        int counts[3] = {0, 0, 0}, number = value;
+        for (i = 0; i < 6; i++) {
+            classes[i] = number % 3;
+            counts[classes[i]]++;
+            number /= 3;
+        }
+        if (counts[0] != 2 || counts[1] != 2) continue;
+        total++;
+        uint64_t rank = orbit_rank_classes(classes, 6, sizes, 2);
+        if (rank >= rankCount) {
+            printf("Error: rank %llu is out of bounds.\n", (unsigned long long)rank);
+        } else if (seen[rank]) {
+            printf("Error: rank %llu is used twice.\n", (unsigned long long)rank);
+        } else {
+            seen[rank] = 1;
+        }
+    }
+    if (total != 90) {
+        printf("Error: enumerated %d arrangements.\n", total);
+    }
+    
+    test_completed();
+}
+
+void test_position_ranks() {
+    test_initiated("orbit position ranks");
+    
+    // three distinct pieces in six slots
+    uint64_t rankCount = orbit_positions_rank_count(3, 6);
+    if (rankCount != 120) {
+        printf("Error: expected 120 ranks, got %llu.\n", (unsigned long long)rankCount);
+    }
+    
+    uint8_t seen[120];
+    bzero(seen, sizeof(seen));
+    uint8_t positions[3];
+    for (positions[0] = 0; positions[0] < 6; positions[0]++) {
+        for (positions[1] = 0; positions[1] < 6; positions[1]++) {
+            for (positions[2] = 0; positions[2] < 6; positions[2]++) {
+                if (positions[0] == positions[1] || positions[0] == positions[2] ||
+                    positions[1] == positions[2]) {
+                    continue;
+                }
+                uint64_t rank = orbit_rank_positions(positions, 3, 6);
+                if (rank >= rankCount) {
+                    printf("Error: rank %llu is out of bounds.\n", (unsigned long long)rank);
+                } else if (seen[rank]) {
+                    printf("Error: rank %llu is used twice.\n", (unsigned long long)rank);
+                } else {
+                    seen[rank] = 1;
+                }
+            }
+        }
+    }
+    
+    test_completed();
+}
+
+void test_group_ranks() {
+    test_initiated("orbit group ranks");
+    
+    // three pairs in six slots
+    uint64_t rankCount = orbit_groups_rank_count(6, 2);
+    if (rankCount != 15) {
+        printf("Error: expected 15 ranks, got %llu.\n", (unsigned long long)rankCount);
+    }
+    
+    // slot 0 is paired with a, and the first slot left over with b
+    uint8_t seen[15];
+    bzero(seen, sizeof(seen));
+    int a, b, i;
+    for (a = 1; a < 6; a++) {
+        for (b = 1; b < 6; b++) {
+            uint8_t labels[6];
+            memset(labels, 2, 6);
+            labels[0] = labels[a] = 0;
+            int first = (a == 1 ? 2 : 1);
+            if (b == a || b <= first) continue;
+            labels[first] = labels[b] = 1;
+            
+            // the rank must not depend on the labels
+            uint8_t relabeled[6];
+            for (i = 0; i < 6; i++) {
+                relabeled[i] = 7 - labels[i];
+            }
+            uint64_t rank = orbit_rank_groups(labels, 6, 2);
+            if (rank != orbit_rank_groups(relabeled, 6, 2)) {
+                puts("Error: the rank depends on the labels.");
+            }
+            if (rank >= rankCount) {
+                printf("Error: rank %llu is out of bounds.\n", (unsigned long long)rank);
+            } else if (seen[rank]) {
+                printf("Error: rank %llu is used twice.\n", (unsigned long long)rank);
+            } else {
+                seen[rank] = 1;
+            }
+        }
+    }
+    for (i = 0; i < 15; i++) {
+        if (!seen[i]) printf("Error: rank %d is never used.\n", i);
+    }
+    
+    test_completed();
+}
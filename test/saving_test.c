@@ -11,15 +11,20 @@ void test_save_algorithm();
 void test_save_base_search();
 void test_save_cuboid_search();
 void test_save_data_list();
+void test_save_hashed_data_list();
+void test_save_data_list_records();
+void test_save_adaptive_records();
 
 BSSearchState * generate_bs_search_state();
 DataList * generate_data_list();
+DataList * generate_adaptive_data_list();
 void test_base_state_equality(BSSearchState * s1, BSSearchState * s2);
 void test_cuboid_state_equality(CSSearchState * s1, CSSearchState * s2);
 void test_srange_equality(SRange r1, SRange r2);
 void test_cuboid_equality(Cuboid * c1, Cuboid * c2);
 int test_algorithm_equality(Algorithm * a1, Algorithm * a2);
 int test_data_list_node_equality(DataListNode * n1, DataListNode * n2);
+void collect_record(void * context, const uint8_t * body, const uint8_t * header);
 
 int main() {
     test_save_cuboid();
@@ -27,6 +32,9 @@ int main() {
     test_save_base_search();
     test_save_cuboid_search();
     test_save_data_list();
+    test_save_hashed_data_list();
+    test_save_data_list_records();
+    test_save_adaptive_records();
     
     tests_completed();
     return 0;
@@ -146,6 +154,9 @@ void test_save_data_list() {
     FILE * temp = tmpfile();
     assert(temp != NULL);
     save_data_list(list, temp);
+    if (ftell(temp) != save_data_list_size(list)) {
+        puts("Error: save_data_list_size() disagrees with the file");
+    }
     fseek(temp, 0, SEEK_SET);
     DataList * loaded = load_data_list(temp);
     fclose(temp);
@@ -171,6 +182,126 @@ void test_save_data_list() {
     test_completed();
 }
 
+void test_save_hashed_data_list() {
+    test_initiated("save_data_list (hashed)");
+    
+    DataList * list = data_list_create_hashed(4, 1);
+    uint8_t key[4];
+    int i;
+    for (i = 0; i < 0x10000; i++) {
+        key[0] = i;
+        key[1] = i >> 8;
+        key[2] = i * 3;
+        key[3] = 0x12;
+        data_list_add(list, key, &key[2]);
+    }
+    
+    FILE * temp = tmpfile();
+    assert(temp != NULL);
+    save_data_list(list, temp);
+    if (ftell(temp) != save_data_list_size(list)) {
+        puts("Error: save_data_list_size() disagrees with the file");
+    }
+    fseek(temp, 0, SEEK_SET);
+    DataList * loaded = load_data_list(temp);
+    fclose(temp);
+    
+    if (!loaded || !loaded->hash) {
+        puts("Error: failed to load hashed data list.");
+    } else {
+        HashDataList * h1 = list->hash, * h2 = loaded->hash;
+        if (h1->count != h2->count || h1->groupCount != h2->groupCount) {
+            puts("Error: hash table sizes disagree");
+        } else if (memcmp(h1->groups, h2->groups, h1->groupCount * h1->groupSize)) {
+            puts("Error: hash table contents disagree");
+        }
+        data_list_free(loaded);
+    }
+    data_list_free(list);
+    
+    test_completed();
+}
+
+void test_save_data_list_records() {
+    test_initiated("save_data_list_records");
+    
+    // the records of a list, in the order they are removed, must save
+    // as the list itself does
+    DataList * list = generate_data_list();
+    DataList * removed = generate_data_list();
+    uint8_t * records = (uint8_t *)malloc(5 * 0x21 * 0x21 * 0x21 * 0x21);
+    uint8_t * next = records;
+    unsigned long long count = data_list_remove_from(removed, 0, collect_record, &next);
+    if (count != (next - records) / 5) {
+        puts("Error: data_list_remove_from() miscounted");
+    }
+    if (data_list_memory_size(removed) != 0) {
+        puts("Error: data_list_remove_from() left entries behind");
+    }
+    
+    FILE * temp = tmpfile();
+    assert(temp != NULL);
+    unsigned long long size = save_data_list_records(records, count, 4, 1, 2, 0, 1, temp);
+    if (ftell(temp) != size || size != save_data_list_size(list)) {
+        puts("Error: save_data_list_records() has the wrong size");
+    }
+    fseek(temp, 0, SEEK_SET);
+    DataList * loaded = load_data_list(temp);
+    fclose(temp);
+    
+    if (loaded) {
+        test_data_list_node_equality(loaded->rootNode, list->rootNode);
+        data_list_free(loaded);
+    } else {
+        puts("Error: failed to load data list records.");
+    }
+    
+    free(records);
+    data_list_free(removed);
+    data_list_free(list);
+    
+    test_completed();
+}
+
+void test_save_adaptive_records() {
+    test_initiated("save_data_list_records (adaptive)");
+    
+    // records must save as a list built with a bigger header would after
+    // it is stripped and resharded
+    DataList * list = generate_adaptive_data_list();
+    DataList * removed = generate_adaptive_data_list();
+    data_list_strip_header(list, 1);
+    data_list_strip_header(removed, 1);
+    data_list_reshard(list, 64);
+    
+    uint8_t * records = (uint8_t *)malloc(5 * 0x10000);
+    uint8_t * next = records;
+    unsigned long long count = data_list_remove_from(removed, 0, collect_record, &next);
+    
+    FILE * temp = tmpfile();
+    assert(temp != NULL);
+    unsigned long long size = save_data_list_records(records, count, 4, 1, 4, 64, 2, temp);
+    if (ftell(temp) != size || size != save_data_list_size(list)) {
+        puts("Error: save_data_list_records() has the wrong size");
+    }
+    fseek(temp, 0, SEEK_SET);
+    DataList * loaded = load_data_list(temp);
+    fclose(temp);
+    
+    if (loaded) {
+        test_data_list_node_equality(loaded->rootNode, list->rootNode);
+        data_list_free(loaded);
+    } else {
+        puts("Error: failed to load data list records.");
+    }
+    
+    free(records);
+    data_list_free(removed);
+    data_list_free(list);
+    
+    test_completed();
+}
+
 BSSearchState * generate_bs_search_state() {
     BSSearchState * state = (BSSearchState *)malloc(sizeof(BSSearchState));
     SBoundary b1, b2, b3, b4;
@@ -248,6 +379,21 @@ DataList * generate_data_list() {
     return list;
 }
 
+DataList * generate_adaptive_data_list() {
+    // each first byte has a different number of entries, so that some
+    // subtrees are split further than others and some not at all
+    DataList * list = data_list_create_adaptive(4, 2, 4, 128);
+    int i, j;
+    for (i = 0; i < 0x20; i++) {
+        for (j = 0; j < i * 3; j++) {
+            uint8_t key[4] = {i, j / 4, (j * 7) & 0xff, j & 3};
+            uint8_t header[2] = {j & 0xf, 0xff};
+            data_list_add(list, key, header);
+        }
+    }
+    return list;
+}
+
 void test_base_state_equality(BSSearchState * s1, BSSearchState * s2) {
     if (s1->threadCount != s2->threadCount) {
         puts("Error: thread counts differ.");
@@ -413,3 +559,10 @@ int test_data_list_node_equality(DataListNode * n1, DataListNode * n2) {
     }
     return 1;
 }
+
+void collect_record(void * context, const uint8_t * body, const uint8_t * header) {
+    uint8_t ** next = (uint8_t **)context;
+    memcpy(*next, body, 4);
+    (*next)[4] = header[0];
+    *next += 5;
+}
@@ -117,6 +117,7 @@ BSCallbacks generate_callbacks() {
     callbacks.handle_depth_increase = cb_handle_depth_increase;
     callbacks.handle_search_complete = cb_handle_search_complete;
     callbacks.should_expand = cb_should_expand;
+    callbacks.should_expand_children = NULL;
     callbacks.handle_save_data = cb_handle_save_data;
     callbacks.handle_progress_update = cb_handle_progress_update;
     return callbacks;
@@ -9,7 +9,7 @@ static volatile unsigned long long cubesFound;
 void test_solve_3x3();
 
 void handle_cuboid(void * data, const Cuboid * cuboid, Cuboid * cache,
-                   const int * sequence, int len);
+                   int thread, const int * sequence, int len);
 
 int main() {
     test_solve_3x3();
@@ -37,6 +37,7 @@ void test_solve_3x3() {
     settings.rootNode = solveMe;
     settings.algorithms = list;
     settings.cacheCuboid = 0;
+    settings.cacheInverse = 0;
     
     bsSettings.threadCount = 8;
     bsSettings.minDepth = 1;
@@ -77,9 +78,10 @@ void test_solve_3x3() {
 }
 
 void handle_cuboid(void * data, const Cuboid * cuboid, Cuboid * _cache,
-                   const int * sequence, int len) {
+                   int thread, const int * sequence, int len) {
     __sync_add_and_fetch(&cubesFound, 1);
     assert(!_cache);
+    assert(thread >= 0 && thread < 8);
     
     RotationGroup * group = (RotationGroup *)data;
     int isSolved = rotation_group_contains(group, cuboid);